@@ -186,12 +186,29 @@ typedef enum {
 /**
  * Vendor model configuration
  * Use this to define custom models with your own protocol
+ *
+ * RECEIVING MESSAGES:
+ * The mesh stack only delivers opcodes listed in the model's operation
+ * table - anything else is dropped before it reaches 'handler'. List the
+ * opcodes this model must receive in rx_opcodes (3-byte vendor opcodes,
+ * e.g. 0xC50001). Sending does not need an entry.
+ *
+ * CLIENT MODELS:
+ * A vendor client (client = true) consumes what other nodes publish -
+ * e.g. a peer's IMU frames on the group it publishes to. Its messages
+ * reach 'handler' the same way; subscribe it to that group with
+ * mesh_model_subscribe_vendor(). The node binds the AppKey to its client
+ * models itself, so the provisioner need not know about them.
  */
 typedef struct {
     uint16_t company_id;         // Your company ID (0xFFFF for testing)
     uint16_t model_id;           // Your model ID (choose any)
     mesh_vendor_handler_t handler; // Message handler callback
     void *user_data;             // Optional user context
+    const uint32_t *rx_opcodes;  // Opcodes to receive (NULL = defaults only)
+    uint8_t rx_opcode_count;     // Entries in rx_opcodes
+    bool deferred;               // Run handler on the rx worker, not the mesh stack's task
+    bool client;                 // Vendor client: receives other nodes' publications
 } mesh_vendor_config_t;
 
 /*
@@ -374,6 +391,120 @@ typedef struct {
 }
 #endif
 
+/**
+ * Configure Vendor model that receives its own opcodes
+ *
+ * @param cid - Company ID
+ * @param mid - Model ID
+ * @param handler - Message handler (called for each listed opcode)
+ * @param ctx - User data pointer
+ * @param ops - Array of 3-byte vendor opcodes to receive
+ * @param count - Number of opcodes in ops
+ *
+ * EXAMPLE:
+ * static const uint32_t my_rx_ops[] = { 0xC50001 };
+ * mesh_model_config_t models[] = {
+ *     MESH_MODEL_VENDOR_RX(0x0001, 0x0001, my_handler, NULL, my_rx_ops, 1),
+ * };
+ */
+#ifdef __cplusplus
+#define MESH_MODEL_VENDOR_RX(cid, mid, handler, ctx, ops, count) { \
+    MESH_MODEL_TYPE_VENDOR, \
+    true, \
+    { .vendor = { (cid), (mid), (handler), (ctx), (ops), (count) } } \
+}
+#else
+#define MESH_MODEL_VENDOR_RX(cid, mid, handler, ctx, ops, count) { \
+    .type = MESH_MODEL_TYPE_VENDOR, \
+    .enable_publication = true, \
+    .config.vendor = { \
+        .company_id = (cid), \
+        .model_id = (mid), \
+        .handler = (handler), \
+        .user_data = (ctx), \
+        .rx_opcodes = (ops), \
+        .rx_opcode_count = (count) \
+    } \
+}
+#endif
+
+/**
+ * Configure Vendor model whose handler runs on the rx worker task
+ *
+ * Same arguments as MESH_MODEL_VENDOR_RX. Each received message is copied
+ * into a pooled buffer and handled on the component's rx worker, so a slow
+ * handler (NVS writes, reconfiguring a pipeline) no longer holds up the
+ * mesh stack. 'ctx' then points to a copy of the message context.
+ *
+ * Costs: one copy per message, a worker task (node_config_t
+ * rx_worker_stack_size), and messages are dropped when all pooled
+ * buffers are busy (mesh_model_get_vendor_rx_stats).
+ */
+#ifdef __cplusplus
+#define MESH_MODEL_VENDOR_RX_DEFERRED(cid, mid, handler, ctx, ops, count) { \
+    MESH_MODEL_TYPE_VENDOR, \
+    true, \
+    { .vendor = { (cid), (mid), (handler), (ctx), (ops), (count), true } } \
+}
+#else
+#define MESH_MODEL_VENDOR_RX_DEFERRED(cid, mid, handler, ctx, ops, count) { \
+    .type = MESH_MODEL_TYPE_VENDOR, \
+    .enable_publication = true, \
+    .config.vendor = { \
+        .company_id = (cid), \
+        .model_id = (mid), \
+        .handler = (handler), \
+        .user_data = (ctx), \
+        .rx_opcodes = (ops), \
+        .rx_opcode_count = (count), \
+        .deferred = true \
+    } \
+}
+#endif
+
+/**
+ * Configure Vendor client model (consumes other nodes' publications)
+ *
+ * @param cid - Company ID of the messages it consumes
+ * @param mid - Model ID (not the server's - one element holds both)
+ * @param handler - Called for each listed opcode a peer publishes to us
+ * @param ctx - User data pointer
+ * @param ops - Array of 3-byte vendor opcodes to receive
+ * @param count - Number of opcodes in ops
+ *
+ * No publication buffer: a client that only listens doesn't need one.
+ * Own publications to a group it is subscribed to come back to it - use
+ * mesh_msg_src_addr() to skip them.
+ *
+ * EXAMPLE:
+ * static const uint32_t peer_ops[] = { 0xC00001 };
+ * mesh_model_config_t models[] = {
+ *     MESH_MODEL_VENDOR_CLIENT(0x0001, 0x0002, on_peer_frame, NULL, peer_ops, 1),
+ * };
+ * ...once provisioned: mesh_model_subscribe_vendor(1, 0xC001);
+ */
+#ifdef __cplusplus
+#define MESH_MODEL_VENDOR_CLIENT(cid, mid, handler, ctx, ops, count) { \
+    MESH_MODEL_TYPE_VENDOR, \
+    false, \
+    { .vendor = { (cid), (mid), (handler), (ctx), (ops), (count), false, true } } \
+}
+#else
+#define MESH_MODEL_VENDOR_CLIENT(cid, mid, handler, ctx, ops, count) { \
+    .type = MESH_MODEL_TYPE_VENDOR, \
+    .enable_publication = false, \
+    .config.vendor = { \
+        .company_id = (cid), \
+        .model_id = (mid), \
+        .handler = (handler), \
+        .user_data = (ctx), \
+        .rx_opcodes = (ops), \
+        .rx_opcode_count = (count), \
+        .client = true \
+    } \
+}
+#endif
+
 /**
  * Configure Battery model
  *
@@ -421,9 +552,15 @@ esp_err_t mesh_model_publish_onoff(uint8_t model_index, uint8_t onoff);
  */
 esp_err_t mesh_model_publish_level(uint8_t model_index, int16_t level);
 
+// TTL of mesh_model_send_vendor / mesh_model_publish_vendor messages. A
+// receiver that sees exactly this TTL (mesh_msg_recv_ttl) got it directly.
+#define MESH_VENDOR_SEND_TTL    7
+
 /**
  * Send vendor model message
  *
+ * Sent with TTL MESH_VENDOR_SEND_TTL.
+ *
  * @param model_index - Which Vendor model (usually 0)
  * @param opcode - Your custom opcode
  * @param data - Message payload
@@ -449,6 +586,145 @@ esp_err_t mesh_model_send_vendor(uint8_t model_index, uint32_t opcode, uint8_t *
 esp_err_t mesh_model_publish_vendor(uint8_t model_index, uint32_t opcode, uint8_t *data,
                                     uint16_t length);
 
+#define MESH_VENDOR_OPCODE_LEN  3
+#define MESH_VENDOR_PUB_MAX     377     // Largest vendor payload: 380-byte access message - opcode
+
+/**
+ * Reserve room for a vendor message next to the model's publication buffer
+ *
+ * Encode the payload straight into the returned pointer, then publish it
+ * with mesh_model_vendor_commit() - no allocation on the way to the stack.
+ * One publication at a time: while the stack still sends the last one
+ * (retransmissions included) there is no room, and the frame goes out
+ * with mesh_model_publish_vendor() instead.
+ *
+ * @param model_index - Which vendor model to use
+ * @param opcode - 3-byte vendor opcode
+ * @param max_len - Largest payload the encoder may write (≤ MESH_VENDOR_PUB_MAX)
+ * @return Where the payload goes, or NULL (not provisioned yet, no
+ *         publication, max_len too large, last publication in flight)
+ */
+uint8_t *mesh_model_vendor_reserve(uint8_t model_index, uint32_t opcode, uint16_t max_len);
+
+/**
+ * Publish the reserved message
+ *
+ * @param model_index - Same model as the reserve call
+ * @param length - Payload bytes written (0 = send nothing, release the reservation)
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if nothing was reserved,
+ *         ESP_ERR_INVALID_SIZE if length exceeds the reservation
+ */
+esp_err_t mesh_model_vendor_commit(uint8_t model_index, uint16_t length);
+
+/**
+ * Periodic publication source
+ *
+ * Called by the mesh stack's publish timer (BTC task) once per period the
+ * provisioner configured with Config Model Publication Set.
+ *
+ * @param opcode - Set to the 3-byte vendor opcode of the frame
+ * @param buf - Where the payload goes (a stage; the frame replaces the
+ *              publication buffer's once its retransmissions are out)
+ * @param cap - Room in buf (MESH_VENDOR_PUB_MAX)
+ * @param user_data - As passed to mesh_model_vendor_set_periodic()
+ * @return Payload length, 0 = nothing new (the last frame is repeated)
+ */
+typedef uint16_t (*mesh_pub_update_t)(uint32_t *opcode, uint8_t *buf, uint16_t cap,
+                                      void *user_data);
+
+/**
+ * Let the stack publish this model periodically
+ *
+ * With a source set, every publish period (0 = none, the default) pulls
+ * the source's latest frame into the publication buffer - the rate then
+ * follows Config Model Publication Set instead of an app timer. Don't mix
+ * with mesh_model_vendor_reserve(): both use the publication buffer.
+ *
+ * @param model_index - Which vendor model
+ * @param update - Frame source, NULL to go back to app-driven publishing
+ * @param user_data - Passed to update
+ * @return ESP_OK, ESP_ERR_NOT_FOUND, or ESP_ERR_INVALID_STATE without publication
+ */
+esp_err_t mesh_model_vendor_set_periodic(uint8_t model_index, mesh_pub_update_t update,
+                                         void *user_data);
+
+/**
+ * Publish-path statistics (all models, since boot or the last reset)
+ */
+typedef struct {
+    uint32_t in_place;          // Publishes sent through the publication buffer (no allocation)
+    uint32_t copied;            // Publishes the stack allocated a buffer for
+    uint32_t copied_bytes;      // Payload bytes copied into those
+    uint32_t in_place_cycles;   // CPU cycles spent inside the publish calls, per path
+    uint32_t copied_cycles;
+} mesh_publish_stats_t;
+
+/**
+ * Read (and optionally reset) the publish-path statistics
+ */
+void mesh_model_get_publish_stats(mesh_publish_stats_t *stats, bool reset);
+
+/**
+ * Received vendor message statistics (all vendor models)
+ */
+typedef struct {
+    uint32_t inline_handled;    // Handled on the mesh stack's task
+    uint32_t deferred;          // Handled on the rx worker
+    uint32_t dropped;           // Deferred, but no pooled buffer was free
+    uint32_t too_long;          // Longer than the largest pooled buffer
+    uint32_t max_pending;       // Most messages waiting for the worker at once
+    uint32_t max_wait_us;       // Longest receive → handler start (deferred)
+    uint32_t max_handler_us;    // Longest handler run (deferred)
+} mesh_vendor_rx_stats_t;
+
+/**
+ * Read (and optionally reset) the received vendor message statistics
+ */
+void mesh_model_get_vendor_rx_stats(mesh_vendor_rx_stats_t *stats, bool reset);
+
+/**
+ * Get the TTL a received vendor message arrived with
+ *
+ * Call it inside a vendor handler. Each relay decrements the TTL, so
+ * (TTL the sender used) - (received TTL) = relay hops the message took.
+ *
+ * @param ctx - The 'ctx' argument of mesh_vendor_handler_t
+ * @return Received TTL, or 0 if ctx is NULL
+ */
+uint8_t mesh_msg_recv_ttl(const void *ctx);
+
+/**
+ * Get the source address of a received vendor message
+ *
+ * @param ctx - The 'ctx' argument of mesh_vendor_handler_t
+ * @return Unicast address of the sender, or 0 if ctx is NULL
+ */
+uint16_t mesh_msg_src_addr(const void *ctx);
+
+/**
+ * Get the RSSI a received vendor message arrived with
+ *
+ * The signal strength of the last hop: the sender's if the message came
+ * directly (received TTL = the TTL it was sent with), else the relay's.
+ *
+ * @param ctx - The 'ctx' argument of mesh_vendor_handler_t
+ * @return RSSI in dBm, or 0 if ctx is NULL
+ */
+int8_t mesh_msg_recv_rssi(const void *ctx);
+
+/**
+ * Subscribe a vendor model to a group address (locally, no provisioner)
+ *
+ * The node adds the subscription itself - e.g. a fixed control group every
+ * node of an application listens on. Needs a free subscription entry
+ * (CONFIG_BLE_MESH_MODEL_GROUP_COUNT counts them per model).
+ *
+ * @param model_index - Which vendor model
+ * @param group_addr - Group address (0xC000-0xFEFF)
+ * @return ESP_OK on success
+ */
+esp_err_t mesh_model_subscribe_vendor(uint8_t model_index, uint16_t group_addr);
+
 /**
  * Get current OnOff state
  *
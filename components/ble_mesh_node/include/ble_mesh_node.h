@@ -93,6 +93,7 @@
 
 #include "esp_err.h"
 #include "ble_mesh_models.h"  // Model library
+#include "mesh_event_loop.h"   // mesh_event_t, mesh_timer_t (event loop + scheduler)
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -110,7 +111,8 @@ extern "C" {
 
 /**
  * Node-level event callbacks
- * These are called for important node lifecycle events
+ * These are called for important node lifecycle events, on the event loop
+ * task (see mesh_event_post()) - not on the mesh stack's task
  */
 typedef struct {
     /**
@@ -189,6 +191,35 @@ typedef struct {
      * Max 29 characters. If NULL, defaults to "ESP-Mesh-Node"
      */
     const char *device_name;
+
+    /**
+     * Optional stack size (bytes) of the event loop task, which runs every
+     * event handler and scheduled job. 0 = 3072; raise it if your
+     * handlers need more.
+     */
+    uint32_t loop_stack_size;
+
+    /**
+     * Optional priority of the event loop task. 0 = 3 (below the Bluetooth
+     * host tasks, so a burst of handlers never delays the radio)
+     */
+    uint8_t loop_priority;
+
+    /**
+     * Optional core affinity of the event loop task
+     * loop_pinned = false: either core (FreeRTOS decides)
+     * loop_pinned = true: always loop_core (0 = PRO_CPU, 1 = APP_CPU;
+     * ignored on single-core builds)
+     */
+    bool loop_pinned;
+    uint8_t loop_core;
+
+    /**
+     * Optional stack size (bytes) of the rx worker task, which runs the
+     * handlers of vendor models configured with
+     * MESH_MODEL_VENDOR_RX_DEFERRED (no task without one). 0 = 3072.
+     */
+    uint32_t rx_worker_stack_size;
 } node_config_t;
 
 /*
@@ -275,6 +306,31 @@ esp_err_t node_init(const node_config_t *config);
  */
 esp_err_t node_start(void);
 
+/**
+ * SWITCH THE RELAY FEATURE
+ * ========================
+ *
+ * A relay re-broadcasts every network PDU it hears (TTL >= 2) with TTL - 1.
+ * Nodes start with relay disabled: relaying everywhere floods the air, so
+ * the application decides at runtime which nodes help - e.g. from the
+ * relay set a gateway computed out of neighbour reports.
+ *
+ * The change is not stored: after a reboot the node relays again only
+ * once it is told to (a Config Relay Set from a provisioner is stored by
+ * the stack as usual).
+ *
+ * @param enable true = relay, false = don't
+ * @return ESP_OK, ESP_ERR_NOT_SUPPORTED without CONFIG_BLE_MESH_RELAY
+ */
+esp_err_t node_set_relay(bool enable);
+
+/**
+ * IS THE NODE RELAYING?
+ * =====================
+ * @return true if the relay feature is enabled
+ */
+bool node_get_relay(void);
+
 /*
  * ============================================================================
  *                    MODEL API FUNCTIONS (NEW EXTENSIBLE API)
@@ -382,6 +438,104 @@ esp_err_t mesh_model_set_battery(uint8_t model_index, uint8_t battery_level);
  */
 esp_err_t mesh_model_publish_battery(uint8_t model_index);
 
+/*
+ * ============================================================================
+ *                    EVENT LOOP AND SCHEDULER
+ * ============================================================================
+ * One task (see mesh_event_loop.h) handles everything the node reacts to:
+ * - events posted to its queue: mesh lifecycle (node_callbacks_t), and
+ *   the application's own - button interrupts, "data ready" from a
+ *   sampling task - registered with mesh_event_on()
+ * - timers on its timer wheel (mesh_timer_wheel.h): the Sensor and Battery
+ *   publish_period_ms of the configured models are armed by node_init(),
+ *   and the application adds its own (telemetry reports, cadence checks)
+ *   instead of creating a task per job. Jobs due in the same
+ *   MESH_WHEEL_TICK_MS tick run back to back in one wakeup.
+ *
+ * Between events and deadlines the task is blocked, nothing polls.
+ * Handlers and callbacks all run on this task: keep them short and never
+ * block, everything after them waits.
+ */
+
+/**
+ * Event loop / scheduler statistics
+ */
+typedef struct {
+    uint32_t armed;                 // Timers currently armed
+    uint32_t fired;                 // Callbacks run
+    uint32_t batches;               // Wakeups that ran at least one callback
+    uint32_t wakeups;               // Times the loop task woke up (events + deadlines)
+    uint32_t skipped;               // Periods skipped because the task ran late
+    uint32_t events;                // Events received
+    uint32_t unhandled;             // Events with no handler
+    uint32_t dropped;               // Posts refused because the queue was full
+} mesh_sched_stats_t;
+
+/**
+ * SET AN EVENT HANDLER
+ * ====================
+ * @param type Event type, MESH_EVENT_APP ... MESH_EVENT_TYPES - 1
+ * @param fn   Runs on the loop task for every event of this type (NULL clears)
+ * @param ctx  Passed to fn
+ * @return ESP_OK, ESP_ERR_INVALID_ARG (type reserved or out of range), or
+ *         ESP_ERR_INVALID_STATE before node_init()
+ */
+esp_err_t mesh_event_on(uint8_t type, mesh_event_fn_t fn, void *ctx);
+
+/**
+ * POST AN EVENT (task context)
+ * ============================
+ * Never blocks.
+ *
+ * @param type Event type
+ * @param arg  Delivered in mesh_event_t.arg
+ * @return ESP_OK, ESP_ERR_TIMEOUT if the queue is full (counted in dropped),
+ *         ESP_ERR_INVALID_STATE before node_init()
+ */
+esp_err_t mesh_event_post(uint8_t type, uint32_t arg);
+
+/**
+ * POST AN EVENT (interrupt context)
+ * =================================
+ * For GPIO and other ISRs.
+ *
+ * @return false if the queue is full or the loop is not running
+ */
+bool mesh_event_post_from_isr(uint8_t type, uint32_t arg);
+
+/**
+ * START A SCHEDULED JOB
+ * =====================
+ * Arms (or re-arms) a timer on the scheduler task. The timer must stay
+ * valid until it is stopped; starting or stopping timers from inside a
+ * callback is allowed.
+ *
+ * @param timer     Caller-owned timer (zero-initialized before first use)
+ * @param delay_ms  Time until the first run (rounded up to a tick)
+ * @param period_ms Time between runs, 0 = run once
+ * @param fn        Callback, runs on the scheduler task
+ * @param arg       Passed to fn
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_INVALID_STATE before node_init()
+ */
+esp_err_t mesh_sched_start(mesh_timer_t *timer, uint32_t delay_ms, uint32_t period_ms,
+                           mesh_timer_fn_t fn, void *arg);
+
+/**
+ * STOP A SCHEDULED JOB
+ * ====================
+ * Disarms the timer; its callback will not run again (no-op if not armed).
+ *
+ * @param timer Timer passed to mesh_sched_start()
+ */
+void mesh_sched_stop(mesh_timer_t *timer);
+
+/**
+ * GET SCHEDULER STATISTICS
+ * ========================
+ * @param stats Filled with the counters since boot
+ */
+void mesh_sched_get_stats(mesh_sched_stats_t *stats);
+
 /*
  * ============================================================================
  *                    BACKWARD COMPATIBILITY (LEGACY API)
@@ -0,0 +1,103 @@
+/*
+ * ============================================================================
+ *                    BLE MESH NODE - EVENT LOOP CORE
+ * ============================================================================
+ *
+ * Everything the node reacts to arrives as an event on ONE queue and is
+ * handled on ONE task:
+ *
+ *     button ISR ──────┐
+ *     sampler watermark┤                        ┌─► handler[type](ev)
+ *     mesh stack ──────┼──► queue ──► wait ─────┤
+ *     mesh_sched_start ┘    (deadline from      └─► wheel: due timers
+ *                            the timer wheel)
+ *
+ * The loop sleeps in the port's wait() until an event arrives or the
+ * earliest timer (mesh_timer_wheel.h) is due - nothing polls, so with no
+ * events and no timers the CPU is free to idle.
+ *
+ * Plain C99, no ESP-IDF: the queue, the clock and the lock come from a
+ * port (mesh_evloop_port_t). ble_mesh_node.c supplies a FreeRTOS one,
+ * tools/sim/sim_evloop a simulated one on the host.
+ */
+
+#ifndef MESH_EVENT_LOOP_H
+#define MESH_EVENT_LOOP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "mesh_timer_wheel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MESH_EVENT_TYPES    16      // Handler table size
+
+/**
+ * Event types: the component uses the ones below MESH_EVENT_APP,
+ * applications number theirs from MESH_EVENT_APP up
+ */
+enum {
+    MESH_EVENT_WAKE = 0,            // No handler: only makes the loop re-read the wheel
+    MESH_EVENT_PROVISIONED,         // arg = unicast address
+    MESH_EVENT_RESET,
+    MESH_EVENT_CONFIGURED,          // arg = AppKey index
+    MESH_EVENT_APP = 8,
+};
+
+typedef struct {
+    uint8_t type;
+    uint32_t arg;
+} mesh_event_t;
+
+typedef void (*mesh_event_fn_t)(const mesh_event_t *ev, void *ctx);
+
+/**
+ * What the loop needs from the platform
+ */
+typedef struct {
+    /**
+     * Block until an event arrives or wheel tick 'deadline' begins
+     * @param forever  No deadline (nothing armed): wait for an event only
+     * @return true with *ev filled, false on timeout
+     */
+    bool (*wait)(void *ctx, mesh_event_t *ev, bool forever, uint32_t deadline);
+    uint32_t (*now)(void *ctx);     // Current wheel tick
+    void (*lock)(void *ctx);        // Optional: guards the wheel against other tasks
+    void (*unlock)(void *ctx);
+    void *ctx;
+} mesh_evloop_port_t;
+
+typedef struct {
+    mesh_wheel_t wheel;
+    mesh_evloop_port_t port;
+    mesh_event_fn_t fn[MESH_EVENT_TYPES];
+    void *fn_ctx[MESH_EVENT_TYPES];
+    uint32_t wakeups;               // Statistics: returns from wait()
+    uint32_t events;                // Statistics: events received
+    uint32_t unhandled;             // Statistics: events with no handler (WAKE excluded)
+} mesh_evloop_t;
+
+/**
+ * Empty loop, no handlers, wheel starting at port->now()
+ */
+void mesh_evloop_init(mesh_evloop_t *l, const mesh_evloop_port_t *port);
+
+/**
+ * Set (or with fn = NULL clear) the handler of one event type
+ * @return false if type ≥ MESH_EVENT_TYPES
+ */
+bool mesh_evloop_on(mesh_evloop_t *l, uint8_t type, mesh_event_fn_t fn, void *ctx);
+
+/**
+ * One turn: run due timers, wait for the next event or deadline, dispatch
+ * the event. Handlers run without the lock held; timer callbacks with it.
+ */
+void mesh_evloop_run_once(mesh_evloop_t *l);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MESH_EVENT_LOOP_H
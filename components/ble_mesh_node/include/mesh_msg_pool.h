@@ -0,0 +1,102 @@
+/*
+ * ============================================================================
+ *                    BLE MESH NODE - RECEIVED MESSAGE POOL
+ * ============================================================================
+ *
+ * Buffers for vendor messages whose handler runs on a worker task instead
+ * of the mesh stack's callback task (MESH_MODEL_VENDOR_RX_DEFERRED):
+ *
+ *     BTC task                                        rx worker task
+ *     get(len) ─► copy msg + ctx ─► push ──► FIFO ──► pop ─► handler ─► put
+ *         │                                                              │
+ *         └──────────────────── free lists ◄──────────────────────────────┘
+ *
+ * Two size classes, all memory static: most control messages fit one
+ * unsegmented PDU, a few (codebooks, calibration tables) are segmented and
+ * need up to MESH_MSG_LARGE bytes. A small message takes a large buffer
+ * only when the small ones are gone. No buffer free = the message is
+ * dropped and counted - the stack's task never waits for the worker.
+ *
+ * Plain C99, no ESP-IDF and no locking: the caller serializes the calls
+ * (ble_mesh_node.c uses a spinlock - every call is O(1)). Host benchmark:
+ * tools/bench/bench_rx_worker.
+ */
+
+#ifndef MESH_MSG_POOL_H
+#define MESH_MSG_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MESH_MSG_SMALL          16      // Payload bytes: one unsegmented access PDU (11) + margin
+#define MESH_MSG_LARGE          384     // Largest access payload: 32 segments × 12 B
+#define MESH_MSG_POOL_SMALL     8
+#define MESH_MSG_POOL_LARGE     2
+#define MESH_MSG_CTX_MAX        48      // Room for the stack's message context (copied)
+
+typedef struct mesh_msg {
+    union {
+        uint8_t bytes[MESH_MSG_CTX_MAX];
+        uint64_t align;
+        void *align_ptr;
+    } ctx;                              // Copy of esp_ble_mesh_msg_ctx_t
+    struct mesh_msg *next;              // Free list / FIFO link
+    uint8_t *data;                      // Payload buffer (its class's size)
+    uint32_t opcode;
+    uint32_t rx_us;                     // Receive time, for the latency statistics
+    uint16_t len;
+    uint16_t cap;
+    void *target;                       // Caller's: which model it is for
+} mesh_msg_t;
+
+typedef struct {
+    mesh_msg_t msg[MESH_MSG_POOL_SMALL + MESH_MSG_POOL_LARGE];
+    uint8_t small_buf[MESH_MSG_POOL_SMALL][MESH_MSG_SMALL];
+    uint8_t large_buf[MESH_MSG_POOL_LARGE][MESH_MSG_LARGE];
+    mesh_msg_t *free_small;
+    mesh_msg_t *free_large;
+    mesh_msg_t *head;                   // FIFO: oldest
+    mesh_msg_t *tail;
+    uint32_t pending;                   // Messages in the FIFO
+    uint32_t max_pending;               // Statistics
+    uint32_t queued;                    // Statistics: buffers handed out
+    uint32_t dropped;                   // Statistics: no buffer of that size free
+    uint32_t too_long;                  // Statistics: longer than MESH_MSG_LARGE
+} mesh_msg_pool_t;
+
+/**
+ * All buffers free, FIFO empty, statistics zero
+ */
+void mesh_msg_pool_init(mesh_msg_pool_t *p);
+
+/**
+ * Take a free buffer for a payload of 'len' bytes
+ * @return The buffer (len set, fill data / opcode / ctx, then push), or
+ *         NULL when none is free or len > MESH_MSG_LARGE (counted)
+ */
+mesh_msg_t *mesh_msg_pool_get(mesh_msg_pool_t *p, uint16_t len);
+
+/**
+ * Append a filled buffer to the FIFO
+ */
+void mesh_msg_pool_push(mesh_msg_pool_t *p, mesh_msg_t *m);
+
+/**
+ * Oldest message, removed from the FIFO; NULL if empty
+ */
+mesh_msg_t *mesh_msg_pool_pop(mesh_msg_pool_t *p);
+
+/**
+ * Return a buffer to its free list (after the handler ran)
+ */
+void mesh_msg_pool_put(mesh_msg_pool_t *p, mesh_msg_t *m);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MESH_MSG_POOL_H
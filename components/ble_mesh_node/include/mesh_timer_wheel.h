@@ -0,0 +1,115 @@
+/*
+ * ============================================================================
+ *                    BLE MESH NODE - HASHED TIMER WHEEL
+ * ============================================================================
+ *
+ * One place for every periodic job a node has: Sensor / Battery publish
+ * periods, cadence checks, telemetry reports. Instead of one FreeRTOS task
+ * (with its own stack) per job, each sleeping in vTaskDelay(), the node's
+ * event loop (mesh_event_loop.h) sleeps until the earliest deadline and
+ * runs whatever is due then (see mesh_sched_start() in ble_mesh_node.h).
+ *
+ * THE WHEEL:
+ * ----------
+ * Time is counted in ticks of MESH_WHEEL_TICK_MS. A timer due at tick d
+ * lives in slot d % MESH_WHEEL_SLOTS; advancing the wheel by one tick only
+ * looks at one slot:
+ *
+ *     slot:   0    1    2    3   ...   63
+ *            [A]  [ ]  [B,C] [ ]  ...  [D]      B due at tick 66, C at 130
+ *                       ▲
+ *                   tick 66: B fires, C stays (its turn is one lap later)
+ *
+ * Start / stop are O(1) / O(slot length); a tick costs O(timers in that
+ * slot) - with fewer timers than slots that is almost always 0 or 1.
+ * There is no ordering between laps, so a timer may wait any number of
+ * laps in its slot.
+ *
+ * COALESCING:
+ * -----------
+ * Deadlines are rounded up to whole ticks, so jobs due within the same
+ * 10 ms fire together in ONE wakeup. Six sensors published every 1000 ms
+ * wake the loop once per second, not six times.
+ *
+ * Plain C99, no ESP-IDF: tools/bench/bench_wheel runs it on the host.
+ */
+
+#ifndef MESH_TIMER_WHEEL_H
+#define MESH_TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MESH_WHEEL_TICK_MS  10      // Resolution; deadlines in the same tick coalesce
+#define MESH_WHEEL_SLOTS    64      // Power of two; one lap = 640 ms
+#define MESH_WHEEL_NONE     UINT32_MAX
+
+typedef void (*mesh_timer_fn_t)(void *arg);
+
+typedef struct mesh_timer {
+    struct mesh_timer *next;        // Slot list
+    uint32_t deadline;              // Absolute tick
+    uint32_t period;                // Ticks between runs, 0 = one-shot
+    mesh_timer_fn_t fn;
+    void *arg;
+    bool armed;
+} mesh_timer_t;
+
+typedef struct {
+    mesh_timer_t *slot[MESH_WHEEL_SLOTS];
+    uint32_t now;                   // Next tick to process (all earlier ones ran)
+    uint32_t armed;                 // Timers in the wheel
+    uint32_t fired;                 // Statistics: callbacks run
+    uint32_t batches;               // Statistics: ticks that ran at least one
+    uint32_t skipped;               // Statistics: periods missed (advance jumped past them)
+} mesh_wheel_t;
+
+/**
+ * Convert milliseconds to ticks, rounding up (at least 1 tick)
+ */
+uint32_t mesh_wheel_ticks(uint32_t ms);
+
+/**
+ * Start empty at tick 'now'
+ */
+void mesh_wheel_init(mesh_wheel_t *w, uint32_t now);
+
+/**
+ * Arm a timer (re-arms it if already armed)
+ * @param delay  Ticks from w->now to the first run (0 runs at the next advance)
+ * @param period Ticks between runs, 0 = one-shot
+ */
+void mesh_wheel_start(mesh_wheel_t *w, mesh_timer_t *t, uint32_t delay, uint32_t period,
+                      mesh_timer_fn_t fn, void *arg);
+
+/**
+ * Disarm a timer (no-op if not armed); safe from inside any callback
+ */
+void mesh_wheel_stop(mesh_wheel_t *w, mesh_timer_t *t);
+
+/**
+ * Run everything due up to and including tick 'now'
+ *
+ * Periodic timers re-arm before their callback runs. If the wheel fell
+ * behind by more than a period, the missed runs are skipped (counted in
+ * w->skipped), not replayed back to back.
+ *
+ * @return Callbacks run
+ */
+uint32_t mesh_wheel_advance(mesh_wheel_t *w, uint32_t now);
+
+/**
+ * Ticks from w->now until the earliest deadline (0 = due at once)
+ * @return MESH_WHEEL_NONE if nothing is armed
+ */
+uint32_t mesh_wheel_next(const mesh_wheel_t *w);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MESH_TIMER_WHEEL_H
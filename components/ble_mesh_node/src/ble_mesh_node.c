@@ -36,11 +36,19 @@
 #include "esp_ble_mesh_config_model_api.h"
 #include "esp_ble_mesh_generic_model_api.h"
 #include "esp_ble_mesh_sensor_model_api.h"
+#include "esp_ble_mesh_local_data_operation_api.h"
+#include "esp_cpu.h"     // esp_cpu_get_cycle_count (publish cost statistics)
+#include "esp_timer.h"   // esp_timer_get_time (rx worker latency), pub_swap
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
 #include <string.h>
 
 // Include our headers AFTER ESP-IDF headers (they need the types defined above)
 #include "ble_mesh_node.h"
 #include "ble_mesh_models.h"
+#include "mesh_msg_pool.h"
 
 #define TAG "BLE_MESH_NODE"
 
@@ -170,6 +178,7 @@ static void mesh_generic_server_cb(esp_ble_mesh_generic_server_cb_event_t event,
                                     esp_ble_mesh_generic_server_cb_param_t *param);
 static void mesh_sensor_server_cb(esp_ble_mesh_sensor_server_cb_event_t event,
                                    esp_ble_mesh_sensor_server_cb_param_t *param);
+static void loop_post_stack_event(uint8_t type, uint32_t arg);
 
 /*
  * ============================================================================
@@ -221,15 +230,26 @@ static level_model_state_t* find_level_model(uint8_t index)
  * ============================================================================
  */
 
+/**
+ * One sensor's publish_period_ms job on the scheduler
+ */
+typedef struct {
+    mesh_timer_t timer;
+    uint8_t model_index;                        // Sensor model index (find_sensor_model)
+    uint16_t type;                              // Sensor to publish
+} sensor_job_t;
+
 /**
  * Sensor model runtime state
  * Stores the ESP-IDF Sensor Server structure and user configuration
  */
 typedef struct {
     mesh_sensor_config_t *sensors;              // Array of sensor configurations
+    sensor_job_t *jobs;                         // Scheduler jobs, one per sensor (NULL until armed)
     uint8_t sensor_count;                       // Number of sensors
     esp_ble_mesh_sensor_state_t *sensor_states; // ESP-IDF sensor states array
     struct net_buf_simple **sensor_bufs;        // Array of buffers for raw_value (one per sensor)
+    volatile bool pub_busy;                     // pub.msg queued to the stack (PUBLICATION IN FLIGHT)
     esp_ble_mesh_sensor_srv_t server;          // ESP-IDF server structure
     esp_ble_mesh_sensor_setup_srv_t setup;     // ESP-IDF setup server structure (REQUIRED)
     esp_ble_mesh_model_pub_t pub;              // Publication context for Sensor Server
@@ -274,6 +294,8 @@ typedef struct {
     esp_ble_mesh_gen_battery_srv_t server; // ESP-IDF server structure
     esp_ble_mesh_model_pub_t pub;          // Publication context
     esp_ble_mesh_model_t *esp_model;       // Pointer to ESP-IDF model (for publishing)
+    mesh_timer_t timer;                    // publish_period_ms job on the scheduler
+    uint8_t model_index;                   // Battery model index (find_battery_model)
 } battery_model_state_t;
 
 /**
@@ -313,6 +335,20 @@ typedef struct {
     uint16_t publish_addr;                  // Publication address (set by provisioner)
     esp_ble_mesh_model_pub_t pub;           // Publication context
     esp_ble_mesh_model_t *esp_model;        // ESP-IDF model structure (for opcodes)
+    esp_ble_mesh_model_op_t *op;            // Operation table (defaults + rx_opcodes)
+    uint8_t *stage;                         // Where mesh_model_vendor_reserve() lets the codec write
+    uint32_t reserved_op;                   // Opcode of the open mesh_model_vendor_reserve()
+    uint16_t reserved_len;                  // Bytes it offered (0 = nothing reserved)
+    volatile bool pub_busy;                 // pub.msg queued to the stack (PUBLICATION IN FLIGHT)
+    mesh_pub_update_t pub_update;           // Periodic publication source (NULL = app publishes)
+    void *pub_update_data;                  // Its user context
+    struct net_buf_simple *pub_next;        // Periodic: next frame, swapped in by pub_swap
+    bool pub_next_ready;                    // pub_next holds a frame (pub_swap_mux)
+    esp_timer_handle_t pub_swap;            // Periodic: installs pub_next after retransmissions
+    bool deferred;                          // Handler runs on the rx worker, not the BTC task
+    bool client;                            // Vendor client (consumes peers' publications)
+    esp_ble_mesh_client_t client_data;      // Client models: the stack's client context
+    esp_ble_mesh_client_op_pair_t op_pair;  // Its request/status pair (see init_vendor_model)
 } vendor_model_state_t;
 
 /**
@@ -579,12 +615,79 @@ static esp_err_t init_vendor_model(mesh_model_config_t *config,
     state->model_id = config->config.vendor.model_id;
     state->handler = config->config.vendor.handler;
     state->user_data = config->config.vendor.user_data;
+    state->deferred = config->config.vendor.deferred;
+    state->client = config->config.vendor.client;
+
+    // Build the operation table: the two default IMU opcodes, then the
+    // opcodes this model asked to receive. The mesh stack drops any
+    // opcode that is not in this table before our handler sees it.
+    // Opcode 0xC00001 = ESP_BLE_MESH_MODEL_OP_3(0xC0, 0x0001) - Accelerometer
+    // Opcode 0xC00002 = ESP_BLE_MESH_MODEL_OP_3(0xC0, 0x0002) - Gyroscope
+    const uint32_t *rx_ops = config->config.vendor.rx_opcodes;
+    uint8_t rx_count = rx_ops ? config->config.vendor.rx_opcode_count : 0;
+    // calloc zeroes the final entry = ESP_BLE_MESH_MODEL_OP_END
+    state->op = calloc(2 + rx_count + 1, sizeof(esp_ble_mesh_model_op_t));
+    if (!state->op) {
+        ESP_LOGE(TAG, "Failed to allocate Vendor model op table");
+        free(state);
+        return ESP_ERR_NO_MEM;
+    }
+    // esp_ble_mesh_model_op_t fields are const: build each entry, then copy it in
+    for (uint8_t i = 0; i < 2 + rx_count; i++) {
+        uint32_t opcode = (i == 0) ? ESP_BLE_MESH_MODEL_OP_3(0xC0, 0x0001)   // Accel opcode
+                        : (i == 1) ? ESP_BLE_MESH_MODEL_OP_3(0xC0, 0x0002)   // Gyro opcode
+                        : rx_ops[i - 2];
+        esp_ble_mesh_model_op_t entry = ESP_BLE_MESH_MODEL_OP(opcode, 0);   // Min length 0
+        memcpy(&state->op[i], &entry, sizeof(entry));
+    }
+
+    // Client models: the stack matches acknowledged client requests to
+    // their status replies through op pairs and refuses a client without
+    // one. We never send acknowledged requests, so a single placeholder
+    // pair is enough - every message then arrives as an unsolicited
+    // publication (ESP_BLE_MESH_CLIENT_MODEL_RECV_PUBLISH_MSG_EVT).
+    if (state->client) {
+        state->op_pair.cli_op = ESP_BLE_MESH_MODEL_OP_3(0xC0, 0x0001);
+        state->op_pair.status_op = ESP_BLE_MESH_MODEL_OP_3(0xC0, 0x0001);
+        state->client_data.op_pair = &state->op_pair;
+        state->client_data.op_pair_size = 1;
+    }
+
+    // Publication buffer: [3-byte opcode][payload]. Sized for the largest
+    // vendor message, and so is the stage mesh_model_vendor_reserve() hands
+    // out, so any frame fits.
+    if (config->enable_publication) {
+        const uint16_t size = MESH_VENDOR_OPCODE_LEN + MESH_VENDOR_PUB_MAX;
+        struct net_buf_simple *pub_msg = calloc(1, sizeof(struct net_buf_simple) + size);
+        struct net_buf_simple *pub_next = calloc(1, sizeof(struct net_buf_simple) + size);
+        state->stage = malloc(MESH_VENDOR_PUB_MAX);
+        if (!pub_msg || !pub_next || !state->stage) {
+            ESP_LOGE(TAG, "Failed to allocate Vendor publication buffer");
+            free(state->stage);
+            free(pub_next);
+            free(pub_msg);
+            free(state->op);
+            free(state);
+            return ESP_ERR_NO_MEM;
+        }
+        pub_msg->data = (uint8_t *)(pub_msg + 1);
+        pub_msg->len = 0;
+        pub_msg->size = size;
+        pub_msg->__buf = pub_msg->data;
+        state->pub.msg = pub_msg;
+        // The periodic path's second buffer (PERIODIC PUBLICATION)
+        pub_next->data = (uint8_t *)(pub_next + 1);
+        pub_next->size = size;
+        pub_next->__buf = pub_next->data;
+        state->pub_next = pub_next;
+        state->pub.update = 0;  // The stack installs its own hook (PERIODIC PUBLICATION)
+    }
 
     // Store state in registry
     registry_entry->runtime_state = state;
 
-    ESP_LOGI(TAG, "Vendor model initialized (CID=0x%04X, MID=0x%04X)",
-             state->company_id, state->model_id);
+    ESP_LOGI(TAG, "Vendor %s initialized (CID=0x%04X, MID=0x%04X, %d rx opcodes)",
+             state->client ? "client" : "model", state->company_id, state->model_id, rx_count);
 
     return ESP_OK;
 }
@@ -801,15 +904,8 @@ static esp_err_t build_models(mesh_model_config_t *user_models, uint8_t model_co
             // Get runtime state
             vendor_model_state_t *vendor_state = (vendor_model_state_t*)registry->runtime_state;
 
-            // Create vendor operation array with our IMU opcodes
-            // IMPORTANT: Vendor models MUST have opcodes defined for all messages they send.
-            // Opcode 0xC00001 = ESP_BLE_MESH_MODEL_OP_3(0xC0, 0x0001) - Accelerometer
-            // Opcode 0xC00002 = ESP_BLE_MESH_MODEL_OP_3(0xC0, 0x0002) - Gyroscope
-            static esp_ble_mesh_model_op_t vendor_op[] = {
-                ESP_BLE_MESH_MODEL_OP(ESP_BLE_MESH_MODEL_OP_3(0xC0, 0x0001), 0),  // Accel opcode, min length 0
-                ESP_BLE_MESH_MODEL_OP(ESP_BLE_MESH_MODEL_OP_3(0xC0, 0x0002), 0),  // Gyro opcode, min length 0
-                ESP_BLE_MESH_MODEL_OP_END,
-            };
+            // Vendor operation array was built by init_vendor_model()
+            // (default IMU opcodes + the model's rx_opcodes, one table per model)
 
             // Build ESP-IDF vendor model structure
             // Vendor models use a different macro with company_id and model_id
@@ -817,9 +913,9 @@ static esp_err_t build_models(mesh_model_config_t *user_models, uint8_t model_co
             esp_ble_mesh_model_t vendor_model = ESP_BLE_MESH_VENDOR_MODEL(
                 vendor_state->company_id,
                 vendor_state->model_id,
-                vendor_op,  // Operation array with IMU data opcode
+                vendor_state->op,  // Operation array (default + rx opcodes)
                 pub_ctx,    // Publication context (if enabled)
-                NULL        // No user_data
+                vendor_state->client ? &vendor_state->client_data : NULL  // Client context
             );
             memcpy(&dynamic_vnd_models[vnd_slot], &vendor_model, sizeof(esp_ble_mesh_model_t));
 
@@ -827,7 +923,8 @@ static esp_err_t build_models(mesh_model_config_t *user_models, uint8_t model_co
             vendor_state->esp_model = &dynamic_vnd_models[vnd_slot];
             registry->esp_model = &dynamic_vnd_models[vnd_slot];
 
-            ESP_LOGI(TAG, "Added Vendor model #%d (CID=0x%04X, MID=0x%04X)",
+            ESP_LOGI(TAG, "Added Vendor %s #%d (CID=0x%04X, MID=0x%04X)",
+                     vendor_state->client ? "client" : "model",
                      registered_model_count, vendor_state->company_id, vendor_state->model_id);
             vnd_slot++;
             break;
@@ -992,10 +1089,9 @@ static void mesh_config_server_cb(esp_ble_mesh_cfg_server_cb_event_t event,
                      param->value.state_change.appkey_add.net_idx,
                      param->value.state_change.appkey_add.app_idx);
 
-            // Notify application
-            if (app_callbacks.config_complete) {
-                app_callbacks.config_complete(param->value.state_change.appkey_add.app_idx);
-            }
+            // Notify application (on the event loop, not the stack's task)
+            loop_post_stack_event(MESH_EVENT_CONFIGURED,
+                                  param->value.state_change.appkey_add.app_idx);
             break;
 
         case ESP_BLE_MESH_MODEL_OP_MODEL_APP_BIND:
@@ -1006,10 +1102,11 @@ static void mesh_config_server_cb(esp_ble_mesh_cfg_server_cb_event_t event,
             break;
 
         case ESP_BLE_MESH_MODEL_OP_MODEL_PUB_SET:
-            ESP_LOGI(TAG, "Model publication set: ElementAddr=0x%04x, PublishAddr=0x%04x, ModelID=0x%04x",
+            ESP_LOGI(TAG, "Model publication set: ElementAddr=0x%04x, PublishAddr=0x%04x, ModelID=0x%04x, Period=0x%02x",
                      param->value.state_change.mod_pub_set.element_addr,
                      param->value.state_change.mod_pub_set.pub_addr,
-                     param->value.state_change.mod_pub_set.model_id);
+                     param->value.state_change.mod_pub_set.model_id,
+                     param->value.state_change.mod_pub_set.pub_period);
             ESP_LOGI(TAG, "Publication configured! Sensor data will now be published");
             break;
 
@@ -1048,14 +1145,318 @@ static void mesh_sensor_server_cb(esp_ble_mesh_sensor_server_cb_event_t event,
     }
 }
 
+/*
+ * ════════════════════════════════════════════════════════════════════════
+ *                     PUBLICATION IN FLIGHT
+ * ════════════════════════════════════════════════════════════════════════
+ *
+ * esp_ble_mesh_model_publish() writes [opcode][payload] into pub.msg on
+ * the caller's task and queues the send to the BTC task, which reads
+ * pub.msg when it gets there - and again for every retransmission the
+ * provisioner configured (pub.count = retransmissions still to go):
+ *
+ *   publish ──pub_busy──▶ BTC sends ──PUBLISH_COMP_EVT──▶ pub_busy cleared
+ *                                     └─ pub.count retransmissions re-read pub.msg
+ *
+ * Until both are over, nothing may rewrite pub.msg: the publisher runs on
+ * the other core and would tear the frame the radio is sending.
+ */
+static volatile bool *pub_busy_flag(esp_ble_mesh_model_t *model)
+{
+    for (int i = 0; i < registered_model_count; i++) {
+        if (model_registry[i].esp_model != model || !model_registry[i].runtime_state) {
+            continue;
+        }
+        if (model_registry[i].type == MESH_MODEL_TYPE_VENDOR) {
+            return &((vendor_model_state_t*)model_registry[i].runtime_state)->pub_busy;
+        }
+        if (model_registry[i].type == MESH_MODEL_TYPE_SENSOR) {
+            return &((sensor_model_state_t*)model_registry[i].runtime_state)->pub_busy;
+        }
+    }
+    return NULL;
+}
+
+static bool pub_in_flight(const esp_ble_mesh_model_pub_t *pub, bool busy)
+{
+    return busy || pub->count != 0;
+}
+
+/*
+ * ════════════════════════════════════════════════════════════════════════
+ *                     PERIODIC PUBLICATION (pub->update)
+ * ════════════════════════════════════════════════════════════════════════
+ *
+ * A provisioner can give any publishing model a PERIOD in Config Model
+ * Publication Set (e.g. 100 ms, 1 s, 10 min). The stack then runs a timer
+ * per model and publishes pub.msg every period - no app task, no app
+ * timer, and the rate is changed over the air like any other setting.
+ *
+ * Before each periodic publish the stack calls the model's pub->update
+ * hook. ESP-IDF installs that hook itself and turns it into
+ * ESP_BLE_MESH_MODEL_PUBLISH_UPDATE_EVT (below). We answer it by asking the
+ * model's mesh_pub_update_t for its latest frame.
+ *
+ * DOUBLE BUFFER:
+ * --------------
+ * The stack sends pub.msg again for each retransmission of the period, so
+ * the new frame is never written into it:
+ *
+ *   update event:  source ──▶ stage ──▶ [opcode][frame] in pub_next, ready
+ *   pub_swap:      retransmissions over (pub.count 0) ──▶ swap pub.msg ⇄ pub_next
+ *
+ * The swap is one pointer store, so a publish sees the old frame or the new
+ * one, whole. pub_swap is an esp_timer armed for the retransmissions still
+ * to go; it re-arms while pub.count says some are left.
+ *
+ * TIMING:
+ * -------
+ * ESP-IDF posts the event to the BTC task and publishes without waiting
+ * for it, so a period sends the frame pulled at the PREVIOUS update: one
+ * period of latency. When the source has nothing new, pub.msg keeps the
+ * last frame and the period repeats it (latest-value semantics).
+ *
+ * Period 0 (the default) = no timer, no events: the app publishes itself.
+ */
+static portMUX_TYPE pub_swap_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// One publication retransmission interval, in µs
+static uint64_t pub_retransmit_us(const esp_ble_mesh_model_pub_t *pub)
+{
+    return (uint64_t)ESP_BLE_MESH_GET_PUBLISH_TRANSMIT_INTERVAL(pub->retransmit) * 1000;
+}
+
+// esp_timer: install the waiting frame once the stack is done with pub.msg
+static void pub_swap_fn(void *arg)
+{
+    vendor_model_state_t *vstate = (vendor_model_state_t*)arg;
+    bool retry = false;
+    taskENTER_CRITICAL(&pub_swap_mux);
+    if (vstate->pub_next_ready && vstate->pub.count != 0) {
+        retry = true;
+    } else if (vstate->pub_next_ready) {
+        struct net_buf_simple *sent = vstate->pub.msg;
+        vstate->pub.msg = vstate->pub_next;
+        vstate->pub_next = sent;
+        vstate->pub_next_ready = false;
+    }
+    taskEXIT_CRITICAL(&pub_swap_mux);
+    if (retry) {
+        esp_timer_start_once(vstate->pub_swap, pub_retransmit_us(&vstate->pub));
+    }
+}
+
+static void vendor_publish_update(esp_ble_mesh_model_t *model)
+{
+    for (int i = 0; i < registered_model_count; i++) {
+        if (model_registry[i].type != MESH_MODEL_TYPE_VENDOR) {
+            continue;
+        }
+        vendor_model_state_t *vstate = (vendor_model_state_t*)model_registry[i].runtime_state;
+        if (!vstate || vstate->esp_model != model || !vstate->pub_update || !vstate->pub_next) {
+            continue;
+        }
+
+        // Pull into the stage: neither buffer the swap touches
+        uint32_t opcode = 0;
+        uint16_t len = vstate->pub_update(&opcode, vstate->stage, MESH_VENDOR_PUB_MAX,
+                                          vstate->pub_update_data);
+        if (len == 0 || len > MESH_VENDOR_PUB_MAX) {
+            return;                         // Nothing new: the period repeats pub.msg
+        }
+
+        // A frame still waiting is replaced: latest value wins
+        taskENTER_CRITICAL(&pub_swap_mux);
+        struct net_buf_simple *next = vstate->pub_next;
+        net_buf_simple_reset(next);
+        net_buf_simple_add_u8(next, (uint8_t)(opcode >> 16));
+        net_buf_simple_add_le16(next, (uint16_t)opcode);
+        net_buf_simple_add_mem(next, vstate->stage, len);
+        vstate->pub_next_ready = true;
+        const uint8_t left = vstate->pub.count;
+        taskEXIT_CRITICAL(&pub_swap_mux);
+
+        // Already armed: that run installs this frame
+        esp_timer_start_once(vstate->pub_swap, left * pub_retransmit_us(&vstate->pub));
+        return;
+    }
+}
+
+/*
+ * ════════════════════════════════════════════════════════════════════════
+ *                     DEFERRED VENDOR MESSAGES (rx worker)
+ * ════════════════════════════════════════════════════════════════════════
+ *
+ * A vendor handler normally runs inside mesh_custom_model_cb, i.e. on the
+ * stack's BTC task: while it works, no other mesh message is decrypted,
+ * relayed or acknowledged. A model configured with
+ * MESH_MODEL_VENDOR_RX_DEFERRED instead gets its messages copied into the
+ * received-message pool (mesh_msg_pool.h) and handled on the rx worker:
+ *
+ *     BTC task:  copy payload + ctx into a pool buffer, push, notify  (µs)
+ *     rx_worker: pop, run the handler, give the buffer back
+ *
+ * The handler sees the same arguments; 'ctx' points to the pool's copy of
+ * the message context, so mesh_msg_recv_ttl() and replies keep working.
+ *
+ * BOUNDED LATENCY: the pool holds MESH_MSG_POOL_SMALL + _LARGE messages
+ * and the worker handles them in arrival order at priority 4 (above the
+ * event loop, below the Bluetooth host). A message waits at most for the
+ * ones queued before it - a full pool's worth of handlers. When every
+ * buffer is in use, new messages are dropped and counted
+ * (mesh_model_get_vendor_rx_stats) - the BTC task never waits.
+ *
+ * tools/bench/bench_rx_worker compares both modes under handler-heavy load.
+ */
+
+#define RX_WORKER_STACK     3072        // Default; node_config_t.rx_worker_stack_size overrides
+#define RX_WORKER_PRIO      4
+
+_Static_assert(sizeof(esp_ble_mesh_msg_ctx_t) <= MESH_MSG_CTX_MAX,
+               "esp_ble_mesh_msg_ctx_t does not fit: raise MESH_MSG_CTX_MAX");
+
+static mesh_msg_pool_t rx_pool;
+static portMUX_TYPE rx_mux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t rx_worker = NULL;
+static mesh_vendor_rx_stats_t rx_stats;     // Pool counters are added on read
+
+static void rx_worker_fn(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // Everything queued since the last wakeup, oldest first
+        for (;;) {
+            taskENTER_CRITICAL(&rx_mux);
+            mesh_msg_t *m = mesh_msg_pool_pop(&rx_pool);
+            taskEXIT_CRITICAL(&rx_mux);
+            if (!m) {
+                break;
+            }
+            vendor_model_state_t *vstate = (vendor_model_state_t *)m->target;
+            const uint32_t start_us = (uint32_t)esp_timer_get_time();
+            vstate->handler(m->opcode, m->data, m->len, m->ctx.bytes, vstate->user_data);
+            const uint32_t end_us = (uint32_t)esp_timer_get_time();
+
+            taskENTER_CRITICAL(&rx_mux);
+            if (start_us - m->rx_us > rx_stats.max_wait_us) {
+                rx_stats.max_wait_us = start_us - m->rx_us;
+            }
+            if (end_us - start_us > rx_stats.max_handler_us) {
+                rx_stats.max_handler_us = end_us - start_us;
+            }
+            rx_stats.deferred++;
+            mesh_msg_pool_put(&rx_pool, m);
+            taskEXIT_CRITICAL(&rx_mux);
+        }
+    }
+}
+
+// BTC task: copy the message into the pool and wake the worker
+static void rx_defer(vendor_model_state_t *vstate, uint32_t opcode, const uint8_t *data,
+                     uint16_t length, const esp_ble_mesh_msg_ctx_t *ctx)
+{
+    taskENTER_CRITICAL(&rx_mux);
+    mesh_msg_t *m = mesh_msg_pool_get(&rx_pool, length);
+    taskEXIT_CRITICAL(&rx_mux);
+    if (!m) {
+        return;                 // Counted in rx_pool.dropped - no UART work on the BTC task
+    }
+    memcpy(m->ctx.bytes, ctx, sizeof(*ctx));
+    memcpy(m->data, data, length);
+    m->opcode = opcode;
+    m->target = vstate;
+    m->rx_us = (uint32_t)esp_timer_get_time();
+
+    taskENTER_CRITICAL(&rx_mux);
+    mesh_msg_pool_push(&rx_pool, m);
+    taskEXIT_CRITICAL(&rx_mux);
+    xTaskNotifyGive(rx_worker);
+}
+
+// Start the worker if any vendor model asked for deferred handling
+static esp_err_t rx_worker_init(uint32_t stack_size)
+{
+    bool needed = false;
+    for (int i = 0; i < registered_model_count; i++) {
+        if (model_registry[i].type == MESH_MODEL_TYPE_VENDOR) {
+            vendor_model_state_t *vstate = (vendor_model_state_t *)model_registry[i].runtime_state;
+            needed |= vstate && vstate->deferred;
+        }
+    }
+    if (!needed || rx_worker) {
+        return ESP_OK;
+    }
+    mesh_msg_pool_init(&rx_pool);
+    if (xTaskCreate(rx_worker_fn, "mesh_rx", stack_size ? stack_size : RX_WORKER_STACK,
+                    NULL, RX_WORKER_PRIO, &rx_worker) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "rx worker: %d + %d pooled buffers (%d / %d B)", MESH_MSG_POOL_SMALL,
+             MESH_MSG_POOL_LARGE, MESH_MSG_SMALL, MESH_MSG_LARGE);
+    return ESP_OK;
+}
+
+void mesh_model_get_vendor_rx_stats(mesh_vendor_rx_stats_t *stats, bool reset)
+{
+    taskENTER_CRITICAL(&rx_mux);
+    *stats = rx_stats;
+    stats->dropped = rx_pool.dropped;
+    stats->too_long = rx_pool.too_long;
+    stats->max_pending = rx_pool.max_pending;
+    if (reset) {
+        memset(&rx_stats, 0, sizeof(rx_stats));
+        rx_pool.dropped = 0;
+        rx_pool.too_long = 0;
+        rx_pool.max_pending = rx_pool.pending;
+    }
+    taskEXIT_CRITICAL(&rx_mux);
+}
+
 /*
  * ════════════════════════════════════════════════════════════════════════
  *                     CUSTOM MODEL (VENDOR) CALLBACK
  * ════════════════════════════════════════════════════════════════════════
  *
  * Handles vendor model messages (both direct unicast and published).
- * Dispatches to user-registered vendor handlers.
+ * Dispatches to user-registered vendor handlers - inline, or through the
+ * rx worker for deferred models (see above). Runs on the BTC task: no
+ * per-message INFO log here, the UART would cost more than most handlers.
+ *
+ * Server models get their messages as MODEL_OPERATION events, client
+ * models (MESH_MODEL_VENDOR_CLIENT) as CLIENT_MODEL_RECV_PUBLISH_MSG
+ * events. Both go through vendor_dispatch().
  */
+
+// Find the model's registry entry and run (or defer) its handler
+static void vendor_dispatch(esp_ble_mesh_model_t *model, uint32_t opcode, uint8_t *data,
+                            uint16_t length, esp_ble_mesh_msg_ctx_t *ctx)
+{
+    for (int i = 0; i < registered_model_count; i++) {
+        if (model_registry[i].type != MESH_MODEL_TYPE_VENDOR) {
+            continue;
+        }
+        vendor_model_state_t *vstate = (vendor_model_state_t*)model_registry[i].runtime_state;
+        if (!vstate || vstate->esp_model != model) {
+            continue;
+        }
+        // Call user's vendor handler if registered
+        if (vstate->handler && vstate->deferred && rx_worker) {
+            rx_defer(vstate, opcode, data, length, ctx);
+        } else if (vstate->handler) {
+            taskENTER_CRITICAL(&rx_mux);    // Stats reader may reset it from another core
+            rx_stats.inline_handled++;
+            taskEXIT_CRITICAL(&rx_mux);
+            vstate->handler(opcode, data, length, ctx, vstate->user_data);
+        } else {
+            ESP_LOGW(TAG, "No handler registered for vendor model CID=0x%04X MID=0x%04X",
+                     vstate->company_id, vstate->model_id);
+        }
+        return;
+    }
+}
+
 static void mesh_custom_model_cb(esp_ble_mesh_model_cb_event_t event,
                                  esp_ble_mesh_model_cb_param_t *param)
 {
@@ -1071,27 +1472,27 @@ static void mesh_custom_model_cb(esp_ble_mesh_model_cb_event_t event,
             uint8_t *data = param->model_operation.msg;
             esp_ble_mesh_model_t *model = param->model_operation.model;
 
-            ESP_LOGI(TAG, "📩 Vendor message recv: opcode=0x%06" PRIx32 " from=0x%04x len=%d",
+            ESP_LOGD(TAG, "📩 Vendor message recv: opcode=0x%06" PRIx32 " from=0x%04x len=%d",
                      opcode, src_addr, length);
 
-            // Find the vendor model in our registry
-            for (int i = 0; i < registered_model_count; i++) {
-                if (model_registry[i].type == MESH_MODEL_TYPE_VENDOR) {
-                    vendor_model_state_t *vstate = (vendor_model_state_t*)model_registry[i].runtime_state;
-
-                    if (vstate && vstate->esp_model == model) {
-                        // Call user's vendor handler if registered
-                        if (vstate->handler) {
-                            vstate->handler(opcode, data, length,
-                                           param->model_operation.ctx,
-                                           vstate->user_data);
-                        } else {
-                            ESP_LOGW(TAG, "No handler registered for vendor model CID=0x%04X MID=0x%04X",
-                                     vstate->company_id, vstate->model_id);
-                        }
-                        break;
-                    }
-                }
+            vendor_dispatch(model, opcode, data, length, param->model_operation.ctx);
+        }
+        break;
+
+    case ESP_BLE_MESH_MODEL_PUBLISH_UPDATE_EVT:
+        // The publish period elapsed: refill pub.msg for the next one
+        vendor_publish_update(param->model_publish_update.model);
+        break;
+
+    case ESP_BLE_MESH_MODEL_PUBLISH_COMP_EVT:
+        // The BTC task sent pub.msg; retransmissions are counted in pub.count
+        {
+            volatile bool *busy = pub_busy_flag(param->model_publish_comp.model);
+            if (busy) {
+                *busy = false;
+            }
+            if (param->model_publish_comp.err_code) {
+                ESP_LOGE(TAG, "Publish failed: err=%d", param->model_publish_comp.err_code);
             }
         }
         break;
@@ -1115,11 +1516,12 @@ static void mesh_custom_model_cb(esp_ble_mesh_model_cb_event_t event,
             uint16_t src_addr = param->client_recv_publish_msg.ctx->addr;
             uint16_t length = param->client_recv_publish_msg.length;
             uint8_t *data = param->client_recv_publish_msg.msg;
+            esp_ble_mesh_model_t *model = param->client_recv_publish_msg.model;
 
-            ESP_LOGI(TAG, "📦 Vendor publish recv: opcode=0x%06" PRIx32 " from=0x%04x len=%d",
+            ESP_LOGD(TAG, "📦 Vendor publish recv: opcode=0x%06" PRIx32 " from=0x%04x len=%d",
                      opcode, src_addr, length);
 
-            // TODO: Dispatch to vendor client handlers when implemented
+            vendor_dispatch(model, opcode, data, length, param->client_recv_publish_msg.ctx);
         }
         break;
 
@@ -1158,19 +1560,15 @@ static void mesh_prov_cb(esp_ble_mesh_prov_cb_event_t event,
         ESP_LOGI(TAG, "  Unicast address: 0x%04x", param->node_prov_complete.addr);
         ESP_LOGI(TAG, "  NetKey index: 0x%04x", param->node_prov_complete.net_idx);
 
-        // Notify application
-        if (app_callbacks.provisioned) {
-            app_callbacks.provisioned(param->node_prov_complete.addr);
-        }
+        // Notify application (on the event loop, not the stack's task)
+        loop_post_stack_event(MESH_EVENT_PROVISIONED, param->node_prov_complete.addr);
         break;
 
     case ESP_BLE_MESH_NODE_PROV_RESET_EVT:
         ESP_LOGI(TAG, "Node reset - returning to unprovisioned state");
 
-        // Notify application
-        if (app_callbacks.reset) {
-            app_callbacks.reset();
-        }
+        // Notify application (on the event loop, not the stack's task)
+        loop_post_stack_event(MESH_EVENT_RESET, 0);
         break;
 
     default:
@@ -1234,6 +1632,372 @@ static esp_err_t bluetooth_init(void)
     return ESP_OK;
 }
 
+/*
+ * ============================================================================
+ *                    EVENT LOOP (one task, one queue)
+ * ============================================================================
+ *
+ * Everything the node does outside the mesh stack's own tasks runs on ONE
+ * task, the mesh_loop task (mesh_event_loop.h):
+ *
+ *     ┌──────────────────── mesh_loop task ────────────────────┐
+ *     │ lock → wheel: run due timers → earliest deadline → unlock│
+ *     │ xQueueReceive(queue, deadline)                          │
+ *     │   event   → handler[type]   (mesh_event_on)             │
+ *     │   timeout → next turn runs the timers                   │
+ *     └─────────────────────────────────────────────────────────┘
+ *
+ * Producers only post: the mesh stack (provisioned / reset / configured),
+ * the application's ISRs and tasks (mesh_event_post / _from_isr), and
+ * mesh_sched_start() from other tasks (a WAKE event, so the loop
+ * re-reads the earliest deadline). Nothing polls: with no events and no
+ * timers the task blocks forever and the CPU can idle.
+ *
+ * Timers: publish_period_ms of every Sensor and Battery model, plus
+ * whatever the application registers with mesh_sched_start(), live on the
+ * loop's timer wheel (mesh_timer_wheel.h). Jobs due in the same 10 ms tick
+ * run back to back in one wakeup: six sensors with a 1000 ms period cost
+ * one wakeup per second, not six, and no stack per job
+ * (tools/bench/bench_wheel.c, tools/sim/sim_evloop.c).
+ *
+ * The lock is recursive: timer callbacks run with it held and may start or
+ * stop timers themselves. Event handlers run without it.
+ */
+
+#define LOOP_TASK_STACK     3072        // Default; node_config_t.loop_stack_size overrides
+#define LOOP_TASK_PRIO      3           // Default; node_config_t.loop_priority overrides
+#define LOOP_QUEUE_LEN      16
+#define LOOP_MAX_SLEEP      6000        // Ticks (60 s): bounds the ms arithmetic below
+
+static mesh_evloop_t loop;
+static QueueHandle_t loop_queue = NULL;
+static SemaphoreHandle_t sched_lock = NULL;
+static TaskHandle_t loop_task = NULL;
+static TickType_t sched_last;           // FreeRTOS tick of the last sched_now()
+static uint32_t sched_tick;             // Wheel ticks since the loop started
+static uint32_t sched_rem_ms;           // Milliseconds into the current wheel tick
+static uint32_t loop_dropped;           // Posts refused: queue full
+
+// Current wheel tick, from FreeRTOS ticks (call with sched_lock held)
+static uint32_t sched_now(void)
+{
+    const TickType_t t = xTaskGetTickCount();
+    sched_rem_ms += (uint32_t)(t - sched_last) * portTICK_PERIOD_MS;
+    sched_last = t;
+    sched_tick += sched_rem_ms / MESH_WHEEL_TICK_MS;
+    sched_rem_ms %= MESH_WHEEL_TICK_MS;
+    return sched_tick;
+}
+
+// ── FreeRTOS port of the loop core ──
+static void port_lock(void *ctx)
+{
+    (void)ctx;
+    xSemaphoreTakeRecursive(sched_lock, portMAX_DELAY);
+}
+
+static void port_unlock(void *ctx)
+{
+    (void)ctx;
+    xSemaphoreGiveRecursive(sched_lock);
+}
+
+static uint32_t port_now(void *ctx)
+{
+    (void)ctx;
+    return sched_now();                 // The core calls it with the lock held
+}
+
+static bool port_wait(void *ctx, mesh_event_t *ev, bool forever, uint32_t deadline)
+{
+    TickType_t wait = portMAX_DELAY;
+    if (!forever) {
+        port_lock(ctx);
+        int32_t ticks = (int32_t)(deadline - sched_now());
+        const uint32_t rem_ms = sched_rem_ms;
+        port_unlock(ctx);
+
+        if (ticks > LOOP_MAX_SLEEP) {
+            ticks = LOOP_MAX_SLEEP;
+        }
+        // Round up: waking a little early would only spin until the tick starts
+        const uint32_t ms = ticks > 0 ? (uint32_t)ticks * MESH_WHEEL_TICK_MS - rem_ms : 0;
+        wait = (ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+    }
+    return xQueueReceive(loop_queue, ev, wait) == pdTRUE;
+}
+
+static void loop_task_fn(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        mesh_evloop_run_once(&loop);
+    }
+}
+
+// ── Mesh stack events: the application's node callbacks run on the loop ──
+static void on_provisioned(const mesh_event_t *ev, void *ctx)
+{
+    (void)ctx;
+    if (app_callbacks.provisioned) {
+        app_callbacks.provisioned((uint16_t)ev->arg);
+    }
+}
+
+static void on_reset(const mesh_event_t *ev, void *ctx)
+{
+    (void)ev;
+    (void)ctx;
+    if (app_callbacks.reset) {
+        app_callbacks.reset();
+    }
+}
+
+static void on_configured(const mesh_event_t *ev, void *ctx)
+{
+    (void)ctx;
+    // The provisioner binds the AppKey to the models it knows about; our
+    // vendor clients get it from us, or they would never decrypt a message
+    for (int i = 0; i < registered_model_count; i++) {
+        if (model_registry[i].type != MESH_MODEL_TYPE_VENDOR) {
+            continue;
+        }
+        vendor_model_state_t *vstate = (vendor_model_state_t *)model_registry[i].runtime_state;
+        if (vstate && vstate->client) {
+            esp_err_t err = esp_ble_mesh_node_bind_app_key_to_local_model(
+                esp_ble_mesh_get_primary_element_address(),
+                vstate->company_id, vstate->model_id, (uint16_t)ev->arg);
+            if (err != ESP_OK) {
+                ESP_LOGW(TAG, "Vendor client MID=0x%04X: AppKey bind failed: err=%d",
+                         vstate->model_id, err);
+            }
+        }
+    }
+    if (app_callbacks.config_complete) {
+        app_callbacks.config_complete((uint16_t)ev->arg);
+    }
+}
+
+/**
+ * Post from a mesh stack callback: waits a little for room rather than
+ * lose a lifecycle event the application acts on
+ */
+static void loop_post_stack_event(uint8_t type, uint32_t arg)
+{
+    const mesh_event_t ev = { type, arg };
+    if (xQueueSend(loop_queue, &ev, pdMS_TO_TICKS(100)) != pdTRUE) {
+        loop_dropped++;
+        ESP_LOGE(TAG, "Event loop queue full, mesh event %d lost", type);
+    }
+}
+
+static esp_err_t loop_init(const node_config_t *config)
+{
+    if (loop_task) {
+        return ESP_OK;
+    }
+    sched_lock = xSemaphoreCreateRecursiveMutex();
+    loop_queue = xQueueCreate(LOOP_QUEUE_LEN, sizeof(mesh_event_t));
+    if (!sched_lock || !loop_queue) {
+        goto fail;
+    }
+    sched_last = xTaskGetTickCount();
+
+    const mesh_evloop_port_t port = {
+        .wait = port_wait,
+        .now = port_now,
+        .lock = port_lock,
+        .unlock = port_unlock,
+        .ctx = NULL,
+    };
+    mesh_evloop_init(&loop, &port);
+    mesh_evloop_on(&loop, MESH_EVENT_PROVISIONED, on_provisioned, NULL);
+    mesh_evloop_on(&loop, MESH_EVENT_RESET, on_reset, NULL);
+    mesh_evloop_on(&loop, MESH_EVENT_CONFIGURED, on_configured, NULL);
+
+    BaseType_t core = tskNO_AFFINITY;
+    if (config->loop_pinned && config->loop_core < portNUM_PROCESSORS) {
+        core = config->loop_core;
+    }
+    if (xTaskCreatePinnedToCore(loop_task_fn, "mesh_loop",
+                                config->loop_stack_size ? config->loop_stack_size : LOOP_TASK_STACK,
+                                NULL, config->loop_priority ? config->loop_priority : LOOP_TASK_PRIO,
+                                &loop_task, core) != pdPASS) {
+        goto fail;
+    }
+    return ESP_OK;
+
+fail:
+    if (loop_queue) {
+        vQueueDelete(loop_queue);
+        loop_queue = NULL;
+    }
+    if (sched_lock) {
+        vSemaphoreDelete(sched_lock);
+        sched_lock = NULL;
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t mesh_event_on(uint8_t type, mesh_event_fn_t fn, void *ctx)
+{
+    if (type < MESH_EVENT_APP || type >= MESH_EVENT_TYPES) {
+        return ESP_ERR_INVALID_ARG;     // Below MESH_EVENT_APP: the component's own
+    }
+    if (!sched_lock) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    port_lock(NULL);
+    mesh_evloop_on(&loop, type, fn, ctx);
+    port_unlock(NULL);
+    return ESP_OK;
+}
+
+esp_err_t mesh_event_post(uint8_t type, uint32_t arg)
+{
+    if (!loop_queue) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    const mesh_event_t ev = { type, arg };
+    if (xQueueSend(loop_queue, &ev, 0) != pdTRUE) {
+        loop_dropped++;
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+bool mesh_event_post_from_isr(uint8_t type, uint32_t arg)
+{
+    if (!loop_queue) {
+        return false;
+    }
+    const mesh_event_t ev = { type, arg };
+    BaseType_t woken = pdFALSE;
+    if (xQueueSendFromISR(loop_queue, &ev, &woken) != pdTRUE) {
+        loop_dropped++;
+        return false;
+    }
+    if (woken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+    return true;
+}
+
+esp_err_t mesh_sched_start(mesh_timer_t *timer, uint32_t delay_ms, uint32_t period_ms,
+                           mesh_timer_fn_t fn, void *arg)
+{
+    if (!timer || !fn) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!sched_lock) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    port_lock(NULL);
+    // The wheel's 'now' lags while the loop sleeps: count the delay from the
+    // real current tick (lag is -1 right after an advance, so delay stays ≥ 0)
+    const int32_t lag = (int32_t)(sched_now() - loop.wheel.now);
+    mesh_wheel_start(&loop.wheel, timer, mesh_wheel_ticks(delay_ms) + lag,
+                     period_ms ? mesh_wheel_ticks(period_ms) : 0, fn, arg);
+    port_unlock(NULL);
+
+    // Wake the loop so it sleeps until the new earliest deadline
+    // (not needed from the loop itself: it re-reads the wheel every turn)
+    if (xTaskGetCurrentTaskHandle() != loop_task) {
+        mesh_event_post(MESH_EVENT_WAKE, 0);
+    }
+    return ESP_OK;
+}
+
+void mesh_sched_stop(mesh_timer_t *timer)
+{
+    if (!timer || !sched_lock) {
+        return;
+    }
+    // No wakeup needed: an earlier sleep end only finds nothing due
+    port_lock(NULL);
+    mesh_wheel_stop(&loop.wheel, timer);
+    port_unlock(NULL);
+}
+
+void mesh_sched_get_stats(mesh_sched_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+    if (!sched_lock) {
+        return;
+    }
+    port_lock(NULL);
+    stats->armed = loop.wheel.armed;
+    stats->fired = loop.wheel.fired;
+    stats->batches = loop.wheel.batches;
+    stats->skipped = loop.wheel.skipped;
+    stats->wakeups = loop.wakeups;
+    stats->events = loop.events;
+    stats->unhandled = loop.unhandled;
+    stats->dropped = loop_dropped;
+    port_unlock(NULL);
+}
+
+// Sensor publish_period_ms: also refreshes the value a Sensor Get answers,
+// so it runs before provisioning too (publish itself is skipped until then)
+static void sensor_publish_job(void *arg)
+{
+    sensor_job_t *job = (sensor_job_t *)arg;
+    mesh_model_publish_sensor(job->model_index, job->type);
+}
+
+// Battery publish_period_ms: only once a publish address is configured
+static void battery_publish_job(void *arg)
+{
+    battery_model_state_t *state = (battery_model_state_t *)arg;
+    if (!state->esp_model || !state->esp_model->pub ||
+        state->esp_model->pub->publish_addr == ESP_BLE_MESH_ADDR_UNASSIGNED) {
+        return;
+    }
+    mesh_model_publish_battery(state->model_index);
+}
+
+/**
+ * Arm the publish_period_ms of every Sensor and Battery model
+ * Models with period 0 stay manual (mesh_model_publish_*() only)
+ */
+static void sched_arm_models(void)
+{
+    uint8_t sensor_idx = 0, battery_idx = 0;
+    for (int i = 0; i < registered_model_count; i++) {
+        if (model_registry[i].type == MESH_MODEL_TYPE_SENSOR) {
+            sensor_model_state_t *state = (sensor_model_state_t *)model_registry[i].runtime_state;
+            state->jobs = calloc(state->sensor_count, sizeof(sensor_job_t));
+            if (!state->jobs) {
+                ESP_LOGE(TAG, "Failed to allocate sensor jobs, periodic publish disabled");
+                sensor_idx++;
+                continue;
+            }
+            for (int s = 0; s < state->sensor_count; s++) {
+                const uint32_t period = state->sensors[s].publish_period_ms;
+                if (period == 0) {
+                    continue;
+                }
+                state->jobs[s].model_index = sensor_idx;
+                state->jobs[s].type = state->sensors[s].type;
+                mesh_sched_start(&state->jobs[s].timer, period, period,
+                                 sensor_publish_job, &state->jobs[s]);
+            }
+            sensor_idx++;
+        } else if (model_registry[i].type == MESH_MODEL_TYPE_BATTERY) {
+            battery_model_state_t *state = (battery_model_state_t *)model_registry[i].runtime_state;
+            state->model_index = battery_idx++;
+            if (state->publish_period_ms) {
+                mesh_sched_start(&state->timer, state->publish_period_ms,
+                                 state->publish_period_ms, battery_publish_job, state);
+            }
+        }
+    }
+    ESP_LOGI(TAG, "Event loop: %d periodic job(s) armed", (int)loop.wheel.armed);
+}
+
 /*
  * ============================================================================
  *                    PUBLIC API IMPLEMENTATION
@@ -1251,6 +2015,13 @@ esp_err_t node_init(const node_config_t *config)
 
     ESP_LOGI(TAG, "=== BLE Mesh Node V2 Initialization (Extensible) ===");
 
+    // Event loop first: the application may register jobs right after node_init()
+    ret = loop_init(config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start the event loop task");
+        return ret;
+    }
+
     // Initialize NVS
     ret = nvs_flash_init();
     if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
@@ -1339,6 +2110,13 @@ esp_err_t node_init(const node_config_t *config)
     };
     memcpy(&provision, &temp_prov, sizeof(provision));
 
+    // Worker for deferred vendor models, before any message can arrive
+    ret = rx_worker_init(config->rx_worker_stack_size);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start the rx worker task");
+        return ret;
+    }
+
     // Initialize BLE Mesh
     ret = esp_ble_mesh_init(&provision, &composition);
     if (ret != ESP_OK) {
@@ -1346,12 +2124,30 @@ esp_err_t node_init(const node_config_t *config)
         return ret;
     }
 
+    // Client contexts of the vendor clients (needs the initialized stack)
+    for (int i = 0; i < registered_model_count; i++) {
+        if (model_registry[i].type != MESH_MODEL_TYPE_VENDOR) {
+            continue;
+        }
+        vendor_model_state_t *vstate = (vendor_model_state_t *)model_registry[i].runtime_state;
+        if (vstate && vstate->client) {
+            ret = esp_ble_mesh_client_model_init(vstate->esp_model);
+            if (ret != ESP_OK) {
+                ESP_LOGE(TAG, "Vendor client init failed (err %d)", ret);
+                return ret;
+            }
+        }
+    }
+
     // Set device name
     ret = esp_ble_mesh_set_unprovisioned_device_name(device_name);
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "Failed to set device name (err %d)", ret);
     }
 
+    // Periodic publication of the SIG models now that the stack is up
+    sched_arm_models();
+
     ESP_LOGI(TAG, "BLE Mesh Node initialized successfully");
     ESP_LOGI(TAG, "  Device name: %s", device_name);
     ESP_LOGI(TAG, "  Total models: %d SIG + %d vendor", sig_model_count, vnd_model_count);
@@ -1377,6 +2173,29 @@ esp_err_t node_start(void)
     return ESP_OK;
 }
 
+esp_err_t node_set_relay(bool enable)
+{
+#if defined(CONFIG_BLE_MESH_RELAY)
+    // The stack reads the Configuration Server's relay state for every PDU
+    // it could forward (bt_mesh_relay_get), so writing it takes effect with
+    // the next one. A single byte: no lock against the BTC task needed.
+    const uint8_t relay = enable ? ESP_BLE_MESH_RELAY_ENABLED : ESP_BLE_MESH_RELAY_DISABLED;
+    if (config_server.relay != relay) {
+        config_server.relay = relay;
+        ESP_LOGI(TAG, "Relay %s", enable ? "enabled" : "disabled");
+    }
+    return ESP_OK;
+#else
+    (void)enable;
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+bool node_get_relay(void)
+{
+    return config_server.relay == ESP_BLE_MESH_RELAY_ENABLED;
+}
+
 /*
  * ============================================================================
  *                    MODEL API FUNCTIONS
@@ -1662,6 +2481,100 @@ esp_err_t mesh_model_read_sensor(uint8_t model_index, uint16_t sensor_type, int3
     return ESP_ERR_NOT_FOUND;
 }
 
+/*
+ * ════════════════════════════════════════════════════════════════════════════
+ *                    PUBLICATION BUFFER
+ * ════════════════════════════════════════════════════════════════════════════
+ *
+ * Every publishing model owns a publication buffer (pub.msg). There are
+ * two ways to hand the stack a payload:
+ *
+ * COPYING - esp_ble_mesh_server_model_send_msg(model, ctx, op, len, data):
+ *   The API allocates a fresh buffer (bt_mesh_malloc), writes the opcode and
+ *   memcpy()s 'data' behind it, then queues that buffer to the BTC task.
+ *   Every message costs a heap allocation + free.
+ *
+ * PUBLICATION BUFFER - esp_ble_mesh_model_publish(model, op, len, data):
+ *   Writes [opcode][data] into pub.msg, and the BTC task encrypts straight
+ *   from it. Same one payload copy, no allocation. The payload must not
+ *   live in pub.msg itself: the API copies it over with memcpy(), which
+ *   is undefined for overlapping memory - reserve() hands out a separate
+ *   stage for that reason.
+ *
+ * The buffer path sends to the publication the provisioner configured
+ * (address, AppKey, TTL, retransmissions) - the same settings any SIG
+ * model publishes with.
+ *
+ * ONE PUBLICATION IN FLIGHT:
+ * --------------------------
+ * While the stack still reads pub.msg (PUBLICATION IN FLIGHT above),
+ * publish_payload() takes the copying path to the same address, AppKey
+ * and TTL instead, and mesh_model_vendor_reserve() returns NULL so the
+ * codec writes into the caller's own buffer. A burst (two frames back to
+ * back) therefore costs one allocation, never a torn frame.
+ *
+ * mesh_model_get_publish_stats() counts both paths and the CPU cycles spent
+ * inside the calls, so the difference can be measured on the device.
+ */
+
+#define SENSOR_STATUS_PAYLOAD_LEN   7   // Format B MPID (3) + int32 value (4)
+
+static mesh_publish_stats_t publish_stats;
+
+// Count one publish call: copied = payload bytes put in an allocated buffer (0 = pub.msg)
+static void count_publish(uint16_t copied, uint32_t cycles)
+{
+    if (copied) {
+        publish_stats.copied++;
+        publish_stats.copied_bytes += copied;
+        publish_stats.copied_cycles += cycles;
+    } else {
+        publish_stats.in_place++;
+        publish_stats.in_place_cycles += cycles;
+    }
+}
+
+/**
+ * Publish [opcode][data] with the model's publication settings
+ *
+ * Through pub.msg when the stack is done with it, else copied.
+ */
+static esp_err_t publish_payload(esp_ble_mesh_model_t *model, volatile bool *busy,
+                                 uint32_t opcode, uint8_t *data, uint16_t len)
+{
+    esp_ble_mesh_model_pub_t *pub = model->pub;
+    const uint32_t c0 = esp_cpu_get_cycle_count();
+    esp_err_t err;
+    if (!pub_in_flight(pub, *busy)) {
+        *busy = true;                   // Cleared by ESP_BLE_MESH_MODEL_PUBLISH_COMP_EVT
+        err = esp_ble_mesh_model_publish(model, opcode, len, data, ROLE_NODE);
+        if (err != ESP_OK) {
+            *busy = false;              // Nothing was queued
+        }
+        count_publish(0, esp_cpu_get_cycle_count() - c0);
+        return err;
+    }
+
+    esp_ble_mesh_msg_ctx_t ctx = {
+        .net_idx = 0,
+        .app_idx = pub->app_idx,
+        .addr = pub->publish_addr,
+        .send_ttl = pub->ttl,
+        .send_rel = false,
+    };
+    err = esp_ble_mesh_server_model_send_msg(model, &ctx, opcode, len, data);
+    count_publish(len, esp_cpu_get_cycle_count() - c0);
+    return err;
+}
+
+void mesh_model_get_publish_stats(mesh_publish_stats_t *stats, bool reset)
+{
+    *stats = publish_stats;
+    if (reset) {
+        memset(&publish_stats, 0, sizeof(publish_stats));
+    }
+}
+
 /*
  * ════════════════════════════════════════════════════════════════════════════
  *                    PUBLISH SENSOR DATA TO BLE MESH NETWORK
@@ -1694,7 +2607,8 @@ esp_err_t mesh_model_read_sensor(uint8_t model_index, uint16_t sensor_type, int3
  * 1. Look up the sensor by type (e.g., 0x5001 = Accel X)
  * 2. Call user's callback to READ the current value from hardware
  * 3. Format the data according to BLE Mesh Sensor Server spec (MPID)
- * 4. Send the formatted message using esp_ble_mesh_server_model_send_msg()
+ * 4. Publish it through the model's publication buffer (see PUBLICATION
+ *    BUFFER above)
  *
  * @param model_index Which Sensor Server model (usually 0)
  * @param sensor_type Which sensor to publish (e.g., SENSOR_ACCEL_X)
@@ -1786,9 +2700,9 @@ esp_err_t mesh_model_publish_sensor(uint8_t model_index, uint16_t sensor_type)
      * This is a network buffer (net_buf_simple) that holds the raw sensor data.
      * For each sensor, ESP-IDF allocates one of these buffers during init.
      *
-     * It's separate from the final message buffer because:
-     *   1. The raw value needs to be stored in ESP-IDF's internal sensor state
-     *   2. We'll copy it into the message buffer along with the MPID header
+     * It is the sensor's STATE (what a Sensor Get is answered from), not a
+     * staging area: the message below encodes the value itself instead of
+     * copying these bytes over.
      */
     struct net_buf_simple *buf = state->sensor_states[sensor_idx].sensor_data.raw_value;
     net_buf_simple_reset(buf);  // Clear any old data
@@ -1810,23 +2724,16 @@ esp_err_t mesh_model_publish_sensor(uint8_t model_index, uint16_t sensor_type)
      * The BLE Mesh stack will add:
      *   [Network Layer Headers] [Transport Layer Headers] [Access Layer]
      *
-     * We only build the ACCESS LAYER payload:
+     * We build the ACCESS LAYER payload behind the opcode:
      *   [Opcode: 0x52] [MPID Header] [Sensor Data]
      *
-     * The opcode (SENSOR_STATUS = 0x52) is passed separately to the send function.
-     * We only need to build [MPID Header + Data].
-     *
-     * USING THE PUBLICATION BUFFER:
-     * -----------------------------
-     * state->pub.msg is a buffer pre-allocated for this model's publications.
-     * It's sized to hold the largest message this model might send.
-     *
-     * For sensors, we configured it as NET_BUF_SIMPLE(2 + 32):
-     *   - 2 bytes for BLE Mesh headers
-     *   - 32 bytes for our data (MPID + sensor value)
+     * The opcode (SENSOR_STATUS = 0x52) is passed separately to the send
+     * function, which writes both into the model's publication buffer
+     * (state->pub.msg, 34 bytes). The 7 bytes of MPID + data are built on
+     * the stack: pub.msg may still be in flight with the last sensor.
      */
-    struct net_buf_simple *msg = state->pub.msg;
-    net_buf_simple_reset(msg);  // Clear any old message
+    NET_BUF_SIMPLE_DEFINE(status, SENSOR_STATUS_PAYLOAD_LEN);
+    struct net_buf_simple *msg = &status;
 
     /*
      * ════════════════════════════════════════════════════════════════════════
@@ -1868,9 +2775,10 @@ esp_err_t mesh_model_publish_sensor(uint8_t model_index, uint16_t sensor_type)
      *
      * COMPLETE MESSAGE:
      * -----------------
-     *   MPID:  09 01 50
-     *   Data:  50 00 00 00  (80 in little-endian = 0x00000050)
-     *   Total: 09 01 50 50 00 00 00  (7 bytes)
+     *   Opcode: 52           (added by the send function)
+     *   MPID:   09 01 50
+     *   Data:   50 00 00 00  (80 in little-endian = 0x00000050)
+     *   Total:  52 09 01 50 50 00 00 00  (8 bytes)
      */
     uint8_t value_len = 4;  // Our sensors use 4-byte (int32_t) values
 
@@ -1880,7 +2788,7 @@ esp_err_t mesh_model_publish_sensor(uint8_t model_index, uint16_t sensor_type)
     // Write the message: [format_byte] [property_id_low] [property_id_high] [data...]
     net_buf_simple_add_u8(msg, format_byte);         // Byte 0: Format B header
     net_buf_simple_add_le16(msg, sensor_type);       // Bytes 1-2: Property ID (little-endian)
-    net_buf_simple_add_mem(msg, buf->data, buf->len); // Bytes 3-6: Sensor value
+    net_buf_simple_add_le32(msg, sensor_value);      // Bytes 3-6: Sensor value
 
     // Debug: show what we're sending
     ESP_LOGI(TAG, "📤 Sending %d bytes:", msg->len);
@@ -1893,88 +2801,51 @@ esp_err_t mesh_model_publish_sensor(uint8_t model_index, uint16_t sensor_type)
      *
      * Now we hand off our formatted message to the BLE Mesh stack.
      * The stack will:
-     *   1. Add Access Layer headers (opcode)
-     *   2. Encrypt with the Application Key
-     *   3. Add Transport Layer headers (segmentation if needed)
-     *   4. Add Network Layer headers (source/dest addresses, TTL)
-     *   5. Transmit over BLE advertising
+     *   1. Encrypt it with the Application Key
+     *   2. Add Transport Layer headers (segmentation if needed)
+     *   3. Add Network Layer headers (source/dest addresses, TTL)
+     *   4. Transmit over BLE advertising
      *
-     * MESSAGE CONTEXT (esp_ble_mesh_msg_ctx_t):
-     * ------------------------------------------
-     * This tells the mesh stack HOW to send the message.
+     * WHERE / HOW IT IS SENT:
+     * -----------------------
+     * Publishing uses the model's publication settings, which the
+     * provisioner configured (MODEL_PUB_SET):
      *
-     * FIELDS:
-     * -------
-     * - net_idx: Which Network Key to use (0 = primary network)
-     *   A mesh can have multiple overlapping networks with different keys.
-     *   We only have one network, so we use 0.
+     * - publish_addr: Destination address
+     *   Typically 0x0001 (provisioner) or 0xC000-0xFFFF (group address).
      *
-     * - app_idx: Which Application Key to use (0 = primary app key)
+     * - app_idx: Which Application Key to use
      *   Even within a network, different apps can use different keys.
-     *   The provisioner gave us app key 0 during configuration.
-     *
-     * - addr: Destination address (where to send)
-     *   This was configured during provisioning (MODEL_PUB_SET).
-     *   Typically 0x0001 (provisioner) or 0xC000-0xFFFF (group address).
      *
-     * - send_ttl: Time To Live (how many hops allowed)
+     * - ttl: Time To Live (how many hops allowed)
      *   Each relay decrements TTL. Message is dropped when TTL=0.
-     *   7 is a good default (allows message to cross several relay nodes).
-     *
-     * - send_rel: Use reliable transport? (false = no acknowledgment)
-     *   true  = Segmented/acknowledged (for important commands)
-     *   false = Unsegmented/unacknowledged (for frequent sensor data)
-     *
-     * WHY send_rel = false FOR SENSORS?
-     * ----------------------------------
-     * Sensor data is:
-     *   - Sent frequently (every 100ms in our case)
-     *   - Not critical if one reading is lost
-     *   - Better to send next reading than retry old one
      *
-     * Using reliable transport would:
-     *   - Add overhead (ACKs, retries)
-     *   - Increase latency
-     *   - Waste bandwidth
+     * - retransmit: How many extra copies to send, and how far apart
      *
-     * FUNCTION: esp_ble_mesh_server_model_send_msg()
-     * -----------------------------------------------
-     * This is the CORRECT API for server models to send messages.
+     * Publications are unacknowledged: sensor data is sent frequently, losing
+     * one reading is not critical, and it is better to send the next reading
+     * than to retry an old one.
      *
-     * PARAMETERS:
-     *   - state->esp_model: Which model is sending (our Sensor Server)
-     *   - &pub_ctx: Message context (where/how to send)
-     *   - ESP_BLE_MESH_MODEL_OP_SENSOR_STATUS: The opcode (0x52)
-     *   - msg->len: How many bytes in our payload
-     *   - msg->data: The payload (MPID + sensor data)
+     * FUNCTION: esp_ble_mesh_model_publish() (via publish_payload)
+     * --------------------------------------------------------------
+     * It writes the message into state->pub.msg and the stack encrypts it
+     * from there (see PUBLICATION BUFFER above). While the previous sensor's
+     * publication still occupies pub.msg - six sensors due in the same
+     * tick - it falls back to esp_ble_mesh_server_model_send_msg(), which
+     * allocates a buffer of its own.
      *
      * WHAT HAPPENS NEXT:
      * ------------------
-     * The mesh stack will:
-     *   1. Validate we have the app key
-     *   2. Build the complete Access Layer message: [0x52] [our data]
-     *   3. Encrypt using AES-CCM with the app key
-     *   4. Add transport headers (no segmentation for small messages)
-     *   5. Add network headers (src=our address, dst=publish address, TTL=7)
-     *   6. Transmit as BLE advertisement packet(s)
-     *   7. If there are relay nodes, they'll rebroadcast (decrement TTL)
-     *   8. The provisioner receives and decrypts using same app key
-     *   9. Provisioner's Sensor Client callback fires with our data!
+     *   1. Encrypt using AES-CCM with the app key
+     *   2. Add transport headers (no segmentation for small messages)
+     *   3. Add network headers (src=our address, dst=publish address)
+     *   4. Transmit as BLE advertisement packet(s)
+     *   5. If there are relay nodes, they'll rebroadcast (decrement TTL)
+     *   6. The provisioner receives and decrypts using same app key
+     *   7. Provisioner's Sensor Client callback fires with our data!
      */
-    esp_ble_mesh_msg_ctx_t pub_ctx = {
-        .net_idx = 0,                      // Primary network key
-        .app_idx = 0,                      // Primary application key
-        .addr = state->pub.publish_addr,   // Where to send (configured by provisioner)
-        .send_ttl = 7,                     // Allow up to 7 relay hops
-        .send_rel = false,                 // Unacknowledged (best for sensors)
-    };
-
-    esp_err_t err = esp_ble_mesh_server_model_send_msg(
-        state->esp_model,                       // Our Sensor Server model
-        &pub_ctx,                               // Message context (where/how)
-        ESP_BLE_MESH_MODEL_OP_SENSOR_STATUS,    // Opcode = 0x52 (SENSOR_STATUS)
-        msg->len,                               // Payload length (7 bytes)
-        msg->data);                             // Payload (MPID + value)
+    esp_err_t err = publish_payload(state->esp_model, &state->pub_busy,
+                                    ESP_BLE_MESH_MODEL_OP_SENSOR_STATUS, msg->data, msg->len);
 
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to publish sensor 0x%04X, err %d", sensor_type, err);
@@ -2045,18 +2916,20 @@ esp_err_t mesh_model_send_vendor(uint8_t model_index, uint32_t opcode,
         .net_idx = 0,          // Primary network key
         .app_idx = 0,          // Primary application key
         .addr = dest_addr,     // Destination address
-        .send_ttl = 7,         // Allow 7 relay hops
+        .send_ttl = MESH_VENDOR_SEND_TTL,   // Allow 7 relay hops
         .send_rel = false,     // Unacknowledged - vendor models don't support ACKs well at high rates
     };
 
     // Send vendor message
     // Note: For vendor models, ESP-IDF expects the FULL opcode (3 bytes)
+    const uint32_t c0 = esp_cpu_get_cycle_count();
     esp_err_t err = esp_ble_mesh_server_model_send_msg(
         state->esp_model,      // Vendor model
         &msg_ctx,              // Message context
         opcode,                // Your 3-byte vendor opcode
         length,                // Payload length
-        data);                 // Payload
+        data);                 // Payload (copied into a new stack buffer)
+    count_publish(length, esp_cpu_get_cycle_count() - c0);
 
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Vendor send failed: opcode=0x%06x err=%d", (unsigned int)opcode, err);
@@ -2113,19 +2986,21 @@ esp_err_t mesh_model_publish_vendor(uint8_t model_index, uint32_t opcode,
         .net_idx = 0,
         .app_idx = 0,
         .addr = state->esp_model->pub->publish_addr,  // ESP-IDF sets this when provisioner configures
-        .send_ttl = 7,
+        .send_ttl = MESH_VENDOR_SEND_TTL,
         .send_rel = false,
     };
 
     ESP_LOGI(TAG, "📡 Publishing vendor message: opcode=0x%06" PRIx32 " len=%d to=0x%04x",
              opcode, length, pub_ctx.addr);
 
+    const uint32_t c0 = esp_cpu_get_cycle_count();
     esp_err_t err = esp_ble_mesh_server_model_send_msg(
         state->esp_model,
         &pub_ctx,
         opcode,
         length,
         data);
+    count_publish(length, esp_cpu_get_cycle_count() - c0);
 
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Vendor publish failed: opcode=0x%06x err=%d", (unsigned int)opcode, err);
@@ -2134,6 +3009,152 @@ esp_err_t mesh_model_publish_vendor(uint8_t model_index, uint32_t opcode,
     return err;
 }
 
+/*
+ * ════════════════════════════════════════════════════════════════════════
+ *                  RESERVE / COMMIT (ENCODE IN PLACE)
+ * ════════════════════════════════════════════════════════════════════════
+ *
+ * The allocation-free form of mesh_model_publish_vendor():
+ *
+ *   uint8_t *p = mesh_model_vendor_reserve(0, op, 8);   // NULL: use your own buffer
+ *   size_t len = my_codec_pack(..., p);                  // encode right there
+ *   mesh_model_vendor_commit(0, len);                    // publish via pub.msg
+ *
+ * reserve() hands out the model's stage - not pub.msg itself, which the
+ * stack may still be sending from - and commit() publishes it through the
+ * publication buffer (see PUBLICATION BUFFER above). While a publication
+ * is in flight, reserve() returns NULL: the caller encodes into its own
+ * buffer and sends that with mesh_model_publish_vendor().
+ */
+uint8_t *mesh_model_vendor_reserve(uint8_t model_index, uint32_t opcode, uint16_t max_len)
+{
+    vendor_model_state_t *state = find_vendor_model(model_index);
+    if (!state || !state->esp_model || !state->pub.msg) {
+        ESP_LOGE(TAG, "Vendor model #%d has no publication buffer", model_index);
+        return NULL;
+    }
+    if (state->pub.publish_addr == ESP_BLE_MESH_ADDR_UNASSIGNED) {
+        ESP_LOGW(TAG, "Vendor model publish address not configured (waiting for provisioner)");
+        return NULL;
+    }
+    if (state->pub_update) {
+        ESP_LOGD(TAG, "Vendor model #%d publishes periodically: no reserve", model_index);
+        return NULL;
+    }
+    if (max_len > MESH_VENDOR_PUB_MAX) {
+        ESP_LOGE(TAG, "Vendor reserve of %d bytes exceeds the publication buffer", max_len);
+        return NULL;
+    }
+    if (pub_in_flight(&state->pub, state->pub_busy)) {
+        return NULL;                    // Last frame still on air: the caller copies
+    }
+
+    state->reserved_op = opcode;
+    state->reserved_len = max_len;
+    return state->stage;
+}
+
+esp_err_t mesh_model_vendor_commit(uint8_t model_index, uint16_t length)
+{
+    vendor_model_state_t *state = find_vendor_model(model_index);
+    if (!state || state->reserved_len == 0) {
+        return ESP_ERR_INVALID_STATE;   // Nothing reserved (e.g. not provisioned yet)
+    }
+    if (length > state->reserved_len) {
+        state->reserved_len = 0;
+        return ESP_ERR_INVALID_SIZE;
+    }
+    state->reserved_len = 0;
+    if (length == 0) {
+        return ESP_OK;                  // Encoder had nothing to send
+    }
+
+    esp_err_t err = publish_payload(state->esp_model, &state->pub_busy, state->reserved_op,
+                                    state->stage, length);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Vendor publish failed: opcode=0x%06x err=%d",
+                 (unsigned int)state->reserved_op, err);
+    }
+    return err;
+}
+
+esp_err_t mesh_model_vendor_set_periodic(uint8_t model_index, mesh_pub_update_t update,
+                                         void *user_data)
+{
+    vendor_model_state_t *state = find_vendor_model(model_index);
+    if (!state || !state->esp_model) {
+        ESP_LOGE(TAG, "Vendor model #%d not found", model_index);
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (!state->pub.msg) {
+        ESP_LOGE(TAG, "Vendor model #%d has no publication (enable_publication)", model_index);
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (update && !state->pub_swap) {
+        const esp_timer_create_args_t args = {
+            .callback = pub_swap_fn,
+            .arg = state,
+            .name = "pub_swap",
+        };
+        esp_err_t err = esp_timer_create(&args, &state->pub_swap);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Vendor model #%d: no swap timer (%d)", model_index, err);
+            return err;
+        }
+    }
+    if (!update && state->pub_swap) {
+        esp_timer_stop(state->pub_swap);    // A waiting frame would overwrite the app's
+        taskENTER_CRITICAL(&pub_swap_mux);
+        state->pub_next_ready = false;
+        taskEXIT_CRITICAL(&pub_swap_mux);
+    }
+    state->pub_update_data = user_data;
+    state->pub_update = update;
+    ESP_LOGI(TAG, "Vendor model #%d: %s", model_index,
+             update ? "periodic publication follows the provisioner's period"
+                    : "app publishes itself");
+    return ESP_OK;
+}
+
+uint8_t mesh_msg_recv_ttl(const void *ctx)
+{
+    // Vendor handlers get the ESP-IDF message context as an opaque pointer
+    return ctx ? ((const esp_ble_mesh_msg_ctx_t *)ctx)->recv_ttl : 0;
+}
+
+uint16_t mesh_msg_src_addr(const void *ctx)
+{
+    return ctx ? ((const esp_ble_mesh_msg_ctx_t *)ctx)->addr : 0;
+}
+
+int8_t mesh_msg_recv_rssi(const void *ctx)
+{
+    return ctx ? ((const esp_ble_mesh_msg_ctx_t *)ctx)->recv_rssi : 0;
+}
+
+esp_err_t mesh_model_subscribe_vendor(uint8_t model_index, uint16_t group_addr)
+{
+    vendor_model_state_t *state = find_vendor_model(model_index);
+    if (!state || !state->esp_model) {
+        ESP_LOGE(TAG, "Vendor model #%d not found", model_index);
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (!ESP_BLE_MESH_ADDR_IS_GROUP(group_addr)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // All our models live on the primary element (see composition above)
+    esp_err_t err = esp_ble_mesh_model_subscribe_group_addr(
+        esp_ble_mesh_get_primary_element_address(),
+        state->company_id, state->model_id, group_addr);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Vendor subscribe to 0x%04x failed: err=%d", group_addr, err);
+    } else {
+        ESP_LOGI(TAG, "Vendor model #%d subscribed to 0x%04x", model_index, group_addr);
+    }
+    return err;
+}
+
 uint8_t mesh_model_get_battery(uint8_t model_index)
 {
     battery_model_state_t *state = find_battery_model(model_index);
@@ -0,0 +1,64 @@
+/*
+ * ============================================================================
+ *                    BLE MESH NODE - EVENT LOOP CORE
+ * ============================================================================
+ *
+ * See mesh_event_loop.h for what it is for.
+ */
+
+#include <string.h>
+#include "mesh_event_loop.h"
+
+static void loop_lock(mesh_evloop_t *l)
+{
+    if (l->port.lock) {
+        l->port.lock(l->port.ctx);
+    }
+}
+
+static void loop_unlock(mesh_evloop_t *l)
+{
+    if (l->port.unlock) {
+        l->port.unlock(l->port.ctx);
+    }
+}
+
+void mesh_evloop_init(mesh_evloop_t *l, const mesh_evloop_port_t *port)
+{
+    memset(l, 0, sizeof(*l));
+    l->port = *port;
+    mesh_wheel_init(&l->wheel, port->now(port->ctx));
+}
+
+bool mesh_evloop_on(mesh_evloop_t *l, uint8_t type, mesh_event_fn_t fn, void *ctx)
+{
+    if (type >= MESH_EVENT_TYPES) {
+        return false;
+    }
+    l->fn[type] = fn;
+    l->fn_ctx[type] = ctx;
+    return true;
+}
+
+void mesh_evloop_run_once(mesh_evloop_t *l)
+{
+    // Timers first: whatever fell due while the last handler ran
+    loop_lock(l);
+    mesh_wheel_advance(&l->wheel, l->port.now(l->port.ctx));
+    const uint32_t gap = mesh_wheel_next(&l->wheel);
+    const uint32_t deadline = l->wheel.now + gap;
+    loop_unlock(l);
+
+    mesh_event_t ev;
+    const bool got = l->port.wait(l->port.ctx, &ev, gap == MESH_WHEEL_NONE, deadline);
+    l->wakeups++;
+    if (!got) {
+        return;                     // Deadline: the next turn runs the timers
+    }
+    l->events++;
+    if (ev.type < MESH_EVENT_TYPES && l->fn[ev.type]) {
+        l->fn[ev.type](&ev, l->fn_ctx[ev.type]);
+    } else if (ev.type != MESH_EVENT_WAKE) {
+        l->unhandled++;
+    }
+}
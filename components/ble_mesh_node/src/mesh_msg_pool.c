@@ -0,0 +1,92 @@
+/*
+ * ============================================================================
+ *                    BLE MESH NODE - RECEIVED MESSAGE POOL
+ * ============================================================================
+ *
+ * See mesh_msg_pool.h for what it is for.
+ */
+
+#include <string.h>
+#include "mesh_msg_pool.h"
+
+void mesh_msg_pool_init(mesh_msg_pool_t *p)
+{
+    memset(p, 0, sizeof(*p));
+    for (int i = 0; i < MESH_MSG_POOL_SMALL; i++) {
+        mesh_msg_t *m = &p->msg[i];
+        m->data = p->small_buf[i];
+        m->cap = MESH_MSG_SMALL;
+        m->next = p->free_small;
+        p->free_small = m;
+    }
+    for (int i = 0; i < MESH_MSG_POOL_LARGE; i++) {
+        mesh_msg_t *m = &p->msg[MESH_MSG_POOL_SMALL + i];
+        m->data = p->large_buf[i];
+        m->cap = MESH_MSG_LARGE;
+        m->next = p->free_large;
+        p->free_large = m;
+    }
+}
+
+mesh_msg_t *mesh_msg_pool_get(mesh_msg_pool_t *p, uint16_t len)
+{
+    if (len > MESH_MSG_LARGE) {
+        p->too_long++;
+        return NULL;
+    }
+    // Smallest class that fits; a small message borrows a large buffer
+    // only when the small ones are all in use
+    mesh_msg_t **list = NULL;
+    if (len <= MESH_MSG_SMALL && p->free_small) {
+        list = &p->free_small;
+    } else if (p->free_large) {
+        list = &p->free_large;
+    }
+    if (!list) {
+        p->dropped++;
+        return NULL;
+    }
+    mesh_msg_t *m = *list;
+    *list = m->next;
+    m->next = NULL;
+    m->len = len;
+    p->queued++;
+    return m;
+}
+
+void mesh_msg_pool_push(mesh_msg_pool_t *p, mesh_msg_t *m)
+{
+    m->next = NULL;
+    if (p->tail) {
+        p->tail->next = m;
+    } else {
+        p->head = m;
+    }
+    p->tail = m;
+    p->pending++;
+    if (p->pending > p->max_pending) {
+        p->max_pending = p->pending;
+    }
+}
+
+mesh_msg_t *mesh_msg_pool_pop(mesh_msg_pool_t *p)
+{
+    mesh_msg_t *m = p->head;
+    if (!m) {
+        return NULL;
+    }
+    p->head = m->next;
+    if (!p->head) {
+        p->tail = NULL;
+    }
+    m->next = NULL;
+    p->pending--;
+    return m;
+}
+
+void mesh_msg_pool_put(mesh_msg_pool_t *p, mesh_msg_t *m)
+{
+    mesh_msg_t **list = (m->cap == MESH_MSG_SMALL) ? &p->free_small : &p->free_large;
+    m->next = *list;
+    *list = m;
+}
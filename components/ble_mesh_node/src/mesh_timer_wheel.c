@@ -0,0 +1,150 @@
+/*
+ * ============================================================================
+ *                    BLE MESH NODE - HASHED TIMER WHEEL
+ * ============================================================================
+ *
+ * See mesh_timer_wheel.h for the layout and what it is for.
+ */
+
+#include <string.h>
+#include "mesh_timer_wheel.h"
+
+#define SLOT_MASK   (MESH_WHEEL_SLOTS - 1)
+
+_Static_assert((MESH_WHEEL_SLOTS & SLOT_MASK) == 0, "MESH_WHEEL_SLOTS must be a power of two");
+
+uint32_t mesh_wheel_ticks(uint32_t ms)
+{
+    uint32_t t = ms / MESH_WHEEL_TICK_MS + (ms % MESH_WHEEL_TICK_MS != 0);
+    return t ? t : 1;
+}
+
+void mesh_wheel_init(mesh_wheel_t *w, uint32_t now)
+{
+    memset(w, 0, sizeof(*w));
+    w->now = now;
+}
+
+static void slot_link(mesh_wheel_t *w, mesh_timer_t *t)
+{
+    mesh_timer_t **head = &w->slot[t->deadline & SLOT_MASK];
+    t->next = *head;
+    *head = t;
+}
+
+static void slot_unlink(mesh_wheel_t *w, mesh_timer_t *t)
+{
+    for (mesh_timer_t **p = &w->slot[t->deadline & SLOT_MASK]; *p; p = &(*p)->next) {
+        if (*p == t) {
+            *p = t->next;
+            return;
+        }
+    }
+}
+
+void mesh_wheel_start(mesh_wheel_t *w, mesh_timer_t *t, uint32_t delay, uint32_t period,
+                      mesh_timer_fn_t fn, void *arg)
+{
+    mesh_wheel_stop(w, t);
+    t->deadline = w->now + delay;
+    t->period = period;
+    t->fn = fn;
+    t->arg = arg;
+    t->armed = true;
+    slot_link(w, t);
+    w->armed++;
+}
+
+void mesh_wheel_stop(mesh_wheel_t *w, mesh_timer_t *t)
+{
+    if (!t->armed) {
+        return;
+    }
+    slot_unlink(w, t);
+    t->armed = false;
+    w->armed--;
+}
+
+uint32_t mesh_wheel_next(const mesh_wheel_t *w)
+{
+    if (w->armed == 0) {
+        return MESH_WHEEL_NONE;
+    }
+    // Walk one lap from now: the first timer due on its own tick is the earliest
+    for (uint32_t i = 0; i < MESH_WHEEL_SLOTS; i++) {
+        const uint32_t tick = w->now + i;
+        for (const mesh_timer_t *t = w->slot[tick & SLOT_MASK]; t; t = t->next) {
+            if (t->deadline == tick) {
+                return i;
+            }
+        }
+    }
+    // Nothing within a lap: every armed deadline is ≥ w->now, so unsigned
+    // differences order them
+    uint32_t best = MESH_WHEEL_NONE;
+    for (int s = 0; s < MESH_WHEEL_SLOTS; s++) {
+        for (const mesh_timer_t *t = w->slot[s]; t; t = t->next) {
+            const uint32_t d = t->deadline - w->now;
+            if (d < best) {
+                best = d;
+            }
+        }
+    }
+    return best;
+}
+
+// First timer in the tick's slot that is due at that tick (not a later lap)
+static mesh_timer_t *due_in_slot(const mesh_wheel_t *w, uint32_t tick)
+{
+    for (mesh_timer_t *t = w->slot[tick & SLOT_MASK]; t; t = t->next) {
+        if (t->deadline == tick) {
+            return t;
+        }
+    }
+    return NULL;
+}
+
+uint32_t mesh_wheel_advance(mesh_wheel_t *w, uint32_t now)
+{
+    uint32_t fired = 0;
+
+    while ((int32_t)(now - w->now) >= 0) {
+        // Jump straight to the next deadline: empty ticks cost nothing
+        const uint32_t gap = mesh_wheel_next(w);
+        if (gap == MESH_WHEEL_NONE || gap > now - w->now) {
+            break;
+        }
+        const uint32_t tick = w->now + gap;
+        w->now = tick;                          // Callbacks start timers relative to this tick
+
+        // Rescan after every callback: it may start or stop any timer
+        uint32_t batch = 0;
+        mesh_timer_t *t;
+        while ((t = due_in_slot(w, tick)) != NULL) {
+            slot_unlink(w, t);
+            if (t->period) {
+                uint32_t d = tick + t->period;
+                if ((int32_t)(now - d) >= 0) {  // Fell behind: skip to the first future run
+                    const uint32_t missed = (now - d) / t->period + 1;
+                    d += missed * t->period;
+                    w->skipped += missed;
+                }
+                t->deadline = d;
+                slot_link(w, t);
+            } else {
+                t->armed = false;
+                w->armed--;
+            }
+            t->fn(t->arg);
+            batch++;
+        }
+        fired += batch;
+        w->fired += batch;
+        w->batches += (batch > 0);
+        w->now = tick + 1;
+    }
+    if ((int32_t)(now - w->now) >= 0) {
+        w->now = now + 1;
+    }
+    return fired;
+}
@@ -0,0 +1,129 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - AUTO-RANGING FULL-SCALE CONTROLLER
+ * ============================================================================
+ *
+ * Picks the MPU6886 accel and gyro full-scale range (imu_mpu6886.h) from
+ * the peaks of recent windows, and scales the ranged frame to match.
+ *
+ * WHY?
+ * ----
+ * A fixed range is wrong most of the time:
+ *   - ±16 g on a device at rest: the int8 frame step is 125 mg, the
+ *     tremor you care about is below one step
+ *   - ±2 g during a fall: the chip clips at 2 g, the impact is gone
+ * The smallest range that holds the signal gives the finest step without
+ * clipping - and it changes with what the device is doing.
+ *
+ * HYSTERESIS:
+ * -----------
+ *   UP   (at once):  window peak > up_pct % of the full scale
+ *                    → smallest range that holds the peak; a CLIPPED peak
+ *                      (true size unknown) jumps straight to the top range
+ *   DOWN (slowly):   window peak < down_pct % of the NEXT LOWER full scale
+ *                    for 'hold' windows in a row → one range down
+ *
+ * With up 90 % / down 70 %, a signal has to shrink well below what would
+ * trigger the way back up before the range drops - no flapping between two
+ * ranges on a signal sitting at a boundary. (Down must stay above 50 %:
+ * gravity alone is 1 g, and ±2 g should still be reachable at rest.) The hold time keeps the range
+ * up between repeated impacts.
+ *
+ * Ranging is reactive: the window that first hits a bigger signal is read
+ * with the old range (and may clip). Every window after that is not.
+ *
+ * RANGED FRAME (opcode 0xC60001, 8 bytes, single segment):
+ * --------------------------------------------------------
+ *   Byte 0-1: [GG|AA|TTTTTTTTTTTT] little-endian
+ *             T = timestamp ms mod 4096, A / G = accel / gyro range index
+ *   Byte 2-7: ax ay az gx gy gz as int8, step = full scale / 128
+ *
+ * Step per range: accel 15.6 / 31 / 62 / 125 mg, gyro 2 / 4 / 8 / 16 dps.
+ * The legacy frame is always 100 mg / 10 dps and clips at 12.7 g.
+ */
+
+#ifndef IMU_AUTORANGE_H
+#define IMU_AUTORANGE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "imu_sample.h"
+#include "imu_mpu6886.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_RANGED_FRAME_LEN  8
+#define IMU_RANGED_TS_MASK    0x0FFFu
+
+typedef enum {
+    IMU_RANGE_SENSOR_ACCEL = 0,
+    IMU_RANGE_SENSOR_GYRO = 1,
+} imu_range_sensor_t;
+
+typedef struct {
+    uint8_t up_pct;                 // Switch up above this % of full scale (e.g. 90)
+    uint8_t down_pct;               // Switch down below this % of the lower full scale (e.g. 70)
+    uint8_t hold;                   // Quiet windows before switching down (e.g. 20)
+    imu_range_t min_range;          // Never go below (e.g. 0)
+} imu_autorange_config_t;
+
+typedef struct {
+    imu_autorange_config_t cfg;
+    imu_range_t range[2];           // Per sensor (imu_range_sensor_t)
+    int32_t peak[2];                // |max| over the 3 axes, this window
+    uint8_t quiet[2];               // Consecutive windows below the down threshold
+    uint32_t switches;              // Range changes since init
+} imu_autorange_t;
+
+/**
+ * Default thresholds: up 90 %, down 70 %, hold 20 windows, min range 0
+ */
+imu_autorange_config_t imu_autorange_default_config(void);
+
+/**
+ * Initialize with the ranges the chip is currently using
+ */
+void imu_autorange_init(imu_autorange_t *ar, const imu_autorange_config_t *cfg,
+                        imu_range_t accel, imu_range_t gyro);
+
+/**
+ * Feed one sample (call for every raw sample of the window)
+ */
+void imu_autorange_observe(imu_autorange_t *ar, const imu_sample_t *s);
+
+/**
+ * Close the window: decide the ranges for the next one
+ *
+ * The returned ranges hold this window's peak, so they are also the best
+ * scale for this window's ranged frame.
+ *
+ * @param accel New accel range (output)
+ * @param gyro  New gyro range (output)
+ * @return true if either range changed (write it to the chip)
+ */
+bool imu_autorange_update(imu_autorange_t *ar, imu_range_t *accel, imu_range_t *gyro);
+
+/**
+ * Pack a sample as a ranged frame (values saturate at the full scale)
+ */
+void imu_ranged_pack(const imu_sample_t *s, uint16_t t_ms, imu_range_t accel,
+                     imu_range_t gyro, uint8_t out[IMU_RANGED_FRAME_LEN]);
+
+/**
+ * Unpack a ranged frame
+ * @param t_ms  Timestamp mod 4096 (may be NULL)
+ * @param accel Accel range (may be NULL)
+ * @param gyro  Gyro range (may be NULL)
+ * @return false if the length is wrong
+ */
+bool imu_ranged_unpack(const uint8_t *in, size_t len, imu_sample_t *s, uint16_t *t_ms,
+                       imu_range_t *accel, imu_range_t *gyro);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_AUTORANGE_H
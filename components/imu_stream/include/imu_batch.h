@@ -0,0 +1,107 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - CLUSTER-HEAD BATCHES
+ * ============================================================================
+ *
+ * Every legacy frame is its own mesh message: 8 data bytes in a 29-byte
+ * network PDU, sent three times by its source and three times again by
+ * every relay on the way to the gateway. When several sticks sit close
+ * together, one of them - the cluster head - can carry the others' frames:
+ *
+ *   member ──TTL 0──▶ head (vendor client on the data group)
+ *   head   ──one segmented 0xCF0001 batch──▶ gateway, over the relays
+ *
+ * TTL 0 keeps the members' frames one hop: relays do not forward them. The
+ * head re-sends up to IMU_BATCH_MAX_ENTRIES frames per batch at 9 bytes
+ * each - 0.75 segments per frame instead of one message per frame on every
+ * relay hop. The members' own hop, the SAR acks and the resends cost about
+ * that much again; tools/sim/sim_aggregate compares both end to end.
+ *
+ * FRAME (opcode 0xCF0001, segmented, 3 + 9 × n bytes + 2 per escape):
+ * ---------------------------------------------------------------------
+ *   Byte 0:    n, entries in the batch (1..IMU_BATCH_MAX_ENTRIES)
+ *   Byte 1-2:  base: source address of the first entry, little endian
+ *   Then n entries, sorted by source (a source's frames in arrival order):
+ *     [src code][8-byte legacy frame, as the member published it]
+ *   src code:  0        same source as the entry before (the first: base)
+ *              1..254   previous source + code
+ *              255      escape, the 2-byte source address follows (LE)
+ *
+ * Sticks are usually provisioned one after the other, so the addresses of
+ * a cluster are close and each costs one byte. The frames travel
+ * unchanged: the gateway decodes each entry exactly like a 0xC00001 frame.
+ */
+
+#ifndef IMU_BATCH_H
+#define IMU_BATCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "imu_proto.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_BATCH_HEADER_LEN    3
+#define IMU_BATCH_FRAME_LEN     IMU_FRAME_MAX                       // Legacy frame, 8 bytes
+#define IMU_BATCH_ENTRY_LEN     (1 + IMU_BATCH_FRAME_LEN)           // Without escape
+#define IMU_BATCH_MAX_ENTRIES   ((IMU_SEG_FRAME_MAX - IMU_BATCH_HEADER_LEN) / IMU_BATCH_ENTRY_LEN)  // 41
+#define IMU_BATCH_SRC_SAME      0
+#define IMU_BATCH_SRC_ESCAPE    255
+
+typedef struct {
+    uint16_t src;                           // Member's unicast address
+    uint8_t frame[IMU_BATCH_FRAME_LEN];
+} imu_batch_entry_t;
+
+/**
+ * Frames collected by the head since the last batch
+ */
+typedef struct {
+    imu_batch_entry_t entry[IMU_BATCH_MAX_ENTRIES];
+    uint8_t count;
+    uint32_t dropped;                       // Statistics: offered while full
+} imu_batch_t;
+
+/**
+ * Empty, statistics zero
+ */
+void imu_batch_init(imu_batch_t *b);
+
+/**
+ * Collect one member frame
+ * @return false when the batch is full (the frame is dropped and counted)
+ */
+bool imu_batch_add(imu_batch_t *b, uint16_t src, const uint8_t frame[IMU_BATCH_FRAME_LEN]);
+
+/**
+ * Sort the collected frames by source and pack as many as fit in cap
+ *
+ * The frames stay collected: they are the first *taken entries now, so
+ * frames added afterwards don't disturb them. Call imu_batch_consume()
+ * once the batch was handed to the mesh stack.
+ *
+ * @param taken Entries packed
+ * @return Batch length, 0 if nothing is collected or cap is too small
+ */
+size_t imu_batch_pack(imu_batch_t *b, uint8_t *out, size_t cap, uint8_t *taken);
+
+/**
+ * Forget the first n entries (the ones a successful pack took)
+ */
+void imu_batch_consume(imu_batch_t *b, uint8_t n);
+
+/**
+ * Unpack a batch
+ * @param out Room for max entries
+ * @return Entries, 0 on a malformed batch or if max is too small
+ */
+uint8_t imu_batch_unpack(const uint8_t *in, size_t len, imu_batch_entry_t *out, uint8_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_BATCH_H
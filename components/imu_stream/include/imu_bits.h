@@ -0,0 +1,184 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - BIT STREAM READER / WRITER
+ * ============================================================================
+ *
+ * MSB-first bit packing for the variable-length codecs.
+ *
+ * WRITER:
+ * -------
+ * Bits collect in a 32-bit accumulator and are flushed a byte at a time,
+ * so a write is a shift + OR in the common case. Writing past the end of
+ * the buffer sets 'overflow' instead of corrupting memory - the encoder
+ * checks it once at the end.
+ *
+ * READER:
+ * -------
+ * Mirror image. Reading past the end returns zero bits and sets
+ * 'overflow' so a truncated frame is detected, not mis-decoded silently.
+ *
+ * All functions are static inline: the codecs call them per residual and
+ * the call overhead would otherwise dominate.
+ */
+
+#ifndef IMU_BITS_H
+#define IMU_BITS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint8_t *buf;
+    size_t cap;             // Buffer size in bytes
+    size_t pos;             // Bytes written so far
+    uint32_t acc;           // Pending bits (right-aligned)
+    uint8_t n;              // Number of pending bits (0..7 between calls)
+    bool overflow;
+} imu_bitwriter_t;
+
+typedef struct {
+    const uint8_t *buf;
+    size_t len;
+    size_t pos;             // Next byte to load
+    uint32_t acc;
+    uint8_t n;
+    bool overflow;
+} imu_bitreader_t;
+
+static inline void imu_bw_init(imu_bitwriter_t *w, uint8_t *buf, size_t cap)
+{
+    w->buf = buf;
+    w->cap = cap;
+    w->pos = 0;
+    w->acc = 0;
+    w->n = 0;
+    w->overflow = false;
+}
+
+/**
+ * Append the low 'nbits' bits of 'value' (nbits <= 24)
+ */
+static inline void imu_bw_put(imu_bitwriter_t *w, uint32_t value, uint8_t nbits)
+{
+    w->acc = (w->acc << nbits) | (value & ((1u << nbits) - 1u));
+    w->n += nbits;
+    while (w->n >= 8) {
+        w->n -= 8;
+        if (w->pos < w->cap) {
+            w->buf[w->pos++] = (uint8_t)(w->acc >> w->n);
+        } else {
+            w->overflow = true;
+        }
+    }
+}
+
+/**
+ * Append 'count' one bits followed by a zero (unary code)
+ */
+static inline void imu_bw_unary(imu_bitwriter_t *w, uint32_t count)
+{
+    while (count >= 16) {
+        imu_bw_put(w, 0xFFFFu, 16);
+        count -= 16;
+    }
+    imu_bw_put(w, ((1u << count) - 1u) << 1, (uint8_t)(count + 1));
+}
+
+/**
+ * Pad the last byte with zeros. Returns the total number of bytes.
+ */
+static inline size_t imu_bw_finish(imu_bitwriter_t *w)
+{
+    if (w->n) {
+        imu_bw_put(w, 0, (uint8_t)(8 - w->n));
+    }
+    return w->pos;
+}
+
+static inline void imu_br_init(imu_bitreader_t *r, const uint8_t *buf, size_t len)
+{
+    r->buf = buf;
+    r->len = len;
+    r->pos = 0;
+    r->acc = 0;
+    r->n = 0;
+    r->overflow = false;
+}
+
+/**
+ * Read 'nbits' bits (nbits <= 24)
+ */
+static inline uint32_t imu_br_get(imu_bitreader_t *r, uint8_t nbits)
+{
+    while (r->n < nbits) {
+        uint8_t byte = 0;
+        if (r->pos < r->len) {
+            byte = r->buf[r->pos++];
+        } else {
+            r->overflow = true;
+        }
+        r->acc = (r->acc << 8) | byte;
+        r->n += 8;
+    }
+    r->n -= nbits;
+    return (r->acc >> r->n) & ((1u << nbits) - 1u);
+}
+
+/**
+ * Read a unary code (count ones up to the terminating zero)
+ *
+ * Works on all pending bits at once: invert, find the highest set bit
+ * (= first zero in stream order) with count-leading-zeros. A run of ones
+ * that spans bytes just loops. Past the end of the buffer the reader
+ * returns zeros, so garbage input always terminates.
+ */
+static inline uint32_t imu_br_unary(imu_bitreader_t *r)
+{
+    uint32_t count = 0;
+    for (;;) {
+        if (r->n == 0) {
+            uint8_t byte = 0;
+            if (r->pos < r->len) {
+                byte = r->buf[r->pos++];
+            } else {
+                r->overflow = true;
+            }
+            r->acc = (r->acc << 8) | byte;
+            r->n = 8;
+        }
+        uint32_t zeros = ~r->acc & ((1u << r->n) - 1u);
+        if (zeros) {
+            uint8_t first_zero = (uint8_t)(31 - __builtin_clz(zeros));
+            count += (uint32_t)(r->n - 1 - first_zero);
+            r->n = first_zero;      // Consume the ones and the zero
+            return count;
+        }
+        count += r->n;
+        r->n = 0;
+    }
+}
+
+/**
+ * Zigzag mapping: 0, -1, 1, -2, 2 ... → 0, 1, 2, 3, 4 ...
+ * Small magnitudes of either sign become small unsigned values.
+ */
+static inline uint32_t imu_zigzag(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t imu_unzigzag(uint32_t u)
+{
+    return (int32_t)(u >> 1) ^ -(int32_t)(u & 1u);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_BITS_H
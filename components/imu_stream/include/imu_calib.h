@@ -0,0 +1,107 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - CALIBRATION STAGE
+ * ============================================================================
+ *
+ * Corrects each sample for the errors of this particular sensor:
+ *
+ *   out = M · (raw - offset - bias(T))        per sensor (accel, gyro)
+ *
+ *   offset   zero-g / zero-rate offset (mg, 0.1 dps)
+ *   bias(T)  extra offset at die temperature T, linearly interpolated in a
+ *            small table (MPU6886 gyro bias drifts ~0.05 dps/°C)
+ *   M        3x3 matrix: scale error, cross-axis misalignment and the
+ *            mounting rotation in one step
+ *
+ * The identity calibration (M = I, no offsets) leaves samples unchanged,
+ * bit for bit - a node without calibration data behaves as before.
+ *
+ * FIXED POINT:
+ * ------------
+ * Matrix entries are Q14 int16 (1.0 = 16384, range ±2.0). Samples are int16
+ * in and out, so an integer kernel skips the int → float → int round trip
+ * and gives the same bits on the node and on the host. Each row's |entries|
+ * may add up to at most 65535 (gain 4.0), so a row of three products never
+ * overflows int32.
+ *
+ * BLOCK KERNEL:
+ * -------------
+ * Temperature moves slowly, so bias(T) is interpolated ONCE per block and
+ * folded into the offset; the per-sample work is 6 subtractions and 18 MACs.
+ *
+ * WIRE / NVS FORMAT (imu_calib_pack):
+ * -----------------------------------
+ *   Byte 0:    format version (1)
+ *   Byte 1:    calibration ID (0 = identity / none)
+ *   Byte 2:    temperature points P (0..IMU_CALIB_TEMP_POINTS)
+ *   Byte 3+:   matrix accel[9], matrix gyro[9], offset[6]   int16 LE
+ *   then P ×:  temperature (0.1 °C), bias[6]                int16 LE
+ *
+ * The same bytes are the install message (opcode 0xC70001, gateway → node,
+ * one segmented message) and the NVS blob, so the node stores what it
+ * received without converting it.
+ */
+
+#ifndef IMU_CALIB_H
+#define IMU_CALIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "imu_sample.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_CALIB_Q             14
+#define IMU_CALIB_ONE           (1 << IMU_CALIB_Q)
+#define IMU_CALIB_TEMP_POINTS   4
+#define IMU_CALIB_VERSION       1
+#define IMU_CALIB_HEADER_LEN    3
+#define IMU_CALIB_BLOB_MAX      (IMU_CALIB_HEADER_LEN + (9 + 9 + IMU_AXIS_COUNT) * 2 + \
+                                 IMU_CALIB_TEMP_POINTS * (1 + IMU_AXIS_COUNT) * 2)
+
+typedef struct {
+    uint8_t id;                                         // 0 = identity
+    int16_t matrix[2][9];                               // [accel, gyro] row-major, Q14
+    int16_t offset[IMU_AXIS_COUNT];                     // mg / 0.1 dps
+    uint8_t temp_points;                                // 0 = no temperature table
+    int16_t temp_c10[IMU_CALIB_TEMP_POINTS];            // Ascending, 0.1 °C
+    int16_t temp_bias[IMU_CALIB_TEMP_POINTS][IMU_AXIS_COUNT];
+} imu_calib_t;
+
+/**
+ * Identity calibration (samples pass through unchanged)
+ */
+void imu_calib_identity(imu_calib_t *c);
+
+/**
+ * Total offset at a temperature: offset + table bias, interpolated and
+ * clamped at the ends of the table
+ */
+void imu_calib_bias(const imu_calib_t *c, int16_t temp_c10, int16_t bias[IMU_AXIS_COUNT]);
+
+/**
+ * Calibrate a block of samples in place (one temperature for the block)
+ */
+void imu_calib_apply(const imu_calib_t *c, int16_t temp_c10, imu_sample_t *block, size_t n);
+
+/**
+ * Serialize (wire message / NVS blob)
+ * @return Length, 0 if cap is too small
+ */
+size_t imu_calib_pack(const imu_calib_t *c, uint8_t *out, size_t cap);
+
+/**
+ * Parse and validate a serialized calibration
+ * @return false on a wrong version or length, temperatures not ascending,
+ *         or a matrix row whose gain could overflow the kernel ('c' untouched)
+ */
+bool imu_calib_unpack(const uint8_t *in, size_t len, imu_calib_t *c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_CALIB_H
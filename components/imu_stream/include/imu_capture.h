@@ -0,0 +1,161 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - GROUP-TRIGGERED SYNCHRONIZED CAPTURE
+ * ============================================================================
+ *
+ * "Every node: record 1 s of full-rate data starting at T." The gateway
+ * sends ONE command to the control group; because all nodes share
+ * mesh-global time (imu_timesync.h), their recordings cover the same
+ * instant to within the sync error.
+ *
+ *   gateway ──0xC90001──▶ control group (every node subscribes)
+ *   node:   history ring (always recording) → window [T, T + n) frozen
+ *           → uploaded in slot (unicast address % slots), chunk by chunk
+ *
+ * PRE-ARMED HISTORY:
+ * ------------------
+ * The recorder keeps the last IMU_CAPTURE_MAX full-rate samples with
+ * their global timestamps at all times. T may therefore lie slightly in
+ * the past when the command arrives (relays, a busy publisher): the
+ * window is cut out of the history. Once the window is complete, the
+ * ring is frozen until the upload is done.
+ *
+ * COMMAND (opcode 0xC90001, gateway → control group, 8 bytes):
+ * -------------------------------------------------------------
+ *   Byte 0:    capture ID
+ *   Byte 1:    upload slots S (a node uploads in slot unicast % S)
+ *   Byte 2:    slot length, 100 ms units
+ *   Byte 3-6:  T = window start, mesh-global µs (low 32 bits, LE)
+ *   Byte 7:    window length, units of 4 samples
+ *
+ * STAGGERED UPLOAD:
+ * -----------------
+ * One second of window is 7 segmented messages of 32 segments per node;
+ * all nodes starting at once collide segment after segment and spend the
+ * airtime on SAR retransmissions. Node k waits until T_end + (k % S) × slot
+ * and sends one chunk every IMU_CAPTURE_CHUNK_MS. Streaming pauses on every
+ * node until the last slot has ended, so uploads only compete with each other. imu_capture_upload_ms() gives the slot
+ * length a window needs; tools/sim/sim_capture validates the schedule.
+ *
+ * CHUNK (opcode 0xCA0001, node → gateway, segmented, ≤ 377 bytes):
+ * -----------------------------------------------------------------
+ *   Byte 0:    capture ID
+ *   Byte 1:    chunk index
+ *   Byte 2:    chunk count
+ *   Byte 3:    samples in this chunk (≤ IMU_CAPTURE_CHUNK_SAMPLES)
+ *   Byte 4-5:  first sample time - T (µs, uint16 LE, < one sample period)
+ *   Byte 6+:   samples, 6 × int16 LE each (calibrated, mg / 0.1 dps)
+ *
+ * Samples are raw int16 (lossless, and a lost chunk costs only its own
+ * samples); byte 4-5 lets the gateway align windows to below a sample.
+ */
+
+#ifndef IMU_CAPTURE_H
+#define IMU_CAPTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "imu_sample.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_CAPTURE_MAX             512     // History / longest window (2.56 s at 200 Hz)
+#define IMU_CAPTURE_CMD_LEN         8
+#define IMU_CAPTURE_CHUNK_HEADER    6
+#define IMU_CAPTURE_CHUNK_SAMPLES   30      // 6 + 30 × 12 = 366 bytes
+#define IMU_CAPTURE_CHUNK_MAX       (IMU_CAPTURE_CHUNK_HEADER + IMU_CAPTURE_CHUNK_SAMPLES * IMU_AXIS_COUNT * 2)
+#define IMU_CAPTURE_CHUNK_MS        900     // 32 segments at ~17 ms + SAR ack + one resend round
+
+typedef struct {
+    uint8_t id;
+    uint8_t slots;                  // 0 or 1 = everyone uploads at once
+    uint8_t slot_100ms;
+    uint32_t t_start_us;            // Mesh-global, low 32 bits
+    uint16_t samples;               // Multiple of 4
+} imu_capture_cmd_t;
+
+typedef enum {
+    IMU_CAPTURE_IDLE = 0,           // Recording history only
+    IMU_CAPTURE_ARMED,              // Waiting for the window to fill
+    IMU_CAPTURE_READY,              // Window complete, history frozen
+} imu_capture_state_t;
+
+typedef struct {
+    // History ring (index = samples recorded since init, masked)
+    imu_sample_t hist[IMU_CAPTURE_MAX];
+    uint32_t hist_us[IMU_CAPTURE_MAX];      // Mesh-global µs, low 32 bits
+    uint32_t count;
+
+    imu_capture_state_t state;
+    imu_capture_cmd_t cmd;
+    bool have_first;
+    uint32_t first;                 // History index of the window's first sample
+    uint16_t first_offset_us;
+} imu_capture_t;
+
+typedef struct {
+    uint8_t id, chunk, chunks, samples;
+    uint16_t first_offset_us;
+} imu_capture_chunk_t;
+
+void imu_capture_cmd_pack(const imu_capture_cmd_t *c, uint8_t out[IMU_CAPTURE_CMD_LEN]);
+bool imu_capture_cmd_unpack(const uint8_t *in, size_t len, imu_capture_cmd_t *c);
+
+void imu_capture_init(imu_capture_t *cap);
+
+/**
+ * Arm a capture window
+ * @return false if busy (not IDLE), the window is empty or longer than
+ *         IMU_CAPTURE_MAX, or T is older than the history
+ */
+bool imu_capture_arm(imu_capture_t *cap, const imu_capture_cmd_t *cmd);
+
+/**
+ * Record one full-rate sample (ignored while READY)
+ * @param global_us Mesh-global time of the sample (low 32 bits)
+ * @return State after the sample
+ */
+imu_capture_state_t imu_capture_push(imu_capture_t *cap, const imu_sample_t *s, uint32_t global_us);
+
+/**
+ * Number of upload chunks of the READY window
+ */
+uint8_t imu_capture_chunks(const imu_capture_t *cap);
+
+/**
+ * Pack upload chunk 'idx' of the READY window
+ * @return Length, 0 if not READY, idx out of range or cap too small
+ */
+size_t imu_capture_chunk_pack(const imu_capture_t *cap, uint8_t idx, uint8_t *out, size_t out_cap);
+
+/**
+ * Parse an upload chunk (gateway / host side)
+ * @param samples Room for IMU_CAPTURE_CHUNK_SAMPLES
+ * @return false on a malformed chunk
+ */
+bool imu_capture_chunk_unpack(const uint8_t *in, size_t len, imu_capture_chunk_t *hdr,
+                              imu_sample_t *samples);
+
+/**
+ * Upload done (or abandoned): resume recording history
+ */
+void imu_capture_release(imu_capture_t *cap);
+
+/**
+ * Time one node needs to upload a window of 'samples' (slot length, ms)
+ */
+uint32_t imu_capture_upload_ms(uint16_t samples);
+
+/**
+ * When this node's upload starts, relative to the end of the window (ms)
+ */
+uint32_t imu_capture_slot_delay_ms(const imu_capture_cmd_t *cmd, uint16_t unicast_addr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_CAPTURE_H
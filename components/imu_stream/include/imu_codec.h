@@ -0,0 +1,187 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - CODEC INTERFACE + AUTO SELECTION
+ * ============================================================================
+ *
+ * One interface for every frame codec, shared by the node (encoder) and the
+ * host decoder. On top of it, a selector that tries the registered codecs
+ * on each window and keeps the smallest frame.
+ *
+ * WHY SELECT PER WINDOW?
+ * ----------------------
+ * No codec wins everywhere:
+ *   - Device at rest:    values tiny and constant → DELTA / RICE shine
+ *   - Walking / gait:    smooth trends           → RICE (order 2) wins
+ *   - Impacts / shaking: large jumps             → RAW8 (if it fits) or RICE escape
+ * Trying all of them costs CPU, so the selector works within a budget.
+ *
+ * TAGGED FRAME (opcode 0xC30001):
+ * -------------------------------
+ *   Byte 0: [RRRR|CCCC]  C = codec ID, R = reserved (0)
+ *   Byte 1: precision step q (values were divided by q before coding)
+ *   Byte 2: window sequence number
+ *   Byte 3+: codec payload
+ *
+ * PRECISION:
+ * ----------
+ * The selector first quantizes the window to steps of q (q = 1 is
+ * lossless; q = 100 is the legacy 0.1 g / 10 dps precision). Every
+ * RECONSTRUCTION codec is lossless on those integers, so the decoded
+ * window is identical whichever one wins - picking the smallest frame is
+ * a free choice. LOSSY codecs (half-float, block floating point) round
+ * large values; they are only picked when no lossless codec fits
+ * 'max_frame'. SUMMARY codecs (envelope) carry less information still;
+ * they are only picked when nothing else fits.
+ *
+ * ADDING A CODEC:
+ * ---------------
+ * 1. Write encode/decode with the imu_codec_t signatures
+ * 2. Give it an ID in imu_codec_id_t
+ * 3. Add it to the registry table in imu_codec.c (cheapest first)
+ * Host decoder and selector pick it up automatically.
+ */
+
+#ifndef IMU_CODEC_H
+#define IMU_CODEC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "imu_sample.h"
+#include "imu_proto.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_CODEC_HEADER_LEN    3
+#define IMU_CODEC_MAX_BLOCK     30                  // Samples per window
+#define IMU_CODEC_MAX_FRAME     IMU_SEG_FRAME_MAX   // One segmented message
+#define IMU_CODEC_MAX           16                  // 4-bit codec ID
+
+typedef enum {
+    IMU_CODEC_RAW8 = 0,         // int8 per value (declines if a value doesn't fit)
+    IMU_CODEC_DELTA = 1,        // int16 first value + int8 deltas (escape to int16)
+    IMU_CODEC_RICE = 2,         // imu_rice.h predictor + Rice coding
+    IMU_CODEC_ENVELOPE = 3,     // imu_envelope.h min/max/mean (summary)
+    IMU_CODEC_HALF = 4,         // imu_float.h IEEE binary16 per value (lossy)
+    IMU_CODEC_BFP8 = 5,         // imu_float.h shared exponent + int8 mantissas (lossy)
+    IMU_CODEC_BFP12 = 6,        // imu_float.h shared exponent + int12 mantissas (lossy)
+} imu_codec_id_t;
+
+#define IMU_CODEC_MASK(id)      (1u << (id))
+#define IMU_CODEC_MASK_ALL      0xFFFFu
+
+/**
+ * Codec encode: n samples → payload. Returns payload length, or 0 if the
+ * codec cannot represent this window within 'cap' (the selector skips it).
+ */
+typedef size_t (*imu_codec_encode_fn)(const imu_sample_t *in, uint8_t n,
+                                      uint8_t *out, size_t cap);
+
+/**
+ * Codec decode: payload → samples. Returns sample count, 0 if malformed.
+ * SUMMARY codecs return 3 "samples": min, mean, max.
+ */
+typedef size_t (*imu_codec_decode_fn)(const uint8_t *in, size_t len,
+                                      imu_sample_t *out, size_t cap);
+
+typedef struct {
+    uint8_t id;
+    const char *name;
+    bool summary;                   // Output is min/mean/max, not the samples
+    bool lossy;                     // Output approximates the samples
+    imu_codec_encode_fn encode;
+    imu_codec_decode_fn decode;
+} imu_codec_t;
+
+/**
+ * Find a registered codec by ID
+ * @return Codec, or NULL if not registered
+ */
+const imu_codec_t* imu_codec_find(uint8_t id);
+
+/**
+ * Registered codecs in try order (cheapest first)
+ * @param count Number of entries (output)
+ */
+const imu_codec_t* const* imu_codec_list(size_t *count);
+
+/*
+ * ============================================================================
+ *                         SELECTOR
+ * ============================================================================
+ *
+ * CPU BUDGET:
+ * -----------
+ * The selector times every codec it runs with 'clock' (cycle counter on
+ * the node, nanoseconds on the host) and keeps a running average per
+ * codec. A codec whose average would push the window past 'cpu_budget'
+ * is skipped. The first allowed codec always runs, so a window is never
+ * dropped for lack of budget. With clock == NULL or budget 0 every
+ * allowed codec runs.
+ */
+
+typedef uint32_t (*imu_codec_clock_fn)(void);
+
+typedef struct {
+    uint16_t allowed_mask;          // IMU_CODEC_MASK() bits
+    uint8_t precision;              // Quantization step q (1 = lossless)
+    uint16_t max_frame;             // Largest acceptable frame in bytes (incl. header)
+    uint32_t cpu_budget;            // Clock ticks per window (0 = unlimited)
+    imu_codec_clock_fn clock;       // NULL = no timing
+} imu_codec_select_config_t;
+
+typedef struct {
+    imu_codec_select_config_t cfg;
+    uint8_t seq;
+    uint32_t cost_avg[IMU_CODEC_MAX];   // Running average ticks per window
+    uint32_t wins[IMU_CODEC_MAX];       // Windows each codec was chosen for
+    uint32_t budget_skips;              // Codec runs skipped for CPU budget
+    imu_sample_t quant[IMU_CODEC_MAX_BLOCK];
+    uint8_t scratch[IMU_CODEC_MAX_FRAME];
+} imu_codec_selector_t;
+
+/**
+ * Initialize a selector (statistics cleared)
+ */
+void imu_codec_selector_init(imu_codec_selector_t *sel, const imu_codec_select_config_t *cfg);
+
+/**
+ * Encode one window with the smallest allowed codec
+ *
+ * @param sel    Selector
+ * @param in     Window samples
+ * @param n      Window length (1..IMU_CODEC_MAX_BLOCK)
+ * @param out    Frame buffer (IMU_CODEC_MAX_FRAME bytes always suffice)
+ * @param cap    Frame buffer capacity
+ * @param chosen Winning codec ID (may be NULL)
+ * @return Frame length including the 3-byte header, 0 if no codec fits
+ */
+size_t imu_codec_select_encode(imu_codec_selector_t *sel, const imu_sample_t *in, uint8_t n,
+                               uint8_t *out, size_t cap, uint8_t *chosen);
+
+/**
+ * Encode one window with a specific codec (no selection)
+ */
+size_t imu_codec_encode_with(uint8_t codec_id, uint8_t precision, uint8_t seq,
+                             const imu_sample_t *in, uint8_t n, uint8_t *out, size_t cap);
+
+/**
+ * Decode a tagged frame
+ *
+ * Reconstruction codecs: samples are scaled back by q.
+ * Summary codecs: out[0..2] = min, mean, max.
+ *
+ * @param codec_id Codec ID from the header (may be NULL)
+ * @param seq      Sequence number from the header (may be NULL)
+ * @return Number of samples written, 0 if malformed or codec unknown
+ */
+size_t imu_codec_frame_decode(const uint8_t *in, size_t len, imu_sample_t *out, size_t cap,
+                              uint8_t *codec_id, uint8_t *seq);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_CODEC_H
@@ -0,0 +1,81 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - RUNTIME STREAM CONFIGURATION
+ * ============================================================================
+ *
+ * Sample rate, publish interval, publish mode, block length, channel mask
+ * and the fixed codec in one 8-byte record. The gateway sends it to a node
+ * to retune the stream without reflashing; the node applies it between two
+ * windows and stores it, so it survives a reboot.
+ *
+ * WIRE / NVS FORMAT (opcode 0xCB0001, gateway → node, 8 bytes):
+ * --------------------------------------------------------------
+ *   Byte 0:    config ID (for the log, 0 = compiled-in defaults)
+ *   Byte 1:    sample period, ms (IMU_CONFIG_MIN_PERIOD_MS..MAX → 500..25 Hz)
+ *   Byte 2-3:  publish interval, ms (uint16 LE, a multiple of the period)
+ *   Byte 4:    bits 3:0 publish mode, bit 4 decimation filter (0 FIR, 1 CIC)
+ *   Byte 5:    block length, samples (RICE / AUTO / VQ / FIXED modes)
+ *   Byte 6:    channel mask, bit a = axis a (0x3F = all six)
+ *   Byte 7:    codec ID for the FIXED mode (imu_codec.h)
+ *
+ * The sample rate is given as a period because the sampler runs on the
+ * 1 ms FreeRTOS tick: every period is exact, 1000 / ODR may not be.
+ * Decimation ratio = publish interval / period.
+ *
+ * The same bytes are the message and the NVS blob, as for the
+ * calibration (imu_calib.h). Publish modes and codecs belong to the
+ * firmware; imu_config_check() only validates what the stream library
+ * knows about (timing, filter, block length, mask).
+ */
+
+#ifndef IMU_CONFIG_H
+#define IMU_CONFIG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "imu_sample.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_CONFIG_LEN              8
+#define IMU_CONFIG_MIN_PERIOD_MS    2       // 500 Hz: I2C read + headroom for the mesh tasks
+#define IMU_CONFIG_MAX_PERIOD_MS    40      // 25 Hz
+#define IMU_AXIS_MASK_ALL           0x3F
+
+typedef struct {
+    uint8_t id;
+    uint8_t period_ms;
+    uint16_t publish_ms;
+    uint8_t mode;
+    uint8_t decim;                  // imu_decim_mode_t
+    uint8_t block;
+    uint8_t axis_mask;
+    uint8_t codec;
+} imu_config_t;
+
+void imu_config_pack(const imu_config_t *c, uint8_t out[IMU_CONFIG_LEN]);
+bool imu_config_unpack(const uint8_t *in, size_t len, imu_config_t *c);
+
+/**
+ * Validate timing, filter, block length and channel mask
+ * @param max_block Longest block the firmware can send
+ * @return false if the record cannot be applied
+ */
+bool imu_config_check(const imu_config_t *c, uint8_t max_block);
+
+/**
+ * Decimation ratio (samples per published window) of a checked config
+ */
+static inline uint8_t imu_config_ratio(const imu_config_t *c)
+{
+    return (uint8_t)(c->publish_ms / c->period_ms);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_CONFIG_H
@@ -0,0 +1,131 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - ANTI-ALIASING DECIMATOR
+ * ============================================================================
+ *
+ * Turns a high-rate sample stream (e.g. 200 Hz) into a low-rate stream
+ * (e.g. 10 Hz) WITHOUT aliasing.
+ *
+ * THE PROBLEM:
+ * ------------
+ * Picking one sample every 100 ms is "decimation by throwing samples away".
+ * Any vibration above the new Nyquist frequency (5 Hz at 10 Hz) does not
+ * disappear - it folds back and shows up as a fake slow oscillation.
+ *
+ * THE FIX:
+ * --------
+ * Low-pass filter first, then keep every R-th output. Two flavours:
+ *
+ * 1. FIR (default) - polyphase windowed-sinc, Q15 coefficients
+ *    - Cutoff at the output Nyquist, 8 taps per output phase
+ *    - Only every R-th output is computed (that is the "polyphase" trick:
+ *      we never compute the outputs we would throw away)
+ *    - Cost: 8 MACs per input sample per axis, independent of R
+ *
+ * 2. CIC (cheap) - 3rd order cascaded integrator-comb
+ *    - No multiplies in the filter itself, only adds
+ *    - Weaker alias rejection near the band edge, sinc^3 passband droop
+ *    - Good fallback when the CPU budget is tight
+ *
+ * Both run on all 6 axes in lock-step, in pure integer arithmetic.
+ * The ratio can be changed at runtime with imu_decimator_configure().
+ *
+ * USAGE:
+ * ------
+ * ```c
+ * imu_decimator_t dec;
+ * imu_decimator_configure(&dec, IMU_DECIM_FIR, 20);   // 200 Hz -> 10 Hz
+ *
+ * imu_sample_t out;
+ * if (imu_decimator_push(&dec, &in, &out)) {
+ *     publish(&out);                                  // every 20th input
+ * }
+ * ```
+ */
+
+#ifndef IMU_DECIMATOR_H
+#define IMU_DECIMATOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "imu_sample.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_DECIM_MAX_RATIO        32   // Largest supported decimation ratio
+#define IMU_DECIM_TAPS_PER_PHASE   8    // FIR length = ratio * taps_per_phase ...
+#define IMU_DECIM_MAX_TAPS         192  // ... capped at this many taps
+
+#define IMU_DECIM_CIC_ORDER        3
+
+typedef enum {
+    IMU_DECIM_FIR = 0,      // Polyphase windowed-sinc FIR (Q15)
+    IMU_DECIM_CIC = 1,      // 3rd order CIC (adds only)
+} imu_decim_mode_t;
+
+/**
+ * Decimator state
+ * Large-ish (~2.5 KB) - allocate statically, not on a task stack.
+ */
+typedef struct {
+    imu_decim_mode_t mode;
+    uint8_t ratio;              // Decimation ratio R (1 = pass-through)
+    uint8_t phase;              // Inputs since the last output (0..R-1)
+
+    // FIR state
+    uint16_t taps;              // Active FIR length
+    uint16_t pos;               // Next write index into hist[] (circular)
+    int16_t coef[IMU_DECIM_MAX_TAPS];       // Q15, sum == 32768 (unity DC gain)
+    imu_sample_t hist[IMU_DECIM_MAX_TAPS];  // Delay line, one row per input
+
+    // CIC state (uint32_t so that wrap-around is well defined in C)
+    uint32_t integ[IMU_AXIS_COUNT][IMU_DECIM_CIC_ORDER];
+    uint32_t comb[IMU_AXIS_COUNT][IMU_DECIM_CIC_ORDER];
+    uint32_t cic_recip;         // round(2^32 / R^3) - gain normalisation
+} imu_decimator_t;
+
+/**
+ * (Re)configure the decimator
+ *
+ * Resets the filter history, designs the FIR coefficients for the new
+ * ratio and computes the CIC gain. Safe to call at runtime between
+ * samples (the first output after a change is a partial-history output).
+ *
+ * @param d     Decimator state
+ * @param mode  IMU_DECIM_FIR or IMU_DECIM_CIC
+ * @param ratio Decimation ratio (1..IMU_DECIM_MAX_RATIO)
+ * @return true on success, false if ratio/mode is out of range
+ */
+bool imu_decimator_configure(imu_decimator_t *d, imu_decim_mode_t mode, uint8_t ratio);
+
+/**
+ * Feed one input sample
+ *
+ * @param d   Decimator state
+ * @param in  High-rate input sample
+ * @param out Filtered low-rate sample (written only when returning true)
+ * @return true every R-th call (an output sample is ready)
+ */
+bool imu_decimator_push(imu_decimator_t *d, const imu_sample_t *in, imu_sample_t *out);
+
+/**
+ * Feed a block of input samples
+ *
+ * @param d       Decimator state
+ * @param in      Input samples
+ * @param n       Number of input samples
+ * @param out     Output buffer
+ * @param out_cap Output buffer capacity (outputs beyond this are dropped)
+ * @return Number of output samples written
+ */
+size_t imu_decimator_process(imu_decimator_t *d, const imu_sample_t *in, size_t n,
+                             imu_sample_t *out, size_t out_cap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_DECIMATOR_H
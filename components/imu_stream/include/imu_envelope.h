@@ -0,0 +1,149 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - MIN/MAX ENVELOPE DOWNSAMPLING
+ * ============================================================================
+ *
+ * Keeps the peaks that a low publish rate would otherwise hide.
+ *
+ * THE PROBLEM:
+ * ------------
+ * At 10 Hz, one value per 100 ms window is published. Whether that value
+ * is an instantaneous read or a filtered average (imu_decimator.h), a
+ * 30 ms impact spike inside the window is gone. For shock / fall / tap
+ * detection the peak IS the data.
+ *
+ * THE FIX:
+ * --------
+ * For every window of W high-rate samples, publish per axis:
+ *   min, max and mean - computed streaming (no buffering of the window)
+ *
+ * FRAME LAYOUT (8 bytes, fits one unsegmented vendor message):
+ * ------------------------------------------------------------
+ * One frame per sensor group, so a window is two frames (accel + gyro):
+ *
+ *   Byte 0:   [G|SSS|QQQQ]  G = group (0 accel, 1 gyro)
+ *                           S = spread shift (0..7)
+ *                           Q = window sequence number (mod 16)
+ *   Byte 1:   mean X  (int8, 100 units: 0.1 g or 10 dps)
+ *   Byte 2:   [dn X | up X] spreads below / above the mean, 4 bits each
+ *   Byte 3-4: mean Y, spreads Y
+ *   Byte 5-6: mean Z, spreads Z
+ *   Byte 7:   window length W (samples, saturates at 255)
+ *
+ * Spread unit = 25 << S (25 mg .. 3.2 g for accel, 2.5 .. 320 dps for
+ * gyro), chosen per frame as the smallest shift that fits the widest axis.
+ * Spreads are rounded UP relative to the transmitted (rounded) mean, so
+ * the decoded envelope always contains the true min and max:
+ *
+ *   decoded_min <= true_min      decoded_max >= true_max
+ *
+ * 18 values (+ shape info) in 16 bytes, versus 6 values in 8 bytes for
+ * the legacy frame - and nothing a receiver draws is ever "inside" a peak.
+ *
+ * USAGE:
+ * ------
+ * ```c
+ * imu_envelope_t env;
+ * imu_envelope_window_t win;
+ * imu_envelope_init(&env, 20);                 // 200 Hz in, one window per 100 ms
+ *
+ * if (imu_envelope_push(&env, &in, &win)) {
+ *     uint8_t f[IMU_ENV_FRAME_LEN];
+ *     imu_envelope_pack(&win, IMU_ENV_GROUP_ACCEL, f);  publish(f);
+ *     imu_envelope_pack(&win, IMU_ENV_GROUP_GYRO, f);   publish(f);
+ * }
+ * ```
+ */
+
+#ifndef IMU_ENVELOPE_H
+#define IMU_ENVELOPE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "imu_sample.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_ENV_FRAME_LEN      8
+#define IMU_ENV_MEAN_LSB       100   // Pipeline units per mean LSB (0.1 g / 10 dps)
+#define IMU_ENV_SPREAD_LSB     25    // Pipeline units per spread LSB at shift 0
+#define IMU_ENV_SPREAD_MAX     15    // 4-bit spreads
+#define IMU_ENV_MAX_SHIFT      7
+
+#define IMU_ENV_GROUP_ACCEL    0     // Axes AX, AY, AZ
+#define IMU_ENV_GROUP_GYRO     1     // Axes GX, GY, GZ
+
+/**
+ * One closed window
+ */
+typedef struct {
+    imu_sample_t min;
+    imu_sample_t max;
+    imu_sample_t mean;
+    uint8_t count;              // Samples in the window
+    uint8_t seq;                // Window sequence number (mod 16 on the wire)
+} imu_envelope_window_t;
+
+/**
+ * Streaming accumulator
+ */
+typedef struct {
+    uint8_t window;             // Window length W (1..255)
+    uint8_t count;              // Samples accumulated so far
+    uint8_t seq;                // Sequence number of the window being built
+    int16_t min[IMU_AXIS_COUNT];
+    int16_t max[IMU_AXIS_COUNT];
+    int32_t sum[IMU_AXIS_COUNT];
+} imu_envelope_t;
+
+/**
+ * Reset the accumulator and set the window length
+ *
+ * @param e      Accumulator
+ * @param window Samples per window (0 is treated as 1)
+ */
+void imu_envelope_init(imu_envelope_t *e, uint8_t window);
+
+/**
+ * Add one high-rate sample
+ *
+ * @param e   Accumulator
+ * @param in  Sample
+ * @param out Closed window (written only when returning true)
+ * @return true when this sample completed a window
+ */
+bool imu_envelope_push(imu_envelope_t *e, const imu_sample_t *in, imu_envelope_window_t *out);
+
+/**
+ * Pack one sensor group of a window into an 8-byte frame
+ *
+ * @param w     Closed window
+ * @param group IMU_ENV_GROUP_ACCEL or IMU_ENV_GROUP_GYRO
+ * @param frame Output buffer (IMU_ENV_FRAME_LEN bytes)
+ * @return Number of bytes written (IMU_ENV_FRAME_LEN)
+ */
+size_t imu_envelope_pack(const imu_envelope_window_t *w, uint8_t group, uint8_t *frame);
+
+/**
+ * Decode one frame into the matching three axes of a window
+ *
+ * Only the axes of the frame's group are written; the other group is
+ * left untouched, so decoding an accel and a gyro frame with the same
+ * sequence number into one window rebuilds the whole envelope.
+ *
+ * @param frame Frame bytes
+ * @param len   Frame length (must be IMU_ENV_FRAME_LEN)
+ * @param w     Window to fill (min/max/mean of 3 axes, count, seq)
+ * @param group Decoded group (may be NULL)
+ * @return true on success, false on a malformed frame
+ */
+bool imu_envelope_unpack(const uint8_t *frame, size_t len, imu_envelope_window_t *w, uint8_t *group);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_ENVELOPE_H
@@ -0,0 +1,163 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - CROSS-FRAME XOR PARITY (FEC)
+ * ============================================================================
+ *
+ * Recovers a lost frame at the receiver without any retransmission.
+ *
+ * WHY NOT ACKNOWLEDGED TRANSPORT?
+ * -------------------------------
+ * Every IMU frame is sent unacknowledged (send_rel = false). Reliable
+ * transport would add an ack per message and a retry timer on the node;
+ * at 10 Hz × many nodes the acks alone double the traffic, and a retry
+ * arrives long after the sample stopped being useful. A parity frame
+ * costs 1/K extra airtime and repairs the loss on the gateway.
+ *
+ * HOW IT WORKS:
+ * -------------
+ *   data frames:   D0  D1  D2  D3          (K = 4, same opcode, ≤ 8 bytes)
+ *   parity frame:  P = D0 ^ D1 ^ D2 ^ D3   (byte-wise XOR, zero-padded)
+ *
+ * If exactly one of the K+1 frames is lost, XOR of the K that arrived
+ * IS the lost one (x ^ x = 0 cancels everything else). Two losses in the
+ * same group cannot be repaired - smaller K survives burstier loss.
+ *
+ * The repaired frame is delivered late (after the parity), but frames
+ * carry their own position (legacy timestamp, envelope sequence number),
+ * so the receiver can put it back in place.
+ *
+ * PARITY OPCODE (keeps the parity frame single-segment):
+ * -------------------------------------------------------
+ * The parity payload is the full 8 bytes, so there is no room for a
+ * header. K and a 3-bit group sequence ride in the 6-bit op field:
+ *
+ *   op = 0b1KKSSS → opcode 0xE00001..0xFF0001
+ *        KK = index into K ∈ {2, 3, 4, 8}   SSS = group sequence (mod 8)
+ *
+ * The group sequence lets the receiver notice LOST PARITY frames: it then
+ * knows how many groups its frames span, and only repairs when they all
+ * belong to one group - never with frames from two different groups.
+ * (A burst that swallows 8 parities in a row aliases; at K = 2 that is
+ * 24 consecutive messages.) A receiver must list all 32 parity opcodes
+ * in its vendor model (see imu_fec_parity_opcodes()).
+ *
+ * SCOPE:
+ * ------
+ * For fixed-length unsegmented frames (legacy 0xC00001, envelope 0xC10001,
+ * ranged 0xC60001), and masked 0xCC0001 frames while the mask stays the same.
+ * A group only covers one opcode. A mode or K change abandons the partial
+ * group and skips one group sequence number: the receiver sees it as a
+ * group whose parity was lost, and never repairs across the boundary.
+ */
+
+#ifndef IMU_FEC_H
+#define IMU_FEC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "imu_proto.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_FEC_PARITY_OPCODES  32
+#define IMU_FEC_GSEQ_MOD        8
+
+/**
+ * Parity opcode for group size k (2, 3, 4 or 8) and group sequence gseq
+ * @return Opcode, 0 if k is not a supported group size
+ */
+uint32_t imu_fec_parity_op(uint8_t k, uint8_t gseq);
+
+/**
+ * Decode a parity opcode
+ * @return true if 'opcode' is a parity opcode (k and gseq filled, may be NULL)
+ */
+bool imu_fec_parity_opcode(uint32_t opcode, uint8_t *k, uint8_t *gseq);
+
+/**
+ * All 32 parity opcodes (for a receiver's vendor model op table)
+ */
+const uint32_t* imu_fec_parity_opcodes(void);
+
+/*
+ * ============================================================================
+ *                         SENDER
+ * ============================================================================
+ */
+
+typedef struct {
+    uint8_t k;                      // Group size (0 = FEC off)
+    uint8_t count;                  // Frames in the current group
+    uint8_t gseq;                   // Group sequence (mod 8)
+    uint8_t len;                    // Longest frame in the group
+    uint32_t opcode;                // Opcode of the current group
+    uint8_t parity[IMU_FRAME_MAX];
+} imu_fec_encoder_t;
+
+/**
+ * Initialize a sender
+ * @param k Group size 2, 3, 4 or 8 (+50/33/25/12.5% messages), 0 = off
+ * @return false if k is out of range (encoder left off)
+ */
+bool imu_fec_encoder_init(imu_fec_encoder_t *enc, uint8_t k);
+
+/**
+ * Change the group size of a running sender (safe mid-group, see SCOPE)
+ * @param k Group size 2, 3, 4 or 8, 0 = off
+ * @return false if k is out of range (encoder unchanged)
+ */
+bool imu_fec_encoder_set_k(imu_fec_encoder_t *enc, uint8_t k);
+
+/**
+ * Account for one data frame that was just sent
+ *
+ * @param opcode     Data frame opcode
+ * @param frame      Data frame payload (≤ IMU_FRAME_MAX bytes, longer is ignored)
+ * @param len        Payload length
+ * @param parity_op  Parity opcode to send (output)
+ * @param parity     Parity payload (output, IMU_FRAME_MAX bytes)
+ * @return Parity length when the group is complete (send it now), else 0
+ */
+size_t imu_fec_encode(imu_fec_encoder_t *enc, uint32_t opcode, const uint8_t *frame,
+                      size_t len, uint32_t *parity_op, uint8_t *parity);
+
+/*
+ * ============================================================================
+ *                         RECEIVER
+ * ============================================================================
+ */
+
+typedef struct {
+    uint32_t opcode;                // Opcode of the group being collected (0 = none)
+    uint8_t count;                  // Data frames received in this group
+    uint8_t len;
+    int8_t last_gseq;               // -1 = no parity seen yet
+    uint8_t acc[IMU_FRAME_MAX];     // XOR of the frames received so far
+    uint32_t groups_ok;             // Parity arrived, nothing lost
+    uint32_t recovered;             // Frames rebuilt
+    uint32_t unrecoverable;         // Groups lost for good (2+ losses, or 1 loss + lost parity)
+} imu_fec_decoder_t;
+
+void imu_fec_decoder_init(imu_fec_decoder_t *dec);
+
+/**
+ * Feed every received frame (data and parity) in arrival order
+ *
+ * @param opcode   Frame opcode
+ * @param frame    Payload
+ * @param len      Payload length
+ * @param rec_op   Opcode of the recovered frame (output)
+ * @param rec      Recovered payload (output, IMU_FRAME_MAX bytes)
+ * @return Recovered frame length if this parity rebuilt a lost frame, else 0
+ */
+size_t imu_fec_decode(imu_fec_decoder_t *dec, uint32_t opcode, const uint8_t *frame,
+                      size_t len, uint32_t *rec_op, uint8_t *rec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_FEC_H
@@ -0,0 +1,111 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - HALF-FLOAT AND BLOCK-FLOATING-POINT FORMATS
+ * ============================================================================
+ *
+ * Two wire formats that keep small AND large values in the same stream.
+ * The legacy frame (÷100 → int8) cannot: a 5 mg tremor rounds to 0, and
+ * an impact past 12.7 g clips.
+ *
+ * HALF (IEEE 754 binary16, 2 bytes per value):
+ * --------------------------------------------
+ *   [S|EEEEE|MMMMMMMMMM]   value = ±1.M × 2^(E-15)
+ *
+ * Each value is the sample itself (mg / 0.1 dps) as a binary16 number:
+ * exact up to ±2048 (±2 g, ±204.8 dps), then a relative error of at most
+ * 2^-11 (0.05%) - 8 mg at 16 g. Any float16 reader (numpy, a GPU, the
+ * gateway) can use it directly. Same size as int16, so it buys range and
+ * interoperability, not bytes.
+ *
+ * BLOCK FLOATING POINT (BFP8 / BFP12):
+ * ------------------------------------
+ * Per axis per batch, one shared exponent e (4 bits) and one signed
+ * mantissa per sample (8 or 12 bits):
+ *
+ *   value ≈ m × 2^e     e = smallest exponent that fits the batch's peak
+ *
+ * A quiet batch gets e = 0 (exact), a batch containing an impact gets a
+ * coarser step - on THAT axis only, for THAT batch only. Error is at most
+ * 2^(e-1). At 20 samples per batch BFP8 costs 6.2 bytes per sample vs 6
+ * for plain int8.
+ *
+ * PAYLOAD LAYOUTS (tagged-frame codec payloads, see imu_codec.h):
+ * ----------------------------------------------------------------
+ *   HALF:   [n] then n × 6 binary16, little-endian, sample-major
+ *   BFP8:   [n][e1e0][e3e2][e5e4] then n × 6 int8 mantissas, sample-major
+ *   BFP12:  same header, then n × 6 int12 mantissas packed two per 3 bytes:
+ *           [m0 bits 0-7][m1 bits 0-3 | m0 bits 8-11][m1 bits 4-11]
+ *
+ * All kernels are integer-only (no FPU needed on the node).
+ */
+
+#ifndef IMU_FLOAT_H
+#define IMU_FLOAT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "imu_sample.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_HALF_MAX            65504   // Largest finite binary16
+#define IMU_BFP_HEADER_LEN      4       // [n] + 6 exponent nibbles
+#define IMU_BFP_MAX_EXP         15
+
+/**
+ * Integer → binary16, round to nearest (ties to even)
+ * Magnitudes that would round to infinity saturate to ±IMU_HALF_MAX.
+ */
+uint16_t imu_half_from_int(int32_t v);
+
+/**
+ * binary16 → integer, round to nearest (ties away from zero)
+ * Infinity saturates to ±IMU_HALF_MAX, NaN decodes as 0.
+ */
+int32_t imu_half_to_int(uint16_t h);
+
+/**
+ * Encode n samples as HALF payload
+ * @return Payload length (1 + 12n), 0 if it doesn't fit 'cap'
+ */
+size_t imu_half_encode(const imu_sample_t *in, uint8_t n, uint8_t *out, size_t cap);
+
+/**
+ * Decode a HALF payload
+ * @return Sample count, 0 if malformed or more than 'cap'
+ */
+size_t imu_half_decode(const uint8_t *in, size_t len, imu_sample_t *out, size_t cap);
+
+/**
+ * Smallest shared exponent for one axis of a batch
+ *
+ * @param axis Axis index (IMU_AXIS_*)
+ * @param bits Mantissa width, 8 or 12
+ * @return e such that every round(v / 2^e) fits 'bits' signed bits
+ */
+uint8_t imu_bfp_exponent(const imu_sample_t *in, uint8_t n, int axis, uint8_t bits);
+
+/**
+ * Encode n samples as BFP payload
+ * @param bits Mantissa width, 8 or 12
+ * @return Payload length (4 + 6n or 4 + 9n), 0 if it doesn't fit 'cap'
+ */
+size_t imu_bfp_encode(const imu_sample_t *in, uint8_t n, uint8_t bits,
+                      uint8_t *out, size_t cap);
+
+/**
+ * Decode a BFP payload
+ * @param bits Mantissa width the payload was encoded with
+ * @return Sample count, 0 if malformed or more than 'cap'
+ */
+size_t imu_bfp_decode(const uint8_t *in, size_t len, uint8_t bits,
+                      imu_sample_t *out, size_t cap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_FLOAT_H
@@ -0,0 +1,85 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - ROTATION-INVARIANT MAGNITUDE FRAMES
+ * ============================================================================
+ *
+ * Shock and activity monitoring do not care which way the device is
+ * mounted or turned - only how hard it is shaken and how fast it spins:
+ *
+ *   |a| = sqrt(ax² + ay² + az²)      (mg)
+ *   |ω| = sqrt(gx² + gy² + gz²)      (0.1 dps)
+ *
+ * Two channels instead of six: an 8-byte frame carries three windows.
+ *
+ * PEAK PER WINDOW:
+ * ----------------
+ * Each window sends the LARGEST |a| and |ω| of its full-rate samples, not
+ * the magnitude of the decimated sample. The anti-aliasing filter spreads
+ * a 9 g knock over the whole window (~1 g left after decimation); the
+ * peak keeps it. At rest |a| reads 1000 mg (gravity).
+ *
+ * INTEGER SQUARE ROOT:
+ * --------------------
+ * imu_isqrt32() is the bit-by-bit method: one candidate bit per step,
+ * 16 steps, shifts / adds / compares only - no divide, no float. The sum
+ * of three int16 squares is < 2^32, so everything stays in uint32.
+ *
+ * FRAME (opcode 0xCD0001, unsegmented, 2 + n × 2 bytes, n ≤ 3):
+ * --------------------------------------------------------------
+ *   Byte 0-1:  time of the LAST window, ms mod 4096 (uint16 LE, bits 15:12 = 0)
+ *   Byte 2+:   n windows, oldest first: |a| / 100 mg, |ω| / 10 dps as uint8
+ *              (0.1 g / 10 dps steps as the legacy frame, saturated at 255)
+ */
+
+#ifndef IMU_MAGNITUDE_H
+#define IMU_MAGNITUDE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "imu_sample.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_MAG_HEADER_LEN      2
+#define IMU_MAG_WINDOWS         3       // Windows per full frame
+#define IMU_MAG_FRAME_MAX       (IMU_MAG_HEADER_LEN + IMU_MAG_WINDOWS * 2)
+#define IMU_MAG_STEP            100     // mg / 0.1 dps per uint8 step
+#define IMU_MAG_TIME_WRAP_MS    4096
+
+typedef struct {
+    uint16_t accel;                 // mg
+    uint16_t gyro;                  // 0.1 dps
+} imu_mag_t;
+
+/**
+ * floor(sqrt(x))
+ */
+uint16_t imu_isqrt32(uint32_t x);
+
+/**
+ * Raise 'peak' to the largest |a| and |ω| of n samples
+ */
+void imu_mag_peak(const imu_sample_t *s, size_t n, imu_mag_t *peak);
+
+/**
+ * Pack n windows (1..IMU_MAG_WINDOWS), oldest first
+ * @param t_ms Time of the last window (kept mod IMU_MAG_TIME_WRAP_MS)
+ * @return Frame length, 0 on a bad count
+ */
+size_t imu_mag_pack(uint16_t t_ms, const imu_mag_t *w, uint8_t n, uint8_t out[IMU_MAG_FRAME_MAX]);
+
+/**
+ * Unpack a frame (values in mg / 0.1 dps)
+ * @param w Room for IMU_MAG_WINDOWS
+ * @return Window count, 0 on a malformed frame
+ */
+uint8_t imu_mag_unpack(const uint8_t *in, size_t len, uint16_t *t_ms, imu_mag_t *w);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_MAGNITUDE_H
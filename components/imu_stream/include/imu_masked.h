@@ -0,0 +1,88 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - CHANNEL-MASKED VARIABLE-LENGTH FRAMES
+ * ============================================================================
+ *
+ * The legacy frame always carries all six channels. A deployment that only
+ * needs the accelerometer (or one gyro axis) pays for three (or five)
+ * channels nobody reads. A masked frame carries only the channels in its
+ * bitmap, and spends the freed bytes on more decimated samples per frame:
+ * fewer messages for the same data.
+ *
+ *   channels   samples/frame   frame   messages at 10 Hz
+ *      6             1          8 B          10/s
+ *      3             2          8 B           5/s
+ *      2             3          8 B          3.3/s
+ *      1             6          8 B          1.7/s
+ *
+ * FRAME (opcode 0xCC0001, unsegmented, 2 + n × k bytes):
+ * -------------------------------------------------------
+ *   Byte 0:    bits 5:0 channel mask (bit a = axis a), bits 7:6 time bits 9:8
+ *   Byte 1:    time bits 7:0 - window end of the LAST sample, 4 ms units
+ *              (wraps every 4.096 s; receivers unwrap against the last frame)
+ *   Byte 2+:   n samples, oldest first, each the k masked channels in axis
+ *              order as int8, step IMU_MASKED_STEP (0.1 g / 10 dps, as legacy)
+ *
+ * k and n follow from the mask and the length, so there is no count byte.
+ * Samples are one publish window apart.
+ *
+ * ONE MASK LOGIC:
+ * ---------------
+ * imu_mask_channels() turns a mask into the axis list; pack, unpack and
+ * imu_masked_capacity() all go through it, so the node and the decoder
+ * cannot disagree on the channel order.
+ */
+
+#ifndef IMU_MASKED_H
+#define IMU_MASKED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "imu_sample.h"
+#include "imu_proto.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_MASKED_HEADER_LEN   2
+#define IMU_MASKED_STEP         100     // mg / 0.1 dps per int8 step
+#define IMU_MASKED_TIME_UNIT_MS 4
+#define IMU_MASKED_TIME_WRAP_MS (1024 * IMU_MASKED_TIME_UNIT_MS)
+#define IMU_MASKED_MAX_SAMPLES  (IMU_FRAME_MAX - IMU_MASKED_HEADER_LEN)    // One channel
+
+/**
+ * Channels of a mask, in axis order
+ * @param axes Filled with the axis index of each channel (may be NULL)
+ * @return Channel count k (0 for an empty or invalid mask)
+ */
+uint8_t imu_mask_channels(uint8_t mask, uint8_t axes[IMU_AXIS_COUNT]);
+
+/**
+ * Samples per full frame for a mask (0 for an empty or invalid mask)
+ */
+uint8_t imu_masked_capacity(uint8_t mask);
+
+/**
+ * Pack n samples (1..imu_masked_capacity(mask)), oldest first
+ * @param t_ms Time of the last sample (only bits up to IMU_MASKED_TIME_WRAP_MS kept)
+ * @return Frame length, 0 on a bad mask / count or if cap is too small
+ */
+size_t imu_masked_pack(uint8_t mask, uint16_t t_ms, const imu_sample_t *s, uint8_t n,
+                       uint8_t *out, size_t cap);
+
+/**
+ * Unpack a frame; channels outside the mask are returned as 0
+ * @param s    Room for IMU_MASKED_MAX_SAMPLES
+ * @param t_ms Time of the last sample, mod IMU_MASKED_TIME_WRAP_MS
+ * @return Sample count, 0 on a malformed frame
+ */
+uint8_t imu_masked_unpack(const uint8_t *in, size_t len, uint8_t *mask, uint16_t *t_ms,
+                          imu_sample_t *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_MASKED_H
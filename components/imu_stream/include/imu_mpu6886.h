@@ -0,0 +1,122 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - MPU6886 REGISTER-LEVEL DRIVER
+ * ============================================================================
+ *
+ * Just enough of the MPU6886 to read samples and change the full-scale
+ * range (FSR) at runtime. M5Unified's IMU class assumes the range it set
+ * up itself; once we change FSR we must also do the count → unit scaling
+ * ourselves, so the sampler reads the registers directly through this
+ * driver.
+ *
+ * BUS ABSTRACTION:
+ * ----------------
+ * The driver never touches I2C itself. It calls two functions in an
+ * imu_reg_bus_t: the node plugs in M5Unified's internal I2C bus, the host
+ * tools plug in a register-level mock (tools/common/imu_mpu6886_mock.h).
+ * Same driver code in both places.
+ *
+ * REGISTERS USED:
+ * ---------------
+ *   0x1B GYRO_CONFIG    bits 4:3 FS_SEL   ±250/500/1000/2000 dps
+ *   0x1C ACCEL_CONFIG   bits 4:3 AFS_SEL  ±2/4/8/16 g
+ *   0x3B..0x48          ACCEL_XOUT_H .. GYRO_ZOUT_L (big-endian, temp in between)
+ *   0x41 TEMP_OUT_H     die temperature: °C = counts / 326.8 + 25
+ *   0x75 WHO_AM_I       0x19
+ *
+ * A range change takes effect from the next sample the chip latches; the
+ * driver converts every read with the range it last wrote, so one sample
+ * right at the switch may be scaled with the new range (datasheet: no
+ * settling time is specified for FS_SEL changes).
+ */
+
+#ifndef IMU_MPU6886_H
+#define IMU_MPU6886_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "imu_sample.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_MPU6886_ADDR            0x68
+#define IMU_MPU6886_WHO_AM_I_VALUE  0x19
+
+#define IMU_MPU6886_REG_GYRO_CONFIG   0x1B
+#define IMU_MPU6886_REG_ACCEL_CONFIG  0x1C
+#define IMU_MPU6886_REG_ACCEL_XOUT_H  0x3B
+#define IMU_MPU6886_REG_TEMP_OUT_H    0x41
+#define IMU_MPU6886_REG_WHO_AM_I      0x75
+#define IMU_MPU6886_FS_SHIFT          3
+#define IMU_MPU6886_FS_MASK           (0x03u << IMU_MPU6886_FS_SHIFT)
+#define IMU_MPU6886_DATA_LEN          14      // accel (6) + temp (2) + gyro (6)
+
+#define IMU_RANGE_COUNT             4
+
+/**
+ * Full-scale range index (the FS_SEL / AFS_SEL field value)
+ *   accel: 0 = ±2 g, 1 = ±4 g, 2 = ±8 g, 3 = ±16 g
+ *   gyro:  0 = ±250, 1 = ±500, 2 = ±1000, 3 = ±2000 dps
+ */
+typedef uint8_t imu_range_t;
+
+/**
+ * Full scale in sample units (accel mg, gyro 0.1 dps)
+ */
+int32_t imu_accel_full_scale(imu_range_t r);
+int32_t imu_gyro_full_scale(imu_range_t r);
+
+/**
+ * Register access. Return 0 on success.
+ */
+typedef int (*imu_reg_read_fn)(void *ctx, uint8_t reg, uint8_t *buf, size_t len);
+typedef int (*imu_reg_write_fn)(void *ctx, uint8_t reg, uint8_t value);
+
+typedef struct {
+    imu_reg_read_fn read;
+    imu_reg_write_fn write;
+    void *ctx;
+} imu_reg_bus_t;
+
+typedef struct {
+    imu_reg_bus_t bus;
+    imu_range_t accel_range;        // Last written / read back
+    imu_range_t gyro_range;
+    int16_t temp_c10;               // Die temperature of the last read, 0.1 °C
+} imu_mpu6886_t;
+
+/**
+ * Attach to a chip that is already running (M5.begin() powers it up)
+ *
+ * Checks WHO_AM_I and adopts the ranges currently in the config registers.
+ * @return false if the bus fails or the chip doesn't answer as an MPU6886
+ */
+bool imu_mpu6886_init(imu_mpu6886_t *dev, const imu_reg_bus_t *bus);
+
+/**
+ * Change accel and gyro full-scale range (read-modify-write, only what changed)
+ * @return false on a bus error (driver keeps its previous ranges)
+ */
+bool imu_mpu6886_set_range(imu_mpu6886_t *dev, imu_range_t accel, imu_range_t gyro);
+
+/**
+ * Read one sample and scale it with the active ranges (mg / 0.1 dps)
+ * @return false on a bus error ('out' untouched)
+ */
+bool imu_mpu6886_read(imu_mpu6886_t *dev, imu_sample_t *out);
+
+/**
+ * Read only the die temperature (when samples come from elsewhere)
+ * @param temp_c10 Temperature in 0.1 °C (output, also kept in dev->temp_c10)
+ * @return false on a bus error
+ */
+bool imu_mpu6886_read_temp(imu_mpu6886_t *dev, int16_t *temp_c10);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_MPU6886_H
@@ -0,0 +1,174 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - PREDICTIVE BIT-PLANE PACKED FRAMES
+ * ============================================================================
+ *
+ * Fits as many decimated samples as possible into one unsegmented message
+ * (11-byte access payload - 3-byte opcode = 8 bytes). The legacy frame
+ * always carries one sample in those 8 bytes; a device at rest or moving
+ * smoothly repeats almost the same values every window.
+ *
+ * FOUR STAGES PER FRAME:
+ * ----------------------
+ * 1. PREDICT each axis from the samples before it (the encoder picks the
+ *    cheaper order for the whole frame):
+ *      order 1:  pred = x[n-1]               (constant: gravity, rest)
+ *      order 2:  pred = 2*x[n-1] - x[n-2]    (linear trend: smooth motion)
+ * 2. ZIGZAG the residual (imu_bits.h): 0, -1, 1, -2 ... → 0, 1, 2, 3 ...
+ * 3. WIDTH: the smallest bit count w that holds every residual of the
+ *    frame, one for the accel axes and one for the gyro axes. A quiet
+ *    sensor costs w = 0: zero bits per value.
+ * 4. BIT PLANES: the top bit of every residual, then the next bit of every
+ *    residual, ... Same size as w bits per value, but a plane is just a
+ *    bit-matrix transpose of the values, so 8 values move at once (below).
+ *
+ * KEY AND PREDICTED FRAMES:
+ * -------------------------
+ * An 8-byte frame cannot start from a raw sample and still batch: six
+ * int8 values already take 6 of its 8 bytes. So only KEY frames carry the
+ * first sample raw; PREDICTED frames continue from the last two samples
+ * of the frames before. A lost frame makes the following predicted frames
+ * undecodable until the next key frame - the key interval bounds the
+ * damage (tools/bench/bench_pack measures both sides). A 3-bit sequence
+ * number lets the receiver notice the gap; eight lost frames in a row alias.
+ *
+ * FRAME (opcode 0xCE0001, unsegmented, 2-8 bytes):
+ * -------------------------------------------------
+ *   Byte 0:    bit 7 key, bits 6:4 sequence, bits 3:1 n - 1, bit 0 order - 1
+ *   Byte 1:    bits 7:4 accel width, bits 3:0 gyro width (0..IMU_PACK_MAX_WIDTH)
+ *   Key only:  6 × int8, the first sample (AX..GZ)
+ *   Then, MSB first: the accel planes (width w_a down to 1) over the
+ *   residuals i × 3 + axis, then the gyro planes; zero padding to a byte
+ *
+ * Values use the legacy 0.1 g / 10 dps step, rounded and saturated at
+ * ±127 like imu_masked.h. Prediction runs on those steps, so the stream
+ * is lossless at that precision. Samples are one publish window apart,
+ * oldest first; there is no timestamp - the last sample is the window
+ * that closed just before the frame was sent.
+ *
+ * SCALAR AND WORD-AT-A-TIME:
+ * --------------------------
+ * imu_pack_planes_ref() writes one bit per call - the obviously correct
+ * reference. imu_pack_planes() loads 8 residual bytes into a uint64, and
+ * one 8×8 bit-matrix transpose (three shift/mask/XOR steps) turns them
+ * into 8 plane bytes; a whole plane of up to 24 values is then one
+ * bit-writer call. Both produce identical bytes (checked by bench_pack).
+ */
+
+#ifndef IMU_PACKED_H
+#define IMU_PACKED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "imu_sample.h"
+#include "imu_proto.h"
+#include "imu_bits.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_PACK_HEADER_LEN     2
+#define IMU_PACK_MAX_SAMPLES    8       // 3-bit count; 800 ms of windows at 10 Hz
+#define IMU_PACK_MAX_WIDTH      10      // Zigzag of an order-2 residual of ±127 steps
+#define IMU_PACK_MAX_VALUES     (IMU_PACK_MAX_SAMPLES * 3)     // Residuals per sensor
+#define IMU_PACK_STEP           100     // mg / 0.1 dps per step (legacy precision)
+#define IMU_PACK_SEQ_MOD        8
+#define IMU_PACK_KEY_INTERVAL   4       // Default: one key frame every 4 frames
+
+/*
+ * ============================================================================
+ *                         BIT-PLANE KERNELS
+ * ============================================================================
+ */
+
+/**
+ * Write m values as w bit planes (MSB plane first) - one bit at a time
+ * @param m Value count (1..IMU_PACK_MAX_VALUES)
+ * @param w Plane count (0..IMU_PACK_MAX_WIDTH); bits above w must be 0
+ */
+void imu_pack_planes_ref(imu_bitwriter_t *bw, const uint16_t *u, uint8_t m, uint8_t w);
+
+/**
+ * Same output as imu_pack_planes_ref(), 8 values per transpose
+ */
+void imu_pack_planes(imu_bitwriter_t *bw, const uint16_t *u, uint8_t m, uint8_t w);
+
+/**
+ * Read m values of w bit planes - one bit at a time
+ */
+void imu_unpack_planes_ref(imu_bitreader_t *br, uint16_t *u, uint8_t m, uint8_t w);
+
+/**
+ * Same result as imu_unpack_planes_ref(), 8 values per transpose
+ */
+void imu_unpack_planes(imu_bitreader_t *br, uint16_t *u, uint8_t m, uint8_t w);
+
+/*
+ * ============================================================================
+ *                         STREAM ENCODER / DECODER
+ * ============================================================================
+ */
+
+typedef struct {
+    uint8_t key_interval;                   // Frames per key frame (1 = all key)
+    uint8_t max_samples;                    // Latency bound (1..IMU_PACK_MAX_SAMPLES)
+    uint8_t seq;
+    uint8_t gop_pos;                        // Frames since the last key frame
+    int8_t hist[2][IMU_AXIS_COUNT];         // Last two sent samples, newest first
+    uint8_t hist_n;
+    int8_t pend[IMU_PACK_MAX_SAMPLES][IMU_AXIS_COUNT];
+    uint8_t fill;
+    bool key;                               // The pending frame is a key frame
+} imu_pack_encoder_t;
+
+typedef struct {
+    int8_t hist[2][IMU_AXIS_COUNT];
+    uint8_t hist_n;                         // 0 = waiting for a key frame
+    uint8_t seq;                            // Sequence of the last decoded frame
+    uint32_t unreferenced;                  // Predicted frames dropped for a lost reference
+} imu_pack_decoder_t;
+
+/**
+ * Initialize an encoder (the first frame is a key frame)
+ * @param key_interval Frames per key frame (0 is treated as 1)
+ * @param max_samples  Samples per frame at most (clamped to 1..IMU_PACK_MAX_SAMPLES)
+ */
+void imu_pack_encoder_init(imu_pack_encoder_t *enc, uint8_t key_interval, uint8_t max_samples);
+
+/**
+ * Add one decimated sample
+ *
+ * A frame is sent when the next sample would not fit or the frame holds
+ * max_samples; this call then returns it and keeps the new sample pending.
+ *
+ * @param out Frame buffer
+ * @return Frame length (2..IMU_FRAME_MAX) if a frame is complete, else 0
+ */
+size_t imu_pack_push(imu_pack_encoder_t *enc, const imu_sample_t *s, uint8_t out[IMU_FRAME_MAX]);
+
+/**
+ * Send the pending samples now (e.g. before a mode change)
+ * @return Frame length, 0 if nothing was pending
+ */
+size_t imu_pack_flush(imu_pack_encoder_t *enc, uint8_t out[IMU_FRAME_MAX]);
+
+void imu_pack_decoder_init(imu_pack_decoder_t *dec);
+
+/**
+ * Decode a frame (values in mg / 0.1 dps)
+ *
+ * @param out Room for IMU_PACK_MAX_SAMPLES
+ * @param key Set to the frame's key flag (may be NULL)
+ * @return Sample count; 0 on a malformed frame or a predicted frame whose
+ *         reference was lost (counted in dec->unreferenced)
+ */
+uint8_t imu_pack_decode(imu_pack_decoder_t *dec, const uint8_t *in, size_t len,
+                        imu_sample_t *out, bool *key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_PACKED_H
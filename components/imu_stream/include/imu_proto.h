@@ -0,0 +1,87 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - WIRE PROTOCOL CONSTANTS
+ * ============================================================================
+ *
+ * Opcodes and payload limits shared by the node firmware and the host tools.
+ * Frame layouts live next to the code that packs them (imu_envelope.h, ...);
+ * this header only holds what every encoder and decoder must agree on.
+ *
+ * VENDOR OPCODES:
+ * ---------------
+ * A 3-byte vendor opcode is: [0xC0 | op (6 bits)] [company ID, little endian]
+ *
+ *   op 0x00 → 0xC00001  Legacy int8 frame (imu_compact_data_t)
+ *   op 0x01 → 0xC10001  Min/max/mean envelope frame (imu_envelope.h)
+ *   op 0x02 → 0xC20001  Lossless Rice block, segmented (imu_rice.h)
+ *   op 0x03 → 0xC30001  Codec-tagged window, auto-selected codec (imu_codec.h)
+ *   op 0x04 → 0xC40001  Vector-quantized block, learned codebook (imu_vq.h)
+ *   op 0x05 → 0xC50001  Codebook install chunk, gateway → node (imu_vq.h)
+ *   op 0x06 → 0xC60001  Range-tagged int8 frame (imu_autorange.h)
+ *   op 0x07 → 0xC70001  Calibration install, gateway → node (imu_calib.h)
+ *   op 0x08 → 0xC80001  Time-sync beacon, gateway → nodes (imu_timesync.h)
+ *   op 0x09 → 0xC90001  Capture command, gateway → control group (imu_capture.h)
+ *   op 0x0A → 0xCA0001  Capture upload chunk, segmented (imu_capture.h)
+ *   op 0x0B → 0xCB0001  Stream configuration, gateway → node (imu_config.h)
+ *   op 0x0C → 0xCC0001  Channel-masked frame, 2-8 bytes (imu_masked.h)
+ *   op 0x0D → 0xCD0001  |a| / |ω| magnitude frame, 4-8 bytes (imu_magnitude.h)
+ *   op 0x0E → 0xCE0001  Predictive bit-plane packed frame, 2-8 bytes (imu_packed.h)
+ *   op 0x0F → 0xCF0001  Cluster-head batch of members' frames, segmented (imu_batch.h)
+ *   op 0x20-0x3F → 0xE00001-0xFF0001  XOR parity frames, K and group
+ *                                     sequence in the op bits (imu_fec.h)
+ *
+ * NOTE: the ESP_BLE_MESH_MODEL_OP_3(0xC0, 0x0002) entry in ble_mesh_node.c
+ * is really "op 0 of company 0x0002" - the company ID lives in the last two
+ * bytes, not the opcode number. New opcodes are built with IMU_VENDOR_OP()
+ * so they stay inside our own company ID.
+ *
+ * PAYLOAD BUDGET:
+ * ---------------
+ *   11 bytes unsegmented access payload
+ *  - 3 bytes vendor opcode
+ *  = 8 bytes of data per single-segment message
+ *
+ * Segmented messages carry up to 32 segments × 12 bytes = 384 bytes,
+ * minus the 4-byte TransMIC and the opcode = 377 bytes of data
+ * (CONFIG_BLE_MESH_TX_SEG_MAX=32). Each extra segment costs airtime and
+ * a network buffer, so segmented frames are for capture modes, not for
+ * the 10 Hz multi-node stream.
+ */
+
+#ifndef IMU_PROTO_H
+#define IMU_PROTO_H
+
+#include <stdint.h>
+
+#define IMU_COMPANY_ID              0x0001
+
+// Build a 3-byte vendor opcode for our company ID (op = 0..63)
+#define IMU_VENDOR_OP(op)           ((uint32_t)((0xC0u | ((op) & 0x3Fu)) << 16) | IMU_COMPANY_ID)
+
+#define IMU_OP_DATA                 IMU_VENDOR_OP(0x00)   // 0xC00001 legacy int8 frame
+#define IMU_OP_ENVELOPE             IMU_VENDOR_OP(0x01)   // 0xC10001 envelope frame
+#define IMU_OP_RICE                 IMU_VENDOR_OP(0x02)   // 0xC20001 lossless Rice block
+#define IMU_OP_CODEC                IMU_VENDOR_OP(0x03)   // 0xC30001 codec-tagged window
+#define IMU_OP_VQ                   IMU_VENDOR_OP(0x04)   // 0xC40001 VQ block
+#define IMU_OP_VQ_INSTALL           IMU_VENDOR_OP(0x05)   // 0xC50001 VQ codebook chunk (received)
+#define IMU_OP_RANGED               IMU_VENDOR_OP(0x06)   // 0xC60001 range-tagged int8 frame
+#define IMU_OP_CALIB                IMU_VENDOR_OP(0x07)   // 0xC70001 calibration install (received)
+#define IMU_OP_TSYNC                IMU_VENDOR_OP(0x08)   // 0xC80001 time-sync beacon (received)
+#define IMU_OP_CAPTURE              IMU_VENDOR_OP(0x09)   // 0xC90001 capture command (received)
+#define IMU_OP_CAPTURE_DATA         IMU_VENDOR_OP(0x0A)   // 0xCA0001 capture upload chunk
+#define IMU_OP_CONFIG               IMU_VENDOR_OP(0x0B)   // 0xCB0001 stream configuration (received)
+#define IMU_OP_MASKED               IMU_VENDOR_OP(0x0C)   // 0xCC0001 channel-masked frame
+#define IMU_OP_MAGNITUDE            IMU_VENDOR_OP(0x0D)   // 0xCD0001 magnitude frame
+#define IMU_OP_PACKED               IMU_VENDOR_OP(0x0E)   // 0xCE0001 bit-plane packed frame
+#define IMU_OP_BATCH                IMU_VENDOR_OP(0x0F)   // 0xCF0001 cluster-head batch
+#define IMU_OP_TOPO_REPORT          IMU_VENDOR_OP(0x10)   // 0xD00001 neighbour report
+#define IMU_OP_RELAY_SET            IMU_VENDOR_OP(0x11)   // 0xD10001 relay set (received)
+
+#define IMU_ACCESS_PAYLOAD_MAX      11  // Unsegmented access message
+#define IMU_VENDOR_OPCODE_LEN       3
+#define IMU_FRAME_MAX               (IMU_ACCESS_PAYLOAD_MAX - IMU_VENDOR_OPCODE_LEN)   // 8
+
+#define IMU_SEG_ACCESS_MAX          380 // 32 segments × 12 bytes - 4 byte TransMIC
+#define IMU_SEG_FRAME_MAX           (IMU_SEG_ACCESS_MAX - IMU_VENDOR_OPCODE_LEN)       // 377
+
+#endif // IMU_PROTO_H
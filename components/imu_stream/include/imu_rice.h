@@ -0,0 +1,103 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - LOSSLESS RICE CODEC
+ * ============================================================================
+ *
+ * Full 16-bit precision for research captures, at a fraction of 16 bits
+ * per value.
+ *
+ * HOW IT WORKS:
+ * -------------
+ * IMU signals are smooth at 200 Hz: the next sample is well predicted by
+ * the previous ones. We send the prediction error (residual) instead of
+ * the value, and residuals are small numbers that need few bits.
+ *
+ * 1. PREDICT (per axis, per block - the encoder picks the cheapest order)
+ *      order 0:  pred = 0                         (noise around zero: gyro at rest)
+ *      order 1:  pred = x[n-1]                    (slow drift: gravity)
+ *      order 2:  pred = 2*x[n-1] - x[n-2]         (smooth motion: linear trend)
+ *
+ * 2. ZIGZAG the residual so small negatives are small too:
+ *      0, -1, 1, -2, 2 ...  →  0, 1, 2, 3, 4 ...
+ *
+ * 3. RICE CODE with parameter k (per axis, per block):
+ *      u = q * 2^k + r   →   q ones, a zero, then r in k bits
+ *    k is chosen so 2^k is about the average residual - a near-optimal
+ *    code for the geometric-ish residual distribution, with no tables.
+ *
+ * BLOCKS:
+ * -------
+ * Each block is self-contained (first value sent raw, no history from
+ * the previous block), so one lost mesh message loses one block only.
+ *
+ * FRAME LAYOUT (segmented vendor message, opcode 0xC20001):
+ * ----------------------------------------------------------
+ *   Byte 0: block length N (1..IMU_RICE_MAX_BLOCK)
+ *   Byte 1: block sequence number (mod 256)
+ *   Then a bit stream, MSB first, per axis AX..GZ:
+ *     2 bits  predictor order p (0, 1, 2) - or 3 = raw escape
+ *     p == 3: N × 16-bit raw values
+ *     else:   4 bits k
+ *             16 bits x[0] raw            (only if p >= 1)
+ *             N (p = 0) or N-1 Rice codes (order 2 uses order 1 for x[1])
+ *   A residual with q >= IMU_RICE_QESC is sent as IMU_RICE_QESC in unary
+ *   followed by the 18-bit zigzag value (bounds the worst case).
+ *
+ * The encoder falls back to the raw escape per axis whenever Rice would be
+ * bigger, so a frame never exceeds IMU_RICE_MAX_FRAME (fits one segmented
+ * message at the default 32-segment limit).
+ */
+
+#ifndef IMU_RICE_H
+#define IMU_RICE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "imu_sample.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_RICE_MAX_BLOCK     30   // Samples per block (worst case must fit a segmented message)
+#define IMU_RICE_HEADER_LEN    2
+#define IMU_RICE_MAX_K         15
+#define IMU_RICE_QESC          16   // Unary length that signals an escaped residual
+#define IMU_RICE_ESC_BITS      18   // Order-2 residual of int16 data fits 18 zigzag bits
+#define IMU_RICE_ORDER_RAW     3
+
+// Worst case: every axis escaped to raw
+#define IMU_RICE_MAX_FRAME     (IMU_RICE_HEADER_LEN + \
+                                (IMU_AXIS_COUNT * (2 + 16 * IMU_RICE_MAX_BLOCK) + 7) / 8)
+
+/**
+ * Encode a block of samples
+ *
+ * @param in  Samples
+ * @param n   Number of samples (1..IMU_RICE_MAX_BLOCK)
+ * @param seq Block sequence number
+ * @param out Output buffer
+ * @param cap Output capacity (IMU_RICE_MAX_FRAME always suffices)
+ * @return Frame length in bytes, 0 if n is out of range or cap too small
+ */
+size_t imu_rice_encode(const imu_sample_t *in, uint8_t n, uint8_t seq,
+                       uint8_t *out, size_t cap);
+
+/**
+ * Decode a frame
+ *
+ * @param in  Frame bytes
+ * @param len Frame length
+ * @param out Output samples
+ * @param cap Output capacity in samples
+ * @param seq Block sequence number (may be NULL)
+ * @return Number of samples decoded, 0 on a malformed or truncated frame
+ */
+size_t imu_rice_decode(const uint8_t *in, size_t len, imu_sample_t *out,
+                       size_t cap, uint8_t *seq);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_RICE_H
@@ -0,0 +1,100 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - HIGH-RATE SAMPLE RING
+ * ============================================================================
+ *
+ * Single-producer / single-consumer ring buffer between the high-rate
+ * sampler task and the (slower) publishing task.
+ *
+ * WHY A RING?
+ * -----------
+ * The sampler runs at hundreds of Hz and must never block on the mesh
+ * stack. The publisher wakes up at the publish rate and drains everything
+ * that arrived since the last frame. The ring decouples the two rates.
+ *
+ * CONCURRENCY:
+ * ------------
+ * Exactly one task pushes, exactly one task pops. The producer only writes
+ * 'head', the consumer only writes 'tail', so no lock is needed - only
+ * acquire/release ordering (the two tasks may run on different cores).
+ *
+ * If the consumer falls behind, new samples are DROPPED (not old ones) and
+ * counted in 'overruns'. Dropping at the head keeps the producer lock-free.
+ */
+
+#ifndef IMU_RING_H
+#define IMU_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "imu_sample.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Must be a power of two (index wrap uses a mask)
+#define IMU_RING_CAPACITY  128
+
+typedef struct {
+    imu_sample_t buf[IMU_RING_CAPACITY];
+    uint32_t head;          // Next slot to write (producer-owned)
+    uint32_t tail;          // Next slot to read (consumer-owned)
+    uint32_t overruns;      // Samples dropped because the ring was full
+} imu_ring_t;
+
+static inline void imu_ring_init(imu_ring_t *r)
+{
+    r->head = 0;
+    r->tail = 0;
+    r->overruns = 0;
+}
+
+/**
+ * Number of samples waiting to be read
+ */
+static inline uint32_t imu_ring_count(const imu_ring_t *r)
+{
+    uint32_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    uint32_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+    return head - tail;
+}
+
+/**
+ * Producer side: append one sample
+ * @return false if the ring was full (sample dropped)
+ */
+static inline bool imu_ring_push(imu_ring_t *r, const imu_sample_t *s)
+{
+    uint32_t head = r->head;
+    uint32_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+    if (head - tail >= IMU_RING_CAPACITY) {
+        r->overruns++;
+        return false;
+    }
+    r->buf[head & (IMU_RING_CAPACITY - 1)] = *s;
+    __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * Consumer side: remove one sample
+ * @return false if the ring was empty
+ */
+static inline bool imu_ring_pop(imu_ring_t *r, imu_sample_t *out)
+{
+    uint32_t tail = r->tail;
+    uint32_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+        return false;
+    }
+    *out = r->buf[tail & (IMU_RING_CAPACITY - 1)];
+    __atomic_store_n(&r->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_RING_H
@@ -0,0 +1,66 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - SAMPLE TYPE
+ * ============================================================================
+ *
+ * The common currency of the IMU pipeline. Every stage (sampler, filters,
+ * codecs, host tools) passes samples around in this one fixed-point format.
+ *
+ * UNITS:
+ * ------
+ *   Accel X/Y/Z: milli-g (mg)        range ±32767 mg   = ±32.7 g
+ *   Gyro  X/Y/Z: 0.1 dps (deci-dps)  range ±32767     = ±3276.7 dps
+ *
+ * Both cover the full MPU6886 range (±16 g, ±2000 dps) with headroom, so
+ * a sample never clips before the codec decides how to quantize it.
+ *
+ * NOTE: This component is plain C99 with no ESP-IDF dependencies so the
+ * exact same code runs on the node, on the gateway and in host tools.
+ */
+
+#ifndef IMU_SAMPLE_H
+#define IMU_SAMPLE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_AXIS_COUNT  6
+
+/**
+ * Axis index into imu_sample_t.v[]
+ */
+typedef enum {
+    IMU_AXIS_AX = 0,    // Accelerometer X (mg)
+    IMU_AXIS_AY,        // Accelerometer Y (mg)
+    IMU_AXIS_AZ,        // Accelerometer Z (mg)
+    IMU_AXIS_GX,        // Gyroscope X (0.1 dps)
+    IMU_AXIS_GY,        // Gyroscope Y (0.1 dps)
+    IMU_AXIS_GZ,        // Gyroscope Z (0.1 dps)
+} imu_axis_t;
+
+/**
+ * One 6-axis IMU sample
+ * Array form (not named fields) so DSP kernels can loop over axes.
+ */
+typedef struct {
+    int16_t v[IMU_AXIS_COUNT];
+} imu_sample_t;
+
+/**
+ * Saturate a 32-bit intermediate to the int16_t sample range
+ */
+static inline int16_t imu_sat16(int32_t x)
+{
+    if (x > INT16_MAX) return INT16_MAX;
+    if (x < INT16_MIN) return INT16_MIN;
+    return (int16_t)x;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_SAMPLE_H
@@ -0,0 +1,98 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - NOISE PRE-FILTER (SMOOTHING)
+ * ============================================================================
+ *
+ * Sensor noise, not motion, sets the size of the residuals the predictive
+ * codecs send (imu_rice.h, imu_packed.h): at rest the MPU6886 wanders a
+ * few mg from sample to sample, and every residual pays for it. Smoothing
+ * each axis before quantization removes most of that noise - at the cost
+ * of delaying real motion a little.
+ *
+ * TWO FILTERS (per axis, fixed point, state in 1/256 LSB):
+ * --------------------------------------------------------
+ * 1. COMPLEMENTARY - x += k · (z - x)
+ *    A fixed blend of the estimate and the new sample (exponential
+ *    smoothing). Smaller k = less noise, more delay: the noise variance
+ *    drops to k / (2 - k) of the input's, and a step takes about
+ *    2.3 / k samples to reach 90 %.
+ *
+ * 2. KALMAN - the same blend, but k comes from two numbers you can
+ *    measure instead of tune:
+ *      noise  R = variance of the sensor at rest (LSB²)
+ *      motion Q = how far the true value may move per sample (LSB²)
+ *    predict:  P += Q
+ *    update:   K = P / (P + R),  x += K · (z - x),  P = (1 - K) · P
+ *    With the gate on, an innovation |z - x| beyond gate · sqrt(P + R)
+ *    (a knock, a fast turn) restarts the estimate at z: quiet stretches
+ *    get the smoothing, events get through on the same sample.
+ *
+ * Accel and gyro axes get separate parameters (index 0 = accel, 1 = gyro).
+ * One 32×32→64 multiply per axis per sample, plus one divide for Kalman.
+ *
+ * WHERE IT RUNS:
+ * --------------
+ * On the full-rate calibrated samples, before the decimator and the block
+ * codecs. Captures (imu_capture.h) and magnitude peaks (imu_magnitude.h)
+ * are taken before it - they want the raw signal.
+ */
+
+#ifndef IMU_SMOOTH_H
+#define IMU_SMOOTH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "imu_sample.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_SMOOTH_ONE          32768   // Q15 gain of 1.0 (complementary: pass-through)
+#define IMU_SMOOTH_FRAC_BITS    8       // State resolution: 1/256 LSB
+
+typedef enum {
+    IMU_SMOOTH_OFF = 0,
+    IMU_SMOOTH_COMPLEMENTARY = 1,       // Fixed gain
+    IMU_SMOOTH_KALMAN = 2,              // Gain from noise / motion variances
+} imu_smooth_mode_t;
+
+typedef struct {
+    imu_smooth_mode_t mode;
+    uint16_t gain[2];                   // COMPLEMENTARY: k in Q15 (1..IMU_SMOOTH_ONE)
+    uint32_t noise[2];                  // KALMAN: R, LSB² (≥ 1)
+    uint32_t motion[2];                 // KALMAN: Q, LSB² per sample
+    uint8_t gate;                       // KALMAN: restart beyond gate σ (0 = never)
+} imu_smooth_config_t;
+
+typedef struct {
+    imu_smooth_config_t cfg;
+    bool primed;                        // First sample seen
+    int32_t x[IMU_AXIS_COUNT];          // Estimate, 1/256 LSB
+    uint32_t p[IMU_AXIS_COUNT];         // KALMAN: estimate variance, LSB² / 256
+    uint32_t restarts;                  // KALMAN: gate hits (statistics)
+} imu_smooth_t;
+
+/**
+ * Defaults for the MPU6886 at 200 Hz: R = 4² mg² / 6² (0.1 dps)², Q = 1,
+ * gate 4 σ (Kalman); k = 0.25 (complementary)
+ */
+void imu_smooth_defaults(imu_smooth_config_t *cfg, imu_smooth_mode_t mode);
+
+/**
+ * (Re)configure; the next sample restarts the estimate
+ * @return false on an out-of-range parameter (state unchanged)
+ */
+bool imu_smooth_configure(imu_smooth_t *s, const imu_smooth_config_t *cfg);
+
+/**
+ * Filter n samples in place (no-op when the mode is OFF)
+ */
+void imu_smooth_apply(imu_smooth_t *s, imu_sample_t *v, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_SMOOTH_H
@@ -0,0 +1,36 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - PLATFORM HOOKS
+ * ============================================================================
+ *
+ * The only place where imu_stream knows it may be running on an ESP32.
+ * Everything else in the component stays plain C99 for the host tools.
+ *
+ * IMU_STREAM_IRAM:
+ * ----------------
+ * On the ESP32, code normally executes from external flash through a small
+ * instruction cache. A hot loop that gets evicted (mesh stack, Wi-Fi/BT
+ * controller, LCD driver all compete for the same cache) pays a flash
+ * refill on the next call, and the cache is disabled entirely while NVS
+ * writes to flash. Tagging a kernel IRAM_ATTR places it in internal RAM:
+ * constant fetch time, no cache misses.
+ *
+ * IRAM is scarce (~128 KB shared with the BT controller), so only tag
+ * small inner loops that run per sample. On the host the macro is empty.
+ *
+ * A function in IRAM should not call into flash code or read const tables
+ * from flash (switch jump tables, string literals) on its hot path,
+ * otherwise the benefit is lost.
+ */
+
+#ifndef IMU_STREAM_PORT_H
+#define IMU_STREAM_PORT_H
+
+#if defined(ESP_PLATFORM)
+#include "esp_attr.h"
+#define IMU_STREAM_IRAM     IRAM_ATTR
+#else
+#define IMU_STREAM_IRAM
+#endif
+
+#endif // IMU_STREAM_PORT_H
@@ -0,0 +1,159 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - MESH-WIDE TIME SYNCHRONIZATION
+ * ============================================================================
+ *
+ * Every node has its own crystal: offsets of seconds (boot time) and skews
+ * of tens of ppm (40 ppm = 2.4 ms drift per minute). Samples from two nodes
+ * can only be fused once both are stamped on ONE clock. The gateway's clock
+ * is that clock ("mesh-global time"); nodes estimate how their own clock
+ * maps onto it from periodic beacons.
+ *
+ * BEACON (opcode 0xC80001, gateway → all nodes, 8 bytes, single segment):
+ * ------------------------------------------------------------------------
+ *   Byte 0:    sequence number
+ *   Byte 1:    TTL the gateway sent it with
+ *   Byte 2-5:  gateway time when the beacon was handed to the stack
+ *              (µs, uint32 LE, wraps every 71 min)
+ *   Byte 6-7:  send-time correction for the PREVIOUS beacon (µs, uint16 LE)
+ *              0xFFFF = unknown / too late, drop that beacon
+ *
+ * SEND-TIME CORRECTION (two-step stamping):
+ * -----------------------------------------
+ * The biggest, most variable delay is on the gateway: a beacon waits in
+ * the mesh stack's advertising queue behind data traffic. The gateway
+ * cannot know that delay while it builds the beacon, but it learns it
+ * once the beacon is on air (advertising-sent callback), and ships it in
+ * the next beacon. The node therefore keeps each beacon's pair
+ * (local receive time, gateway stamp) pending until the correction for
+ * it arrives. A lost beacon therefore costs two pairs, not one.
+ *
+ *   gateway  stamp t ─── queue q ───▶ on air ─── relays ───▶ node rx (local L)
+ *   next beacon carries q  →  pair (L, t + q + hops × hop_delay)
+ *
+ * What is left after the correction: relay backoff jitter and receive
+ * latency (a few ms), plus the mean relay delay, which is compensated as
+ * hops × hop_delay_us (hops from the TTL, see mesh_msg_recv_ttl()).
+ *
+ * ESTIMATOR (node side):
+ * ----------------------
+ * Least-squares line through the corrected pairs, in offset form:
+ *
+ *   global - local = offset + skew × (local - anchor)     anchor = newest pair
+ *
+ * Relay jitter is a few ms, so a skew fitted over a handful of beacons is
+ * mostly noise (3 ms over 8 s is ~400 ppm). The fit therefore keeps
+ * exponentially weighted sums instead of a window of pairs: each beacon
+ * weighs IMU_TSYNC_FORGET less than the one after it, giving a memory of
+ * ~1 / (1 - FORGET) beacons at O(1) state. Until those beacons span
+ * enough time, skew is pulled towards 0 by a prior of ±IMU_TSYNC_SKEW_PRIOR
+ * (ridge regression), so a few noisy pairs cannot fit a 200 ppm slope.
+ * Skew then holds the estimate between beacons and across lost ones.
+ *
+ * A pair far off the line (> max(4 × jitter, IMU_TSYNC_MIN_GATE_US)) is
+ * rejected as a delay outlier; IMU_TSYNC_MAX_REJECTS rejections in a row
+ * mean the line itself is wrong (gateway reboot, clock step) and the
+ * estimator restarts. Runs once per beacon, so it uses double.
+ *
+ * REPORTED ERROR:
+ * ---------------
+ *   jitter_us   RMS of (pair - prediction): the delay noise on the beacons
+ *   error_us    standard error of the line at the newest pair - the node's
+ *               own estimate of its alignment error to mesh-global time
+ *
+ * tools/sim/sim_timesync checks error_us against the true error.
+ */
+
+#ifndef IMU_TIMESYNC_H
+#define IMU_TIMESYNC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_TSYNC_BEACON_LEN        8
+#define IMU_TSYNC_CORR_UNKNOWN      0xFFFFu
+#define IMU_TSYNC_FORGET            0.97
+#define IMU_TSYNC_SKEW_PRIOR        50e-6       // Crystal tolerance (±50 ppm)
+#define IMU_TSYNC_GATE_POINTS       4           // Pairs before the outlier gate
+#define IMU_TSYNC_MIN_GATE_US       10000
+#define IMU_TSYNC_MAX_REJECTS       3
+
+typedef struct {
+    uint8_t seq;
+    uint8_t ttl;
+    uint32_t t_us;                  // Gateway clock, at hand-off to the stack
+    uint16_t prev_corr_us;          // Queue delay of beacon seq-1
+} imu_tsync_beacon_t;
+
+typedef struct {
+    int32_t hop_delay_us;           // Mean delay added per relay hop
+
+    // Beacon waiting for its send-time correction
+    bool have_pending;
+    uint8_t pending_seq;
+    int64_t pending_local_us;
+    int64_t pending_global_us;
+
+    // Gateway clock unwrapping (32-bit stamps → 64-bit)
+    bool have_global;
+    int64_t last_global_us;
+
+    // Weighted sums, x = local - anchor_us, y = global - local
+    double sw, sx, sy, sxx, sxy;
+    double q0, q1, q2;              // Same with squared weights (for error_us)
+    uint32_t points;                // Pairs since the last (re)start
+
+    // Current line: global = local + offset_us + skew × (local - anchor_us)
+    bool synced;
+    int64_t anchor_us;
+    double offset_us;
+    double skew;                    // e.g. 25e-6 = gateway runs 25 ppm faster
+    double jitter_us;               // RMS prediction residual
+    double error_us;                // Standard error of the line at anchor_us
+
+    uint32_t beacons, used, rejected, restarts;
+    uint8_t reject_run;
+} imu_tsync_t;
+
+/**
+ * Pack a beacon (gateway / host side)
+ */
+void imu_tsync_beacon_pack(const imu_tsync_beacon_t *b, uint8_t out[IMU_TSYNC_BEACON_LEN]);
+
+/**
+ * Parse a beacon
+ * @return false if the length is wrong
+ */
+bool imu_tsync_beacon_unpack(const uint8_t *in, size_t len, imu_tsync_beacon_t *b);
+
+/**
+ * Reset the estimator
+ * @param hop_delay_us Mean delay per relay hop (µs)
+ */
+void imu_tsync_init(imu_tsync_t *ts, int32_t hop_delay_us);
+
+/**
+ * Feed one received beacon
+ *
+ * @param recv_ttl TTL the beacon arrived with (hops = beacon TTL - recv_ttl)
+ * @param local_us Node clock when the beacon was received (esp_timer_get_time)
+ * @return true if a pair was confirmed and the line updated
+ */
+bool imu_tsync_feed(imu_tsync_t *ts, const imu_tsync_beacon_t *b, uint8_t recv_ttl,
+                    int64_t local_us);
+
+/**
+ * Node clock → mesh-global time (µs). Returns local_us while not synced.
+ */
+int64_t imu_tsync_to_global(const imu_tsync_t *ts, int64_t local_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_TIMESYNC_H
@@ -0,0 +1,220 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - RELAY ELECTION
+ * ============================================================================
+ *
+ * Sticks start with relay disabled: a stick out of the gateway's range gets
+ * no help, and relaying on every stick sends each frame once more per stick.
+ * The relay election picks a small relay set from what the sticks hear:
+ *
+ *   stick    ──0xD00001 neighbour report──▶ data group (every 30 s)
+ *   gateway  plans: the fewest relays that bring every stick within range
+ *            of the gateway or of a relay, the relays connected to it
+ *   gateway  ──0xD10001 relay set──▶ control group
+ *   stick    relays iff its address is in the set (node_set_relay)
+ *
+ * A stick hears its neighbours' reports: a report that arrives with the
+ * TTL it was sent with came directly, and its RSSI is the neighbour's. The
+ * table keeps an average per neighbour. With no relays yet, the gateway
+ * only gets the reports of its own neighbours; each plan reaches one ring
+ * further, so the set settles after about as many rounds as the mesh is
+ * hops deep. tools/sim/sim_relay measures delivery and transmissions.
+ *
+ * NEIGHBOUR REPORT (opcode 0xD00001, segmented, 3 + 3 × n bytes):
+ * ---------------------------------------------------------------
+ *   Byte 0:    TTL the report was sent with
+ *   Byte 1:    Flags: bit 0 = the stick relays now
+ *   Byte 2:    n, neighbours (0..IMU_TOPO_REPORT_MAX): relays first, then
+ *              the others, strongest first
+ *   Then n × [address LE][RSSI, int8 dBm]
+ *
+ * RELAY SET (opcode 0xD10001, segmented above 2 relays, 2 + 2 × n bytes):
+ * -----------------------------------------------------------------------
+ *   Byte 0:    Plan ID (the gateway counts up; logged by the sticks)
+ *   Byte 1:    n, relays (0..IMU_TOPO_MAX_RELAYS)
+ *   Then n × [address LE]
+ */
+
+#ifndef IMU_TOPOLOGY_H
+#define IMU_TOPOLOGY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_TOPO_MAX_NEIGHBOURS     16      // Stick: neighbours it keeps
+#define IMU_TOPO_REPORT_MAX         12      // Neighbours per report
+#define IMU_TOPO_REPORT_HEADER_LEN  3
+#define IMU_TOPO_REPORT_ENTRY_LEN   3
+#define IMU_TOPO_REPORT_LEN_MAX     (IMU_TOPO_REPORT_HEADER_LEN + IMU_TOPO_REPORT_MAX * IMU_TOPO_REPORT_ENTRY_LEN)
+#define IMU_TOPO_FLAG_RELAYING      0x01
+
+#define IMU_TOPO_MAX_NODES          32      // Gateway: nodes in the graph, gateway included
+#define IMU_TOPO_MAX_RELAYS         16
+#define IMU_TOPO_SET_HEADER_LEN     2
+#define IMU_TOPO_SET_LEN_MAX        (IMU_TOPO_SET_HEADER_LEN + 2 * IMU_TOPO_MAX_RELAYS)
+#define IMU_TOPO_NO_LINK            INT8_MIN
+#define IMU_TOPO_RSSI_MIN           (-88)   // Weaker links don't count (dBm)
+#define IMU_TOPO_HYSTERESIS_DB      6       // ...unless a relay of the last plan is on one end
+
+/**
+ * A relay set: planned by the gateway, received by the sticks
+ */
+typedef struct {
+    uint16_t relay[IMU_TOPO_MAX_RELAYS];
+    uint8_t count;
+    uint8_t unreached;                      // No usable path to the gateway
+    uint8_t short_cover;                    // Reached, but fewer than 'cover' in range
+} imu_topo_plan_t;
+
+/*
+ * ----------------------------------------------------------------------------
+ *                    STICK: NEIGHBOUR TABLE
+ * ----------------------------------------------------------------------------
+ */
+
+typedef struct {
+    uint16_t addr;
+    int16_t rssi_x16;                       // Average RSSI, dBm × 16
+    uint32_t last_ms;                       // Last heard
+} imu_topo_neighbour_t;
+
+typedef struct {
+    imu_topo_neighbour_t n[IMU_TOPO_MAX_NEIGHBOURS];
+    uint8_t count;
+    uint32_t replaced;                      // Statistics: weakest dropped for a stronger one
+} imu_topo_table_t;
+
+/**
+ * Empty, statistics zero
+ */
+void imu_topo_table_init(imu_topo_table_t *t);
+
+/**
+ * Note a message heard directly from addr
+ *
+ * Known neighbours: RSSI averaged (1/4 new). New ones: added; when the
+ * table is full they replace the weakest neighbour if they are stronger.
+ */
+void imu_topo_observe(imu_topo_table_t *t, uint16_t addr, int8_t rssi, uint32_t now_ms);
+
+/**
+ * Forget neighbours not heard for max_age_ms
+ */
+void imu_topo_expire(imu_topo_table_t *t, uint32_t now_ms, uint32_t max_age_ms);
+
+/**
+ * Pack a neighbour report
+ *
+ * Neighbours in the current relay set first - the links the plan rests
+ * on stay in view even when more than IMU_TOPO_REPORT_MAX are heard -
+ * then the others, strongest first.
+ *
+ * @param ttl TTL the report will be sent with
+ * @param relays Last relay set received, NULL if none
+ * @return Report length (at least the header), 0 if cap is too small
+ */
+size_t imu_topo_report_pack(const imu_topo_table_t *t, uint8_t ttl, bool relaying,
+                            const imu_topo_plan_t *relays, uint8_t *out, size_t cap);
+
+typedef struct {
+    uint16_t addr;
+    int8_t rssi;
+} imu_topo_link_t;
+
+typedef struct {
+    uint8_t ttl;
+    bool relaying;
+    uint8_t count;
+    imu_topo_link_t link[IMU_TOPO_REPORT_MAX];
+} imu_topo_report_t;
+
+/**
+ * Unpack a neighbour report
+ * @return false if malformed
+ */
+bool imu_topo_report_unpack(const uint8_t *in, size_t len, imu_topo_report_t *r);
+
+/*
+ * ----------------------------------------------------------------------------
+ *                    GATEWAY: GRAPH AND PLANNER
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * What the gateway knows: rssi[rx][tx] = how well node rx hears node tx
+ */
+typedef struct {
+    uint16_t addr[IMU_TOPO_MAX_NODES];      // [0] = gateway
+    int8_t rssi[IMU_TOPO_MAX_NODES][IMU_TOPO_MAX_NODES];
+    uint8_t count;
+} imu_topo_graph_t;
+
+/**
+ * Only the gateway, no links
+ */
+void imu_topo_graph_init(imu_topo_graph_t *g, uint16_t gateway);
+
+/**
+ * Set one link: rx hears tx with rssi
+ *
+ * The gateway calls it for every report it hears directly (received
+ * TTL = report TTL) with rx = itself.
+ *
+ * @return false if a new node doesn't fit
+ */
+bool imu_topo_graph_link(imu_topo_graph_t *g, uint16_t rx, uint16_t tx, int8_t rssi);
+
+/**
+ * Replace what the reporter hears with its latest report
+ * @return false if a node didn't fit (the links that fit are kept)
+ */
+bool imu_topo_graph_report(imu_topo_graph_t *g, uint16_t reporter, const imu_topo_report_t *r);
+
+/**
+ * Pick the relays
+ *
+ * A link counts if it is at least rssi_min strong; a link only one side
+ * reported counts both ways. Greedy, grown from the gateway: the next
+ * relay is the node next to the gateway or a relay that brings the most
+ * nodes closer to 'cover' relays (or the gateway) in range. Ties go to a
+ * relay of prev, the stronger link, then the lower address - the same
+ * graph gives the same plan.
+ *
+ * prev stays as it is while its relays still reach the gateway, every
+ * node is in range of one, and the new plan would not cover better or
+ * save two relays. Links with a relay of prev on one end count down to
+ * IMU_TOPO_HYSTERESIS_DB below rssi_min.
+ *
+ * @param cover 1 = every node in range of one, 2 = of two (a spare path)
+ * @param prev The plan in force, NULL for none
+ */
+void imu_topo_plan(const imu_topo_graph_t *g, int8_t rssi_min, uint8_t cover,
+                   const imu_topo_plan_t *prev, imu_topo_plan_t *p);
+
+/**
+ * Pack a relay set
+ * @return Length, 0 if cap is too small
+ */
+size_t imu_topo_relay_set_pack(const imu_topo_plan_t *p, uint8_t plan_id, uint8_t *out, size_t cap);
+
+/**
+ * Unpack a relay set (the statistics of p are zeroed)
+ * @return false if malformed
+ */
+bool imu_topo_relay_set_unpack(const uint8_t *in, size_t len, uint8_t *plan_id, imu_topo_plan_t *p);
+
+/**
+ * Is addr in the relay set?
+ */
+bool imu_topo_is_relay(const imu_topo_plan_t *p, uint16_t addr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_TOPOLOGY_H
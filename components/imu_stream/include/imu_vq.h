@@ -0,0 +1,205 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - VECTOR QUANTIZATION (LEARNED CODEBOOK)
+ * ============================================================================
+ *
+ * For repetitive motion (a machine cycle, a gait) the same handful of
+ * 6-axis "poses" come back over and over. A codebook of those poses,
+ * learned on the gateway from earlier captures, lets the node send one
+ * byte per pose instead of the values.
+ *
+ * HOW IT WORKS:
+ * -------------
+ *   Gateway: capture → k-means → codebook (K codewords) → install on node
+ *   Node:    sample → nearest codeword → send its index (1 byte)
+ *   Gateway: index → codeword → reconstructed sample
+ *
+ * GROUPS:
+ * -------
+ *   groups = 1: one 6-D codebook (accel + gyro jointly)   1 byte / sample
+ *   groups = 2: one 3-D codebook for accel, one for gyro  2 bytes / sample
+ * Split codebooks need far fewer codewords for the same error (accel and
+ * gyro combinations don't have to be learned jointly); joint codebooks
+ * win when the motion is truly periodic.
+ *
+ * ESCAPES (outliers):
+ * -------------------
+ * A sample that is far from every codeword (a knock, a new movement) must
+ * not be silently snapped to the wrong pose. If any single value is more
+ * than esc_thresh from the nearest codeword, the group escapes:
+ *   0xFE idx r0..rD-1    residual escape: codeword + r × 2^res_shift (int8 r)
+ *   0xFF v0..vD-1        raw escape: int16 LE values (exact)
+ * The residual form is tried first; raw is used when a residual overflows
+ * or would still land outside esc_thresh. Every decoded value is therefore
+ * within esc_thresh of the input - with esc_thresh = 99 never worse than
+ * the legacy int8 frame (step 100).
+ *
+ * DATA FRAME (opcode 0xC40001, segmented when > 8 bytes):
+ * --------------------------------------------------------
+ *   Byte 0: codebook ID (receiver must hold the same codebook)
+ *   Byte 1: block sequence number
+ *   Byte 2: block length N
+ *   Then per sample, per group: index byte [+ escape payload]
+ *
+ * INSTALL CHUNK (opcode 0xC50001, gateway → node, segmented):
+ * ------------------------------------------------------------
+ *   Byte 0: codebook ID         Byte 3: res_shift
+ *   Byte 1: groups (1 or 2)     Byte 4-5: esc_thresh (LE)
+ *   Byte 2: K codewords/group   Byte 6-7: chunk offset in values (LE)
+ *   Byte 8+: int16 LE codebook values
+ * Values are stored group by group, codeword by codeword (K × 6 values in
+ * total for either grouping). Every chunk repeats the header, so chunks
+ * may arrive in any order and a lost one is simply re-sent. The node
+ * switches to the new codebook between blocks once every chunk is in.
+ */
+
+#ifndef IMU_VQ_H
+#define IMU_VQ_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "imu_sample.h"
+#include "imu_proto.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_VQ_MAX_GROUPS       2
+#define IMU_VQ_MAX_CODES        254     // Indexes 0xFE/0xFF are the escapes
+#define IMU_VQ_ESC_RESIDUAL     0xFE
+#define IMU_VQ_ESC_RAW          0xFF
+#define IMU_VQ_MAX_VALUES       (IMU_VQ_MAX_CODES * IMU_AXIS_COUNT)
+#define IMU_VQ_MAX_THRESH       16383   // Keeps squared distances inside uint32_t
+
+#define IMU_VQ_HEADER_LEN       3
+#define IMU_VQ_MAX_BLOCK        30
+// Worst case per sample: two 3-D groups escaped raw (2 × (1 + 6))
+#define IMU_VQ_MAX_SAMPLE_BYTES (IMU_VQ_MAX_GROUPS + IMU_AXIS_COUNT * 2)
+
+#define IMU_VQ_INSTALL_HEADER_LEN   8
+#define IMU_VQ_CHUNK_VALUES         ((IMU_SEG_FRAME_MAX - IMU_VQ_INSTALL_HEADER_LEN) / 2)  // 184
+#define IMU_VQ_MAX_CHUNKS           ((IMU_VQ_MAX_VALUES + IMU_VQ_CHUNK_VALUES - 1) / IMU_VQ_CHUNK_VALUES)
+
+/**
+ * A codebook (3 KB at the maximum size)
+ *
+ * Keep instances in internal RAM (static/global, not PSRAM, not const in
+ * flash): the nearest-codeword search streams through all of it per sample.
+ */
+typedef struct {
+    uint8_t id;                     // Tags data frames (0 = none installed)
+    uint8_t groups;                 // 1 = joint 6-D, 2 = accel 3-D + gyro 3-D
+    uint8_t codes;                  // K codewords per group (1..IMU_VQ_MAX_CODES)
+    uint8_t res_shift;              // Residual escape step = 1 << res_shift
+    uint16_t esc_thresh;            // Escape above this error on any one value
+    int16_t values[IMU_VQ_MAX_VALUES];
+} imu_vq_codebook_t;
+
+/**
+ * Encoder counters (accumulate across calls)
+ */
+typedef struct {
+    uint32_t coded;                 // Groups sent as a bare index
+    uint32_t residual;              // Groups sent as residual escapes
+    uint32_t raw;                   // Groups sent raw
+} imu_vq_stats_t;
+
+/**
+ * Check that a codebook's parameters are usable
+ */
+bool imu_vq_codebook_valid(const imu_vq_codebook_t *cb);
+
+/**
+ * Nearest codeword of one group (squared Euclidean distance)
+ *
+ * Partial-distance search: a candidate is dropped as soon as its running
+ * sum exceeds the best so far. Starting from 'hint' (last winner) makes
+ * the bound tight from the first codeword for slowly changing motion.
+ * Placed in IRAM on the ESP32 (see imu_stream_port.h).
+ *
+ * @param cb    Codebook
+ * @param group Group index (0..groups-1)
+ * @param x     Group values (6 or 3 values)
+ * @param hint  First codeword to try
+ * @param dist  Squared distance of the winner (output, may be NULL)
+ * @return Codeword index
+ */
+uint8_t imu_vq_nearest(const imu_vq_codebook_t *cb, uint8_t group, const int16_t *x,
+                       uint8_t hint, uint32_t *dist);
+
+/**
+ * Encode a block of samples
+ *
+ * @param cb    Codebook
+ * @param seq   Block sequence number
+ * @param in    Samples
+ * @param n     Number of samples (1..IMU_VQ_MAX_BLOCK)
+ * @param out   Output buffer
+ * @param cap   Output capacity (IMU_VQ_HEADER_LEN + n × IMU_VQ_MAX_SAMPLE_BYTES suffices)
+ * @param stats Escape counters (may be NULL)
+ * @return Frame length, 0 if the codebook is invalid, n out of range or cap too small
+ */
+size_t imu_vq_encode(const imu_vq_codebook_t *cb, uint8_t seq, const imu_sample_t *in,
+                     uint8_t n, uint8_t *out, size_t cap, imu_vq_stats_t *stats);
+
+/**
+ * Decode a data frame
+ *
+ * @param cb  Codebook (its ID must match byte 0 of the frame)
+ * @param seq Block sequence number (may be NULL)
+ * @return Number of samples decoded, 0 on a codebook mismatch or malformed frame
+ */
+size_t imu_vq_decode(const imu_vq_codebook_t *cb, const uint8_t *in, size_t len,
+                     imu_sample_t *out, size_t cap, uint8_t *seq);
+
+/*
+ * ============================================================================
+ *                         CODEBOOK INSTALL
+ * ============================================================================
+ */
+
+/**
+ * Build install chunk number 'chunk' of a codebook (gateway / host side)
+ *
+ * @param out Output buffer (IMU_SEG_FRAME_MAX bytes always suffice)
+ * @return Chunk length, 0 when 'chunk' is past the end of the codebook
+ */
+size_t imu_vq_install_chunk(const imu_vq_codebook_t *cb, uint8_t chunk,
+                            uint8_t *out, size_t cap);
+
+typedef enum {
+    IMU_VQ_INSTALL_PARTIAL = 0,     // Chunk stored, more to come
+    IMU_VQ_INSTALL_COMPLETE,        // Last missing chunk stored: 'pending' is ready
+    IMU_VQ_INSTALL_INVALID,         // Malformed chunk or bad parameters (ignored)
+} imu_vq_install_status_t;
+
+/**
+ * Receiver-side install state
+ *
+ * A chunk whose header differs from the install in progress starts a new
+ * install (the previous partial codebook is dropped).
+ */
+typedef struct {
+    imu_vq_codebook_t pending;
+    uint16_t have_mask;             // Bit per chunk received
+    uint16_t need_mask;             // Bit per chunk of this codebook
+} imu_vq_installer_t;
+
+/**
+ * Reset an installer (no install in progress)
+ */
+void imu_vq_installer_init(imu_vq_installer_t *inst);
+
+/**
+ * Feed one install chunk
+ */
+imu_vq_install_status_t imu_vq_install_feed(imu_vq_installer_t *inst,
+                                            const uint8_t *in, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_VQ_H
@@ -0,0 +1,129 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - AUTO-RANGING FULL-SCALE CONTROLLER
+ * ============================================================================
+ *
+ * See imu_autorange.h for the hysteresis rules and the ranged frame.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "imu_autorange.h"
+
+typedef int32_t (*full_scale_fn)(imu_range_t r);
+
+static const full_scale_fn full_scale[2] = { imu_accel_full_scale, imu_gyro_full_scale };
+
+imu_autorange_config_t imu_autorange_default_config(void)
+{
+    imu_autorange_config_t cfg = { 90, 70, 20, 0 };
+    return cfg;
+}
+
+void imu_autorange_init(imu_autorange_t *ar, const imu_autorange_config_t *cfg,
+                        imu_range_t accel, imu_range_t gyro)
+{
+    memset(ar, 0, sizeof(*ar));
+    ar->cfg = *cfg;
+    ar->range[IMU_RANGE_SENSOR_ACCEL] = accel;
+    ar->range[IMU_RANGE_SENSOR_GYRO] = gyro;
+}
+
+void imu_autorange_observe(imu_autorange_t *ar, const imu_sample_t *s)
+{
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        int sensor = (a < IMU_AXIS_GX) ? IMU_RANGE_SENSOR_ACCEL : IMU_RANGE_SENSOR_GYRO;
+        int32_t v = abs(s->v[a]);
+        if (v > ar->peak[sensor]) {
+            ar->peak[sensor] = v;
+        }
+    }
+}
+
+static imu_range_t decide(imu_autorange_t *ar, int sensor)
+{
+    const imu_autorange_config_t *cfg = &ar->cfg;
+    const full_scale_fn fs = full_scale[sensor];
+    const int32_t peak = ar->peak[sensor];
+    imu_range_t r = ar->range[sensor];
+
+    // Clipped: the true peak is unknown, so take no chances
+    if (peak >= fs(r) - fs(r) / 128) {
+        ar->quiet[sensor] = 0;
+        return IMU_RANGE_COUNT - 1;
+    }
+    if (peak * 100 > fs(r) * cfg->up_pct) {
+        ar->quiet[sensor] = 0;
+        while (r < IMU_RANGE_COUNT - 1 && peak * 100 > fs(r) * cfg->up_pct) {
+            r++;
+        }
+        return r;
+    }
+    if (r > cfg->min_range && peak * 100 < fs(r - 1) * cfg->down_pct) {
+        if (++ar->quiet[sensor] >= cfg->hold) {
+            ar->quiet[sensor] = 0;
+            return r - 1;
+        }
+    } else {
+        ar->quiet[sensor] = 0;
+    }
+    return r;
+}
+
+bool imu_autorange_update(imu_autorange_t *ar, imu_range_t *accel, imu_range_t *gyro)
+{
+    bool changed = false;
+    for (int sensor = 0; sensor < 2; sensor++) {
+        imu_range_t r = decide(ar, sensor);
+        if (r != ar->range[sensor]) {
+            ar->range[sensor] = r;
+            ar->switches++;
+            changed = true;
+        }
+        ar->peak[sensor] = 0;
+    }
+    *accel = ar->range[IMU_RANGE_SENSOR_ACCEL];
+    *gyro = ar->range[IMU_RANGE_SENSOR_GYRO];
+    return changed;
+}
+
+/*
+ * ============================================================================
+ *                         RANGED FRAME
+ * ============================================================================
+ */
+
+void imu_ranged_pack(const imu_sample_t *s, uint16_t t_ms, imu_range_t accel,
+                     imu_range_t gyro, uint8_t out[IMU_RANGED_FRAME_LEN])
+{
+    uint16_t hdr = (uint16_t)((t_ms & IMU_RANGED_TS_MASK) | ((accel & 0x03u) << 12) |
+                              ((gyro & 0x03u) << 14));
+    out[0] = (uint8_t)hdr;
+    out[1] = (uint8_t)(hdr >> 8);
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        int32_t fs = (a < IMU_AXIS_GX) ? imu_accel_full_scale(accel) : imu_gyro_full_scale(gyro);
+        // v × 128 / fs, rounded to nearest
+        int32_t p = (int32_t)s->v[a] * 128;
+        int32_t q = (p >= 0) ? (p + fs / 2) / fs : -((-p + fs / 2) / fs);
+        q = (q > INT8_MAX) ? INT8_MAX : (q < INT8_MIN) ? INT8_MIN : q;
+        out[2 + a] = (uint8_t)(int8_t)q;
+    }
+}
+
+bool imu_ranged_unpack(const uint8_t *in, size_t len, imu_sample_t *s, uint16_t *t_ms,
+                       imu_range_t *accel, imu_range_t *gyro)
+{
+    if (len != IMU_RANGED_FRAME_LEN) {
+        return false;
+    }
+    uint16_t hdr = (uint16_t)(in[0] | (in[1] << 8));
+    imu_range_t ar = (hdr >> 12) & 0x03u, gr = (hdr >> 14) & 0x03u;
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        int32_t fs = (a < IMU_AXIS_GX) ? imu_accel_full_scale(ar) : imu_gyro_full_scale(gr);
+        s->v[a] = imu_sat16((int32_t)(int8_t)in[2 + a] * fs / 128);
+    }
+    if (t_ms) *t_ms = hdr & IMU_RANGED_TS_MASK;
+    if (accel) *accel = ar;
+    if (gyro) *gyro = gr;
+    return true;
+}
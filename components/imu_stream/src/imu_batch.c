@@ -0,0 +1,128 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - CLUSTER-HEAD BATCHES
+ * ============================================================================
+ *
+ * See imu_batch.h for the frame layout.
+ */
+
+#include <string.h>
+#include "imu_batch.h"
+
+void imu_batch_init(imu_batch_t *b)
+{
+    memset(b, 0, sizeof(*b));
+}
+
+bool imu_batch_add(imu_batch_t *b, uint16_t src, const uint8_t frame[IMU_BATCH_FRAME_LEN])
+{
+    if (b->count >= IMU_BATCH_MAX_ENTRIES) {
+        b->dropped++;
+        return false;
+    }
+    imu_batch_entry_t *e = &b->entry[b->count++];
+    e->src = src;
+    memcpy(e->frame, frame, IMU_BATCH_FRAME_LEN);
+    return true;
+}
+
+// Bytes the source code of an entry takes after 'prev'
+static size_t src_code_len(uint16_t prev, uint16_t src)
+{
+    const uint16_t d = (uint16_t)(src - prev);
+    return (src >= prev && d < IMU_BATCH_SRC_ESCAPE) ? 1 : 3;
+}
+
+size_t imu_batch_pack(imu_batch_t *b, uint8_t *out, size_t cap, uint8_t *taken)
+{
+    *taken = 0;
+    if (b->count == 0 || cap < IMU_BATCH_HEADER_LEN + IMU_BATCH_ENTRY_LEN) {
+        return 0;
+    }
+
+    // Insertion sort by source: stable, so a member's frames keep their order
+    for (uint8_t i = 1; i < b->count; i++) {
+        const imu_batch_entry_t e = b->entry[i];
+        uint8_t j = i;
+        while (j > 0 && b->entry[j - 1].src > e.src) {
+            b->entry[j] = b->entry[j - 1];
+            j--;
+        }
+        b->entry[j] = e;
+    }
+
+    const uint16_t base = b->entry[0].src;
+    size_t len = IMU_BATCH_HEADER_LEN;
+    uint16_t prev = base;
+    uint8_t n = 0;
+    while (n < b->count) {
+        const imu_batch_entry_t *e = &b->entry[n];
+        const size_t code_len = src_code_len(prev, e->src);
+        if (len + code_len + IMU_BATCH_FRAME_LEN > cap) {
+            break;
+        }
+        if (code_len == 1) {
+            out[len++] = (uint8_t)(e->src - prev);
+        } else {
+            out[len++] = IMU_BATCH_SRC_ESCAPE;
+            out[len++] = (uint8_t)(e->src & 0xFF);
+            out[len++] = (uint8_t)(e->src >> 8);
+        }
+        memcpy(&out[len], e->frame, IMU_BATCH_FRAME_LEN);
+        len += IMU_BATCH_FRAME_LEN;
+        prev = e->src;
+        n++;
+    }
+    out[0] = n;
+    out[1] = (uint8_t)(base & 0xFF);
+    out[2] = (uint8_t)(base >> 8);
+    *taken = n;
+    return len;
+}
+
+void imu_batch_consume(imu_batch_t *b, uint8_t n)
+{
+    if (n >= b->count) {
+        b->count = 0;
+        return;
+    }
+    memmove(&b->entry[0], &b->entry[n], (size_t)(b->count - n) * sizeof(b->entry[0]));
+    b->count = (uint8_t)(b->count - n);
+}
+
+uint8_t imu_batch_unpack(const uint8_t *in, size_t len, imu_batch_entry_t *out, uint8_t max)
+{
+    if (len < IMU_BATCH_HEADER_LEN) {
+        return 0;
+    }
+    const uint8_t n = in[0];
+    if (n == 0 || n > IMU_BATCH_MAX_ENTRIES || n > max) {
+        return 0;
+    }
+    uint16_t prev = (uint16_t)(in[1] | (in[2] << 8));
+    size_t pos = IMU_BATCH_HEADER_LEN;
+    for (uint8_t i = 0; i < n; i++) {
+        if (pos >= len) {
+            return 0;
+        }
+        uint16_t src;
+        if (in[pos] == IMU_BATCH_SRC_ESCAPE) {
+            if (pos + 3 > len) {
+                return 0;
+            }
+            src = (uint16_t)(in[pos + 1] | (in[pos + 2] << 8));
+            pos += 3;
+        } else {
+            src = (uint16_t)(prev + in[pos]);
+            pos += 1;
+        }
+        if (pos + IMU_BATCH_FRAME_LEN > len) {
+            return 0;
+        }
+        out[i].src = src;
+        memcpy(out[i].frame, &in[pos], IMU_BATCH_FRAME_LEN);
+        pos += IMU_BATCH_FRAME_LEN;
+        prev = src;
+    }
+    return (pos == len) ? n : 0;
+}
@@ -0,0 +1,155 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - CALIBRATION STAGE
+ * ============================================================================
+ *
+ * See imu_calib.h for the model, the fixed-point format and the blob layout.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "imu_calib.h"
+
+void imu_calib_identity(imu_calib_t *c)
+{
+    memset(c, 0, sizeof(*c));
+    for (int s = 0; s < 2; s++) {
+        c->matrix[s][0] = c->matrix[s][4] = c->matrix[s][8] = IMU_CALIB_ONE;
+    }
+}
+
+void imu_calib_bias(const imu_calib_t *c, int16_t temp_c10, int16_t bias[IMU_AXIS_COUNT])
+{
+    const uint8_t p = c->temp_points;
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        int32_t b = c->offset[a];
+        if (p == 1 || (p > 1 && temp_c10 <= c->temp_c10[0])) {
+            b += c->temp_bias[0][a];
+        } else if (p > 1 && temp_c10 >= c->temp_c10[p - 1]) {
+            b += c->temp_bias[p - 1][a];
+        } else if (p > 1) {
+            int k = 1;
+            while (temp_c10 > c->temp_c10[k]) {
+                k++;
+            }
+            int32_t t0 = c->temp_c10[k - 1], t1 = c->temp_c10[k];
+            int32_t b0 = c->temp_bias[k - 1][a], b1 = c->temp_bias[k][a];
+            b += b0 + (int32_t)((int64_t)(b1 - b0) * (temp_c10 - t0) / (t1 - t0));
+        }
+        bias[a] = imu_sat16(b);
+    }
+}
+
+void imu_calib_apply(const imu_calib_t *c, int16_t temp_c10, imu_sample_t *block, size_t n)
+{
+    int16_t bias[IMU_AXIS_COUNT];
+    imu_calib_bias(c, temp_c10, bias);
+
+    for (size_t i = 0; i < n; i++) {
+        int16_t *v = block[i].v;
+        for (int s = 0; s < 2; s++) {
+            const int16_t *m = c->matrix[s];
+            const int32_t x0 = imu_sat16((int32_t)v[3 * s] - bias[3 * s]);
+            const int32_t x1 = imu_sat16((int32_t)v[3 * s + 1] - bias[3 * s + 1]);
+            const int32_t x2 = imu_sat16((int32_t)v[3 * s + 2] - bias[3 * s + 2]);
+            // Row gain ≤ 4.0 (checked on unpack): |sum| < 2^31, round to nearest
+            const int32_t half = 1 << (IMU_CALIB_Q - 1);
+            v[3 * s]     = imu_sat16((m[0] * x0 + m[1] * x1 + m[2] * x2 + half) >> IMU_CALIB_Q);
+            v[3 * s + 1] = imu_sat16((m[3] * x0 + m[4] * x1 + m[5] * x2 + half) >> IMU_CALIB_Q);
+            v[3 * s + 2] = imu_sat16((m[6] * x0 + m[7] * x1 + m[8] * x2 + half) >> IMU_CALIB_Q);
+        }
+    }
+}
+
+/*
+ * ============================================================================
+ *                         SERIALIZATION
+ * ============================================================================
+ */
+
+static uint8_t *put16(uint8_t *p, int16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)((uint16_t)v >> 8);
+    return p + 2;
+}
+
+static const uint8_t *get16(const uint8_t *p, int16_t *v)
+{
+    *v = (int16_t)(p[0] | (p[1] << 8));
+    return p + 2;
+}
+
+static size_t blob_len(uint8_t temp_points)
+{
+    return IMU_CALIB_HEADER_LEN + (9 + 9 + IMU_AXIS_COUNT) * 2 +
+           (size_t)temp_points * (1 + IMU_AXIS_COUNT) * 2;
+}
+
+size_t imu_calib_pack(const imu_calib_t *c, uint8_t *out, size_t cap)
+{
+    const size_t len = blob_len(c->temp_points);
+    if (c->temp_points > IMU_CALIB_TEMP_POINTS || cap < len) {
+        return 0;
+    }
+    uint8_t *p = out;
+    *p++ = IMU_CALIB_VERSION;
+    *p++ = c->id;
+    *p++ = c->temp_points;
+    for (int s = 0; s < 2; s++) {
+        for (int k = 0; k < 9; k++) {
+            p = put16(p, c->matrix[s][k]);
+        }
+    }
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        p = put16(p, c->offset[a]);
+    }
+    for (int t = 0; t < c->temp_points; t++) {
+        p = put16(p, c->temp_c10[t]);
+        for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+            p = put16(p, c->temp_bias[t][a]);
+        }
+    }
+    return len;
+}
+
+bool imu_calib_unpack(const uint8_t *in, size_t len, imu_calib_t *c)
+{
+    if (len < IMU_CALIB_HEADER_LEN || in[0] != IMU_CALIB_VERSION ||
+        in[2] > IMU_CALIB_TEMP_POINTS || len != blob_len(in[2])) {
+        return false;
+    }
+    imu_calib_t tmp;
+    memset(&tmp, 0, sizeof(tmp));
+    tmp.id = in[1];
+    tmp.temp_points = in[2];
+    const uint8_t *p = in + IMU_CALIB_HEADER_LEN;
+    for (int s = 0; s < 2; s++) {
+        for (int k = 0; k < 9; k++) {
+            p = get16(p, &tmp.matrix[s][k]);
+        }
+        for (int row = 0; row < 3; row++) {
+            int32_t gain = 0;
+            for (int k = 0; k < 3; k++) {
+                gain += abs(tmp.matrix[s][3 * row + k]);
+            }
+            if (gain > 65535) {
+                return false;
+            }
+        }
+    }
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        p = get16(p, &tmp.offset[a]);
+    }
+    for (int t = 0; t < tmp.temp_points; t++) {
+        p = get16(p, &tmp.temp_c10[t]);
+        if (t > 0 && tmp.temp_c10[t] <= tmp.temp_c10[t - 1]) {
+            return false;
+        }
+        for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+            p = get16(p, &tmp.temp_bias[t][a]);
+        }
+    }
+    *c = tmp;
+    return true;
+}
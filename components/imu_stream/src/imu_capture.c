@@ -0,0 +1,183 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - GROUP-TRIGGERED SYNCHRONIZED CAPTURE
+ * ============================================================================
+ *
+ * See imu_capture.h for the command, the recorder and the chunk layout.
+ */
+
+#include <string.h>
+#include "imu_capture.h"
+
+#define HIST_MASK   (IMU_CAPTURE_MAX - 1)
+
+void imu_capture_cmd_pack(const imu_capture_cmd_t *c, uint8_t out[IMU_CAPTURE_CMD_LEN])
+{
+    out[0] = c->id;
+    out[1] = c->slots;
+    out[2] = c->slot_100ms;
+    out[3] = (uint8_t)c->t_start_us;
+    out[4] = (uint8_t)(c->t_start_us >> 8);
+    out[5] = (uint8_t)(c->t_start_us >> 16);
+    out[6] = (uint8_t)(c->t_start_us >> 24);
+    out[7] = (uint8_t)(c->samples / 4);
+}
+
+bool imu_capture_cmd_unpack(const uint8_t *in, size_t len, imu_capture_cmd_t *c)
+{
+    if (len != IMU_CAPTURE_CMD_LEN) {
+        return false;
+    }
+    c->id = in[0];
+    c->slots = in[1];
+    c->slot_100ms = in[2];
+    c->t_start_us = (uint32_t)in[3] | ((uint32_t)in[4] << 8) |
+                    ((uint32_t)in[5] << 16) | ((uint32_t)in[6] << 24);
+    c->samples = (uint16_t)(in[7] * 4);
+    return true;
+}
+
+void imu_capture_init(imu_capture_t *cap)
+{
+    cap->count = 0;
+    cap->state = IMU_CAPTURE_IDLE;
+    cap->have_first = false;
+}
+
+// Signed distance from T, valid within ±35 min of it
+static int32_t since_start(const imu_capture_t *cap, uint32_t t_us)
+{
+    return (int32_t)(t_us - cap->cmd.t_start_us);
+}
+
+static void window_check(imu_capture_t *cap, uint32_t idx)
+{
+    const int32_t dt = since_start(cap, cap->hist_us[idx & HIST_MASK]);
+    if (!cap->have_first && dt >= 0) {
+        cap->have_first = true;
+        cap->first = idx;
+        cap->first_offset_us = (uint16_t)(dt > 0xFFFF ? 0xFFFF : dt);
+    }
+    if (cap->have_first && idx + 1 - cap->first >= cap->cmd.samples) {
+        cap->state = IMU_CAPTURE_READY;
+    }
+}
+
+bool imu_capture_arm(imu_capture_t *cap, const imu_capture_cmd_t *cmd)
+{
+    if (cap->state != IMU_CAPTURE_IDLE || cmd->samples == 0 || cmd->samples > IMU_CAPTURE_MAX) {
+        return false;
+    }
+    const uint32_t oldest = (cap->count > IMU_CAPTURE_MAX) ? cap->count - IMU_CAPTURE_MAX : 0;
+    cap->cmd = *cmd;
+    cap->have_first = false;
+
+    // T already in the history? Then a sample from before T must still be there
+    if (cap->count > oldest && since_start(cap, cap->hist_us[oldest & HIST_MASK]) > 0) {
+        return false;
+    }
+    cap->state = IMU_CAPTURE_ARMED;
+    for (uint32_t i = oldest; i < cap->count && cap->state == IMU_CAPTURE_ARMED; i++) {
+        window_check(cap, i);
+    }
+    return true;
+}
+
+imu_capture_state_t imu_capture_push(imu_capture_t *cap, const imu_sample_t *s, uint32_t global_us)
+{
+    if (cap->state == IMU_CAPTURE_READY) {
+        return cap->state;
+    }
+    const uint32_t idx = cap->count++;
+    cap->hist[idx & HIST_MASK] = *s;
+    cap->hist_us[idx & HIST_MASK] = global_us;
+    if (cap->state == IMU_CAPTURE_ARMED) {
+        window_check(cap, idx);
+    }
+    return cap->state;
+}
+
+uint8_t imu_capture_chunks(const imu_capture_t *cap)
+{
+    if (cap->state != IMU_CAPTURE_READY) {
+        return 0;
+    }
+    return (uint8_t)((cap->cmd.samples + IMU_CAPTURE_CHUNK_SAMPLES - 1) / IMU_CAPTURE_CHUNK_SAMPLES);
+}
+
+size_t imu_capture_chunk_pack(const imu_capture_t *cap, uint8_t idx, uint8_t *out, size_t out_cap)
+{
+    const uint8_t chunks = imu_capture_chunks(cap);
+    if (idx >= chunks) {
+        return 0;
+    }
+    const uint32_t start = (uint32_t)idx * IMU_CAPTURE_CHUNK_SAMPLES;
+    uint32_t n = cap->cmd.samples - start;
+    if (n > IMU_CAPTURE_CHUNK_SAMPLES) {
+        n = IMU_CAPTURE_CHUNK_SAMPLES;
+    }
+    const size_t len = IMU_CAPTURE_CHUNK_HEADER + n * IMU_AXIS_COUNT * 2;
+    if (out_cap < len) {
+        return 0;
+    }
+    out[0] = cap->cmd.id;
+    out[1] = idx;
+    out[2] = chunks;
+    out[3] = (uint8_t)n;
+    out[4] = (uint8_t)cap->first_offset_us;
+    out[5] = (uint8_t)(cap->first_offset_us >> 8);
+    uint8_t *p = out + IMU_CAPTURE_CHUNK_HEADER;
+    for (uint32_t i = 0; i < n; i++) {
+        const imu_sample_t *s = &cap->hist[(cap->first + start + i) & HIST_MASK];
+        for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+            *p++ = (uint8_t)s->v[a];
+            *p++ = (uint8_t)((uint16_t)s->v[a] >> 8);
+        }
+    }
+    return len;
+}
+
+bool imu_capture_chunk_unpack(const uint8_t *in, size_t len, imu_capture_chunk_t *hdr,
+                              imu_sample_t *samples)
+{
+    if (len < IMU_CAPTURE_CHUNK_HEADER) {
+        return false;
+    }
+    const uint8_t n = in[3];
+    if (n == 0 || n > IMU_CAPTURE_CHUNK_SAMPLES || in[1] >= in[2] ||
+        len != IMU_CAPTURE_CHUNK_HEADER + (size_t)n * IMU_AXIS_COUNT * 2) {
+        return false;
+    }
+    hdr->id = in[0];
+    hdr->chunk = in[1];
+    hdr->chunks = in[2];
+    hdr->samples = n;
+    hdr->first_offset_us = (uint16_t)(in[4] | (in[5] << 8));
+    const uint8_t *p = in + IMU_CAPTURE_CHUNK_HEADER;
+    for (uint8_t i = 0; i < n; i++) {
+        for (int a = 0; a < IMU_AXIS_COUNT; a++, p += 2) {
+            samples[i].v[a] = (int16_t)(p[0] | (p[1] << 8));
+        }
+    }
+    return true;
+}
+
+void imu_capture_release(imu_capture_t *cap)
+{
+    cap->state = IMU_CAPTURE_IDLE;
+    cap->have_first = false;
+}
+
+uint32_t imu_capture_upload_ms(uint16_t samples)
+{
+    const uint32_t chunks = (samples + IMU_CAPTURE_CHUNK_SAMPLES - 1) / IMU_CAPTURE_CHUNK_SAMPLES;
+    return chunks * IMU_CAPTURE_CHUNK_MS;
+}
+
+uint32_t imu_capture_slot_delay_ms(const imu_capture_cmd_t *cmd, uint16_t unicast_addr)
+{
+    if (cmd->slots <= 1) {
+        return 0;
+    }
+    return (uint32_t)(unicast_addr % cmd->slots) * cmd->slot_100ms * 100u;
+}
@@ -0,0 +1,451 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - CODEC INTERFACE + AUTO SELECTION
+ * ============================================================================
+ *
+ * See imu_codec.h for the frame layout. This file contains:
+ * - The RAW8 and DELTA codecs (small enough to live here)
+ * - Adapters for the Rice, envelope and float-format codecs
+ * - The codec registry (find / list)
+ * - The selector and the tagged-frame decoder
+ */
+
+#include "imu_codec.h"
+#include "imu_rice.h"
+#include "imu_envelope.h"
+#include "imu_float.h"
+#include <string.h>
+
+/*
+ * ============================================================================
+ *                         RAW8 CODEC
+ * ============================================================================
+ *
+ * Payload: [n] then n × 6 int8 values. Declines when any value is outside
+ * int8 - at q = 100 that is the legacy frame, at q = 1 it only fits a
+ * device lying very still.
+ */
+static size_t raw8_encode(const imu_sample_t *in, uint8_t n, uint8_t *out, size_t cap)
+{
+    const size_t len = 1 + (size_t)n * IMU_AXIS_COUNT;
+    if (len > cap) {
+        return 0;
+    }
+    out[0] = n;
+    uint8_t *p = out + 1;
+    for (uint8_t i = 0; i < n; i++) {
+        for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+            int16_t v = in[i].v[a];
+            if (v < INT8_MIN || v > INT8_MAX) {
+                return 0;
+            }
+            *p++ = (uint8_t)(int8_t)v;
+        }
+    }
+    return len;
+}
+
+static size_t raw8_decode(const uint8_t *in, size_t len, imu_sample_t *out, size_t cap)
+{
+    if (len < 1 || in[0] > cap || len != 1 + (size_t)in[0] * IMU_AXIS_COUNT) {
+        return 0;
+    }
+    const uint8_t *p = in + 1;
+    for (uint8_t i = 0; i < in[0]; i++) {
+        for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+            out[i].v[a] = (int8_t)*p++;
+        }
+    }
+    return in[0];
+}
+
+/*
+ * ============================================================================
+ *                         DELTA CODEC
+ * ============================================================================
+ *
+ * Payload: [n] then per axis: first value int16 (LE), then n-1 deltas as
+ * int8. A delta outside -127..127 is sent as 0x80 + int16 (LE) value.
+ */
+#define DELTA_ESCAPE  0x80
+
+static size_t delta_encode(const imu_sample_t *in, uint8_t n, uint8_t *out, size_t cap)
+{
+    size_t pos = 0;
+    if (cap < 1) {
+        return 0;
+    }
+    out[pos++] = n;
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        if (pos + 2 > cap) {
+            return 0;
+        }
+        out[pos++] = (uint8_t)in[0].v[a];
+        out[pos++] = (uint8_t)((uint16_t)in[0].v[a] >> 8);
+        for (uint8_t i = 1; i < n; i++) {
+            int32_t d = (int32_t)in[i].v[a] - in[i - 1].v[a];
+            if (d >= -127 && d <= 127) {
+                if (pos + 1 > cap) {
+                    return 0;
+                }
+                out[pos++] = (uint8_t)(int8_t)d;
+            } else {
+                if (pos + 3 > cap) {
+                    return 0;
+                }
+                out[pos++] = DELTA_ESCAPE;
+                out[pos++] = (uint8_t)in[i].v[a];
+                out[pos++] = (uint8_t)((uint16_t)in[i].v[a] >> 8);
+            }
+        }
+    }
+    return pos;
+}
+
+static size_t delta_decode(const uint8_t *in, size_t len, imu_sample_t *out, size_t cap)
+{
+    size_t pos = 0;
+    if (len < 1 || in[0] == 0 || in[0] > cap) {
+        return 0;
+    }
+    const uint8_t n = in[pos++];
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        if (pos + 2 > len) {
+            return 0;
+        }
+        out[0].v[a] = (int16_t)(in[pos] | (in[pos + 1] << 8));
+        pos += 2;
+        for (uint8_t i = 1; i < n; i++) {
+            if (pos + 1 > len) {
+                return 0;
+            }
+            if (in[pos] == DELTA_ESCAPE) {
+                if (pos + 3 > len) {
+                    return 0;
+                }
+                out[i].v[a] = (int16_t)(in[pos + 1] | (in[pos + 2] << 8));
+                pos += 3;
+            } else {
+                out[i].v[a] = (int16_t)(out[i - 1].v[a] + (int8_t)in[pos]);
+                pos += 1;
+            }
+        }
+    }
+    return (pos == len) ? n : 0;
+}
+
+/*
+ * ============================================================================
+ *                         RICE ADAPTER
+ * ============================================================================
+ *
+ * imu_rice frames start with [n][seq]; the tagged header already carries
+ * the sequence number, so the adapter drops that byte on the wire.
+ */
+static size_t rice_encode(const imu_sample_t *in, uint8_t n, uint8_t *out, size_t cap)
+{
+    uint8_t tmp[IMU_RICE_MAX_FRAME];
+    size_t len = imu_rice_encode(in, n, 0, tmp, sizeof(tmp));
+    if (len == 0 || len - 1 > cap) {
+        return 0;
+    }
+    out[0] = tmp[0];
+    memcpy(out + 1, tmp + 2, len - 2);
+    return len - 1;
+}
+
+static size_t rice_decode(const uint8_t *in, size_t len, imu_sample_t *out, size_t cap)
+{
+    uint8_t tmp[IMU_RICE_MAX_FRAME];
+    if (len < 1 || len + 1 > sizeof(tmp)) {
+        return 0;
+    }
+    tmp[0] = in[0];
+    tmp[1] = 0;
+    memcpy(tmp + 2, in + 1, len - 1);
+    return imu_rice_decode(tmp, len + 1, out, cap, NULL);
+}
+
+/*
+ * ============================================================================
+ *                         ENVELOPE ADAPTER
+ * ============================================================================
+ *
+ * Payload: the accel and gyro envelope frames back to back (16 bytes).
+ */
+static size_t envelope_encode(const imu_sample_t *in, uint8_t n, uint8_t *out, size_t cap)
+{
+    if (cap < 2 * IMU_ENV_FRAME_LEN) {
+        return 0;
+    }
+    imu_envelope_t env;
+    imu_envelope_window_t w;
+    imu_envelope_init(&env, n);
+    for (uint8_t i = 0; i < n; i++) {
+        imu_envelope_push(&env, &in[i], &w);
+    }
+    imu_envelope_pack(&w, IMU_ENV_GROUP_ACCEL, out);
+    imu_envelope_pack(&w, IMU_ENV_GROUP_GYRO, out + IMU_ENV_FRAME_LEN);
+    return 2 * IMU_ENV_FRAME_LEN;
+}
+
+static size_t envelope_decode(const uint8_t *in, size_t len, imu_sample_t *out, size_t cap)
+{
+    imu_envelope_window_t w;
+    if (len != 2 * IMU_ENV_FRAME_LEN || cap < 3 ||
+        !imu_envelope_unpack(in, IMU_ENV_FRAME_LEN, &w, NULL) ||
+        !imu_envelope_unpack(in + IMU_ENV_FRAME_LEN, IMU_ENV_FRAME_LEN, &w, NULL)) {
+        return 0;
+    }
+    out[0] = w.min;
+    out[1] = w.mean;
+    out[2] = w.max;
+    return 3;
+}
+
+/*
+ * ============================================================================
+ *                         FLOAT-FORMAT ADAPTERS
+ * ============================================================================
+ *
+ * imu_float.h payloads go on the wire as they are.
+ */
+static size_t bfp8_encode(const imu_sample_t *in, uint8_t n, uint8_t *out, size_t cap)
+{
+    return imu_bfp_encode(in, n, 8, out, cap);
+}
+
+static size_t bfp8_decode(const uint8_t *in, size_t len, imu_sample_t *out, size_t cap)
+{
+    return imu_bfp_decode(in, len, 8, out, cap);
+}
+
+static size_t bfp12_encode(const imu_sample_t *in, uint8_t n, uint8_t *out, size_t cap)
+{
+    return imu_bfp_encode(in, n, 12, out, cap);
+}
+
+static size_t bfp12_decode(const uint8_t *in, size_t len, imu_sample_t *out, size_t cap)
+{
+    return imu_bfp_decode(in, len, 12, out, cap);
+}
+
+/*
+ * ============================================================================
+ *                         REGISTRY
+ * ============================================================================
+ */
+static const imu_codec_t codec_raw8 = {
+    IMU_CODEC_RAW8, "raw8", false, false, raw8_encode, raw8_decode,
+};
+static const imu_codec_t codec_delta = {
+    IMU_CODEC_DELTA, "delta", false, false, delta_encode, delta_decode,
+};
+static const imu_codec_t codec_envelope = {
+    IMU_CODEC_ENVELOPE, "envelope", true, false, envelope_encode, envelope_decode,
+};
+static const imu_codec_t codec_rice = {
+    IMU_CODEC_RICE, "rice", false, false, rice_encode, rice_decode,
+};
+static const imu_codec_t codec_bfp8 = {
+    IMU_CODEC_BFP8, "bfp8", false, true, bfp8_encode, bfp8_decode,
+};
+static const imu_codec_t codec_bfp12 = {
+    IMU_CODEC_BFP12, "bfp12", false, true, bfp12_encode, bfp12_decode,
+};
+static const imu_codec_t codec_half = {
+    IMU_CODEC_HALF, "half", false, true, imu_half_encode, imu_half_decode,
+};
+
+// Try order: cheapest first (matters when the CPU budget runs out).
+// Lossy codecs only run when no lossless one fit, so they go last.
+static const imu_codec_t *const codec_registry[] = {
+    &codec_raw8,
+    &codec_delta,
+    &codec_envelope,
+    &codec_rice,
+    &codec_bfp8,
+    &codec_bfp12,
+    &codec_half,
+};
+
+#define CODEC_COUNT  (sizeof(codec_registry) / sizeof(codec_registry[0]))
+
+const imu_codec_t* imu_codec_find(uint8_t id)
+{
+    for (size_t i = 0; i < CODEC_COUNT; i++) {
+        if (codec_registry[i]->id == id) {
+            return codec_registry[i];
+        }
+    }
+    return NULL;
+}
+
+const imu_codec_t* const* imu_codec_list(size_t *count)
+{
+    *count = CODEC_COUNT;
+    return codec_registry;
+}
+
+/*
+ * ============================================================================
+ *                         SELECTOR
+ * ============================================================================
+ */
+void imu_codec_selector_init(imu_codec_selector_t *sel, const imu_codec_select_config_t *cfg)
+{
+    memset(sel, 0, sizeof(*sel));
+    sel->cfg = *cfg;
+    if (sel->cfg.precision == 0) {
+        sel->cfg.precision = 1;
+    }
+    if (sel->cfg.max_frame == 0 || sel->cfg.max_frame > IMU_CODEC_MAX_FRAME) {
+        sel->cfg.max_frame = IMU_CODEC_MAX_FRAME;
+    }
+}
+
+static void quantize(const imu_sample_t *in, uint8_t n, uint8_t q, imu_sample_t *out)
+{
+    if (q == 1) {
+        memcpy(out, in, n * sizeof(imu_sample_t));
+        return;
+    }
+    for (uint8_t i = 0; i < n; i++) {
+        for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+            int32_t v = in[i].v[a];
+            out[i].v[a] = (int16_t)((v >= 0) ? (v + q / 2) / q : (v - q / 2) / q);
+        }
+    }
+}
+
+// Selection tier: lossless beats lossy beats summary, whatever the size
+static int codec_tier(const imu_codec_t *c)
+{
+    return c->summary ? 2 : c->lossy ? 1 : 0;
+}
+
+static void write_header(uint8_t *out, uint8_t id, uint8_t q, uint8_t seq)
+{
+    out[0] = id & 0x0Fu;
+    out[1] = q;
+    out[2] = seq;
+}
+
+size_t imu_codec_select_encode(imu_codec_selector_t *sel, const imu_sample_t *in, uint8_t n,
+                               uint8_t *out, size_t cap, uint8_t *chosen)
+{
+    const imu_codec_select_config_t *cfg = &sel->cfg;
+    const size_t frame_cap = (cap < cfg->max_frame) ? cap : cfg->max_frame;
+    if (n == 0 || n > IMU_CODEC_MAX_BLOCK || frame_cap <= IMU_CODEC_HEADER_LEN) {
+        return 0;
+    }
+    const size_t limit = frame_cap - IMU_CODEC_HEADER_LEN;
+
+    quantize(in, n, cfg->precision, sel->quant);
+
+    size_t best_len = 0;
+    int best_id = -1;
+    int best_tier = 3;
+    uint32_t spent = 0;
+    bool ran_any = false;
+
+    for (size_t i = 0; i < CODEC_COUNT; i++) {
+        const imu_codec_t *c = codec_registry[i];
+        if (!(cfg->allowed_mask & IMU_CODEC_MASK(c->id))) {
+            continue;
+        }
+        // A lower tier only matters if nothing better has fit yet
+        const int tier = codec_tier(c);
+        if (tier > best_tier) {
+            continue;
+        }
+        if (ran_any && cfg->clock && cfg->cpu_budget &&
+            spent + sel->cost_avg[c->id] > cfg->cpu_budget) {
+            sel->budget_skips++;
+            continue;
+        }
+
+        uint32_t t0 = cfg->clock ? cfg->clock() : 0;
+        size_t len = c->encode(c->summary ? in : sel->quant, n, sel->scratch, limit);
+        if (cfg->clock) {
+            uint32_t dt = cfg->clock() - t0;
+            spent += dt;
+            // Running average, 1/8 weight for the new measurement
+            sel->cost_avg[c->id] = sel->cost_avg[c->id]
+                                 ? sel->cost_avg[c->id] - (sel->cost_avg[c->id] >> 3) + (dt >> 3)
+                                 : dt;
+        }
+        ran_any = true;
+        if (len == 0) {
+            continue;
+        }
+
+        // Better tier wins; within a tier, smaller wins
+        if (tier < best_tier || len < best_len) {
+            memcpy(out + IMU_CODEC_HEADER_LEN, sel->scratch, len);
+            best_len = len;
+            best_id = c->id;
+            best_tier = tier;
+        }
+    }
+
+    if (best_id < 0) {
+        return 0;
+    }
+    write_header(out, (uint8_t)best_id, cfg->precision, sel->seq++);
+    sel->wins[best_id]++;
+    if (chosen) {
+        *chosen = (uint8_t)best_id;
+    }
+    return IMU_CODEC_HEADER_LEN + best_len;
+}
+
+size_t imu_codec_encode_with(uint8_t codec_id, uint8_t precision, uint8_t seq,
+                             const imu_sample_t *in, uint8_t n, uint8_t *out, size_t cap)
+{
+    const imu_codec_t *c = imu_codec_find(codec_id);
+    imu_sample_t quant[IMU_CODEC_MAX_BLOCK];
+    if (!c || n == 0 || n > IMU_CODEC_MAX_BLOCK || cap <= IMU_CODEC_HEADER_LEN) {
+        return 0;
+    }
+    if (precision == 0) {
+        precision = 1;
+    }
+    quantize(in, n, precision, quant);
+    size_t len = c->encode(c->summary ? in : quant, n, out + IMU_CODEC_HEADER_LEN,
+                           cap - IMU_CODEC_HEADER_LEN);
+    if (len == 0) {
+        return 0;
+    }
+    write_header(out, codec_id, precision, seq);
+    return IMU_CODEC_HEADER_LEN + len;
+}
+
+size_t imu_codec_frame_decode(const uint8_t *in, size_t len, imu_sample_t *out, size_t cap,
+                              uint8_t *codec_id, uint8_t *seq)
+{
+    if (len <= IMU_CODEC_HEADER_LEN) {
+        return 0;
+    }
+    const imu_codec_t *c = imu_codec_find(in[0] & 0x0Fu);
+    const uint8_t q = in[1] ? in[1] : 1;
+    if (!c) {
+        return 0;
+    }
+
+    size_t n = c->decode(in + IMU_CODEC_HEADER_LEN, len - IMU_CODEC_HEADER_LEN, out, cap);
+    if (n && !c->summary && q != 1) {
+        for (size_t i = 0; i < n; i++) {
+            for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+                out[i].v[a] = imu_sat16((int32_t)out[i].v[a] * q);
+            }
+        }
+    }
+    if (n && codec_id) {
+        *codec_id = c->id;
+    }
+    if (n && seq) {
+        *seq = in[2];
+    }
+    return n;
+}
@@ -0,0 +1,56 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - RUNTIME STREAM CONFIGURATION
+ * ============================================================================
+ *
+ * See imu_config.h for the record layout.
+ */
+
+#include "imu_config.h"
+#include "imu_decimator.h"
+
+void imu_config_pack(const imu_config_t *c, uint8_t out[IMU_CONFIG_LEN])
+{
+    out[0] = c->id;
+    out[1] = c->period_ms;
+    out[2] = (uint8_t)c->publish_ms;
+    out[3] = (uint8_t)(c->publish_ms >> 8);
+    out[4] = (uint8_t)((c->mode & 0x0F) | ((c->decim & 0x01) << 4));
+    out[5] = c->block;
+    out[6] = c->axis_mask;
+    out[7] = c->codec;
+}
+
+bool imu_config_unpack(const uint8_t *in, size_t len, imu_config_t *c)
+{
+    if (len != IMU_CONFIG_LEN || (in[4] & 0xE0) != 0) {
+        return false;       // Reserved bits set: a newer format
+    }
+    c->id = in[0];
+    c->period_ms = in[1];
+    c->publish_ms = (uint16_t)(in[2] | (in[3] << 8));
+    c->mode = in[4] & 0x0F;
+    c->decim = (in[4] >> 4) & 0x01;
+    c->block = in[5];
+    c->axis_mask = in[6];
+    c->codec = in[7];
+    return true;
+}
+
+bool imu_config_check(const imu_config_t *c, uint8_t max_block)
+{
+    if (c->period_ms < IMU_CONFIG_MIN_PERIOD_MS || c->period_ms > IMU_CONFIG_MAX_PERIOD_MS) {
+        return false;
+    }
+    if (c->publish_ms % c->period_ms != 0) {
+        return false;
+    }
+    const uint32_t ratio = c->publish_ms / c->period_ms;
+    if (ratio < 1 || ratio > IMU_DECIM_MAX_RATIO) {
+        return false;
+    }
+    if (c->decim > IMU_DECIM_CIC || c->block < 1 || c->block > max_block) {
+        return false;
+    }
+    return c->axis_mask != 0 && (c->axis_mask & ~IMU_AXIS_MASK_ALL) == 0;
+}
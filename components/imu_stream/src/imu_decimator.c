@@ -0,0 +1,217 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - ANTI-ALIASING DECIMATOR
+ * ============================================================================
+ *
+ * See imu_decimator.h for the big picture. This file contains:
+ * - FIR design (windowed sinc, done once per configure, floating point)
+ * - Polyphase FIR kernel (integer, runs every R-th input)
+ * - CIC kernel (integer, adds only)
+ */
+
+#include "imu_decimator.h"
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/*
+ * ============================================================================
+ *                         FIR DESIGN
+ * ============================================================================
+ *
+ * Windowed-sinc low-pass with the cutoff at the OUTPUT Nyquist frequency:
+ *
+ *   fc = 0.5 / R   (cycles per input sample)
+ *
+ *   h[n] = 2fc * sinc(2fc * (n - M)) * hamming[n],   M = (N - 1) / 2
+ *
+ * Coefficients are quantized to Q15 and the rounding residual is folded
+ * into the centre tap so the taps sum to EXACTLY 32768. That gives unity
+ * DC gain: a device lying still reports exactly 1000 mg after filtering,
+ * not 998 mg.
+ *
+ * Floating point is fine here: this runs once per configure(), never in
+ * the sample path.
+ */
+static void design_fir(imu_decimator_t *d)
+{
+    const uint16_t n_taps = d->taps;
+    const double fc = 0.5 / (double)d->ratio;
+    const double m = (double)(n_taps - 1) / 2.0;
+    double h[IMU_DECIM_MAX_TAPS];
+    double sum = 0.0;
+
+    for (uint16_t n = 0; n < n_taps; n++) {
+        double x = 2.0 * fc * ((double)n - m);
+        double sinc = (fabs(x) < 1e-12) ? 1.0 : sin(M_PI * x) / (M_PI * x);
+        double w = 0.54 - 0.46 * cos(2.0 * M_PI * (double)n / (double)(n_taps - 1));
+        h[n] = 2.0 * fc * sinc * w;
+        sum += h[n];
+    }
+
+    int32_t qsum = 0;
+    for (uint16_t n = 0; n < n_taps; n++) {
+        d->coef[n] = (int16_t)lrint(h[n] / sum * 32768.0);
+        qsum += d->coef[n];
+    }
+    d->coef[n_taps / 2] += (int16_t)(32768 - qsum);
+}
+
+bool imu_decimator_configure(imu_decimator_t *d, imu_decim_mode_t mode, uint8_t ratio)
+{
+    if (ratio < 1 || ratio > IMU_DECIM_MAX_RATIO) {
+        return false;
+    }
+    if (mode != IMU_DECIM_FIR && mode != IMU_DECIM_CIC) {
+        return false;
+    }
+
+    memset(d, 0, sizeof(*d));
+    d->mode = mode;
+    d->ratio = ratio;
+
+    uint32_t taps = (uint32_t)ratio * IMU_DECIM_TAPS_PER_PHASE;
+    d->taps = (uint16_t)(taps > IMU_DECIM_MAX_TAPS ? IMU_DECIM_MAX_TAPS : taps);
+    design_fir(d);
+
+    // CIC gain is R^N (differential delay 1). Normalise with a 32.32 multiply
+    // instead of a divide: out = (acc * round(2^32 / R^3)) >> 32
+    uint64_t gain = (uint64_t)ratio * ratio * ratio;
+    d->cic_recip = (uint32_t)(((1ULL << 32) + gain / 2) / gain);
+
+    return true;
+}
+
+/*
+ * ============================================================================
+ *                         POLYPHASE FIR KERNEL
+ * ============================================================================
+ *
+ * Every input goes into the circular delay line (cheap copy). Only on the
+ * R-th input do we run the dot product over the whole line - the R-1
+ * outputs in between would be discarded anyway, so we never compute them.
+ *
+ * The circular line is walked as two contiguous runs (oldest..end, then
+ * start..newest) to keep the inner loop free of modulo operations.
+ *
+ * OVERFLOW:
+ * Coefficients sum to 32768 and the absolute sum stays below ~1.3 * 32768,
+ * so |acc| < 32767 * 1.3 * 32768 < 2^31. int32_t is enough.
+ */
+static inline void fir_mac_run(int32_t acc[IMU_AXIS_COUNT], const int16_t *coef,
+                               const imu_sample_t *hist, uint16_t count)
+{
+    for (uint16_t i = 0; i < count; i++) {
+        const int32_t c = coef[i];
+        const int16_t *v = hist[i].v;
+        acc[0] += c * v[0];
+        acc[1] += c * v[1];
+        acc[2] += c * v[2];
+        acc[3] += c * v[3];
+        acc[4] += c * v[4];
+        acc[5] += c * v[5];
+    }
+}
+
+static void fir_output(const imu_decimator_t *d, imu_sample_t *out)
+{
+    int32_t acc[IMU_AXIS_COUNT] = {0};
+
+    // pos is the oldest sample; coef[] is symmetric so oldest-first is fine
+    uint16_t first = d->taps - d->pos;
+    fir_mac_run(acc, d->coef, &d->hist[d->pos], first);
+    fir_mac_run(acc, d->coef + first, &d->hist[0], d->pos);
+
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        out->v[a] = imu_sat16((acc[a] + (1 << 14)) >> 15);
+    }
+}
+
+/*
+ * ============================================================================
+ *                         CIC KERNEL
+ * ============================================================================
+ *
+ * Integrators run at the input rate, combs at the output rate:
+ *
+ *   x --> [I] --> [I] --> [I] --> (keep every R-th) --> [C] --> [C] --> [C] --> y
+ *
+ * Integrators overflow by design. In two's complement the combs undo the
+ * wrap-around exactly, as long as the final result fits the register:
+ * 16 input bits + 3*log2(32) = 31 bits, so uint32_t is enough for R <= 32.
+ */
+static inline void cic_integrate(imu_decimator_t *d, const imu_sample_t *in)
+{
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        uint32_t *s = d->integ[a];
+        s[0] += (uint32_t)(int32_t)in->v[a];
+        s[1] += s[0];
+        s[2] += s[1];
+    }
+}
+
+static void cic_output(imu_decimator_t *d, imu_sample_t *out)
+{
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        uint32_t y = d->integ[a][IMU_DECIM_CIC_ORDER - 1];
+        for (int stage = 0; stage < IMU_DECIM_CIC_ORDER; stage++) {
+            uint32_t prev = d->comb[a][stage];
+            d->comb[a][stage] = y;
+            y -= prev;
+        }
+        int64_t scaled = (int64_t)(int32_t)y * d->cic_recip;
+        out->v[a] = imu_sat16((int32_t)((scaled + (1LL << 31)) >> 32));
+    }
+}
+
+/*
+ * ============================================================================
+ *                         PUBLIC API
+ * ============================================================================
+ */
+
+bool imu_decimator_push(imu_decimator_t *d, const imu_sample_t *in, imu_sample_t *out)
+{
+    if (d->ratio <= 1) {
+        *out = *in;
+        return true;
+    }
+
+    if (d->mode == IMU_DECIM_CIC) {
+        cic_integrate(d, in);
+    } else {
+        d->hist[d->pos] = *in;
+        if (++d->pos >= d->taps) {
+            d->pos = 0;
+        }
+    }
+
+    if (++d->phase < d->ratio) {
+        return false;
+    }
+    d->phase = 0;
+
+    if (d->mode == IMU_DECIM_CIC) {
+        cic_output(d, out);
+    } else {
+        fir_output(d, out);
+    }
+    return true;
+}
+
+size_t imu_decimator_process(imu_decimator_t *d, const imu_sample_t *in, size_t n,
+                             imu_sample_t *out, size_t out_cap)
+{
+    size_t produced = 0;
+    imu_sample_t y;
+
+    for (size_t i = 0; i < n; i++) {
+        if (imu_decimator_push(d, &in[i], &y) && produced < out_cap) {
+            out[produced++] = y;
+        }
+    }
+    return produced;
+}
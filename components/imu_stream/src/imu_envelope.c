@@ -0,0 +1,149 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - MIN/MAX ENVELOPE DOWNSAMPLING
+ * ============================================================================
+ *
+ * See imu_envelope.h for the frame layout. This file contains:
+ * - Streaming accumulator (one compare/compare/add per axis per sample)
+ * - Frame packing with conservative (round-up) spread quantization
+ * - Frame unpacking (used by the host decoder)
+ */
+
+#include "imu_envelope.h"
+
+static void envelope_reset(imu_envelope_t *e)
+{
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        e->min[a] = INT16_MAX;
+        e->max[a] = INT16_MIN;
+        e->sum[a] = 0;
+    }
+    e->count = 0;
+}
+
+void imu_envelope_init(imu_envelope_t *e, uint8_t window)
+{
+    e->window = window ? window : 1;
+    e->seq = 0;
+    envelope_reset(e);
+}
+
+// Round-to-nearest division for a signed sum and a positive count
+static int16_t div_round(int32_t sum, int32_t n)
+{
+    int32_t q = (sum >= 0) ? (sum + n / 2) / n : (sum - n / 2) / n;
+    return imu_sat16(q);
+}
+
+bool imu_envelope_push(imu_envelope_t *e, const imu_sample_t *in, imu_envelope_window_t *out)
+{
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        int16_t v = in->v[a];
+        if (v < e->min[a]) e->min[a] = v;
+        if (v > e->max[a]) e->max[a] = v;
+        e->sum[a] += v;
+    }
+
+    if (++e->count < e->window) {
+        return false;
+    }
+
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        out->min.v[a] = e->min[a];
+        out->max.v[a] = e->max[a];
+        out->mean.v[a] = div_round(e->sum[a], e->count);
+    }
+    out->count = e->count;
+    out->seq = e->seq++;
+    envelope_reset(e);
+    return true;
+}
+
+/*
+ * ============================================================================
+ *                         FRAME PACKING
+ * ============================================================================
+ *
+ * 1. Quantize each mean to int8 (100 units per LSB)
+ * 2. Measure each axis' distance from the QUANTIZED mean to its min/max
+ *    (measuring from the true mean would lose up to half a mean LSB)
+ * 3. Pick the smallest shift S where every distance fits 15 * (25 << S)
+ * 4. Quantize distances rounding UP, so the decoded envelope never shrinks
+ */
+
+static int8_t quant_mean(int16_t mean)
+{
+    int32_t q = div_round(mean, IMU_ENV_MEAN_LSB);
+    if (q > INT8_MAX) q = INT8_MAX;
+    if (q < INT8_MIN) q = INT8_MIN;
+    return (int8_t)q;
+}
+
+static uint8_t ceil_div(int32_t num, int32_t den)
+{
+    if (num <= 0) {
+        return 0;
+    }
+    int32_t q = (num + den - 1) / den;
+    return (uint8_t)(q > IMU_ENV_SPREAD_MAX ? IMU_ENV_SPREAD_MAX : q);
+}
+
+size_t imu_envelope_pack(const imu_envelope_window_t *w, uint8_t group, uint8_t *frame)
+{
+    const int first = group ? IMU_AXIS_GX : IMU_AXIS_AX;
+    int8_t mean_q[3];
+    int32_t dn[3], up[3];
+    int32_t widest = 0;
+
+    for (int i = 0; i < 3; i++) {
+        int a = first + i;
+        mean_q[i] = quant_mean(w->mean.v[a]);
+        int32_t centre = (int32_t)mean_q[i] * IMU_ENV_MEAN_LSB;
+        dn[i] = centre - w->min.v[a];
+        up[i] = w->max.v[a] - centre;
+        if (dn[i] > widest) widest = dn[i];
+        if (up[i] > widest) widest = up[i];
+    }
+
+    uint8_t shift = 0;
+    while (shift < IMU_ENV_MAX_SHIFT &&
+           widest > (int32_t)IMU_ENV_SPREAD_MAX * (IMU_ENV_SPREAD_LSB << shift)) {
+        shift++;
+    }
+    const int32_t unit = IMU_ENV_SPREAD_LSB << shift;
+
+    frame[0] = (uint8_t)(((group & 1u) << 7) | (shift << 4) | (w->seq & 0x0Fu));
+    for (int i = 0; i < 3; i++) {
+        frame[1 + 2 * i] = (uint8_t)mean_q[i];
+        frame[2 + 2 * i] = (uint8_t)((ceil_div(dn[i], unit) << 4) | ceil_div(up[i], unit));
+    }
+    frame[7] = w->count;
+    return IMU_ENV_FRAME_LEN;
+}
+
+bool imu_envelope_unpack(const uint8_t *frame, size_t len, imu_envelope_window_t *w, uint8_t *group)
+{
+    if (len != IMU_ENV_FRAME_LEN) {
+        return false;
+    }
+
+    const uint8_t g = frame[0] >> 7;
+    const uint8_t shift = (frame[0] >> 4) & 0x07u;
+    const int32_t unit = IMU_ENV_SPREAD_LSB << shift;
+    const int first = g ? IMU_AXIS_GX : IMU_AXIS_AX;
+
+    for (int i = 0; i < 3; i++) {
+        int a = first + i;
+        int32_t centre = (int32_t)(int8_t)frame[1 + 2 * i] * IMU_ENV_MEAN_LSB;
+        uint8_t s = frame[2 + 2 * i];
+        w->mean.v[a] = imu_sat16(centre);
+        w->min.v[a] = imu_sat16(centre - (int32_t)(s >> 4) * unit);
+        w->max.v[a] = imu_sat16(centre + (int32_t)(s & 0x0Fu) * unit);
+    }
+    w->seq = frame[0] & 0x0Fu;
+    w->count = frame[7];
+    if (group) {
+        *group = g;
+    }
+    return true;
+}
@@ -0,0 +1,191 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - CROSS-FRAME XOR PARITY (FEC)
+ * ============================================================================
+ *
+ * See imu_fec.h for the scheme and the parity opcode layout.
+ */
+
+#include <string.h>
+#include "imu_fec.h"
+
+// Supported group sizes, indexed by the 2 K bits of the parity op
+static const uint8_t fec_k_values[4] = { 2, 3, 4, 8 };
+
+uint32_t imu_fec_parity_op(uint8_t k, uint8_t gseq)
+{
+    for (uint8_t i = 0; i < 4; i++) {
+        if (fec_k_values[i] == k) {
+            return IMU_VENDOR_OP(0x20u | (i << 3) | (gseq & 0x07u));
+        }
+    }
+    return 0;
+}
+
+bool imu_fec_parity_opcode(uint32_t opcode, uint8_t *k, uint8_t *gseq)
+{
+    uint8_t hi = (uint8_t)(opcode >> 16);
+    if ((opcode & 0xFFFFu) != IMU_COMPANY_ID || (opcode >> 24) != 0 || (hi & 0xE0u) != 0xE0u) {
+        return false;
+    }
+    if (k) {
+        *k = fec_k_values[(hi >> 3) & 0x03u];
+    }
+    if (gseq) {
+        *gseq = hi & 0x07u;
+    }
+    return true;
+}
+
+const uint32_t* imu_fec_parity_opcodes(void)
+{
+    static uint32_t ops[IMU_FEC_PARITY_OPCODES];
+    if (ops[0] == 0) {
+        for (uint8_t i = 0; i < IMU_FEC_PARITY_OPCODES; i++) {
+            ops[i] = IMU_VENDOR_OP(0x20u | i);
+        }
+    }
+    return ops;
+}
+
+/*
+ * ============================================================================
+ *                         SENDER
+ * ============================================================================
+ */
+
+bool imu_fec_encoder_init(imu_fec_encoder_t *enc, uint8_t k)
+{
+    memset(enc, 0, sizeof(*enc));
+    if (k != 0 && imu_fec_parity_op(k, 0) == 0) {
+        return false;
+    }
+    enc->k = k;
+    return true;
+}
+
+// Drop a partial group. Skipping its sequence number makes the receiver
+// treat the frames it got from it as "parity lost" - no repair attempt.
+static void group_abandon(imu_fec_encoder_t *enc)
+{
+    if (enc->count > 0) {
+        enc->count = 0;
+        enc->gseq = (enc->gseq + 1) % IMU_FEC_GSEQ_MOD;
+    }
+}
+
+bool imu_fec_encoder_set_k(imu_fec_encoder_t *enc, uint8_t k)
+{
+    if (k != 0 && imu_fec_parity_op(k, 0) == 0) {
+        return false;
+    }
+    if (k != enc->k) {
+        group_abandon(enc);
+        enc->k = k;
+    }
+    return true;
+}
+
+size_t imu_fec_encode(imu_fec_encoder_t *enc, uint32_t opcode, const uint8_t *frame,
+                      size_t len, uint32_t *parity_op, uint8_t *parity)
+{
+    if (enc->k == 0 || len == 0 || len > IMU_FRAME_MAX) {
+        return 0;
+    }
+
+    // Mode change: the partial group can't be repaired, start over
+    if (opcode != enc->opcode) {
+        group_abandon(enc);
+    }
+    if (enc->count == 0) {
+        memset(enc->parity, 0, sizeof(enc->parity));
+        enc->len = 0;
+        enc->opcode = opcode;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        enc->parity[i] ^= frame[i];
+    }
+    if (len > enc->len) {
+        enc->len = (uint8_t)len;
+    }
+
+    if (++enc->count < enc->k) {
+        return 0;
+    }
+    *parity_op = imu_fec_parity_op(enc->k, enc->gseq);
+    memcpy(parity, enc->parity, enc->len);
+    enc->gseq = (enc->gseq + 1) % IMU_FEC_GSEQ_MOD;
+    enc->count = 0;
+    return enc->len;
+}
+
+/*
+ * ============================================================================
+ *                         RECEIVER
+ * ============================================================================
+ */
+
+static void group_reset(imu_fec_decoder_t *dec)
+{
+    dec->count = 0;
+    dec->len = 0;
+    memset(dec->acc, 0, sizeof(dec->acc));
+}
+
+void imu_fec_decoder_init(imu_fec_decoder_t *dec)
+{
+    memset(dec, 0, sizeof(*dec));
+    dec->last_gseq = -1;
+}
+
+size_t imu_fec_decode(imu_fec_decoder_t *dec, uint32_t opcode, const uint8_t *frame,
+                      size_t len, uint32_t *rec_op, uint8_t *rec)
+{
+    uint8_t k, gseq;
+    if (!imu_fec_parity_opcode(opcode, &k, &gseq)) {
+        // Data frame: fold into the current group
+        if (len == 0 || len > IMU_FRAME_MAX) {
+            return 0;
+        }
+        if (opcode != dec->opcode) {
+            group_reset(dec);
+            dec->opcode = opcode;
+        }
+        for (size_t i = 0; i < len; i++) {
+            dec->acc[i] ^= frame[i];
+        }
+        if (len > dec->len) {
+            dec->len = (uint8_t)len;
+        }
+        dec->count++;
+        return 0;
+    }
+
+    // Parity frame: closes the group. Parities lost in between mean our
+    // frames span 'groups' groups - fine if none is missing, but a repair
+    // is only possible within a single group.
+    uint8_t lost_parities = (dec->last_gseq < 0) ? 0 :
+        (uint8_t)((gseq - dec->last_gseq - 1 + IMU_FEC_GSEQ_MOD) % IMU_FEC_GSEQ_MOD);
+    uint32_t groups = lost_parities + 1u;
+    dec->last_gseq = (int8_t)gseq;
+    size_t out = 0;
+
+    if (len == 0 || len > IMU_FRAME_MAX || dec->opcode == 0) {
+        dec->unrecoverable++;
+    } else if (dec->count == groups * k) {
+        dec->groups_ok += groups;
+    } else if (groups == 1 && dec->count + 1 == k) {
+        for (size_t i = 0; i < len; i++) {
+            rec[i] = dec->acc[i] ^ frame[i];
+        }
+        *rec_op = dec->opcode;
+        out = len;
+        dec->recovered++;
+    } else {
+        dec->unrecoverable++;
+    }
+
+    group_reset(dec);
+    return out;
+}
@@ -0,0 +1,233 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - HALF-FLOAT AND BLOCK-FLOATING-POINT FORMATS
+ * ============================================================================
+ *
+ * See imu_float.h for the formats and payload layouts.
+ */
+
+#include "imu_float.h"
+
+/*
+ * ============================================================================
+ *                         BINARY16 KERNELS
+ * ============================================================================
+ *
+ * A normal binary16 with biased exponent E and 10-bit fraction M is
+ * (1024 + M) × 2^(E - 25). Converting an integer is finding its top bit
+ * p (E = p + 15) and keeping the 11 bits below and including it.
+ */
+
+uint16_t imu_half_from_int(int32_t v)
+{
+    const uint16_t sign = (v < 0) ? 0x8000u : 0;
+    uint32_t a = (v < 0) ? 0u - (uint32_t)v : (uint32_t)v;
+
+    if (a == 0) {
+        return sign;
+    }
+    if (a >= 65520u) {          // Rounds to 2^16 = infinity
+        return sign | 0x7BFFu;
+    }
+
+    int p = 0;
+    while ((a >> (p + 1)) != 0) {
+        p++;
+    }
+
+    uint32_t mant;              // 11 bits, top bit = implicit 1
+    if (p <= 10) {
+        mant = a << (10 - p);
+    } else {
+        const int shift = p - 10;
+        const uint32_t rem = a & ((1u << shift) - 1u);
+        const uint32_t half = 1u << (shift - 1);
+        mant = a >> shift;
+        if (rem > half || (rem == half && (mant & 1u))) {
+            mant++;
+            if (mant == 2048u) {    // Rounded up to the next power of two
+                mant = 1024u;
+                p++;
+            }
+        }
+    }
+    return sign | (uint16_t)((p + 15) << 10) | (uint16_t)(mant - 1024u);
+}
+
+int32_t imu_half_to_int(uint16_t h)
+{
+    const bool neg = (h & 0x8000u) != 0;
+    const int exp = (h >> 10) & 0x1F;
+    const uint32_t frac = h & 0x03FFu;
+    uint32_t a;
+
+    if (exp == 0x1F) {
+        if (frac) {
+            return 0;               // NaN
+        }
+        a = IMU_HALF_MAX;           // Infinity
+    } else if (exp == 0) {
+        a = 0;                      // Subnormals are all below 2^-14
+    } else {
+        const uint32_t mant = frac | 0x0400u;
+        const int e = exp - 25;
+        if (e >= 0) {
+            a = mant << e;
+        } else {
+            const int shift = -e;
+            a = (mant + (1u << (shift - 1))) >> shift;
+        }
+    }
+    return neg ? -(int32_t)a : (int32_t)a;
+}
+
+size_t imu_half_encode(const imu_sample_t *in, uint8_t n, uint8_t *out, size_t cap)
+{
+    const size_t len = 1 + (size_t)n * IMU_AXIS_COUNT * 2;
+    if (n == 0 || len > cap) {
+        return 0;
+    }
+    out[0] = n;
+    uint8_t *p = out + 1;
+    for (uint8_t i = 0; i < n; i++) {
+        for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+            uint16_t h = imu_half_from_int(in[i].v[a]);
+            *p++ = (uint8_t)h;
+            *p++ = (uint8_t)(h >> 8);
+        }
+    }
+    return len;
+}
+
+size_t imu_half_decode(const uint8_t *in, size_t len, imu_sample_t *out, size_t cap)
+{
+    if (len < 1 || in[0] == 0 || in[0] > cap ||
+        len != 1 + (size_t)in[0] * IMU_AXIS_COUNT * 2) {
+        return 0;
+    }
+    const uint8_t *p = in + 1;
+    for (uint8_t i = 0; i < in[0]; i++) {
+        for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+            out[i].v[a] = imu_sat16(imu_half_to_int((uint16_t)(p[0] | (p[1] << 8))));
+            p += 2;
+        }
+    }
+    return in[0];
+}
+
+/*
+ * ============================================================================
+ *                         BLOCK FLOATING POINT
+ * ============================================================================
+ */
+
+// round(v / 2^e), halves rounded up (monotonic, so min/max bound the batch)
+static inline int32_t bfp_scale(int32_t v, uint8_t e)
+{
+    return e ? (v + (1 << (e - 1))) >> e : v;
+}
+
+uint8_t imu_bfp_exponent(const imu_sample_t *in, uint8_t n, int axis, uint8_t bits)
+{
+    const int32_t hi = (1 << (bits - 1)) - 1;
+    const int32_t lo = -(1 << (bits - 1));
+    int32_t vmin = 0, vmax = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        int32_t v = in[i].v[axis];
+        if (v < vmin) vmin = v;
+        if (v > vmax) vmax = v;
+    }
+    uint8_t e = 0;
+    while (e < IMU_BFP_MAX_EXP && (bfp_scale(vmax, e) > hi || bfp_scale(vmin, e) < lo)) {
+        e++;
+    }
+    return e;
+}
+
+static inline int32_t bfp_sat(int32_t m, uint8_t bits)
+{
+    const int32_t hi = (1 << (bits - 1)) - 1;
+    const int32_t lo = -(1 << (bits - 1));
+    return (m > hi) ? hi : (m < lo) ? lo : m;
+}
+
+static size_t bfp_len(uint8_t n, uint8_t bits)
+{
+    return IMU_BFP_HEADER_LEN + ((size_t)n * IMU_AXIS_COUNT * bits + 7) / 8;
+}
+
+size_t imu_bfp_encode(const imu_sample_t *in, uint8_t n, uint8_t bits,
+                      uint8_t *out, size_t cap)
+{
+    if (n == 0 || (bits != 8 && bits != 12) || bfp_len(n, bits) > cap) {
+        return 0;
+    }
+
+    uint8_t exps[IMU_AXIS_COUNT];
+    out[0] = n;
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        exps[a] = imu_bfp_exponent(in, n, a, bits);
+    }
+    for (int a = 0; a < IMU_AXIS_COUNT; a += 2) {
+        out[1 + a / 2] = (uint8_t)(exps[a] | (exps[a + 1] << 4));
+    }
+
+    uint8_t *p = out + IMU_BFP_HEADER_LEN;
+    bool odd = false;               // BFP12: a half-written 3-byte pair is open
+    for (uint8_t i = 0; i < n; i++) {
+        for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+            uint32_t m = (uint32_t)bfp_sat(bfp_scale(in[i].v[a], exps[a]), bits);
+            if (bits == 8) {
+                *p++ = (uint8_t)m;
+            } else if (!odd) {
+                p[0] = (uint8_t)m;
+                p[1] = (uint8_t)((m >> 8) & 0x0Fu);
+                odd = true;
+            } else {
+                p[1] |= (uint8_t)((m & 0x0Fu) << 4);
+                p[2] = (uint8_t)(m >> 4);
+                p += 3;
+                odd = false;
+            }
+        }
+    }
+    return bfp_len(n, bits);
+}
+
+size_t imu_bfp_decode(const uint8_t *in, size_t len, uint8_t bits,
+                      imu_sample_t *out, size_t cap)
+{
+    if ((bits != 8 && bits != 12) || len < IMU_BFP_HEADER_LEN || in[0] == 0 ||
+        in[0] > cap || len != bfp_len(in[0], bits)) {
+        return 0;
+    }
+
+    uint8_t exps[IMU_AXIS_COUNT];
+    for (int a = 0; a < IMU_AXIS_COUNT; a += 2) {
+        exps[a] = in[1 + a / 2] & 0x0Fu;
+        exps[a + 1] = in[1 + a / 2] >> 4;
+    }
+
+    const uint8_t *p = in + IMU_BFP_HEADER_LEN;
+    bool odd = false;
+    for (uint8_t i = 0; i < in[0]; i++) {
+        for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+            int32_t m;
+            if (bits == 8) {
+                m = (int8_t)*p++;
+            } else if (!odd) {
+                m = p[0] | ((p[1] & 0x0F) << 8);
+                odd = true;
+            } else {
+                m = (p[1] >> 4) | (p[2] << 4);
+                p += 3;
+                odd = false;
+            }
+            if (bits == 12 && (m & 0x800)) {
+                m -= 0x1000;        // Sign-extend 12 bits
+            }
+            out[i].v[a] = imu_sat16(m * (1 << exps[a]));
+        }
+    }
+    return in[0];
+}
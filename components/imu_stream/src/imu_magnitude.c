@@ -0,0 +1,87 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - ROTATION-INVARIANT MAGNITUDE FRAMES
+ * ============================================================================
+ *
+ * See imu_magnitude.h for the frame layout and why windows send peaks.
+ */
+
+#include "imu_magnitude.h"
+
+uint16_t imu_isqrt32(uint32_t x)
+{
+    // Bit-by-bit: try each result bit from the top, keep it if root² ≤ x
+    uint32_t root = 0;
+    uint32_t bit = 1u << 30;
+    while (bit > x) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (x >= root + bit) {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint16_t)root;
+}
+
+static uint32_t sum_sq3(const int16_t *v)
+{
+    return (uint32_t)((int32_t)v[0] * v[0]) + (uint32_t)((int32_t)v[1] * v[1]) +
+           (uint32_t)((int32_t)v[2] * v[2]);
+}
+
+void imu_mag_peak(const imu_sample_t *s, size_t n, imu_mag_t *peak)
+{
+    // Compare squares; one square root per channel per call
+    uint32_t a2 = (uint32_t)peak->accel * peak->accel;
+    uint32_t g2 = (uint32_t)peak->gyro * peak->gyro;
+    for (size_t i = 0; i < n; i++) {
+        const uint32_t sa = sum_sq3(&s[i].v[IMU_AXIS_AX]);
+        const uint32_t sg = sum_sq3(&s[i].v[IMU_AXIS_GX]);
+        if (sa > a2) a2 = sa;
+        if (sg > g2) g2 = sg;
+    }
+    peak->accel = imu_isqrt32(a2);
+    peak->gyro = imu_isqrt32(g2);
+}
+
+static uint8_t to_step(uint16_t v)
+{
+    const uint32_t q = ((uint32_t)v + IMU_MAG_STEP / 2) / IMU_MAG_STEP;
+    return (uint8_t)(q > 255 ? 255 : q);
+}
+
+size_t imu_mag_pack(uint16_t t_ms, const imu_mag_t *w, uint8_t n, uint8_t out[IMU_MAG_FRAME_MAX])
+{
+    if (n == 0 || n > IMU_MAG_WINDOWS) {
+        return 0;
+    }
+    const uint16_t t = t_ms % IMU_MAG_TIME_WRAP_MS;
+    out[0] = (uint8_t)t;
+    out[1] = (uint8_t)(t >> 8);
+    for (uint8_t i = 0; i < n; i++) {
+        out[IMU_MAG_HEADER_LEN + 2 * i] = to_step(w[i].accel);
+        out[IMU_MAG_HEADER_LEN + 2 * i + 1] = to_step(w[i].gyro);
+    }
+    return IMU_MAG_HEADER_LEN + 2u * n;
+}
+
+uint8_t imu_mag_unpack(const uint8_t *in, size_t len, uint16_t *t_ms, imu_mag_t *w)
+{
+    if (len < IMU_MAG_HEADER_LEN + 2 || len > IMU_MAG_FRAME_MAX || (len & 1) || (in[1] & 0xF0)) {
+        return 0;
+    }
+    const uint8_t n = (uint8_t)((len - IMU_MAG_HEADER_LEN) / 2);
+    for (uint8_t i = 0; i < n; i++) {
+        w[i].accel = (uint16_t)(in[IMU_MAG_HEADER_LEN + 2 * i] * IMU_MAG_STEP);
+        w[i].gyro = (uint16_t)(in[IMU_MAG_HEADER_LEN + 2 * i + 1] * IMU_MAG_STEP);
+    }
+    if (t_ms) {
+        *t_ms = (uint16_t)(in[0] | (in[1] << 8));
+    }
+    return n;
+}
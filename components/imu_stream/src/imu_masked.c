@@ -0,0 +1,96 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - CHANNEL-MASKED VARIABLE-LENGTH FRAMES
+ * ============================================================================
+ *
+ * See imu_masked.h for the frame layout.
+ */
+
+#include <string.h>
+#include "imu_masked.h"
+
+uint8_t imu_mask_channels(uint8_t mask, uint8_t axes[IMU_AXIS_COUNT])
+{
+    if (mask & ~((1u << IMU_AXIS_COUNT) - 1)) {
+        return 0;
+    }
+    uint8_t k = 0;
+    for (uint8_t a = 0; a < IMU_AXIS_COUNT; a++) {
+        if (mask & (1u << a)) {
+            if (axes) {
+                axes[k] = a;
+            }
+            k++;
+        }
+    }
+    return k;
+}
+
+uint8_t imu_masked_capacity(uint8_t mask)
+{
+    const uint8_t k = imu_mask_channels(mask, NULL);
+    return k ? (uint8_t)((IMU_FRAME_MAX - IMU_MASKED_HEADER_LEN) / k) : 0;
+}
+
+// Round to the nearest step and saturate (the legacy frame truncates and wraps)
+static int8_t to_step(int16_t v)
+{
+    int32_t q = (v >= 0) ? (v + IMU_MASKED_STEP / 2) / IMU_MASKED_STEP
+                         : -((-v + IMU_MASKED_STEP / 2) / IMU_MASKED_STEP);
+    if (q > 127) q = 127;
+    if (q < -127) q = -127;
+    return (int8_t)q;
+}
+
+size_t imu_masked_pack(uint8_t mask, uint16_t t_ms, const imu_sample_t *s, uint8_t n,
+                       uint8_t *out, size_t cap)
+{
+    uint8_t axes[IMU_AXIS_COUNT];
+    const uint8_t k = imu_mask_channels(mask, axes);
+    if (k == 0 || n == 0 || n > imu_masked_capacity(mask)) {
+        return 0;
+    }
+    const size_t len = IMU_MASKED_HEADER_LEN + (size_t)n * k;
+    if (cap < len) {
+        return 0;
+    }
+    const uint16_t t = (uint16_t)((t_ms / IMU_MASKED_TIME_UNIT_MS) & 0x3FF);
+    out[0] = (uint8_t)(mask | ((t >> 8) << 6));
+    out[1] = (uint8_t)t;
+    uint8_t *p = out + IMU_MASKED_HEADER_LEN;
+    for (uint8_t i = 0; i < n; i++) {
+        for (uint8_t c = 0; c < k; c++) {
+            *p++ = (uint8_t)to_step(s[i].v[axes[c]]);
+        }
+    }
+    return len;
+}
+
+uint8_t imu_masked_unpack(const uint8_t *in, size_t len, uint8_t *mask, uint16_t *t_ms,
+                          imu_sample_t *s)
+{
+    if (len <= IMU_MASKED_HEADER_LEN || len > IMU_FRAME_MAX) {
+        return 0;
+    }
+    uint8_t axes[IMU_AXIS_COUNT];
+    const uint8_t m = in[0] & 0x3F;
+    const uint8_t k = imu_mask_channels(m, axes);
+    if (k == 0 || (len - IMU_MASKED_HEADER_LEN) % k != 0) {
+        return 0;
+    }
+    const uint8_t n = (uint8_t)((len - IMU_MASKED_HEADER_LEN) / k);
+    const uint8_t *p = in + IMU_MASKED_HEADER_LEN;
+    for (uint8_t i = 0; i < n; i++) {
+        memset(&s[i], 0, sizeof(s[i]));
+        for (uint8_t c = 0; c < k; c++) {
+            s[i].v[axes[c]] = (int16_t)((int8_t)*p++ * IMU_MASKED_STEP);
+        }
+    }
+    if (mask) {
+        *mask = m;
+    }
+    if (t_ms) {
+        *t_ms = (uint16_t)((((in[0] >> 6) << 8) | in[1]) * IMU_MASKED_TIME_UNIT_MS);
+    }
+    return n;
+}
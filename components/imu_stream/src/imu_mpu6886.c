@@ -0,0 +1,105 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - MPU6886 REGISTER-LEVEL DRIVER
+ * ============================================================================
+ *
+ * See imu_mpu6886.h.
+ */
+
+#include "imu_mpu6886.h"
+
+int32_t imu_accel_full_scale(imu_range_t r)
+{
+    return 2000 << (r & 0x03u);     // mg
+}
+
+int32_t imu_gyro_full_scale(imu_range_t r)
+{
+    return 2500 << (r & 0x03u);     // 0.1 dps
+}
+
+// counts × full_scale / 32768, rounded to nearest
+static int16_t scale_counts(int16_t counts, int32_t full_scale)
+{
+    int32_t p = (int32_t)counts * full_scale;
+    return imu_sat16((p >= 0) ? (p + 16384) >> 15 : -((-p + 16384) >> 15));
+}
+
+// counts / 326.8 + 25 °C, in 0.1 °C
+static int16_t temp_counts_to_c10(int16_t counts)
+{
+    int32_t p = (int32_t)counts * 100;
+    return (int16_t)(250 + ((p >= 0) ? (p + 1634) / 3268 : -((-p + 1634) / 3268)));
+}
+
+static bool update_fs(imu_mpu6886_t *dev, uint8_t reg, imu_range_t r)
+{
+    uint8_t v;
+    if (dev->bus.read(dev->bus.ctx, reg, &v, 1) != 0) {
+        return false;
+    }
+    v = (uint8_t)((v & ~IMU_MPU6886_FS_MASK) | ((r & 0x03u) << IMU_MPU6886_FS_SHIFT));
+    return dev->bus.write(dev->bus.ctx, reg, v) == 0;
+}
+
+bool imu_mpu6886_init(imu_mpu6886_t *dev, const imu_reg_bus_t *bus)
+{
+    uint8_t who, gyro_cfg, accel_cfg;
+    dev->bus = *bus;
+    if (bus->read(bus->ctx, IMU_MPU6886_REG_WHO_AM_I, &who, 1) != 0 ||
+        who != IMU_MPU6886_WHO_AM_I_VALUE ||
+        bus->read(bus->ctx, IMU_MPU6886_REG_GYRO_CONFIG, &gyro_cfg, 1) != 0 ||
+        bus->read(bus->ctx, IMU_MPU6886_REG_ACCEL_CONFIG, &accel_cfg, 1) != 0) {
+        return false;
+    }
+    dev->gyro_range = (gyro_cfg & IMU_MPU6886_FS_MASK) >> IMU_MPU6886_FS_SHIFT;
+    dev->accel_range = (accel_cfg & IMU_MPU6886_FS_MASK) >> IMU_MPU6886_FS_SHIFT;
+    dev->temp_c10 = 250;
+    return true;
+}
+
+bool imu_mpu6886_set_range(imu_mpu6886_t *dev, imu_range_t accel, imu_range_t gyro)
+{
+    if (accel != dev->accel_range) {
+        if (!update_fs(dev, IMU_MPU6886_REG_ACCEL_CONFIG, accel)) {
+            return false;
+        }
+        dev->accel_range = accel & 0x03u;
+    }
+    if (gyro != dev->gyro_range) {
+        if (!update_fs(dev, IMU_MPU6886_REG_GYRO_CONFIG, gyro)) {
+            return false;
+        }
+        dev->gyro_range = gyro & 0x03u;
+    }
+    return true;
+}
+
+bool imu_mpu6886_read(imu_mpu6886_t *dev, imu_sample_t *out)
+{
+    uint8_t raw[IMU_MPU6886_DATA_LEN];
+    if (dev->bus.read(dev->bus.ctx, IMU_MPU6886_REG_ACCEL_XOUT_H, raw, sizeof(raw)) != 0) {
+        return false;
+    }
+    const int32_t afs = imu_accel_full_scale(dev->accel_range);
+    const int32_t gfs = imu_gyro_full_scale(dev->gyro_range);
+    for (int a = 0; a < 3; a++) {
+        int16_t acc = (int16_t)((raw[2 * a] << 8) | raw[2 * a + 1]);
+        int16_t gyr = (int16_t)((raw[8 + 2 * a] << 8) | raw[8 + 2 * a + 1]);
+        out->v[IMU_AXIS_AX + a] = scale_counts(acc, afs);
+        out->v[IMU_AXIS_GX + a] = scale_counts(gyr, gfs);
+    }
+    dev->temp_c10 = temp_counts_to_c10((int16_t)((raw[6] << 8) | raw[7]));
+    return true;
+}
+
+bool imu_mpu6886_read_temp(imu_mpu6886_t *dev, int16_t *temp_c10)
+{
+    uint8_t raw[2];
+    if (dev->bus.read(dev->bus.ctx, IMU_MPU6886_REG_TEMP_OUT_H, raw, sizeof(raw)) != 0) {
+        return false;
+    }
+    dev->temp_c10 = temp_counts_to_c10((int16_t)((raw[0] << 8) | raw[1]));
+    *temp_c10 = dev->temp_c10;
+    return true;
+}
@@ -0,0 +1,373 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - PREDICTIVE BIT-PLANE PACKED FRAMES
+ * ============================================================================
+ *
+ * See imu_packed.h for the frame layout. This file contains:
+ * - The bit-plane kernels: scalar reference and 8×8 transpose
+ * - Residuals, widths and the per-frame order choice
+ * - The greedy stream encoder and the decoder
+ */
+
+#include <string.h>
+#include "imu_packed.h"
+
+/*
+ * ============================================================================
+ *                         BIT-PLANE KERNELS
+ * ============================================================================
+ */
+
+void imu_pack_planes_ref(imu_bitwriter_t *bw, const uint16_t *u, uint8_t m, uint8_t w)
+{
+    for (int p = (int)w - 1; p >= 0; p--) {
+        for (uint8_t i = 0; i < m; i++) {
+            imu_bw_put(bw, (u[i] >> p) & 1u, 1);
+        }
+    }
+}
+
+void imu_unpack_planes_ref(imu_bitreader_t *br, uint16_t *u, uint8_t m, uint8_t w)
+{
+    memset(u, 0, sizeof(*u) * m);
+    for (int p = (int)w - 1; p >= 0; p--) {
+        for (uint8_t i = 0; i < m; i++) {
+            u[i] |= (uint16_t)(imu_br_get(br, 1) << p);
+        }
+    }
+}
+
+/*
+ * 8×8 bit-matrix transpose (Hacker's Delight 7-3). Row j is byte 7-j of
+ * the word (row 0 = most significant byte), column c is bit 7-c of a row.
+ * Loaded with value j in row j, the result holds bit p of all 8 values in
+ * byte p, value 0 in its top bit - exactly one plane in stream order.
+ * The transpose is its own inverse.
+ */
+static uint64_t transpose8(uint64_t x)
+{
+    uint64_t t;
+    t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAull;
+    x = x ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCull;
+    x = x ^ t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ull;
+    x = x ^ t ^ (t << 28);
+    return x;
+}
+
+#define PLANE_GROUPS    ((IMU_PACK_MAX_VALUES + 7) / 8)
+
+void imu_pack_planes(imu_bitwriter_t *bw, const uint16_t *u, uint8_t m, uint8_t w)
+{
+    if (m == 0 || w == 0) {
+        return;
+    }
+    // Transpose each group of 8 values: low bits 0-7, high bits 8+ if needed
+    const uint8_t groups = (uint8_t)((m + 7) / 8);
+    uint64_t lo[PLANE_GROUPS], hi[PLANE_GROUPS];
+    for (uint8_t g = 0; g < groups; g++) {
+        const uint8_t last = (uint8_t)((m - g * 8 < 8) ? m - g * 8 : 8);
+        uint64_t xl = 0, xh = 0;
+        for (uint8_t j = 0; j < last; j++) {
+            const uint16_t v = u[g * 8 + j];
+            xl = (xl << 8) | (v & 0xFF);
+            xh = (xh << 8) | (v >> 8);
+        }
+        xl <<= 8 * (8 - last);          // Missing values of the last group are 0
+        xh <<= 8 * (8 - last);
+        lo[g] = transpose8(xl);
+        hi[g] = (w > 8) ? transpose8(xh) : 0;
+    }
+    // One writer call per plane: the group bytes side by side, m ≤ 24 bits
+    const uint8_t pad = (uint8_t)(groups * 8 - m);
+    for (int p = (int)w - 1; p >= 0; p--) {
+        const uint64_t *t = (p >= 8) ? hi : lo;
+        const uint8_t shift = (uint8_t)(8 * (p & 7));
+        uint32_t word = 0;
+        for (uint8_t g = 0; g < groups; g++) {
+            word = (word << 8) | (uint32_t)((t[g] >> shift) & 0xFF);
+        }
+        imu_bw_put(bw, word >> pad, m);
+    }
+}
+
+void imu_unpack_planes(imu_bitreader_t *br, uint16_t *u, uint8_t m, uint8_t w)
+{
+    if (m == 0) {
+        return;
+    }
+    const uint8_t groups = (uint8_t)((m + 7) / 8);
+    const uint8_t pad = (uint8_t)(groups * 8 - m);
+    uint64_t lo[PLANE_GROUPS] = { 0 }, hi[PLANE_GROUPS] = { 0 };
+    for (int p = (int)w - 1; p >= 0; p--) {
+        uint64_t *t = (p >= 8) ? hi : lo;
+        const uint8_t shift = (uint8_t)(8 * (p & 7));
+        const uint32_t word = imu_br_get(br, m) << pad;
+        for (uint8_t g = 0; g < groups; g++) {
+            t[g] |= (uint64_t)((word >> (8 * (groups - 1 - g))) & 0xFF) << shift;
+        }
+    }
+    for (uint8_t g = 0; g < groups; g++) {
+        const uint64_t xl = transpose8(lo[g]);
+        const uint64_t xh = (w > 8) ? transpose8(hi[g]) : 0;
+        for (uint8_t j = 0; j < 8 && g * 8 + j < m; j++) {
+            u[g * 8 + j] = (uint16_t)(((xl >> (8 * (7 - j))) & 0xFF) |
+                                      (((xh >> (8 * (7 - j))) & 0xFF) << 8));
+        }
+    }
+}
+
+/*
+ * ============================================================================
+ *                         RESIDUALS AND WIDTHS
+ * ============================================================================
+ */
+
+typedef struct {
+    uint8_t order;                          // 1 or 2
+    uint8_t wa, wg;                         // Plane counts per sensor
+    uint8_t m;                              // Residuals per sensor (3 per sample)
+    uint16_t ua[IMU_PACK_MAX_VALUES];
+    uint16_t ug[IMU_PACK_MAX_VALUES];
+} frame_plan_t;
+
+// Round to the nearest step and saturate, as imu_masked.c
+static int8_t to_step(int16_t v)
+{
+    int32_t q = (v >= 0) ? (v + IMU_PACK_STEP / 2) / IMU_PACK_STEP
+                         : -((-v + IMU_PACK_STEP / 2) / IMU_PACK_STEP);
+    if (q > 127) q = 127;
+    if (q < -127) q = -127;
+    return (int8_t)q;
+}
+
+// Smallest width holding every value: one OR, one count-leading-zeros
+static uint8_t width_of(const uint16_t *u, uint8_t m)
+{
+    uint32_t any = 0;
+    for (uint8_t i = 0; i < m; i++) {
+        any |= u[i];
+    }
+    return any ? (uint8_t)(32 - __builtin_clz(any)) : 0;
+}
+
+/*
+ * Zigzagged residuals of n samples x[] for one predictor order. 'hist'
+ * holds the hist_n samples before x[0], newest first; a key frame sends
+ * x[0] raw and predicts the rest from it alone.
+ */
+static void residuals(const int8_t hist[2][IMU_AXIS_COUNT], uint8_t hist_n, bool key,
+                      const int8_t (*x)[IMU_AXIS_COUNT], uint8_t n, uint8_t order,
+                      frame_plan_t *p)
+{
+    // s[2 + i] = x[i], s[1] / s[0] = history; 'valid' = first usable index
+    int8_t s[2 + IMU_PACK_MAX_SAMPLES][IMU_AXIS_COUNT];
+    memcpy(s[0], hist[1], IMU_AXIS_COUNT);
+    memcpy(s[1], hist[0], IMU_AXIS_COUNT);
+    memcpy(s[2], x, (size_t)n * IMU_AXIS_COUNT);
+    const uint8_t valid = key ? 2 : (uint8_t)(2 - hist_n);
+    const uint8_t start = key ? 3 : 2;
+
+    p->order = order;
+    p->m = 0;
+    for (uint8_t k = start; k < 2 + n; k++) {
+        const bool second = (order == 2) && (k - valid >= 2);
+        for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+            const int32_t pred = second ? 2 * s[k - 1][a] - s[k - 2][a] : s[k - 1][a];
+            const uint16_t u = (uint16_t)imu_zigzag(s[k][a] - pred);
+            if (a < IMU_AXIS_GX) {
+                p->ua[p->m + a] = u;
+            } else {
+                p->ug[p->m + a - IMU_AXIS_GX] = u;
+            }
+        }
+        p->m += 3;
+    }
+    p->wa = width_of(p->ua, p->m);
+    p->wg = width_of(p->ug, p->m);
+}
+
+static size_t plan_len(const frame_plan_t *p, bool key)
+{
+    const uint32_t bits = (uint32_t)p->m * (p->wa + p->wg);
+    return IMU_PACK_HEADER_LEN + (key ? IMU_AXIS_COUNT : 0) + (bits + 7) / 8;
+}
+
+// Cheaper of the two orders (ties → order 1); returns the frame length
+static size_t plan_frame(const imu_pack_encoder_t *enc, uint8_t n, bool key, frame_plan_t *p)
+{
+    frame_plan_t p2;
+    residuals(enc->hist, enc->hist_n, key, enc->pend, n, 1, p);
+    residuals(enc->hist, enc->hist_n, key, enc->pend, n, 2, &p2);
+    if (p2.wa + p2.wg < p->wa + p->wg) {
+        *p = p2;
+    }
+    return plan_len(p, key);
+}
+
+/*
+ * ============================================================================
+ *                         ENCODER
+ * ============================================================================
+ */
+void imu_pack_encoder_init(imu_pack_encoder_t *enc, uint8_t key_interval, uint8_t max_samples)
+{
+    memset(enc, 0, sizeof(*enc));
+    enc->key_interval = key_interval ? key_interval : 1;
+    enc->max_samples = max_samples < 1 ? 1
+                     : (max_samples > IMU_PACK_MAX_SAMPLES ? IMU_PACK_MAX_SAMPLES : max_samples);
+}
+
+// Pack the first n pending samples, then advance history / sequence
+static size_t emit(imu_pack_encoder_t *enc, uint8_t n, uint8_t out[IMU_FRAME_MAX])
+{
+    frame_plan_t p;
+    const size_t len = plan_frame(enc, n, enc->key, &p);
+
+    out[0] = (uint8_t)((enc->key ? 0x80 : 0) | (enc->seq << 4) | ((n - 1) << 1) | (p.order - 1));
+    out[1] = (uint8_t)((p.wa << 4) | p.wg);
+    size_t pos = IMU_PACK_HEADER_LEN;
+    if (enc->key) {
+        memcpy(out + pos, enc->pend[0], IMU_AXIS_COUNT);
+        pos += IMU_AXIS_COUNT;
+    }
+    imu_bitwriter_t bw;
+    imu_bw_init(&bw, out + pos, IMU_FRAME_MAX - pos);
+    imu_pack_planes(&bw, p.ua, p.m, p.wa);
+    imu_pack_planes(&bw, p.ug, p.m, p.wg);
+    imu_bw_finish(&bw);
+
+    // History: the last two samples the receiver will have decoded
+    if (n >= 2) {
+        memcpy(enc->hist[1], enc->pend[n - 2], IMU_AXIS_COUNT);
+        enc->hist_n = 2;
+    } else {
+        memcpy(enc->hist[1], enc->hist[0], IMU_AXIS_COUNT);
+        enc->hist_n = (enc->key || enc->hist_n == 0) ? 1 : 2;
+    }
+    memcpy(enc->hist[0], enc->pend[n - 1], IMU_AXIS_COUNT);
+    enc->seq = (uint8_t)((enc->seq + 1) % IMU_PACK_SEQ_MOD);
+    enc->gop_pos = (uint8_t)((enc->key ? 1 : enc->gop_pos + 1) % enc->key_interval);
+    enc->fill = 0;
+    return len;
+}
+
+size_t imu_pack_push(imu_pack_encoder_t *enc, const imu_sample_t *s, uint8_t out[IMU_FRAME_MAX])
+{
+    int8_t q[IMU_AXIS_COUNT];
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        q[a] = to_step(s->v[a]);
+    }
+
+    size_t len = 0;
+    if (enc->fill > 0) {
+        frame_plan_t p;
+        memcpy(enc->pend[enc->fill], q, IMU_AXIS_COUNT);
+        if (plan_frame(enc, (uint8_t)(enc->fill + 1), enc->key, &p) <= IMU_FRAME_MAX) {
+            enc->fill++;
+            return (enc->fill == enc->max_samples) ? emit(enc, enc->fill, out) : 0;
+        }
+        len = emit(enc, enc->fill, out);        // Full: send it, start over with q
+    }
+
+    // New frame: key on schedule, or when even one predicted sample won't fit
+    frame_plan_t p;
+    memcpy(enc->pend[0], q, IMU_AXIS_COUNT);
+    enc->key = (enc->gop_pos == 0 || enc->hist_n == 0);
+    if (!enc->key && plan_frame(enc, 1, false, &p) > IMU_FRAME_MAX) {
+        enc->key = true;
+    }
+    enc->fill = 1;
+    if (len == 0 && enc->max_samples == 1) {
+        len = emit(enc, 1, out);
+    }
+    return len;
+}
+
+size_t imu_pack_flush(imu_pack_encoder_t *enc, uint8_t out[IMU_FRAME_MAX])
+{
+    return enc->fill ? emit(enc, enc->fill, out) : 0;
+}
+
+/*
+ * ============================================================================
+ *                         DECODER
+ * ============================================================================
+ */
+void imu_pack_decoder_init(imu_pack_decoder_t *dec)
+{
+    memset(dec, 0, sizeof(*dec));
+}
+
+uint8_t imu_pack_decode(imu_pack_decoder_t *dec, const uint8_t *in, size_t len,
+                        imu_sample_t *out, bool *key_out)
+{
+    if (len < IMU_PACK_HEADER_LEN || len > IMU_FRAME_MAX) {
+        return 0;
+    }
+    const bool key = (in[0] & 0x80) != 0;
+    const uint8_t seq = (in[0] >> 4) & 0x07;
+    const uint8_t n = (uint8_t)(((in[0] >> 1) & 0x07) + 1);
+    const uint8_t order = (uint8_t)((in[0] & 1) + 1);
+    frame_plan_t p;
+    p.wa = in[1] >> 4;
+    p.wg = in[1] & 0x0F;
+    p.m = (uint8_t)(3 * (n - (key ? 1 : 0)));
+    if (p.wa > IMU_PACK_MAX_WIDTH || p.wg > IMU_PACK_MAX_WIDTH || plan_len(&p, key) != len) {
+        return 0;
+    }
+    if (!key && (dec->hist_n == 0 || seq != (dec->seq + 1) % IMU_PACK_SEQ_MOD)) {
+        dec->hist_n = 0;                    // Lost a frame: wait for the next key
+        dec->unreferenced++;
+        return 0;
+    }
+
+    size_t pos = IMU_PACK_HEADER_LEN;
+    int8_t s[2 + IMU_PACK_MAX_SAMPLES][IMU_AXIS_COUNT];
+    memcpy(s[0], dec->hist[1], IMU_AXIS_COUNT);
+    memcpy(s[1], dec->hist[0], IMU_AXIS_COUNT);
+    if (key) {
+        memcpy(s[2], in + pos, IMU_AXIS_COUNT);
+        pos += IMU_AXIS_COUNT;
+    }
+    imu_bitreader_t br;
+    imu_br_init(&br, in + pos, len - pos);
+    imu_unpack_planes(&br, p.ua, p.m, p.wa);
+    imu_unpack_planes(&br, p.ug, p.m, p.wg);
+
+    // Same predictor walk as residuals(), in reverse
+    const uint8_t valid = key ? 2 : (uint8_t)(2 - dec->hist_n);
+    uint8_t r = 0;
+    for (uint8_t k = key ? 3 : 2; k < 2 + n; k++, r += 3) {
+        const bool second = (order == 2) && (k - valid >= 2);
+        for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+            const int32_t pred = second ? 2 * s[k - 1][a] - s[k - 2][a] : s[k - 1][a];
+            const uint16_t u = (a < IMU_AXIS_GX) ? p.ua[r + a] : p.ug[r + a - IMU_AXIS_GX];
+            const int32_t v = pred + imu_unzigzag(u);
+            if (v < -127 || v > 127) {
+                return 0;
+            }
+            s[k][a] = (int8_t)v;
+        }
+    }
+
+    for (uint8_t i = 0; i < n; i++) {
+        for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+            out[i].v[a] = (int16_t)(s[2 + i][a] * IMU_PACK_STEP);
+        }
+    }
+    const uint8_t avail = (uint8_t)(n + (key ? 0 : dec->hist_n));
+    if (n >= 2) {
+        memcpy(dec->hist[1], s[n], IMU_AXIS_COUNT);
+    } else {
+        memcpy(dec->hist[1], dec->hist[0], IMU_AXIS_COUNT);
+    }
+    memcpy(dec->hist[0], s[n + 1], IMU_AXIS_COUNT);
+    dec->hist_n = avail >= 2 ? 2 : 1;
+    dec->seq = seq;
+    if (key_out) {
+        *key_out = key;
+    }
+    return n;
+}
@@ -0,0 +1,209 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - LOSSLESS RICE CODEC
+ * ============================================================================
+ *
+ * See imu_rice.h for the frame layout. This file contains:
+ * - Residual computation for predictor orders 0..2
+ * - Parameter search (order and k) by exact bit counting
+ * - Encoder / decoder on top of imu_bits.h
+ */
+
+#include "imu_rice.h"
+#include "imu_bits.h"
+
+/*
+ * ============================================================================
+ *                         RESIDUALS
+ * ============================================================================
+ */
+
+// Zigzagged residuals of one axis for predictor 'order' (u[0..n-1]).
+// For orders 1 and 2, u[0] is unused (x[0] goes raw).
+static void residuals(const imu_sample_t *in, uint8_t n, int axis, uint8_t order, uint32_t *u)
+{
+    for (uint8_t i = 0; i < n; i++) {
+        int32_t x = in[i].v[axis];
+        int32_t pred = 0;
+        if (order >= 1 && i >= 1) {
+            pred = in[i - 1].v[axis];
+            if (order == 2 && i >= 2) {
+                pred = 2 * pred - in[i - 2].v[axis];
+            }
+        }
+        u[i] = imu_zigzag(x - pred);
+    }
+}
+
+static uint32_t rice_bits(const uint32_t *u, uint8_t first, uint8_t n, uint8_t k)
+{
+    uint32_t bits = 0;
+    for (uint8_t i = first; i < n; i++) {
+        uint32_t q = u[i] >> k;
+        bits += (q < IMU_RICE_QESC) ? q + 1 + k : IMU_RICE_QESC + 1 + IMU_RICE_ESC_BITS;
+    }
+    return bits;
+}
+
+/*
+ * Pick k near log2(mean residual), then check the neighbours exactly:
+ * the estimate is right most of the time, and 3 exact counts are cheap
+ * next to the cost of a wrong k on a 30-sample block.
+ */
+static uint8_t best_k(const uint32_t *u, uint8_t first, uint8_t n, uint32_t *bits_out)
+{
+    uint32_t sum = 0;
+    for (uint8_t i = first; i < n; i++) {
+        sum += u[i];
+    }
+    uint32_t mean = sum / (uint32_t)(n - first ? n - first : 1);
+    uint8_t k_est = 0;
+    while (k_est < IMU_RICE_MAX_K && (1u << (k_est + 1)) <= mean) {
+        k_est++;
+    }
+
+    uint8_t best = k_est;
+    uint32_t best_bits = UINT32_MAX;
+    for (int k = (int)k_est - 1; k <= (int)k_est + 1; k++) {
+        if (k < 0 || k > IMU_RICE_MAX_K) {
+            continue;
+        }
+        uint32_t bits = rice_bits(u, first, n, (uint8_t)k);
+        if (bits < best_bits) {
+            best_bits = bits;
+            best = (uint8_t)k;
+        }
+    }
+    *bits_out = best_bits;
+    return best;
+}
+
+/*
+ * ============================================================================
+ *                         ENCODER
+ * ============================================================================
+ */
+size_t imu_rice_encode(const imu_sample_t *in, uint8_t n, uint8_t seq,
+                       uint8_t *out, size_t cap)
+{
+    if (n == 0 || n > IMU_RICE_MAX_BLOCK || cap < IMU_RICE_HEADER_LEN) {
+        return 0;
+    }
+
+    out[0] = n;
+    out[1] = seq;
+
+    imu_bitwriter_t bw;
+    imu_bw_init(&bw, out + IMU_RICE_HEADER_LEN, cap - IMU_RICE_HEADER_LEN);
+
+    uint32_t u[3][IMU_RICE_MAX_BLOCK];
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        // Cost of each predictor (including its side info) vs raw
+        uint8_t best_order = IMU_RICE_ORDER_RAW;
+        uint8_t best_kv = 0;
+        uint32_t best_bits = 16u * n;
+
+        for (uint8_t p = 0; p <= 2; p++) {
+            uint8_t first = p ? 1 : 0;
+            uint32_t bits;
+            residuals(in, n, a, p, u[p]);
+            uint8_t k = best_k(u[p], first, n, &bits);
+            bits += 4 + (p ? 16 : 0);
+            if (bits < best_bits) {
+                best_bits = bits;
+                best_order = p;
+                best_kv = k;
+            }
+        }
+
+        imu_bw_put(&bw, best_order, 2);
+        if (best_order == IMU_RICE_ORDER_RAW) {
+            for (uint8_t i = 0; i < n; i++) {
+                imu_bw_put(&bw, (uint16_t)in[i].v[a], 16);
+            }
+            continue;
+        }
+
+        imu_bw_put(&bw, best_kv, 4);
+        uint8_t first = 0;
+        if (best_order >= 1) {
+            imu_bw_put(&bw, (uint16_t)in[0].v[a], 16);
+            first = 1;
+        }
+        const uint32_t *ua = u[best_order];
+        for (uint8_t i = first; i < n; i++) {
+            uint32_t q = ua[i] >> best_kv;
+            if (q < IMU_RICE_QESC) {
+                imu_bw_unary(&bw, q);
+                imu_bw_put(&bw, ua[i], best_kv);
+            } else {
+                imu_bw_unary(&bw, IMU_RICE_QESC);
+                imu_bw_put(&bw, ua[i], IMU_RICE_ESC_BITS);
+            }
+        }
+    }
+
+    size_t body = imu_bw_finish(&bw);
+    if (bw.overflow) {
+        return 0;
+    }
+    return IMU_RICE_HEADER_LEN + body;
+}
+
+/*
+ * ============================================================================
+ *                         DECODER
+ * ============================================================================
+ */
+size_t imu_rice_decode(const uint8_t *in, size_t len, imu_sample_t *out,
+                       size_t cap, uint8_t *seq)
+{
+    if (len < IMU_RICE_HEADER_LEN) {
+        return 0;
+    }
+    const uint8_t n = in[0];
+    if (n == 0 || n > IMU_RICE_MAX_BLOCK || n > cap) {
+        return 0;
+    }
+
+    imu_bitreader_t br;
+    imu_br_init(&br, in + IMU_RICE_HEADER_LEN, len - IMU_RICE_HEADER_LEN);
+
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        uint8_t order = (uint8_t)imu_br_get(&br, 2);
+        if (order == IMU_RICE_ORDER_RAW) {
+            for (uint8_t i = 0; i < n; i++) {
+                out[i].v[a] = (int16_t)imu_br_get(&br, 16);
+            }
+            continue;
+        }
+
+        uint8_t k = (uint8_t)imu_br_get(&br, 4);
+        uint8_t first = 0;
+        if (order >= 1) {
+            out[0].v[a] = (int16_t)imu_br_get(&br, 16);
+            first = 1;
+        }
+        for (uint8_t i = first; i < n; i++) {
+            uint32_t q = imu_br_unary(&br);
+            uint32_t u = (q < IMU_RICE_QESC) ? (q << k) | imu_br_get(&br, k)
+                                             : imu_br_get(&br, IMU_RICE_ESC_BITS);
+            int32_t pred = 0;
+            if (order >= 1) {
+                pred = out[i - 1].v[a];
+                if (order == 2 && i >= 2) {
+                    pred = 2 * pred - out[i - 2].v[a];
+                }
+            }
+            out[i].v[a] = (int16_t)(pred + imu_unzigzag(u));
+        }
+    }
+
+    if (br.overflow) {
+        return 0;
+    }
+    if (seq) {
+        *seq = in[1];
+    }
+    return n;
+}
@@ -0,0 +1,98 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - NOISE PRE-FILTER (SMOOTHING)
+ * ============================================================================
+ *
+ * See imu_smooth.h for the filters and where they run.
+ */
+
+#include <string.h>
+#include "imu_smooth.h"
+
+#define FRAC    IMU_SMOOTH_FRAC_BITS
+
+void imu_smooth_defaults(imu_smooth_config_t *cfg, imu_smooth_mode_t mode)
+{
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->mode = mode;
+    cfg->gain[0] = cfg->gain[1] = IMU_SMOOTH_ONE / 4;
+    cfg->noise[0] = 4 * 4;              // ~4 mg RMS at rest
+    cfg->noise[1] = 6 * 6;              // ~0.6 dps RMS at rest
+    cfg->motion[0] = cfg->motion[1] = 1;
+    cfg->gate = 4;
+}
+
+bool imu_smooth_configure(imu_smooth_t *s, const imu_smooth_config_t *cfg)
+{
+    if (cfg->mode > IMU_SMOOTH_KALMAN) {
+        return false;
+    }
+    for (int g = 0; g < 2; g++) {
+        // Variances stay below 2^23 so P + R still fits 32 bits in 1/256 LSB
+        if (cfg->gain[g] == 0 || cfg->gain[g] > IMU_SMOOTH_ONE ||
+            cfg->noise[g] == 0 || cfg->noise[g] >= (1u << 23) || cfg->motion[g] >= (1u << 23)) {
+            return false;
+        }
+    }
+    memset(s, 0, sizeof(*s));
+    s->cfg = *cfg;
+    return true;
+}
+
+// x += k · (z - x), k in Q15, rounded
+static int32_t blend(int32_t x, int32_t z, uint32_t k)
+{
+    const int64_t d = (int64_t)(z - x) * k;
+    return x + (int32_t)((d + (1 << 14)) >> 15);
+}
+
+static int16_t output(int32_t x)
+{
+    return imu_sat16((x + (1 << (FRAC - 1))) >> FRAC);
+}
+
+void imu_smooth_apply(imu_smooth_t *s, imu_sample_t *v, size_t n)
+{
+    const imu_smooth_config_t *c = &s->cfg;
+    if (c->mode == IMU_SMOOTH_OFF) {
+        return;
+    }
+    size_t i = 0;
+    if (!s->primed && n > 0) {
+        for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+            s->x[a] = (int32_t)v[0].v[a] * (1 << FRAC);
+            s->p[a] = c->noise[a < IMU_AXIS_GX ? 0 : 1] << FRAC;
+        }
+        s->primed = true;
+        i = 1;                          // First sample passes unchanged
+    }
+
+    for (; i < n; i++) {
+        for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+            const int g = (a < IMU_AXIS_GX) ? 0 : 1;
+            const int32_t z = (int32_t)v[i].v[a] * (1 << FRAC);
+            if (c->mode == IMU_SMOOTH_COMPLEMENTARY) {
+                s->x[a] = blend(s->x[a], z, c->gain[g]);
+            } else {
+                const uint32_t r = c->noise[g] << FRAC;
+                uint32_t p = s->p[a] + (c->motion[g] << FRAC);
+                if (p >= (1u << 31)) {
+                    p = 1u << 31;       // Long stretch of pure prediction: K ≈ 1 anyway
+                }
+                // Gate in LSB²: e² > gate² (P + R)
+                const int64_t e = (int64_t)v[i].v[a] - ((s->x[a] + (1 << (FRAC - 1))) >> FRAC);
+                if (c->gate && (uint64_t)(e * e) << FRAC >
+                               (uint64_t)c->gate * c->gate * ((uint64_t)p + r)) {
+                    s->x[a] = z;
+                    s->p[a] = r;
+                    s->restarts++;
+                } else {
+                    const uint32_t k = (uint32_t)(((uint64_t)p << 15) / ((uint64_t)p + r));
+                    s->x[a] = blend(s->x[a], z, k);
+                    s->p[a] = (uint32_t)(((uint64_t)(IMU_SMOOTH_ONE - k) * p) >> 15);
+                }
+            }
+            v[i].v[a] = output(s->x[a]);
+        }
+    }
+}
@@ -0,0 +1,160 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - MESH-WIDE TIME SYNCHRONIZATION
+ * ============================================================================
+ *
+ * See imu_timesync.h for the beacon format and the estimator.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "imu_timesync.h"
+
+void imu_tsync_beacon_pack(const imu_tsync_beacon_t *b, uint8_t out[IMU_TSYNC_BEACON_LEN])
+{
+    out[0] = b->seq;
+    out[1] = b->ttl;
+    out[2] = (uint8_t)b->t_us;
+    out[3] = (uint8_t)(b->t_us >> 8);
+    out[4] = (uint8_t)(b->t_us >> 16);
+    out[5] = (uint8_t)(b->t_us >> 24);
+    out[6] = (uint8_t)b->prev_corr_us;
+    out[7] = (uint8_t)(b->prev_corr_us >> 8);
+}
+
+bool imu_tsync_beacon_unpack(const uint8_t *in, size_t len, imu_tsync_beacon_t *b)
+{
+    if (len != IMU_TSYNC_BEACON_LEN) {
+        return false;
+    }
+    b->seq = in[0];
+    b->ttl = in[1];
+    b->t_us = (uint32_t)in[2] | ((uint32_t)in[3] << 8) |
+              ((uint32_t)in[4] << 16) | ((uint32_t)in[5] << 24);
+    b->prev_corr_us = (uint16_t)(in[6] | (in[7] << 8));
+    return true;
+}
+
+void imu_tsync_init(imu_tsync_t *ts, int32_t hop_delay_us)
+{
+    memset(ts, 0, sizeof(*ts));
+    ts->hop_delay_us = hop_delay_us;
+}
+
+static void restart(imu_tsync_t *ts)
+{
+    ts->sw = ts->sx = ts->sy = ts->sxx = ts->sxy = 0.0;
+    ts->q0 = ts->q1 = ts->q2 = 0.0;
+    ts->points = 0;
+    ts->synced = false;
+    ts->jitter_us = ts->error_us = 0.0;
+    ts->reject_run = 0;
+    ts->restarts++;
+}
+
+// 32-bit gateway stamps → 64-bit (stamps are much less than 35 min apart)
+static int64_t unwrap(imu_tsync_t *ts, uint32_t t_us)
+{
+    if (!ts->have_global) {
+        ts->have_global = true;
+        ts->last_global_us = t_us;
+    } else {
+        ts->last_global_us += (int32_t)(t_us - (uint32_t)ts->last_global_us);
+    }
+    return ts->last_global_us;
+}
+
+static void fit(imu_tsync_t *ts)
+{
+    // Ridge term: a skew of SKEW_PRIOR costs as much as one pair off by the jitter
+    const double jitter = fmax(ts->jitter_us, IMU_TSYNC_MIN_GATE_US / 4.0);
+    const double ridge = (jitter / IMU_TSYNC_SKEW_PRIOR) * (jitter / IMU_TSYNC_SKEW_PRIOR);
+    const double sxx = ts->sxx + ridge;
+    const double d = ts->sw * sxx - ts->sx * ts->sx;
+
+    ts->skew = (ts->sw * ts->sxy - ts->sx * ts->sy) / d;
+    ts->offset_us = (ts->sy - ts->skew * ts->sx) / ts->sw;
+
+    // Intercept variance / jitter², weights w on unit-variance noise
+    const double var_gain = (sxx * sxx * ts->q0 - 2.0 * sxx * ts->sx * ts->q1 +
+                             ts->sx * ts->sx * ts->q2) / (d * d);
+    ts->error_us = ts->jitter_us * sqrt(var_gain);
+    ts->synced = true;
+}
+
+static bool add_pair(imu_tsync_t *ts, int64_t local_us, int64_t global_us)
+{
+    const double y = (double)(global_us - local_us);
+
+    if (ts->synced) {
+        const double e = y - (ts->offset_us + ts->skew * (double)(local_us - ts->anchor_us));
+        const double gate = fmax(4.0 * ts->jitter_us, IMU_TSYNC_MIN_GATE_US);
+        if (ts->points >= IMU_TSYNC_GATE_POINTS && fabs(e) > gate) {
+            ts->rejected++;
+            if (++ts->reject_run < IMU_TSYNC_MAX_REJECTS) {
+                return false;
+            }
+            restart(ts);                // The line is wrong, not the pair
+        } else {
+            const double j2 = ts->jitter_us * ts->jitter_us;
+            ts->jitter_us = (ts->points == 1) ? fabs(e)
+                          : sqrt(IMU_TSYNC_FORGET * j2 + (1.0 - IMU_TSYNC_FORGET) * e * e);
+        }
+    }
+    ts->reject_run = 0;
+
+    // Move x = 0 to the new pair, then age the old pairs
+    if (ts->points > 0) {
+        const double dx = (double)(local_us - ts->anchor_us);
+        ts->sxx += dx * dx * ts->sw - 2.0 * dx * ts->sx;
+        ts->sxy -= dx * ts->sy;
+        ts->sx -= dx * ts->sw;
+        ts->q2 += dx * dx * ts->q0 - 2.0 * dx * ts->q1;
+        ts->q1 -= dx * ts->q0;
+    }
+    const double f = IMU_TSYNC_FORGET, f2 = f * f;
+    ts->sw = ts->sw * f + 1.0;
+    ts->sx *= f;
+    ts->sy = ts->sy * f + y;
+    ts->sxx *= f;
+    ts->sxy *= f;
+    ts->q0 = ts->q0 * f2 + 1.0;
+    ts->q1 *= f2;
+    ts->q2 *= f2;
+
+    ts->anchor_us = local_us;
+    ts->points++;
+    ts->used++;
+    fit(ts);
+    return true;
+}
+
+bool imu_tsync_feed(imu_tsync_t *ts, const imu_tsync_beacon_t *b, uint8_t recv_ttl,
+                    int64_t local_us)
+{
+    ts->beacons++;
+    const int64_t global_us = unwrap(ts, b->t_us);
+
+    // The previous beacon becomes a pair once its send-time correction is known
+    bool updated = false;
+    if (ts->have_pending && b->seq == (uint8_t)(ts->pending_seq + 1) &&
+        b->prev_corr_us != IMU_TSYNC_CORR_UNKNOWN) {
+        updated = add_pair(ts, ts->pending_local_us,
+                           ts->pending_global_us + b->prev_corr_us);
+    }
+
+    const int32_t hops = (b->ttl > recv_ttl) ? b->ttl - recv_ttl : 0;
+    ts->have_pending = true;
+    ts->pending_seq = b->seq;
+    ts->pending_local_us = local_us;
+    ts->pending_global_us = global_us + (int64_t)hops * ts->hop_delay_us;
+    return updated;
+}
+
+int64_t imu_tsync_to_global(const imu_tsync_t *ts, int64_t local_us)
+{
+    if (!ts->synced) {
+        return local_us;
+    }
+    return local_us + llround(ts->offset_us + ts->skew * (double)(local_us - ts->anchor_us));
+}
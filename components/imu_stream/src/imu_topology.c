@@ -0,0 +1,415 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - RELAY ELECTION
+ * ============================================================================
+ *
+ * See imu_topology.h for the frame layouts.
+ */
+
+#include <string.h>
+#include "imu_topology.h"
+
+/*
+ * ============================================================================
+ *                         STICK: NEIGHBOUR TABLE
+ * ============================================================================
+ */
+
+void imu_topo_table_init(imu_topo_table_t *t)
+{
+    memset(t, 0, sizeof(*t));
+}
+
+void imu_topo_observe(imu_topo_table_t *t, uint16_t addr, int8_t rssi, uint32_t now_ms)
+{
+    const int16_t x16 = (int16_t)(rssi * 16);
+    for (uint8_t i = 0; i < t->count; i++) {
+        imu_topo_neighbour_t *n = &t->n[i];
+        if (n->addr == addr) {
+            n->rssi_x16 = (int16_t)(n->rssi_x16 + (x16 - n->rssi_x16) / 4);
+            n->last_ms = now_ms;
+            return;
+        }
+    }
+
+    uint8_t slot = t->count;
+    if (slot == IMU_TOPO_MAX_NEIGHBOURS) {
+        slot = 0;
+        for (uint8_t i = 1; i < t->count; i++) {
+            if (t->n[i].rssi_x16 < t->n[slot].rssi_x16) {
+                slot = i;
+            }
+        }
+        if (t->n[slot].rssi_x16 >= x16) {
+            return;                         // Weaker than everything we keep
+        }
+        t->replaced++;
+    } else {
+        t->count++;
+    }
+    t->n[slot].addr = addr;
+    t->n[slot].rssi_x16 = x16;
+    t->n[slot].last_ms = now_ms;
+}
+
+void imu_topo_expire(imu_topo_table_t *t, uint32_t now_ms, uint32_t max_age_ms)
+{
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < t->count; i++) {
+        if ((uint32_t)(now_ms - t->n[i].last_ms) <= max_age_ms) {
+            t->n[kept++] = t->n[i];
+        }
+    }
+    t->count = kept;
+}
+
+// Neighbours that relay go first, then the stronger
+static bool report_before(const imu_topo_table_t *t, const imu_topo_plan_t *relays,
+                          uint8_t a, uint8_t b)
+{
+    const bool ra = relays && imu_topo_is_relay(relays, t->n[a].addr);
+    const bool rb = relays && imu_topo_is_relay(relays, t->n[b].addr);
+    return (ra != rb) ? ra : t->n[a].rssi_x16 > t->n[b].rssi_x16;
+}
+
+size_t imu_topo_report_pack(const imu_topo_table_t *t, uint8_t ttl, bool relaying,
+                            const imu_topo_plan_t *relays, uint8_t *out, size_t cap)
+{
+    if (cap < IMU_TOPO_REPORT_HEADER_LEN) {
+        return 0;
+    }
+
+    // Selection over a copy of the indices
+    uint8_t order[IMU_TOPO_MAX_NEIGHBOURS];
+    for (uint8_t i = 0; i < t->count; i++) {
+        order[i] = i;
+    }
+    size_t len = IMU_TOPO_REPORT_HEADER_LEN;
+    uint8_t n = 0;
+    while (n < t->count && n < IMU_TOPO_REPORT_MAX && len + IMU_TOPO_REPORT_ENTRY_LEN <= cap) {
+        uint8_t best = n;
+        for (uint8_t i = (uint8_t)(n + 1); i < t->count; i++) {
+            if (report_before(t, relays, order[i], order[best])) {
+                best = i;
+            }
+        }
+        const uint8_t swap = order[n];
+        order[n] = order[best];
+        order[best] = swap;
+
+        const imu_topo_neighbour_t *e = &t->n[order[n]];
+        out[len++] = (uint8_t)(e->addr & 0xFF);
+        out[len++] = (uint8_t)(e->addr >> 8);
+        out[len++] = (uint8_t)(int8_t)(e->rssi_x16 / 16);
+        n++;
+    }
+    out[0] = ttl;
+    out[1] = relaying ? IMU_TOPO_FLAG_RELAYING : 0;
+    out[2] = n;
+    return len;
+}
+
+bool imu_topo_report_unpack(const uint8_t *in, size_t len, imu_topo_report_t *r)
+{
+    if (len < IMU_TOPO_REPORT_HEADER_LEN) {
+        return false;
+    }
+    const uint8_t n = in[2];
+    if (n > IMU_TOPO_REPORT_MAX ||
+        len != IMU_TOPO_REPORT_HEADER_LEN + (size_t)n * IMU_TOPO_REPORT_ENTRY_LEN) {
+        return false;
+    }
+    r->ttl = in[0];
+    r->relaying = (in[1] & IMU_TOPO_FLAG_RELAYING) != 0;
+    r->count = n;
+    const uint8_t *p = &in[IMU_TOPO_REPORT_HEADER_LEN];
+    for (uint8_t i = 0; i < n; i++, p += IMU_TOPO_REPORT_ENTRY_LEN) {
+        r->link[i].addr = (uint16_t)(p[0] | (p[1] << 8));
+        r->link[i].rssi = (int8_t)p[2];
+    }
+    return true;
+}
+
+/*
+ * ============================================================================
+ *                         GATEWAY: GRAPH AND PLANNER
+ * ============================================================================
+ */
+
+void imu_topo_graph_init(imu_topo_graph_t *g, uint16_t gateway)
+{
+    memset(g->rssi, (uint8_t)IMU_TOPO_NO_LINK, sizeof(g->rssi));
+    g->addr[0] = gateway;
+    g->count = 1;
+}
+
+// Index of addr, added if new; -1 if the graph is full
+static int graph_node(imu_topo_graph_t *g, uint16_t addr)
+{
+    for (uint8_t i = 0; i < g->count; i++) {
+        if (g->addr[i] == addr) {
+            return i;
+        }
+    }
+    if (g->count == IMU_TOPO_MAX_NODES) {
+        return -1;
+    }
+    g->addr[g->count] = addr;
+    return g->count++;
+}
+
+bool imu_topo_graph_link(imu_topo_graph_t *g, uint16_t rx, uint16_t tx, int8_t rssi)
+{
+    const int r = graph_node(g, rx);
+    const int t = (r < 0) ? -1 : graph_node(g, tx);
+    if (t < 0) {
+        return false;
+    }
+    if (r == t) {
+        return true;                        // Heard itself: nothing to note
+    }
+    // NO_LINK is reserved
+    g->rssi[r][t] = (rssi == IMU_TOPO_NO_LINK) ? (int8_t)(IMU_TOPO_NO_LINK + 1) : rssi;
+    return true;
+}
+
+bool imu_topo_graph_report(imu_topo_graph_t *g, uint16_t reporter, const imu_topo_report_t *r)
+{
+    const int rx = graph_node(g, reporter);
+    if (rx < 0) {
+        return false;
+    }
+    memset(g->rssi[rx], (uint8_t)IMU_TOPO_NO_LINK, sizeof(g->rssi[rx]));
+    bool ok = true;
+    for (uint8_t i = 0; i < r->count; i++) {
+        ok &= imu_topo_graph_link(g, reporter, r->link[i].addr, r->link[i].rssi);
+    }
+    return ok;
+}
+
+// Link strength between i and j: the weaker side if both reported it
+static int link_rssi(const imu_topo_graph_t *g, int i, int j)
+{
+    const int a = g->rssi[i][j], b = g->rssi[j][i];
+    if (a == IMU_TOPO_NO_LINK) {
+        return b;
+    }
+    return (b == IMU_TOPO_NO_LINK || a < b) ? a : b;
+}
+
+// The planner's working state, indexed like the graph
+typedef struct {
+    int n;
+    uint8_t cover;
+    int8_t rssi[IMU_TOPO_MAX_NODES][IMU_TOPO_MAX_NODES];    // Usable links, else NO_LINK
+    bool reached[IMU_TOPO_MAX_NODES];                       // Any path to the gateway
+    bool kept[IMU_TOPO_MAX_NODES];                          // Relay in the previous plan
+} planner_t;
+
+// Dominators (gateway + relays) in range of every node
+static void count_in_range(const planner_t *pl, const bool *dom, uint8_t *in_range)
+{
+    for (int u = 0; u < pl->n; u++) {
+        in_range[u] = 0;
+        for (int d = 0; d < pl->n; d++) {
+            in_range[u] = (uint8_t)(in_range[u] + (dom[d] && pl->rssi[u][d] != IMU_TOPO_NO_LINK));
+        }
+    }
+}
+
+static void plan_stats(const planner_t *pl, const uint8_t *in_range, imu_topo_plan_t *p)
+{
+    p->unreached = p->short_cover = 0;
+    for (int u = 1; u < pl->n; u++) {
+        if (!pl->reached[u]) {
+            p->unreached++;
+        } else if (in_range[u] < pl->cover) {
+            p->short_cover++;
+        }
+    }
+}
+
+// Greedy from the gateway, see imu_topo_plan()
+static void plan_greedy(const planner_t *pl, const imu_topo_graph_t *g, imu_topo_plan_t *p)
+{
+    const int n = pl->n;
+    uint8_t need[IMU_TOPO_MAX_NODES] = {0};
+    for (int u = 1; u < n; u++) {
+        uint8_t degree = 0;
+        for (int v = 0; v < n; v++) {
+            degree = (uint8_t)(degree + (pl->rssi[u][v] != IMU_TOPO_NO_LINK));
+        }
+        need[u] = pl->reached[u] ? ((degree < pl->cover) ? degree : pl->cover) : 0;
+    }
+
+    bool dom[IMU_TOPO_MAX_NODES] = { true };
+    uint8_t in_range[IMU_TOPO_MAX_NODES];
+    count_in_range(pl, dom, in_range);
+    memset(p, 0, sizeof(*p));
+    while (p->count < IMU_TOPO_MAX_RELAYS) {
+        int best = -1, best_score = 0, best_link = IMU_TOPO_NO_LINK;
+        for (int v = 1; v < n; v++) {
+            if (dom[v] || !in_range[v]) {
+                continue;                   // A relay already, or not next to one
+            }
+            int gain = 0, link = IMU_TOPO_NO_LINK;
+            for (int u = 1; u < n; u++) {
+                if (pl->rssi[v][u] != IMU_TOPO_NO_LINK && in_range[u] < need[u]) {
+                    gain += need[u] - in_range[u];
+                }
+            }
+            if (gain == 0) {
+                continue;
+            }
+            for (int d = 0; d < n; d++) {
+                if (dom[d] && pl->rssi[v][d] > link) {
+                    link = pl->rssi[v][d];
+                }
+            }
+            // Equal gain: the relay we have, the stronger link, the lower address
+            const int score = gain * 2 + pl->kept[v];
+            if (score > best_score || (score == best_score &&
+                (link > best_link || (link == best_link && g->addr[v] < g->addr[best])))) {
+                best = v;
+                best_score = score;
+                best_link = link;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        dom[best] = true;
+        p->relay[p->count++] = g->addr[best];
+        for (int u = 0; u < n; u++) {
+            in_range[u] = (uint8_t)(in_range[u] + (pl->rssi[u][best] != IMU_TOPO_NO_LINK));
+        }
+    }
+    plan_stats(pl, in_range, p);
+}
+
+// The previous plan, if all its relays still hang together through the
+// gateway and every reached node is still in range of one
+static bool plan_still_good(const planner_t *pl, const imu_topo_plan_t *prev, imu_topo_plan_t *p)
+{
+    bool dom[IMU_TOPO_MAX_NODES] = { true };
+    uint8_t found = 0;
+    for (int v = 1; v < pl->n; v++) {
+        dom[v] = pl->kept[v];
+        found = (uint8_t)(found + dom[v]);
+    }
+    if (found != prev->count) {
+        return false;                       // A relay the graph no longer has
+    }
+
+    bool linked[IMU_TOPO_MAX_NODES] = { true };
+    uint8_t queue[IMU_TOPO_MAX_NODES] = { 0 };
+    int head = 0, tail = 1;
+    while (head < tail) {
+        const int u = queue[head++];
+        for (int v = 1; v < pl->n; v++) {
+            if (dom[v] && !linked[v] && pl->rssi[u][v] != IMU_TOPO_NO_LINK) {
+                linked[v] = true;
+                queue[tail++] = (uint8_t)v;
+            }
+        }
+    }
+    if (tail != 1 + found) {
+        return false;                       // A relay cut off from the gateway
+    }
+
+    uint8_t in_range[IMU_TOPO_MAX_NODES];
+    count_in_range(pl, dom, in_range);
+    for (int u = 1; u < pl->n; u++) {
+        if (pl->reached[u] && in_range[u] == 0) {
+            return false;
+        }
+    }
+    *p = *prev;
+    plan_stats(pl, in_range, p);
+    return true;
+}
+
+void imu_topo_plan(const imu_topo_graph_t *g, int8_t rssi_min, uint8_t cover,
+                   const imu_topo_plan_t *prev, imu_topo_plan_t *p)
+{
+    planner_t pl;
+    pl.n = g->count;
+    pl.cover = cover;
+    for (int i = 0; i < pl.n; i++) {
+        pl.kept[i] = i > 0 && prev && imu_topo_is_relay(prev, g->addr[i]);
+    }
+    // Links of the relays we have count down to IMU_TOPO_HYSTERESIS_DB
+    // weaker: a link around rssi_min doesn't flip the plan every round
+    for (int i = 0; i < pl.n; i++) {
+        for (int j = 0; j < pl.n; j++) {
+            const int l = (i == j) ? IMU_TOPO_NO_LINK : link_rssi(g, i, j);
+            const int min = rssi_min - ((pl.kept[i] || pl.kept[j]) ? IMU_TOPO_HYSTERESIS_DB : 0);
+            pl.rssi[i][j] = (int8_t)((l >= min) ? l : IMU_TOPO_NO_LINK);
+        }
+    }
+
+    // Reachable from the gateway at all
+    memset(pl.reached, 0, sizeof(pl.reached));
+    pl.reached[0] = true;
+    uint8_t queue[IMU_TOPO_MAX_NODES] = { 0 };
+    int head = 0, tail = 1;
+    while (head < tail) {
+        const int u = queue[head++];
+        for (int v = 0; v < pl.n; v++) {
+            if (!pl.reached[v] && pl.rssi[u][v] != IMU_TOPO_NO_LINK) {
+                pl.reached[v] = true;
+                queue[tail++] = (uint8_t)v;
+            }
+        }
+    }
+
+    plan_greedy(&pl, g, p);
+
+    // Keep the relays we have unless the new plan covers better or needs
+    // two fewer: one relay more or less isn't worth switching every round
+    imu_topo_plan_t kept;
+    if (prev && prev->count && plan_still_good(&pl, prev, &kept) &&
+        kept.count <= p->count + 1 && kept.short_cover <= p->short_cover) {
+        *p = kept;
+    }
+}
+
+size_t imu_topo_relay_set_pack(const imu_topo_plan_t *p, uint8_t plan_id, uint8_t *out, size_t cap)
+{
+    const size_t len = IMU_TOPO_SET_HEADER_LEN + 2u * p->count;
+    if (p->count > IMU_TOPO_MAX_RELAYS || len > cap) {
+        return 0;
+    }
+    out[0] = plan_id;
+    out[1] = p->count;
+    for (uint8_t i = 0; i < p->count; i++) {
+        out[2 + 2 * i] = (uint8_t)(p->relay[i] & 0xFF);
+        out[3 + 2 * i] = (uint8_t)(p->relay[i] >> 8);
+    }
+    return len;
+}
+
+bool imu_topo_relay_set_unpack(const uint8_t *in, size_t len, uint8_t *plan_id, imu_topo_plan_t *p)
+{
+    if (len < IMU_TOPO_SET_HEADER_LEN || in[1] > IMU_TOPO_MAX_RELAYS ||
+        len != IMU_TOPO_SET_HEADER_LEN + 2u * in[1]) {
+        return false;
+    }
+    memset(p, 0, sizeof(*p));
+    *plan_id = in[0];
+    p->count = in[1];
+    for (uint8_t i = 0; i < p->count; i++) {
+        p->relay[i] = (uint16_t)(in[2 + 2 * i] | (in[3 + 2 * i] << 8));
+    }
+    return true;
+}
+
+bool imu_topo_is_relay(const imu_topo_plan_t *p, uint16_t addr)
+{
+    for (uint8_t i = 0; i < p->count; i++) {
+        if (p->relay[i] == addr) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,351 @@
+/*
+ * ============================================================================
+ *                    IMU STREAM - VECTOR QUANTIZATION
+ * ============================================================================
+ *
+ * See imu_vq.h for the frame layouts. This file contains:
+ * - The nearest-codeword search (the only per-sample hot loop, in IRAM)
+ * - Block encoder / decoder with residual and raw escapes
+ * - Install chunk builder and receiver
+ */
+
+#include <string.h>
+#include "imu_vq.h"
+#include "imu_stream_port.h"
+
+static inline uint8_t group_dim(const imu_vq_codebook_t *cb)
+{
+    return (uint8_t)(IMU_AXIS_COUNT / cb->groups);
+}
+
+static inline const int16_t* group_base(const imu_vq_codebook_t *cb, uint8_t group)
+{
+    return &cb->values[(size_t)group * cb->codes * group_dim(cb)];
+}
+
+bool imu_vq_codebook_valid(const imu_vq_codebook_t *cb)
+{
+    return cb && cb->id != 0 && (cb->groups == 1 || cb->groups == 2) &&
+           cb->codes >= 1 && cb->codes <= IMU_VQ_MAX_CODES &&
+           cb->res_shift <= 8 && cb->esc_thresh <= IMU_VQ_MAX_THRESH;
+}
+
+/*
+ * ============================================================================
+ *                         NEAREST CODEWORD
+ * ============================================================================
+ *
+ * Cost per sample ≈ K × (a few values each), dominated by loads from the
+ * codebook. Differences are clamped to ±16383 so one squared term is
+ * < 2^28 and six of them still fit a uint32_t - a larger error is an
+ * escape anyway, so the clamp never changes which codeword wins.
+ *
+ * 📏 Squared distance picks the codeword, but the escape decision uses the
+ * LARGEST per-axis error (max_abs_err): an RMS bound over six values lets a
+ * single axis drift √6 × further, which is worse than the int8 frame.
+ */
+static inline uint32_t sq_diff(int32_t a, int32_t b)
+{
+    int32_t e = a - b;
+    if (e > IMU_VQ_MAX_THRESH) e = IMU_VQ_MAX_THRESH;
+    if (e < -IMU_VQ_MAX_THRESH) e = -IMU_VQ_MAX_THRESH;
+    return (uint32_t)(e * e);
+}
+
+static inline uint32_t max_abs_err(const int16_t *x, const int16_t *c, uint8_t dim)
+{
+    uint32_t worst = 0;
+    for (uint8_t j = 0; j < dim; j++) {
+        int32_t e = (int32_t)x[j] - c[j];
+        uint32_t a = (uint32_t)(e < 0 ? -e : e);
+        if (a > worst) worst = a;
+    }
+    return worst;
+}
+
+IMU_STREAM_IRAM uint8_t imu_vq_nearest(const imu_vq_codebook_t *cb, uint8_t group,
+                                       const int16_t *x, uint8_t hint, uint32_t *dist)
+{
+    const uint8_t dim = group_dim(cb);
+    const uint8_t codes = cb->codes;
+    const int16_t *base = group_base(cb, group);
+    if (hint >= codes) {
+        hint = 0;
+    }
+
+    // Full distance to the hint sets the initial bound
+    const int16_t *c = base + (size_t)hint * dim;
+    uint32_t best = 0;
+    for (uint8_t j = 0; j < dim; j++) {
+        best += sq_diff(x[j], c[j]);
+    }
+    uint8_t best_i = hint;
+
+    c = base;
+    for (uint8_t i = 0; i < codes && best != 0; i++, c += dim) {
+        uint32_t d = 0;
+        uint8_t j = 0;
+        // Partial distance: stop summing as soon as this one can't win
+        while (j < dim && d < best) {
+            d += sq_diff(x[j], c[j]);
+            j++;
+        }
+        if (j == dim && d < best) {
+            best = d;
+            best_i = i;
+        }
+    }
+
+    if (dist) {
+        *dist = best;
+    }
+    return best_i;
+}
+
+/*
+ * ============================================================================
+ *                         ENCODE / DECODE
+ * ============================================================================
+ */
+
+static void put_le16(uint8_t *p, int32_t v)
+{
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)((v >> 8) & 0xFF);
+}
+
+static int16_t get_le16(const uint8_t *p)
+{
+    return (int16_t)(uint16_t)(p[0] | (p[1] << 8));
+}
+
+// Round-to-nearest division by 2^shift (symmetric around zero)
+static int32_t div_pow2_round(int32_t v, uint8_t shift)
+{
+    if (shift == 0) {
+        return v;
+    }
+    int32_t half = 1 << (shift - 1);
+    return (v >= 0) ? (v + half) >> shift : -((-v + half) >> shift);
+}
+
+size_t imu_vq_encode(const imu_vq_codebook_t *cb, uint8_t seq, const imu_sample_t *in,
+                     uint8_t n, uint8_t *out, size_t cap, imu_vq_stats_t *stats)
+{
+    if (!imu_vq_codebook_valid(cb) || n < 1 || n > IMU_VQ_MAX_BLOCK ||
+        cap < IMU_VQ_HEADER_LEN) {
+        return 0;
+    }
+    const uint8_t dim = group_dim(cb);
+    const uint32_t limit = cb->esc_thresh;   // Per axis, not RMS
+
+    out[0] = cb->id;
+    out[1] = seq;
+    out[2] = n;
+    size_t pos = IMU_VQ_HEADER_LEN;
+
+    uint8_t hint[IMU_VQ_MAX_GROUPS] = { 0, 0 };
+    for (uint8_t i = 0; i < n; i++) {
+        for (uint8_t g = 0; g < cb->groups; g++) {
+            const int16_t *x = &in[i].v[g * dim];
+            uint8_t idx = imu_vq_nearest(cb, g, x, hint[g], NULL);
+            hint[g] = idx;
+            const int16_t *c = group_base(cb, g) + (size_t)idx * dim;
+
+            if (max_abs_err(x, c, dim) <= limit) {
+                if (pos + 1 > cap) return 0;
+                out[pos++] = idx;
+                if (stats) stats->coded++;
+                continue;
+            }
+
+            // Outlier: residual against the nearest codeword, if it fits int8
+            // and the decoder's reconstruction lands inside the threshold too
+            int8_t r[IMU_AXIS_COUNT];
+            int16_t y[IMU_AXIS_COUNT];
+            bool fits = true;
+            for (uint8_t j = 0; j < dim && fits; j++) {
+                int32_t q = div_pow2_round((int32_t)x[j] - c[j], cb->res_shift);
+                fits = (q >= INT8_MIN && q <= INT8_MAX);
+                r[j] = (int8_t)q;
+                y[j] = imu_sat16(c[j] + q * (1 << cb->res_shift));
+            }
+            fits = fits && max_abs_err(x, y, dim) <= limit;
+            if (fits) {
+                if (pos + 2 + dim > cap) return 0;
+                out[pos++] = IMU_VQ_ESC_RESIDUAL;
+                out[pos++] = idx;
+                for (uint8_t j = 0; j < dim; j++) {
+                    out[pos++] = (uint8_t)r[j];
+                }
+                if (stats) stats->residual++;
+            } else {
+                if (pos + 1 + 2 * (size_t)dim > cap) return 0;
+                out[pos++] = IMU_VQ_ESC_RAW;
+                for (uint8_t j = 0; j < dim; j++) {
+                    put_le16(&out[pos], x[j]);
+                    pos += 2;
+                }
+                if (stats) stats->raw++;
+            }
+        }
+    }
+    return pos;
+}
+
+size_t imu_vq_decode(const imu_vq_codebook_t *cb, const uint8_t *in, size_t len,
+                     imu_sample_t *out, size_t cap, uint8_t *seq)
+{
+    if (!imu_vq_codebook_valid(cb) || len < IMU_VQ_HEADER_LEN || in[0] != cb->id) {
+        return 0;
+    }
+    const uint8_t n = in[2];
+    if (n < 1 || n > IMU_VQ_MAX_BLOCK || n > cap) {
+        return 0;
+    }
+    const uint8_t dim = group_dim(cb);
+    size_t pos = IMU_VQ_HEADER_LEN;
+
+    for (uint8_t i = 0; i < n; i++) {
+        for (uint8_t g = 0; g < cb->groups; g++) {
+            int16_t *y = &out[i].v[g * dim];
+            if (pos >= len) return 0;
+            uint8_t idx = in[pos++];
+
+            if (idx == IMU_VQ_ESC_RAW) {
+                if (pos + 2 * (size_t)dim > len) return 0;
+                for (uint8_t j = 0; j < dim; j++) {
+                    y[j] = get_le16(&in[pos]);
+                    pos += 2;
+                }
+                continue;
+            }
+
+            const int8_t *r = NULL;
+            if (idx == IMU_VQ_ESC_RESIDUAL) {
+                if (pos + 1 + dim > len) return 0;
+                idx = in[pos++];
+                r = (const int8_t *)&in[pos];
+                pos += dim;
+            }
+            if (idx >= cb->codes) return 0;
+
+            const int16_t *c = group_base(cb, g) + (size_t)idx * dim;
+            for (uint8_t j = 0; j < dim; j++) {
+                int32_t v = c[j];
+                if (r) {
+                    v += (int32_t)r[j] * (1 << cb->res_shift);
+                }
+                y[j] = imu_sat16(v);
+            }
+        }
+    }
+    if (pos != len) {
+        return 0;
+    }
+    if (seq) {
+        *seq = in[1];
+    }
+    return n;
+}
+
+/*
+ * ============================================================================
+ *                         INSTALL
+ * ============================================================================
+ */
+
+static size_t codebook_values(const imu_vq_codebook_t *cb)
+{
+    return (size_t)cb->codes * IMU_AXIS_COUNT;
+}
+
+size_t imu_vq_install_chunk(const imu_vq_codebook_t *cb, uint8_t chunk,
+                            uint8_t *out, size_t cap)
+{
+    if (!imu_vq_codebook_valid(cb)) {
+        return 0;
+    }
+    size_t offset = (size_t)chunk * IMU_VQ_CHUNK_VALUES;
+    size_t total = codebook_values(cb);
+    if (offset >= total) {
+        return 0;
+    }
+    size_t count = total - offset;
+    if (count > IMU_VQ_CHUNK_VALUES) {
+        count = IMU_VQ_CHUNK_VALUES;
+    }
+    if (cap < IMU_VQ_INSTALL_HEADER_LEN + 2 * count) {
+        return 0;
+    }
+
+    out[0] = cb->id;
+    out[1] = cb->groups;
+    out[2] = cb->codes;
+    out[3] = cb->res_shift;
+    put_le16(&out[4], cb->esc_thresh);
+    put_le16(&out[6], (int32_t)offset);
+    for (size_t i = 0; i < count; i++) {
+        put_le16(&out[IMU_VQ_INSTALL_HEADER_LEN + 2 * i], cb->values[offset + i]);
+    }
+    return IMU_VQ_INSTALL_HEADER_LEN + 2 * count;
+}
+
+void imu_vq_installer_init(imu_vq_installer_t *inst)
+{
+    memset(inst, 0, sizeof(*inst));
+}
+
+imu_vq_install_status_t imu_vq_install_feed(imu_vq_installer_t *inst,
+                                            const uint8_t *in, size_t len)
+{
+    if (len < IMU_VQ_INSTALL_HEADER_LEN || (len - IMU_VQ_INSTALL_HEADER_LEN) % 2 != 0) {
+        return IMU_VQ_INSTALL_INVALID;
+    }
+
+    imu_vq_codebook_t hdr;
+    hdr.id = in[0];
+    hdr.groups = in[1];
+    hdr.codes = in[2];
+    hdr.res_shift = in[3];
+    hdr.esc_thresh = (uint16_t)get_le16(&in[4]);
+    if (!imu_vq_codebook_valid(&hdr)) {
+        return IMU_VQ_INSTALL_INVALID;
+    }
+
+    // Chunks are fixed-size slices; only the last one may be shorter
+    size_t offset = (uint16_t)get_le16(&in[6]);
+    size_t count = (len - IMU_VQ_INSTALL_HEADER_LEN) / 2;
+    size_t total = codebook_values(&hdr);
+    size_t chunk = offset / IMU_VQ_CHUNK_VALUES;
+    size_t chunks = (total + IMU_VQ_CHUNK_VALUES - 1) / IMU_VQ_CHUNK_VALUES;
+    size_t expect = (chunk + 1 < chunks) ? IMU_VQ_CHUNK_VALUES : total - chunk * IMU_VQ_CHUNK_VALUES;
+    if (offset % IMU_VQ_CHUNK_VALUES != 0 || chunk >= chunks || count != expect) {
+        return IMU_VQ_INSTALL_INVALID;
+    }
+
+    // A different header means a new codebook: restart
+    imu_vq_codebook_t *p = &inst->pending;
+    if (inst->need_mask == 0 || p->id != hdr.id || p->groups != hdr.groups ||
+        p->codes != hdr.codes || p->res_shift != hdr.res_shift ||
+        p->esc_thresh != hdr.esc_thresh) {
+        p->id = hdr.id;
+        p->groups = hdr.groups;
+        p->codes = hdr.codes;
+        p->res_shift = hdr.res_shift;
+        p->esc_thresh = hdr.esc_thresh;
+        inst->have_mask = 0;
+        inst->need_mask = (uint16_t)((1u << chunks) - 1);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        p->values[offset + i] = get_le16(&in[IMU_VQ_INSTALL_HEADER_LEN + 2 * i]);
+    }
+    inst->have_mask |= (uint16_t)(1u << chunk);
+
+    if (inst->have_mask == inst->need_mask) {
+        inst->need_mask = 0;    // Next chunk starts a fresh install
+        return IMU_VQ_INSTALL_COMPLETE;
+    }
+    return IMU_VQ_INSTALL_PARTIAL;
+}
@@ -61,6 +61,119 @@
  *    - 50 nodes: 500 msg/sec = 4000 bytes/sec (approaching limit but feasible)
  *    - Key: No segmentation + proper task priorities + sufficient buffers
  *
+ * 6. ANTI-ALIASING (SAMPLE FAST, PUBLISH SLOW)
+ *    - Reading the IMU once per 100ms folds any vibration above 5 Hz back
+ *      into the stream as a fake slow wobble (aliasing)
+ *    - Sampler task reads at IMU_SAMPLE_RATE_HZ (200 Hz) into a ring buffer
+ *    - Publisher low-pass filters + decimates (imu_decimator) to the publish rate
+ *    - Same 8-byte message, same 10 Hz - but the values are now honest averages
+ *
+ * 7. PEAK-PRESERVING ENVELOPE
+ *    - An average (or a single read) per window hides short impacts
+ *    - Envelope mode publishes min/max/mean per axis per window (imu_envelope)
+ *    - Two 8-byte frames per window (accel + gyro), still no segmentation
+ *
+ * 8. LOSSLESS CAPTURE (RICE)
+ *    - Research mode: every 200 Hz sample at full 16-bit precision
+ *    - Predict each value from the previous ones, Rice-code the error
+ *    - ~7 bits per value instead of 16, one segmented message per block
+ *
+ * 9. PER-WINDOW CODEC SELECTION
+ *    - Auto mode tries every registered codec (imu_codec) on each block
+ *    - Smallest frame wins, within a CPU budget measured in CPU cycles
+ *    - A codec ID byte in the frame tells the receiver how to decode it
+ *
+ * 10. LEARNED CODEBOOKS (VECTOR QUANTIZATION)
+ *    - The gateway trains a codebook of typical 6-axis poses from captures
+ *      (tools/vq/vq_train) and installs it over the mesh (0xC50001)
+ *    - VQ mode sends the index of the nearest pose: 1-2 bytes per sample
+ *    - Outliers escape to a residual or the raw values - never silently wrong
+ *
+ * 11. LOSS RECOVERY WITHOUT RETRANSMISSION (XOR PARITY)
+ *    - Frames are unacknowledged: a lost frame is simply gone
+ *    - With IMU_FEC_K set, every K data frames are followed by one parity
+ *      frame (their XOR, imu_fec.h) - the gateway rebuilds any single loss
+ *    - Costs 1/K extra airtime, no acks, no retry timers on the node
+ *
+ * 12. FLOATING-POINT WIRE FORMATS (HALF / BLOCK FLOATING POINT)
+ *    - int8 at 0.1 g loses a 5 mg tremor and clips a 13 g impact
+ *    - BFP: one shared exponent per axis per block + int8/int12 mantissas
+ *      (imu_float.h) - fine steps when quiet, coarse only around an impact
+ *    - BFP8 costs ~6.2 bytes per sample, int8 costs 6
+ *
+ * 13. AUTO-RANGING THE SENSOR (FULL-SCALE SELECTION)
+ *    - ±2 g resolves tremor but clips a knock; ±16 g holds the knock but
+ *      hides the tremor - no fixed range fits every regime
+ *    - imu_autorange picks the smallest range that holds recent peaks:
+ *      up at once, down only after a quiet hold time (hysteresis)
+ *    - The ranged frame (0xC60001) carries the range in 4 bits, so its
+ *      int8 step follows it: 15.6 mg at ±2 g instead of a fixed 100 mg
+ *
+ * 14. PER-NODE CALIBRATION (FIXED-POINT MATRIX + TEMPERATURE TABLE)
+ *    - Every sensor has its own scale error, misalignment and offsets;
+ *      the gyro offset also drifts as the chip warms up
+ *    - imu_calib: 3x3 Q14 matrix + offset + bias interpolated from the die
+ *      temperature, applied to each drained batch before any filtering
+ *    - Installed over the mesh (0xC70001) and kept in NVS across reboots
+ *
+ * 15. ONE CLOCK FOR THE WHOLE MESH (TIME SYNC BEACONS)
+ *    - Every node counts time from its own boot, on its own crystal
+ *      (±40 ppm = 2.4 ms drift per minute) - frame timestamps from two
+ *      nodes cannot be compared as they are
+ *    - The gateway beacons its clock (0xC80001); imu_timesync corrects each
+ *      beacon for the gateway's queue delay and the relay hops, then fits
+ *      offset + skew over many beacons
+ *    - Frames carry the mesh-global time of their window: nodes agree
+ *      within ~3 ms (p99) in tools/sim/sim_timesync, vs ~15 ms when each
+ *      node just trusts the last beacon
+ *
+ * 16. ONE COMMAND, EVERY NODE RECORDS THE SAME SECOND (SYNCED CAPTURE)
+ *    - The gateway sends one 0xC90001 command to the control group:
+ *      "record N full-rate samples starting at global time T"
+ *    - imu_capture keeps the last 2.5 s with global timestamps, so T may
+ *      already be slightly in the past when the command arrives
+ *    - The window goes out as 0xCA0001 chunks, one upload slot per node:
+ *      uploads that start together collide segment after segment
+ *
+ * 17. RETUNING A RUNNING FLEET (STREAM CONFIG OPCODE)
+ *    - Sample rate, publish interval, mode, block length, channel mask and
+ *      codec arrive as one 8-byte 0xCB0001 record (imu_config.h) - to one
+ *      node, or to the control group for all of them
+ *    - The sampler switches at a window close and the publisher one window
+ *      later, so no window mixes two configurations
+ *    - Stored in NVS: a node reboots into the configuration it was given
+ *
+ * 18. SEND ONLY THE CHANNELS SOMEONE READS (MASKED FRAMES)
+ *    - Accel-only deployments paid for three gyro bytes in every frame
+ *    - MASKED mode (0xCC0001, imu_masked.h): a channel bitmap in the header,
+ *      and the freed bytes carry more windows - accel only = 2 windows per
+ *      frame = half the messages, one axis = 6 windows per frame
+ *    - Node and decoder share one mask → channel list function
+ *
+ * 19. ORIENTATION DOES NOT MATTER FOR A KNOCK (MAGNITUDE FRAMES)
+ *    - Shock monitoring wants |a| and |ω|, not six axes that change with
+ *      how the stick is mounted
+ *    - MAGNITUDE mode (0xCD0001, imu_magnitude.h): two channels, three
+ *      windows per 8-byte frame, integer square root (no float)
+ *    - Each window sends its full-rate PEAK - the anti-aliasing filter
+ *      would have smeared the knock away
+ *
+ * 20. PREDICT, THEN SEND ONLY THE BITS THAT CHANGED (PACKED FRAMES)
+ *    - Consecutive windows differ by a few steps; the legacy frame resends
+ *      all 8 bits of every value anyway
+ *    - PACKED mode (0xCE0001, imu_packed.h): per-axis prediction, zigzag,
+ *      one bit width per sensor per frame, bit planes - 2.5 windows per
+ *      8-byte frame on the synthetic trace instead of 1
+ *    - Only key frames start from raw values: a lost frame costs the
+ *      frames up to the next key frame (tools/bench/bench_pack)
+ *
+ * 21. DON'T PAY TO SEND NOISE (PRE-FILTER)
+ *    - At rest, sensor noise is most of every residual the codecs send
+ *    - imu_smooth.h: per-axis complementary (fixed gain) or 1-D Kalman
+ *      (gain from noise / motion variances) before quantization
+ *    - Less noise = more delay; the Kalman gate lets knocks through at
+ *      once (tools/bench/bench_codec_select prints the trade-off)
+ *
  * AUTHOR NOTES:
  * =============
  * This implementation evolved through debugging buffer exhaustion issues.
@@ -77,6 +190,11 @@
  * =================================================================== */
 
 #include <stdio.h>       // C standard library (printf)
+#include <string.h>      // memcpy (calibration install)
+#include <inttypes.h>    // PRIX32 (frame dumps), PRId64 (time sync)
+#include <esp_cpu.h>     // esp_cpu_get_cycle_count (codec cost)
+#include <nvs.h>         // Calibration storage (NVS is initialized by mesh_node_init)
+#include <driver/gpio.h> // Button interrupts
 #include <M5Unified.h>   // C++ library for M5StickC hardware
 
 /* C++/C INTERFACING: extern "C" Explained
@@ -132,13 +250,45 @@
 extern "C" {
     #include "ble_mesh_node.h"    // C library: mesh node management
     #include "ble_mesh_models.h"  // C library: model definitions
+    #include "imu_sample.h"       // C library: pipeline sample type
+    #include "imu_ring.h"         // C library: sampler -> publisher ring
+    #include "imu_decimator.h"    // C library: anti-aliasing decimator
+    #include "imu_envelope.h"     // C library: min/max/mean envelope frames
+    #include "imu_rice.h"         // C library: lossless Rice codec
+    #include "imu_codec.h"        // C library: codec registry + auto selection
+    #include "imu_vq.h"           // C library: learned-codebook VQ codec
+    #include "imu_fec.h"          // C library: cross-frame XOR parity
+    #include "imu_mpu6886.h"      // C library: MPU6886 register driver
+    #include "imu_autorange.h"    // C library: full-scale range controller
+    #include "imu_calib.h"        // C library: calibration matrix + temperature bias
+    #include "imu_timesync.h"     // C library: mesh-global time from gateway beacons
+    #include "imu_capture.h"      // C library: group-triggered synchronized capture
+    #include "imu_config.h"       // C library: runtime stream configuration record
+    #include "imu_masked.h"       // C library: channel-masked variable-length frames
+    #include "imu_magnitude.h"    // C library: |a| / |ω| magnitude frames
+    #include "imu_packed.h"       // C library: predictive bit-plane packed frames
+    #include "imu_smooth.h"       // C library: complementary / Kalman noise pre-filter
+    #include "imu_proto.h"        // C library: vendor opcodes, payload limits
+    #include "imu_batch.h"        // C library: cluster-head batches of members' frames
+    #include "imu_topology.h"     // C library: neighbour reports + relay sets
 }
 
 // Provisioning state flag (set by callback when node joins network)
 static bool is_provisioned = false;
 
-// Forward declaration for publishing function
+// Forward declarations for publishing functions
 void publish_imu_data(void);
+void publish_imu_envelope(const imu_envelope_window_t *w);
+void publish_imu_rice(const imu_sample_t *block, uint8_t n);
+void publish_imu_auto(const imu_sample_t *block, uint8_t n);
+void publish_imu_vq(const imu_sample_t *block, uint8_t n);
+void publish_imu_fixed(const imu_sample_t *block, uint8_t n);
+void publish_imu_ranged(const imu_sample_t *s);
+void publish_imu_masked(const imu_sample_t *s);
+void publish_imu_magnitude(const imu_mag_t *w);
+void publish_imu_packed(const imu_sample_t *s);
+void publish_capture(void);
+static void report_publish_stats(void *arg);
 
 /*
  * ───────────────────────────────────────────────────────────────────────────
@@ -159,6 +309,523 @@ static int16_t gyro_x = 0;   // Gyroscope X in dps (degrees per second)
 static int16_t gyro_y = 0;   // Gyroscope Y in dps
 static int16_t gyro_z = 0;   // Gyroscope Z in dps
 
+/*
+ * ───────────────────────────────────────────────────────────────────────────
+ *                   HIGH-RATE SAMPLING + DECIMATION
+ * ───────────────────────────────────────────────────────────────────────────
+ *
+ * Two tasks, two rates:
+ *
+ *   imu_sample_task  (200 Hz) ──push──▶ sample_ring ──pop──▶ on_window (10 Hz, mesh_loop task)
+ *                                                            │
+ *                                                   imu_decimator (low-pass + keep 1/R)
+ *
+ * Decimation ratio R = IMU_SAMPLE_RATE_HZ * IMU_PUBLISH_INTERVAL_MS / 1000
+ *   200 Hz * 100 ms / 1000 = 20 → one filtered output every 20 samples
+ *
+ * Every R samples (the ring's watermark) the sampler posts IMU_EVENT_WINDOW
+ * to the component's event loop (mesh_event_post), whose task runs the
+ * publisher, so the publish rate follows the decimation ratio automatically.
+ * Change the ratio at runtime with imu_set_decimation(), or the whole
+ * stream setup over the mesh (RUNTIME CONFIGURATION below).
+ *
+ * Pipeline samples (imu_sample_t) carry accel in mg and gyro in 0.1 dps;
+ * the globals above keep their original units for the Sensor model.
+ */
+#define IMU_SAMPLE_RATE_HZ       200   // Default sampler rate (must divide 1000)
+#define IMU_PUBLISH_INTERVAL_MS  100   // Default; 50 for 20Hz, 200 for 5Hz (or 0xCB0001)
+#define IMU_DECIM_DEFAULT_MODE   IMU_DECIM_FIR
+
+// Set to 1 to print every raw sample as "T,ax,ay,az,gx,gy,gz" on the console.
+// Save the log and feed it to the host tools in tools/ (real-trace benchmarks).
+#define IMU_TRACE_TO_CONSOLE     0
+
+// Set to 1 to print every published frame as "F,opcode,hex" on the console.
+// Pipe the log into tools/decoder/imu_decode to see what a receiver sees.
+#define IMU_FRAMES_TO_CONSOLE    0
+
+// Set to 1 to let the mesh stack pace the per-window frames: it publishes
+// the latest one at the period the provisioner configured (Config Model
+// Publication Set) instead of one per window. See MESH-DRIVEN PUBLISHING.
+#define IMU_MESH_PERIODIC        0
+
+static imu_ring_t sample_ring;                  // Sampler → publisher
+static imu_decimator_t decimator;               // Owned by the publisher task
+static volatile bool window_posted = false;     // IMU_EVENT_WINDOW queued, not yet handled
+
+// Our events on the component's event loop (mesh_event_on / mesh_event_post)
+#define IMU_EVENT_WINDOW    (MESH_EVENT_APP + 0)    // Sampler: one window is in the ring
+#define IMU_EVENT_BUTTON    (MESH_EVENT_APP + 1)    // GPIO ISR: button edge, arg = pin
+#define IMU_EVENT_PEER      (MESH_EVENT_APP + 2)    // Peer client: arg = source << 16 | |a|²
+#define IMU_EVENT_RELAY_SET (MESH_EVENT_APP + 3)    // Vendor model: relay set in relay_set_rx
+
+// Requested decimation setup (applied by the publisher between frames)
+static volatile uint8_t decim_ratio = IMU_SAMPLE_RATE_HZ * IMU_PUBLISH_INTERVAL_MS / 1000;
+static volatile imu_decim_mode_t decim_mode = IMU_DECIM_DEFAULT_MODE;
+static volatile bool decim_pending = true;
+
+/*
+ * NOISE PRE-FILTER:
+ * -----------------
+ * IMU_SMOOTH_OFF sends the calibrated samples as they are. COMPLEMENTARY
+ * or KALMAN (imu_smooth.h) smooth every axis before the decimator and the
+ * block codecs: fewer bits per sample, a little more delay. Captures and
+ * magnitude peaks still see the unsmoothed samples. Change it at runtime
+ * with imu_set_smoothing().
+ */
+#define IMU_SMOOTH_MODE          IMU_SMOOTH_OFF
+
+static imu_smooth_t smoother;                   // Owned by the publisher task
+static imu_smooth_config_t smooth_next;         // Requested setup
+static volatile bool smooth_pending = false;
+
+/*
+ * PUBLISH MODES:
+ * --------------
+ * DECIMATED: one anti-aliased value per axis per window (8 bytes, 0xC00001)
+ * ENVELOPE:  min/max/mean per axis per window (2 × 8 bytes, 0xC10001)
+ * RICE:      every raw sample, lossless (segmented, 0xC20001)
+ *
+ * The envelope window is the decimation window, so both modes publish on
+ * the same wake-up. ENVELOPE doubles the message count - at many nodes,
+ * pair it with a larger ratio (e.g. 40 → 5 windows/s, 10 msg/s).
+ *
+ * RICE ignores the decimator: it collects a block of raw samples (default
+ * IMU_RICE_BLOCK, up to IMU_BLOCK_MAX via the stream config) and
+ * sends them as one segmented message (~110 bytes, ~10 segments at 200 Hz).
+ * Meant for one node capturing at a time, not for the whole network.
+ *
+ * AUTO collects the same raw blocks, quantizes them to IMU_AUTO_PRECISION
+ * and lets the codec selector (imu_codec.h) pick the smallest frame
+ * (0xC30001, codec ID in byte 0) within IMU_AUTO_CPU_BUDGET cycles.
+ *
+ * VQ sends each raw sample of the block as codebook indexes (0xC40001,
+ * see imu_vq.h). Until the gateway has installed a codebook it behaves
+ * like AUTO, so switching modes never stalls the stream.
+ *
+ * FIXED sends the same blocks and tagged frames as AUTO, but always with
+ * the codec picked by imu_set_block_codec() - e.g. IMU_CODEC_BFP8 for
+ * impacts and tremor at near-int8 cost, IMU_CODEC_HALF for float16
+ * consumers. A block the codec declines goes through the selector.
+ *
+ * RANGED is DECIMATED with a range-tagged frame (0xC60001, imu_autorange.h):
+ * same 8 bytes and rate, but the int8 step follows the full scale the
+ * auto-ranging controller picked for the window.
+ *
+ * MASKED is DECIMATED with only the channels in the stream config's axis
+ * mask (0xCC0001, imu_masked.h). The freed bytes carry more windows per
+ * frame: accel only sends one 8-byte frame every 2 windows, one axis one
+ * every 6. Fewer messages, but the oldest window in a frame waits for it
+ * to fill (tools/bench/bench_mask).
+ *
+ * MAGNITUDE sends |a| and |ω| instead of the axes (0xCD0001,
+ * imu_magnitude.h): the largest of each window's full-rate samples, three
+ * windows per frame. Orientation-free shock / activity monitoring at a
+ * third of the messages.
+ *
+ * PACKED sends the decimated stream as predicted residuals in bit planes
+ * (0xCE0001, imu_packed.h): as many windows as fit in 8 bytes, ~2.5 on
+ * motion, 8 at rest. A frame leaves when the next window would not fit,
+ * so samples wait ~200 ms on average; a lost frame also costs the
+ * predicted frames up to the next key frame (every IMU_PACK_KEY_INTERVAL).
+ */
+typedef enum {
+    IMU_PUBLISH_DECIMATED = 0,
+    IMU_PUBLISH_ENVELOPE = 1,
+    IMU_PUBLISH_RICE = 2,
+    IMU_PUBLISH_AUTO = 3,
+    IMU_PUBLISH_VQ = 4,
+    IMU_PUBLISH_FIXED = 5,
+    IMU_PUBLISH_RANGED = 6,
+    IMU_PUBLISH_MASKED = 7,
+    IMU_PUBLISH_MAGNITUDE = 8,
+    IMU_PUBLISH_PACKED = 9,
+} imu_publish_mode_t;
+
+#define IMU_PUBLISH_DEFAULT_MODE  IMU_PUBLISH_DECIMATED
+#define IMU_RICE_BLOCK            20    // Default samples per Rice/auto block
+#define IMU_BLOCK_MAX             26    // Longest block a stream config may ask for
+#define IMU_AUTO_PRECISION        1     // Auto mode step: 1 = lossless, 100 = legacy 0.1 g
+#define IMU_AUTO_CPU_BUDGET       240000 // Cycles per block (1 ms at 240 MHz)
+#define IMU_FIXED_DEFAULT_CODEC   IMU_CODEC_BFP8
+
+static_assert(IMU_RICE_BLOCK <= IMU_BLOCK_MAX, "Default block too long");
+static_assert(IMU_BLOCK_MAX <= IMU_RICE_MAX_BLOCK, "Rice block too long");
+static_assert(IMU_BLOCK_MAX <= IMU_CODEC_MAX_BLOCK, "Auto block too long");
+static_assert(IMU_RICE_MAX_FRAME <= IMU_SEG_FRAME_MAX, "Rice frame must fit one segmented message");
+static_assert(IMU_VQ_HEADER_LEN + IMU_BLOCK_MAX * IMU_VQ_MAX_SAMPLE_BYTES <= IMU_SEG_FRAME_MAX,
+              "VQ block must fit one segmented message even if every sample escapes");
+static_assert(IMU_SEG_FRAME_MAX <= MESH_VENDOR_PUB_MAX, "Publication buffer must hold any frame");
+
+static imu_envelope_t envelope;                 // Owned by the publisher task
+static imu_sample_t raw_block[IMU_BLOCK_MAX];   // Owned by the publisher task
+static uint8_t raw_fill = 0;
+static imu_codec_selector_t codec_selector;     // Owned by the publisher task
+static volatile uint8_t fixed_codec = IMU_FIXED_DEFAULT_CODEC;
+
+/*
+ * VQ CODEBOOK DOUBLE BUFFER:
+ * --------------------------
+ * Install chunks arrive in the mesh task (vendor handler), blocks are
+ * encoded in the publisher task. The handler fills vq_installer.pending;
+ * when the last chunk is in it raises vq_ready, and the publisher copies
+ * pending → vq_codebook before its next block. While vq_ready is set the
+ * handler ignores chunks, so neither side ever reads a half-written
+ * codebook. Both are static: 3 KB each in internal DRAM, where the
+ * nearest-codeword search reads them without cache misses.
+ */
+static imu_vq_installer_t vq_installer;         // Written by the mesh task
+static imu_vq_codebook_t vq_codebook;           // Owned by the publisher task (id 0 = none)
+static volatile bool vq_ready = false;
+static volatile imu_publish_mode_t publish_mode = IMU_PUBLISH_DEFAULT_MODE;
+
+/*
+ * LOSS RECOVERY (XOR PARITY):
+ * ---------------------------
+ * IMU_FEC_K = 0 sends the stream as before. 2, 3, 4 or 8 adds one parity
+ * frame (0xE00001..0xFF0001, see imu_fec.h) after every K DECIMATED,
+ * RANGED, MASKED, MAGNITUDE or ENVELOPE frames: +50/33/25/12.5% messages, any single loss
+ * per group repaired by the gateway. Smaller K survives burstier loss - compare
+ * with tools/sim/sim_fec before picking one.
+ *
+ * Segmented modes (RICE/AUTO/VQ) are not covered: one lost segment already
+ * costs the whole block, and the parity of a ~100-byte block would have
+ * to be segmented itself.
+ *
+ * PACKED frames are not covered either: a repaired frame arrives after
+ * the predicted frames that needed it, and those were already dropped.
+ * Its key interval is its loss recovery.
+ */
+#define IMU_FEC_K  0
+
+static imu_fec_encoder_t fec_encoder;           // Owned by the publisher task
+static volatile uint8_t fec_k = IMU_FEC_K;
+static volatile bool fec_pending = true;
+
+/*
+ * AUTO-RANGING:
+ * -------------
+ * M5.begin() leaves the MPU6886 at ±8 g / ±2000 dps, and M5Unified scales
+ * every read with that range. IMU_AUTORANGE = 1 makes the sampler read the
+ * chip through our own driver (imu_mpu6886.h, on M5Unified's internal I2C
+ * bus) and lets imu_autorange switch the range at window boundaries.
+ *
+ * The controller runs either way: with IMU_AUTORANGE = 0 the chip stays at
+ * ±8 g / ±2000 dps and the controller only picks the ranged frame's scale
+ * (a value above that scale counts as "clipped" and moves it to the top).
+ * range_tag hands the window's ranges to the publisher: accel in bits 1:0,
+ * gyro in bits 3:2.
+ */
+#define IMU_AUTORANGE  0
+
+static imu_autorange_t autorange;               // Owned by the sampler task
+static volatile uint8_t range_tag = 2 | (3 << 2);
+
+/*
+ * CALIBRATION:
+ * ------------
+ * The publisher calibrates every sample it drains from the ring, in
+ * batches of up to IMU_CALIB_BATCH (imu_calib.h: matrix + offset +
+ * temperature bias, fixed point). Everything downstream - decimator,
+ * envelope, block codecs, the Sensor model - sees calibrated values.
+ *
+ * The die temperature comes from the MPU6886 TEMP_OUT register, read by
+ * the sampler once per window (imu_temp_c10, 0.1 °C).
+ *
+ * A new calibration arrives as one 0xC70001 message (the imu_calib_pack
+ * blob). The vendor handler only copies it and raises calib_ready; the
+ * publisher validates it, swaps it in between two batches and stores the
+ * blob in NVS, where it is loaded from at the next boot. No calibration
+ * stored = identity = samples unchanged.
+ */
+#define IMU_CALIB_BATCH      32
+#define IMU_CALIB_NVS_NS     "imu"
+#define IMU_CALIB_NVS_KEY    "calib"
+
+static imu_calib_t calib;                       // Owned by the publisher task
+static uint8_t calib_rx[IMU_CALIB_BLOB_MAX];    // Written by the mesh task
+static volatile uint16_t calib_rx_len = 0;
+static volatile bool calib_ready = false;
+static volatile int16_t imu_temp_c10 = 250;     // Written by the sampler task
+
+/*
+ * TIME SYNC:
+ * ----------
+ * The gateway sends a 0xC80001 beacon every few seconds (imu_timesync.h).
+ * The vendor handler reads the local clock FIRST, then copies the beacon
+ * and its received TTL into the mailbox below and raises tsync_pending;
+ * the publisher feeds the estimator.
+ *
+ * The sampler notes the local time at which each window closes
+ * (window_end_us, low 32 bits); the publisher maps it to mesh-global time
+ * and the decimated / ranged frames carry that, in ms. Not synced yet =
+ * local time, as before.
+ *
+ * IMU_TSYNC_HOP_DELAY_US is the mean delay one relay adds (network
+ * transmit + relay retransmit interval + random backoff). Measure it on
+ * your mesh if nodes at different hop counts disagree by a constant.
+ */
+#define IMU_TSYNC_HOP_DELAY_US   8000
+#define IMU_TSYNC_LOG_EVERY      30     // Print the sync state every N beacons
+
+static imu_tsync_t tsync;                       // Owned by the publisher task
+static uint8_t tsync_rx[IMU_TSYNC_BEACON_LEN];  // Written by the mesh task
+static int64_t tsync_rx_local_us;
+static uint8_t tsync_rx_ttl;
+static volatile bool tsync_pending = false;
+static uint16_t frame_ts_ms = 0;                // Mesh-global ms of the current window
+
+// Window close stamp, written by the sampler task (seqlock: odd gen = writing)
+static volatile uint32_t window_stamp_gen = 0;
+static volatile uint32_t window_end_us = 0;     // Local µs, low 32 bits
+static volatile uint32_t window_end_count = 0;  // sample_ring.head at that time
+
+/*
+ * SYNCHRONIZED CAPTURE:
+ * ---------------------
+ * Besides the data publication, the vendor model subscribes to
+ * IMU_CONTROL_GROUP at provisioning time: one 0xC90001 command sent there
+ * reaches every node (imu_capture.h). The handler copies it into the
+ * mailbox below; the publisher arms the recorder.
+ *
+ * The recorder sees every calibrated full-rate sample with its mesh-global
+ * time: sample k of sample_ring was taken (window_end_count - 1 - k) sample
+ * periods before window_end_us (the period of the active stream config).
+ * Once the window is complete, this node
+ * waits for its slot (unicast % slots) and publishes one 0xCA0001 chunk
+ * every IMU_CAPTURE_CHUNK_MS. The stream pauses from the end of the window
+ * until the last slot has ended, on every node - uploads only compete with
+ * each other (tools/sim/sim_capture).
+ */
+#define IMU_CONTROL_GROUP        0xC002 // Capture commands (data goes to the publish address)
+
+static imu_capture_t capture;                   // Owned by the publisher task
+static uint8_t capture_rx[IMU_CAPTURE_CMD_LEN]; // Written by the mesh task
+static volatile bool capture_pending = false;
+static uint16_t node_addr = 0;                  // Our unicast address (upload slot)
+static bool capture_scheduled = false;          // Upload times below are valid
+static uint8_t capture_next_chunk = 0;
+static int64_t capture_next_us = 0;             // Mesh-global time of the next chunk
+static int64_t capture_quiet_until_us = 0;      // Stream paused until then (global)
+
+/*
+ * PEER REACTIONS:
+ * ---------------
+ * A second vendor model, a client (MESH_MODEL_VENDOR_CLIENT), subscribes
+ * to IMU_DATA_GROUP - where every stick publishes - and reads the other
+ * sticks' frames directly, without a round trip through the gateway. When
+ * a peer's acceleration exceeds IMU_PEER_TRIGGER_G10, the event loop
+ * prints the peer's address and shows it on the screen: knock one stick
+ * and the others react one frame delivery later. Only legacy frames
+ * (0xC00001, DECIMATED mode) are decoded; peers in other publish modes
+ * are ignored.
+ *
+ * Off by default: every peer the client hears takes an entry in the
+ * replay protection list (CONFIG_BLE_MESH_CRPL = 32). Past ~31 sticks the
+ * list is full and the stack rejects any source it has not seen yet -
+ * the gateway's commands included. Raise CRPL with the fleet.
+ */
+#define IMU_PEER_LISTEN          0
+#define IMU_DATA_GROUP           0xC001 // The publish address the provisioner gives every node
+#define IMU_PEER_MODEL_ID        0x0002 // Client model, next to our server model (0x0001)
+#define IMU_PEER_TRIGGER_G10     25     // |a| above 2.5 g (0.1 g units, as in the frame)
+#define IMU_PEER_HOLDOFF_MS      500    // One reaction per knock, not one per frame
+#define IMU_PEER_SHOW_MS         2000   // How long the screen names the peer
+
+static volatile bool peer_posted = false;       // IMU_EVENT_PEER queued, not yet handled
+static volatile uint32_t peer_frames = 0;       // Peer frames received (mesh task)
+static uint32_t peer_reactions = 0;             // Reactions run (event loop)
+static uint16_t peer_shown = 0;                 // Peer on the screen, 0 = none
+static int64_t peer_shown_until_us = 0;
+
+/*
+ * CLUSTER-HEAD AGGREGATION:
+ * -------------------------
+ * Several sticks close together, the gateway relays away: one stick - the
+ * head - can carry the others' legacy frames. The peer client collects
+ * them, and every IMU_AGG_WINDOW_MS the head sends one segmented 0xCF0001
+ * batch (imu_batch.h) to the gateway, acknowledged by SAR. The head's own
+ * frames are published as before. The members need no firmware change:
+ * the provisioner sets their publication TTL to 0 (and best their network
+ * transmit count to one copy), so only the sticks around them hear them.
+ *
+ * Off by default. In tools/sim/sim_aggregate the batches cost as many or
+ * more transmissions per frame than publishing directly, with second-long
+ * latency: a segment holds 1.3 frames where a message holds one, but the
+ * members' hop, the acks and the resends take that back, and the head's
+ * advertiser becomes the cluster's bottleneck (tools/README.md).
+ */
+#define IMU_AGG_OFF              0
+#define IMU_AGG_HEAD             1
+#define IMU_AGG_ROLE             IMU_AGG_OFF
+#define IMU_AGG_WINDOW_MS        1000   // One batch per window (if the last one is through)
+#define IMU_GATEWAY_ADDR         0x0001 // The provisioner / gateway, batches go there
+
+#if IMU_AGG_ROLE == IMU_AGG_HEAD && !IMU_PEER_LISTEN
+#error "The cluster head collects its members' frames with the peer client (IMU_PEER_LISTEN 1)"
+#endif
+
+#if IMU_AGG_ROLE == IMU_AGG_HEAD
+static imu_batch_t agg_batch;                   // Members' frames since the last batch
+static portMUX_TYPE agg_lock = portMUX_INITIALIZER_UNLOCKED;   // BTC task ↔ event loop
+static uint32_t agg_batches = 0;                // Statistics (event loop)
+static uint32_t agg_frames = 0;
+static uint32_t agg_busy = 0;                   // Send refused: last batch still in SAR
+#endif
+
+/*
+ * RELAY ELECTION:
+ * ---------------
+ * The node starts with relay off (ble_mesh_node.c): relaying on every
+ * stick sends each frame once more per stick, relaying on none leaves the
+ * sticks out of the gateway's range alone. The gateway picks the relays:
+ *
+ *   every IMU_TOPO_REPORT_MS: 0xD00001 neighbour report ──▶ IMU_DATA_GROUP
+ *   peer client: a neighbour's report that came directly ──▶ topo_table
+ *   gateway: plans (imu_topo_plan) ──0xD10001 relay set──▶ IMU_CONTROL_GROUP
+ *   event loop: relay on iff our address is in the set (node_set_relay)
+ *
+ * The reports double as hellos: a report whose received TTL is the TTL
+ * it was sent with (first byte) came without a relay, and its RSSI is the
+ * neighbour's. The gateway side is not in this repository - it runs
+ * imu_topology.h's planner on the reports it collects. tools/sim/sim_relay
+ * measures delivery and transmissions against no relays and all relays.
+ *
+ * Off by default: without that gateway nobody acts on the reports, and a
+ * stock node would send one every 30 s and decrypt every peer's traffic
+ * for nothing. Set it to 1 (with IMU_PEER_LISTEN) once the gateway plans.
+ */
+#define IMU_RELAY_ELECTION       0
+#define IMU_TOPO_REPORT_MS       30000  // Neighbour report period
+#define IMU_TOPO_AGE_MS          90000  // Neighbours unheard for three reports are dropped
+
+#if IMU_RELAY_ELECTION && !IMU_PEER_LISTEN
+#error "Neighbour reports are heard by the peer client (IMU_PEER_LISTEN 1)"
+#endif
+
+#if IMU_RELAY_ELECTION
+static imu_topo_table_t topo_table;             // Neighbours heard
+static portMUX_TYPE topo_lock = portMUX_INITIALIZER_UNLOCKED;  // BTC task ↔ event loop
+static imu_topo_plan_t relay_set;               // Last set received (event loop)
+static uint8_t relay_set_rx[IMU_TOPO_SET_LEN_MAX];  // Written by the mesh task
+static uint8_t relay_set_rx_len = 0;
+static volatile bool relay_set_pending = false; // IMU_EVENT_RELAY_SET queued, not yet handled
+static volatile uint32_t topo_heard = 0;        // Neighbour reports heard directly (mesh task)
+static uint32_t topo_sent = 0;                  // Statistics (event loop)
+static uint32_t relay_sets = 0;
+#endif
+
+/*
+ * RUNTIME CONFIGURATION:
+ * ----------------------
+ * The defines above are the defaults. A 0xCB0001 record (imu_config.h)
+ * replaces sample period, publish interval, publish mode, decimation
+ * filter, block length, channel mask and FIXED codec in one go - sent to
+ * a node's unicast address, or to IMU_CONTROL_GROUP for every node.
+ *
+ * Three hand-overs keep every window on one configuration:
+ *
+ *   mesh task   ──config_rx──▶ publisher: validate, save to NVS
+ *   publisher   ──config_next──▶ sampler: new period + ratio from the
+ *                                 next window on (config_switched)
+ *   publisher, one wake later: decimator, envelope, mode, block, mask
+ *                              (the wake in between drains the last old window)
+ *
+ * Masked-off channels are sent as zero: the block codecs spend about one
+ * bit per sample on them. The stored record is loaded at boot, before the
+ * tasks start.
+ */
+#define IMU_CONFIG_NVS_NS        "imu"
+#define IMU_CONFIG_NVS_KEY       "stream"
+
+static imu_config_t stream_cfg;                 // Active; owned by the publisher task
+static imu_config_t config_next;                // Publisher → sampler
+static uint8_t config_rx[IMU_CONFIG_LEN];       // Written by the mesh task
+static volatile bool config_pending = false;    // Mesh task → publisher
+static volatile bool config_handoff = false;    // Publisher → sampler: switch at next close
+static volatile bool config_switched = false;   // Sampler → publisher: first new window running
+static bool config_apply = false;               // Publisher: activate at the next wake
+
+/**
+ * Select decimation filter and ratio at runtime
+ *
+ * Publish rate becomes IMU_SAMPLE_RATE_HZ / ratio.
+ * Takes effect at the next publish cycle (filter history is reset).
+ *
+ * @param mode  IMU_DECIM_FIR (better alias rejection) or IMU_DECIM_CIC (cheaper)
+ * @param ratio 1..IMU_DECIM_MAX_RATIO
+ * @return true if accepted
+ */
+bool imu_set_decimation(imu_decim_mode_t mode, uint8_t ratio)
+{
+    if (ratio < 1 || ratio > IMU_DECIM_MAX_RATIO) {
+        return false;
+    }
+    decim_mode = mode;
+    decim_ratio = ratio;
+    decim_pending = true;
+    return true;
+}
+
+/**
+ * Select the noise pre-filter at runtime (takes effect next window)
+ *
+ * Start from imu_smooth_defaults() and adjust, e.g. a lower gain or
+ * motion variance for quieter (and slower) output.
+ *
+ * @param cfg Filter mode and parameters (copied)
+ * @return true if accepted
+ */
+bool imu_set_smoothing(const imu_smooth_config_t *cfg)
+{
+    static imu_smooth_t check;
+    if (smooth_pending || !imu_smooth_configure(&check, cfg)) {
+        return false;                   // Previous request not applied yet, or bad values
+    }
+    smooth_next = *cfg;
+    smooth_pending = true;
+    return true;
+}
+
+/**
+ * Select the parity group size at runtime (takes effect next window)
+ *
+ * @param k 2, 3, 4 or 8 data frames per parity frame, 0 = off
+ * @return true if accepted
+ */
+bool imu_set_fec(uint8_t k)
+{
+    if (k != 0 && imu_fec_parity_op(k, 0) == 0) {
+        return false;
+    }
+    fec_k = k;
+    fec_pending = true;
+    return true;
+}
+
+/**
+ * Select the codec IMU_PUBLISH_FIXED uses (takes effect next block)
+ *
+ * @param codec_id Any registered imu_codec_id_t (IMU_CODEC_HALF, IMU_CODEC_BFP8, ...)
+ * @return true if the codec is registered
+ */
+bool imu_set_block_codec(uint8_t codec_id)
+{
+    if (imu_codec_find(codec_id) == NULL) {
+        return false;
+    }
+    fixed_codec = codec_id;
+    return true;
+}
+
+/**
+ * Select what the publisher sends each window (takes effect next window)
+ */
+void imu_set_publish_mode(imu_publish_mode_t mode)
+{
+    publish_mode = mode;
+}
+
 /*
  * ───────────────────────────────────────────────────────────────────────────
  *                      VENDOR MODEL OPCODE
@@ -392,6 +1059,359 @@ esp_err_t read_gyro_z(uint16_t sensor_type, int32_t *value_out, void *user_data)
     return ESP_OK;
 }
 
+/*
+ * ═══════════════════════════════════════════════════════════════════════════
+ *                         TASK LAYOUT (DUAL CORE)
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * The ESP32 has two cores. The Bluetooth controller and the Bluedroid host
+ * (BTC / BTU tasks, which also run the mesh stack) are pinned to PRO_CPU
+ * (sdkconfig.defaults). Left unpinned, our tasks landed wherever a core
+ * was free: the sampler could wake behind a BTC burst and read late, and
+ * the codec search could be pre-empted by the whole Bluetooth stack.
+ *
+ * So the pipeline is split by core:
+ *
+ *     APP_CPU (1)                                      PRO_CPU (0)
+ *     imu_sample (4) ──ring──▶ mesh_loop (3) ──publish──▶ BTC ──▶ BTU ──▶ radio
+ *     acquisition             DSP + encode      (queue)    mesh stack
+ *                             buttons, LCD, timers
+ *
+ * esp_ble_mesh_model_publish() only queues the message for the BTC task,
+ * so "publishing" - encryption, segmentation, advertising - already runs
+ * on the Bluetooth core; the frame crosses cores once, on the stack's own
+ * queue. APP_CPU has nothing else on it, so the sampler (priority 4) is
+ * only ever pre-empted by interrupts, and the loop only by the sampler.
+ *
+ * NOTE: with the loop on the other core, its priority no longer holds the
+ * publisher back behind the mesh tasks (TASK PRIORITY below). The window
+ * rate still bounds what it queues: at most a frame or two per window.
+ *
+ * Placement comes from task_layout[] - edit the table, not the
+ * xTaskCreate calls. IMU_PIN_TASKS 0 leaves every task unpinned (the old
+ * behaviour) so both layouts can be compared with the report below.
+ *
+ * TASK USAGE REPORT:
+ * ------------------
+ * Every 10 s, next to the publish statistics (needs the FreeRTOS run time
+ * statistics, enabled in sdkconfig.defaults):
+ *
+ *   🧮 Cores: PRO 18.4% busy, APP 6.1% busy
+ *      imu_sample  core 1 prio 4   2.3% CPU, wake jitter max 40 µs
+ *      mesh_loop   core 1 prio 3   3.7% CPU, window 1.9 ms avg / 4.0 ms max, ≥2% pre-empted
+ *      busiest others: BTC 9.2% (core 0), BTU 4.1% (core 0), esp_timer 0.8% (core 0)
+ *
+ * - busy %: 100% minus the core's IDLE task share
+ * - wake jitter: largest gap between two sampler wakeups beyond its period
+ * - pre-empted: window wall time the loop task did NOT get the CPU for
+ *   (wall time of on_window minus the loop's run time - a lower bound, the
+ *   loop's other handlers count as its own run time)
+ * ═══════════════════════════════════════════════════════════════════════════
+ */
+#define IMU_PIN_TASKS       1
+
+#define IMU_CORE_PRO        0           // PRO_CPU: Bluetooth controller + host
+#define IMU_CORE_APP        1           // APP_CPU
+
+typedef struct {
+    const char *name;
+    uint32_t stack;                     // Bytes
+    UBaseType_t priority;
+    BaseType_t core;                    // IMU_CORE_PRO / IMU_CORE_APP
+} imu_task_layout_t;
+
+enum { IMU_TASK_SAMPLE, IMU_TASK_LOOP, IMU_TASK_COUNT };
+
+static const imu_task_layout_t task_layout[IMU_TASK_COUNT] = {
+    { "imu_sample", 3072, 4, IMU_CORE_APP },    // Acquisition
+    { "mesh_loop",  6144, 3, IMU_CORE_APP },    // DSP + encode (on_window), events, timers
+};
+
+// Core a task is created on (tskNO_AFFINITY unpinned or single-core)
+static BaseType_t task_core(int task)
+{
+#if IMU_PIN_TASKS
+    if (task_layout[task].core < portNUM_PROCESSORS) {
+        return task_layout[task].core;
+    }
+#endif
+    (void)task;
+    return tskNO_AFFINITY;
+}
+
+// Contention counters, reset by every report
+static volatile uint32_t sample_jitter_max_us = 0;  // Sampler writes
+static uint32_t window_busy_us = 0;                 // mesh_loop only
+static uint32_t window_max_us = 0;
+static uint32_t window_count = 0;
+
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS && configTASKLIST_INCLUDE_COREID
+#define IMU_USAGE_TASKS_MAX     32
+
+typedef struct {
+    TaskHandle_t handle;
+    uint32_t run;                       // Run time counter at the last report (µs)
+} task_run_t;
+
+// Run time of 'st' since the last report
+static uint32_t task_run_delta(const TaskStatus_t *st, const task_run_t *prev, size_t n_prev)
+{
+    for (size_t i = 0; i < n_prev; i++) {
+        if (prev[i].handle == st->xHandle) {
+            return st->ulRunTimeCounter - prev[i].run;
+        }
+    }
+    return st->ulRunTimeCounter;        // Created since
+}
+
+static void print_task_line(const TaskStatus_t *st, uint32_t run, uint32_t elapsed)
+{
+    if (st->xCoreID == tskNO_AFFINITY) {
+        printf("   %-11s any    prio %u %5.1f%% CPU", st->pcTaskName,
+               (unsigned)st->uxCurrentPriority, run * 100.0f / elapsed);
+    } else {
+        printf("   %-11s core %d prio %u %5.1f%% CPU", st->pcTaskName, (int)st->xCoreID,
+               (unsigned)st->uxCurrentPriority, run * 100.0f / elapsed);
+    }
+}
+
+static void report_task_usage(void)
+{
+    static TaskStatus_t st[IMU_USAGE_TASKS_MAX];
+    static task_run_t prev[IMU_USAGE_TASKS_MAX];
+    static size_t n_prev = 0;
+    static uint32_t prev_total = 0;
+    uint32_t delta[IMU_USAGE_TASKS_MAX];
+    uint32_t total;
+
+    const size_t n = uxTaskGetSystemState(st, IMU_USAGE_TASKS_MAX, &total);
+    if (n == 0) {
+        printf("⚠️  More than %d tasks: raise IMU_USAGE_TASKS_MAX\n", IMU_USAGE_TASKS_MAX);
+        return;
+    }
+    const uint32_t elapsed = total - prev_total;
+    const bool first = (n_prev == 0);
+    for (size_t i = 0; i < n; i++) {
+        delta[i] = task_run_delta(&st[i], prev, n_prev);
+    }
+    for (size_t i = 0; i < n; i++) {
+        prev[i].handle = st[i].xHandle;
+        prev[i].run = st[i].ulRunTimeCounter;
+    }
+    n_prev = n;
+    prev_total = total;
+    if (first || elapsed == 0) {
+        return;                         // Baseline only
+    }
+
+    // Per core: whatever its IDLE task did not get
+    uint32_t idle[portNUM_PROCESSORS] = {};
+    for (size_t i = 0; i < n; i++) {
+        if (strncmp(st[i].pcTaskName, "IDLE", 4) == 0 && st[i].xCoreID < portNUM_PROCESSORS) {
+            idle[st[i].xCoreID] += delta[i];
+        }
+    }
+    printf("🧮 Cores:");
+    for (int c = 0; c < portNUM_PROCESSORS; c++) {
+        const float busy = 100.0f - (idle[c] > elapsed ? elapsed : idle[c]) * 100.0f / elapsed;
+        printf("%s %s %.1f%% busy", c ? "," : "", c == IMU_CORE_PRO ? "PRO" : "APP", busy);
+    }
+    printf("\n");
+
+    // Our tasks, with the contention they saw
+    for (size_t i = 0; i < n; i++) {
+        if (strcmp(st[i].pcTaskName, task_layout[IMU_TASK_SAMPLE].name) == 0) {
+            print_task_line(&st[i], delta[i], elapsed);
+            printf(", wake jitter max %" PRIu32 " µs\n", sample_jitter_max_us);
+        } else if (strcmp(st[i].pcTaskName, task_layout[IMU_TASK_LOOP].name) == 0) {
+            const uint32_t lost = window_busy_us > delta[i] ? window_busy_us - delta[i] : 0;
+            print_task_line(&st[i], delta[i], elapsed);
+            printf(", window %.1f ms avg / %.1f ms max, ≥%" PRIu32 "%% pre-empted\n",
+                   window_count ? window_busy_us / 1000.0f / window_count : 0.0f,
+                   window_max_us / 1000.0f, window_busy_us ? lost * 100 / window_busy_us : 0);
+        }
+    }
+
+    // The three busiest of everyone else: who we share the cores with
+    printf("   busiest others:");
+    for (int k = 0; k < 3; k++) {
+        int best = -1;
+        for (size_t i = 0; i < n; i++) {
+            const char *name = st[i].pcTaskName;
+            if (strncmp(name, "IDLE", 4) == 0 || strcmp(name, task_layout[IMU_TASK_SAMPLE].name) == 0 ||
+                strcmp(name, task_layout[IMU_TASK_LOOP].name) == 0 || delta[i] == 0) {
+                continue;
+            }
+            if (best < 0 || delta[i] > delta[best]) {
+                best = (int)i;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        if (st[best].xCoreID == tskNO_AFFINITY) {
+            printf("%s %s %.1f%% (any core)", k ? "," : "", st[best].pcTaskName,
+                   delta[best] * 100.0f / elapsed);
+        } else {
+            printf("%s %s %.1f%% (core %d)", k ? "," : "", st[best].pcTaskName,
+                   delta[best] * 100.0f / elapsed, (int)st[best].xCoreID);
+        }
+        delta[best] = 0;                // Taken
+    }
+    printf("\n");
+}
+#else
+static void report_task_usage(void)
+{
+    static bool told = false;
+    if (!told) {
+        told = true;
+        printf("🧮 Task usage needs CONFIG_FREERTOS_USE_TRACE_FACILITY, "
+               "CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS and "
+               "CONFIG_FREERTOS_VTASKLIST_INCLUDE_COREID\n");
+    }
+}
+#endif
+
+/*
+ * ═══════════════════════════════════════════════════════════════════════════
+ *                         IMU SAMPLING TASK
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * Reads the IMU at IMU_SAMPLE_RATE_HZ and pushes raw samples into
+ * sample_ring. Does nothing else - no filtering, no mesh, no display -
+ * so its timing stays tight.
+ *
+ * vTaskDelayUntil vs vTaskDelay:
+ * ------------------------------
+ * vTaskDelay(5) sleeps 5 ticks AFTER the work is done, so the period
+ * drifts by however long the I2C read took. vTaskDelayUntil() wakes at
+ * fixed absolute tick boundaries: 0, 5, 10, 15... ms. A steady sample
+ * rate is what the decimation filter design assumes.
+ *
+ * Priority 4: above the publisher (it must never wait for the LCD or
+ * the mesh API), still below the BLE Mesh tasks (~5-8). Pinned to APP_CPU
+ * with the loop task, away from Bluetooth (TASK LAYOUT above).
+ * ═══════════════════════════════════════════════════════════════════════════
+ */
+// imu_reg_bus_t on M5Unified's internal I2C bus (400 kHz)
+static int imu_bus_read(void *ctx, uint8_t reg, uint8_t *buf, size_t len)
+{
+    (void)ctx;
+    return M5.In_I2C.readRegister(IMU_MPU6886_ADDR, reg, buf, len, 400000) ? 0 : -1;
+}
+
+static int imu_bus_write(void *ctx, uint8_t reg, uint8_t value)
+{
+    (void)ctx;
+    return M5.In_I2C.writeRegister8(IMU_MPU6886_ADDR, reg, value, 400000) ? 0 : -1;
+}
+
+void imu_sample_task(void *pvParameters)
+{
+    TickType_t period = pdMS_TO_TICKS(stream_cfg.period_ms);  // Loaded before the tasks start
+    TickType_t last_wake = xTaskGetTickCount();
+    uint8_t since_notify = 0;
+    uint32_t last_woke_us = 0;
+
+    imu_autorange_config_t range_cfg = imu_autorange_default_config();
+    imu_autorange_init(&autorange, &range_cfg, range_tag & 0x03, range_tag >> 2);
+
+    // Our own driver: temperature always, samples and ranges with IMU_AUTORANGE
+    imu_mpu6886_t imu_dev;
+    const imu_reg_bus_t bus = { imu_bus_read, imu_bus_write, NULL };
+    const bool own_driver = imu_mpu6886_init(&imu_dev, &bus);
+    if (!own_driver) {
+        printf("⚠️  MPU6886 not found: no auto-ranging, no temperature\n");
+    }
+#if IMU_AUTORANGE
+    if (own_driver) {
+        imu_autorange_init(&autorange, &range_cfg, imu_dev.accel_range, imu_dev.gyro_range);
+    }
+#endif
+
+    while(1) {
+        vTaskDelayUntil(&last_wake, period);
+
+        // Contention shows up as a late wakeup (TASK USAGE REPORT)
+        const uint32_t woke_us = (uint32_t)esp_timer_get_time();
+        const uint32_t period_us = (uint32_t)period * portTICK_PERIOD_MS * 1000u;
+        const uint32_t gap_us = woke_us - last_woke_us;
+        if (last_woke_us && gap_us > period_us && gap_us - period_us > sample_jitter_max_us) {
+            sample_jitter_max_us = gap_us - period_us;
+        }
+        last_woke_us = woke_us;
+
+        imu_sample_t s;
+#if IMU_AUTORANGE
+        // NOTE: raw chip axes - M5Unified may remap axes for the board
+        // orientation in getImuData(), the driver does not
+        if (!own_driver || !imu_mpu6886_read(&imu_dev, &s))
+#endif
+        {
+            M5.Imu.update();
+            auto imu_data = M5.Imu.getImuData();
+
+            // Float → pipeline fixed point (accel mg, gyro 0.1 dps)
+            s.v[IMU_AXIS_AX] = imu_sat16((int32_t)(imu_data.accel.x * 1000.0f));
+            s.v[IMU_AXIS_AY] = imu_sat16((int32_t)(imu_data.accel.y * 1000.0f));
+            s.v[IMU_AXIS_AZ] = imu_sat16((int32_t)(imu_data.accel.z * 1000.0f));
+            s.v[IMU_AXIS_GX] = imu_sat16((int32_t)(imu_data.gyro.x * 10.0f));
+            s.v[IMU_AXIS_GY] = imu_sat16((int32_t)(imu_data.gyro.y * 10.0f));
+            s.v[IMU_AXIS_GZ] = imu_sat16((int32_t)(imu_data.gyro.z * 10.0f));
+        }
+        imu_autorange_observe(&autorange, &s);
+
+#if IMU_TRACE_TO_CONSOLE
+        printf("T,%d,%d,%d,%d,%d,%d\n", s.v[0], s.v[1], s.v[2], s.v[3], s.v[4], s.v[5]);
+#endif
+
+        imu_ring_push(&sample_ring, &s);
+
+        // Wake the publisher once per decimated output
+        if (++since_notify >= decim_ratio) {
+            since_notify = 0;
+
+            // Window closed: its ranges tag the frame, and drive the chip
+            imu_range_t a_r, g_r;
+            bool changed = imu_autorange_update(&autorange, &a_r, &g_r);
+            range_tag = (uint8_t)(a_r | (g_r << 2));
+            __atomic_store_n(&window_stamp_gen, window_stamp_gen + 1, __ATOMIC_RELEASE);
+            window_end_us = (uint32_t)esp_timer_get_time();
+            window_end_count = sample_ring.head;
+            __atomic_store_n(&window_stamp_gen, window_stamp_gen + 1, __ATOMIC_RELEASE);
+
+            // A new stream config starts with the next window
+            if (config_handoff) {
+                period = pdMS_TO_TICKS(config_next.period_ms);
+                decim_ratio = imu_config_ratio(&config_next);
+                config_handoff = false;
+                config_switched = true;
+            }
+#if IMU_AUTORANGE
+            if (changed && own_driver && !imu_mpu6886_set_range(&imu_dev, a_r, g_r)) {
+                printf("⚠️  Range change failed\n");
+            }
+            imu_temp_c10 = imu_dev.temp_c10;    // Latched with every sample read
+#else
+            (void)changed;
+            int16_t temp_c10;
+            if (own_driver && imu_mpu6886_read_temp(&imu_dev, &temp_c10)) {
+                imu_temp_c10 = temp_c10;
+            }
+#endif
+            // One event per watermark, and none while the last one is still
+            // queued: its handler drains the whole ring anyway
+            if (!window_posted) {
+                window_posted = true;
+                if (mesh_event_post(IMU_EVENT_WINDOW, 0) != ESP_OK) {
+                    window_posted = false;
+                }
+            }
+        }
+    }
+}
+
 /*
  * ═══════════════════════════════════════════════════════════════════════════
  *                         IMU PUBLISHING TASK
@@ -409,7 +1429,7 @@ esp_err_t read_gyro_z(uint16_t sensor_type, int32_t *value_out, void *user_data)
  *
  * Solution:
  * ---------
- * 1. Dedicated publishing task at priority 3 (lower than mesh tasks)
+ * 1. Publishing on the mesh event loop task at priority 3 (lower than mesh tasks)
  * 2. FreeRTOS scheduler gives mesh tasks preference when they need CPU
  * 3. Mesh advertising task gets time to:
  *    - Copy messages to HCI buffers
@@ -421,8 +1441,8 @@ esp_err_t read_gyro_z(uint16_t sensor_type, int32_t *value_out, void *user_data)
  * ------------------------
  * Priority 8-10: System critical (Bluetooth controller)
  * Priority 5-8:  BLE Mesh advertising task
- * Priority 3:    IMU publishing task (THIS TASK)
- * Priority 1:    Main UI task
+ * Priority 4:    IMU sampling task
+ * Priority 3:    mesh_loop task: IMU publishing (on_window), buttons, timers
  *
  * Why This Works:
  * ---------------
@@ -431,107 +1451,750 @@ esp_err_t read_gyro_z(uint16_t sensor_type, int32_t *value_out, void *user_data)
  * - We only publish when mesh isn't busy
  * - Natural flow control prevents buffer overflow
  *
+ * With IMU_PIN_TASKS (TASK LAYOUT) the priorities only order tasks on the
+ * SAME core: sampler and loop share APP_CPU, the Bluetooth tasks own
+ * PRO_CPU. The mesh never waits for our tasks at all; what limits the
+ * queued messages is the window rate.
+ *
  * Timing:
  * -------
- * - 5 second delay at startup: Wait for provisioning config to complete
+ * - No startup delay: the filter runs from the first window, frames go out
+ *   once provisioned (is_provisioned) - failed publishes before the AppKey
+ *   is bound are harmless (ESP_ERR_INVALID_STATE)
  * - 100ms publish interval: 10 Hz rate, sustainable with multiple nodes
+ *   (paced by the sampler's notification every R samples, see above)
  * - Each message takes ~30-50ms to transmit, but we don't block
  *
  * ═══════════════════════════════════════════════════════════════════════════
  */
-void imu_publish_task(void *pvParameters)
+// Selector clock: raw CPU cycles (wraps every ~18 s, differences stay valid)
+static uint32_t cycle_clock(void)
 {
-    // Wait for initial provisioning and configuration to complete
-    // The provisioner needs time to:
-    // 1. Complete provisioning handshake
-    // 2. Bind AppKey to our models
-    // 3. Configure publication addresses
-    // Without this delay, we'd try to send before being properly configured
-    vTaskDelay(pdMS_TO_TICKS(5000));
+    return esp_cpu_get_cycle_count();
+}
 
-    while(1) {
-        // Check if node has been provisioned (joined the mesh network)
-        if (!is_provisioned) {
-            vTaskDelay(pdMS_TO_TICKS(1000));
-            continue;  // Wait for provisioning
-        }
+// Pop up to 'cap' samples from the sampler ring
+static size_t pop_batch(imu_sample_t *buf, size_t cap)
+{
+    size_t n = 0;
+    while (n < cap && imu_ring_pop(&sample_ring, &buf[n])) {
+        n++;
+    }
+    return n;
+}
 
-        // Update IMU sensor readings
-        M5.Imu.update();
-        auto imu_data = M5.Imu.getImuData();
+// Load the calibration stored in NVS (identity if none or invalid)
+static void calib_load(void)
+{
+    uint8_t blob[IMU_CALIB_BLOB_MAX];
+    size_t len = sizeof(blob);
+    nvs_handle_t h;
 
-        // Store latest values in global variables
-        accel_x = (int16_t)(imu_data.accel.x * 1000.0f);
-        accel_y = (int16_t)(imu_data.accel.y * 1000.0f);
-        accel_z = (int16_t)(imu_data.accel.z * 1000.0f);
-        gyro_x = (int16_t)(imu_data.gyro.x);
-        gyro_y = (int16_t)(imu_data.gyro.y);
-        gyro_z = (int16_t)(imu_data.gyro.z);
+    imu_calib_identity(&calib);
+    if (nvs_open(IMU_CALIB_NVS_NS, NVS_READONLY, &h) != ESP_OK) {
+        return;
+    }
+    esp_err_t ret = nvs_get_blob(h, IMU_CALIB_NVS_KEY, blob, &len);
+    nvs_close(h);
+    if (ret == ESP_OK && imu_calib_unpack(blob, len, &calib)) {
+        printf("🎯 Calibration %u loaded (%u temperature points)\n", calib.id, calib.temp_points);
+    }
+}
 
-        // Send compressed IMU data via BLE Mesh
-        publish_imu_data();
+// Swap in a calibration received over the mesh and persist it
+static void calib_install(void)
+{
+    imu_calib_t next;
+    const uint16_t len = calib_rx_len;
+    if (!imu_calib_unpack(calib_rx, len, &next)) {
+        printf("⚠️  Bad calibration (%u bytes)\n", len);
+        return;
+    }
+    calib = next;
 
-        // 100ms interval = 10 Hz update rate
-        // This is a good balance:
-        // - Fast enough for motion tracking
-        // - Slow enough to avoid overwhelming the mesh network
-        // - Allows ~50+ nodes to coexist in same network
-        vTaskDelay(pdMS_TO_TICKS(100));
+    nvs_handle_t h;
+    esp_err_t ret = nvs_open(IMU_CALIB_NVS_NS, NVS_READWRITE, &h);
+    if (ret == ESP_OK) {
+        ret = nvs_set_blob(h, IMU_CALIB_NVS_KEY, calib_rx, len);
+        if (ret == ESP_OK) {
+            ret = nvs_commit(h);
+        }
+        nvs_close(h);
     }
+    printf("🎯 Calibration %u active%s\n", calib.id, (ret == ESP_OK) ? ", saved" : ", NOT saved");
 }
 
-/*
- * ═══════════════════════════════════════════════════════════════════════════
- *                      IMU DATA PUBLISHING FUNCTION
- * ═══════════════════════════════════════════════════════════════════════════
- *
- * Packs all 6 IMU values into an 8-byte message and sends via vendor model.
- *
- * COMPRESSION ALGORITHM:
- * ----------------------
- * Input:  int16_t values (accel in mg, gyro in dps)
- * Output: int8_t values (accel in 0.1g, gyro in 10dps)
- *
- * Accel compression:
- *   - Divide mg by 100 → 0.1g units
- *   - Example: 1500 mg = 1.5g → 1500/100 = 15
- *   - Range: ±127 * 0.1g = ±12.7g (sufficient for most motion)
- *
- * Gyro compression:
- *   - Divide dps by 10 → 10dps units
- *   - Example: 250 dps → 250/10 = 25
- *   - Range: ±127 * 10dps = ±1270 dps (sufficient for human motion)
- *
- * NETWORK TRANSMISSION:
- * ---------------------
- * mesh_model_send_vendor() does:
- * 1. Looks up vendor model by index (0 = first vendor model)
- * 2. Prepares BLE Mesh message with opcode 0xC00001
- * 3. Encrypts payload with AppKey
- * 4. Adds network headers (src, dst, TTL)
- * 5. Queues for transmission to address 0x0001 (provisioner)
- *
- * NO SEGMENTATION:
- * ----------------
- * 8 bytes < 11 byte segment limit = single packet transmission
- * - Fast: ~30ms total time
- * - Efficient: Uses 1 network buffer (not 3+)
- * - Reliable: Lower chance of packet loss
- *
- * ═══════════════════════════════════════════════════════════════════════════
- */
-void publish_imu_data(void)
+// Feed a received beacon to the estimator
+static void tsync_update(void)
 {
-    // Get microsecond timestamp, convert to milliseconds
-    // esp_timer_get_time() returns microseconds since boot
-    // Wraps every ~49 days (uint64_t), but we use uint16_t (wraps every ~65 seconds)
-    // This is fine because we only need relative timing for correlation
-    uint16_t timestamp = (uint16_t)(esp_timer_get_time() / 1000);
+    imu_tsync_beacon_t b;
+    if (!imu_tsync_beacon_unpack(tsync_rx, sizeof(tsync_rx), &b)) {
+        return;
+    }
+    const uint32_t restarts = tsync.restarts;
+    const bool updated = imu_tsync_feed(&tsync, &b, tsync_rx_ttl, tsync_rx_local_us);
+    if (tsync.restarts != restarts) {
+        printf("⏱  Time sync restarted (gateway clock stepped?)\n");
+    }
+    if (updated && (tsync.used == 1 || tsync.beacons % IMU_TSYNC_LOG_EVERY == 0)) {
+        printf("⏱  Sync: offset %" PRId64 " us, skew %+.1f ppm, error ~%.1f ms "
+               "(%" PRIu32 "/%" PRIu32 " beacons used)\n",
+               imu_tsync_to_global(&tsync, tsync.anchor_us) - tsync.anchor_us,
+               tsync.skew * 1e6, tsync.error_us / 1000.0, tsync.used, tsync.beacons);
+    }
+}
 
-    // Pack all 6 IMU values + timestamp into 8 bytes
-    imu_compact_data_t imu_data = {
-        .timestamp_ms = timestamp,
-        .accel_x = (int8_t)(accel_x / 100),  // mg → 0.1g units
+// Local µs of the window the sampler just closed, and the ring count at that time
+static int64_t window_end_local(uint32_t *count)
+{
+    uint32_t gen, end_us;
+    do {
+        gen = __atomic_load_n(&window_stamp_gen, __ATOMIC_ACQUIRE);
+        end_us = window_end_us;
+        *count = window_end_count;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((gen & 1) || gen != window_stamp_gen);
+
+    const int64_t now = esp_timer_get_time();
+    return now - (uint32_t)((uint32_t)now - end_us);
+}
+
+// Defaults from the defines at the top of this file
+static imu_config_t stream_config_defaults(void)
+{
+    imu_config_t c = {};
+    c.period_ms = 1000 / IMU_SAMPLE_RATE_HZ;
+    c.publish_ms = IMU_PUBLISH_INTERVAL_MS;
+    c.mode = IMU_PUBLISH_DEFAULT_MODE;
+    c.decim = IMU_DECIM_DEFAULT_MODE;
+    c.block = IMU_RICE_BLOCK;
+    c.axis_mask = IMU_AXIS_MASK_ALL;
+    c.codec = IMU_FIXED_DEFAULT_CODEC;
+    return c;
+}
+
+static bool stream_config_valid(const imu_config_t *c)
+{
+    return imu_config_check(c, IMU_BLOCK_MAX) && c->mode <= IMU_PUBLISH_PACKED &&
+           imu_codec_find(c->codec) != NULL;
+}
+
+// Make 'c' the configuration the tasks start with (app_main, before they run)
+static void stream_config_set_initial(const imu_config_t *c)
+{
+    stream_cfg = *c;
+    decim_ratio = imu_config_ratio(c);
+    decim_mode = (imu_decim_mode_t)c->decim;
+    decim_pending = true;
+    publish_mode = (imu_publish_mode_t)c->mode;
+    fixed_codec = c->codec;
+}
+
+// Load the stream config stored in NVS (defaults if none or invalid)
+static void stream_config_load(void)
+{
+    imu_config_t c = stream_config_defaults();
+    uint8_t blob[IMU_CONFIG_LEN];
+    size_t len = sizeof(blob);
+    nvs_handle_t h;
+
+    if (nvs_open(IMU_CONFIG_NVS_NS, NVS_READONLY, &h) == ESP_OK) {
+        imu_config_t stored;
+        esp_err_t ret = nvs_get_blob(h, IMU_CONFIG_NVS_KEY, blob, &len);
+        nvs_close(h);
+        if (ret == ESP_OK && imu_config_unpack(blob, len, &stored) && stream_config_valid(&stored)) {
+            c = stored;
+            printf("🎛  Stream config %u loaded\n", c.id);
+        }
+    }
+    stream_config_set_initial(&c);
+}
+
+// Validate a config received over the mesh, store it and hand it to the sampler
+static void config_receive(void)
+{
+    imu_config_t c;
+    if (!imu_config_unpack(config_rx, sizeof(config_rx), &c) || !stream_config_valid(&c)) {
+        printf("⚠️  Bad stream config\n");
+        return;
+    }
+    config_next = c;
+    config_handoff = true;
+
+    nvs_handle_t h;
+    esp_err_t ret = nvs_open(IMU_CONFIG_NVS_NS, NVS_READWRITE, &h);
+    if (ret == ESP_OK) {
+        ret = nvs_set_blob(h, IMU_CONFIG_NVS_KEY, config_rx, sizeof(config_rx));
+        if (ret == ESP_OK) {
+            ret = nvs_commit(h);
+        }
+        nvs_close(h);
+    }
+    printf("🎛  Stream config %u: %u Hz, %u ms windows, mode %u, block %u, axes 0x%02X%s\n",
+           c.id, 1000u / c.period_ms, c.publish_ms, c.mode, c.block, c.axis_mask,
+           (ret == ESP_OK) ? ", saved" : ", NOT saved");
+}
+
+// First window sampled with config_next is in the ring: switch the publisher over
+static void config_activate(void)
+{
+    stream_cfg = config_next;
+    decim_mode = (imu_decim_mode_t)stream_cfg.decim;
+    imu_decimator_configure(&decimator, decim_mode, imu_config_ratio(&stream_cfg));
+    imu_envelope_init(&envelope, imu_config_ratio(&stream_cfg));
+    decim_pending = false;
+    publish_mode = (imu_publish_mode_t)stream_cfg.mode;
+    fixed_codec = stream_cfg.codec;
+    raw_fill = 0;           // A block never mixes two configurations
+}
+
+// Zero the channels the stream config switched off (stream path only)
+static void mask_axes(imu_sample_t *batch, size_t n, uint8_t mask)
+{
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        if (mask & (1u << a)) {
+            continue;
+        }
+        for (size_t i = 0; i < n; i++) {
+            batch[i].v[a] = 0;
+        }
+    }
+}
+
+// Arm the recorder with a received capture command
+static void capture_arm(void)
+{
+    imu_capture_cmd_t cmd;
+    if (!imu_capture_cmd_unpack(capture_rx, sizeof(capture_rx), &cmd)) {
+        return;
+    }
+    if (!imu_capture_arm(&capture, &cmd)) {
+        printf("⚠️  Capture %u rejected (busy, bad length or T already gone)\n", cmd.id);
+        return;
+    }
+    capture_scheduled = false;
+    printf("📸 Capture %u armed: %u samples%s\n", cmd.id, cmd.samples,
+           tsync.synced ? "" : " (NOT time-synced - local clock!)");
+}
+
+/**
+ * Feed a calibrated batch to the capture history
+ * @param first sample_ring index of batch[0]
+ */
+static void capture_record(const imu_sample_t *batch, size_t n, uint32_t first,
+                           uint32_t end_count, int64_t end_local_us)
+{
+    const int64_t period_us = (int64_t)stream_cfg.period_ms * 1000;
+    const int32_t back = (int32_t)(end_count - 1 - first);
+    const int64_t t0 = imu_tsync_to_global(&tsync, end_local_us - back * period_us);
+    for (size_t i = 0; i < n; i++) {
+        imu_capture_push(&capture, &batch[i], (uint32_t)(t0 + (int64_t)i * period_us));
+    }
+}
+
+// Window complete: work out this node's upload slot and the quiet period
+static void capture_schedule(int64_t now_global)
+{
+    const imu_capture_cmd_t *cmd = &capture.cmd;
+    const int64_t t_start = now_global + (int32_t)(cmd->t_start_us - (uint32_t)now_global);
+    const int64_t t_end = t_start + (int64_t)cmd->samples * stream_cfg.period_ms * 1000;
+
+    uint32_t quiet_ms = (uint32_t)(cmd->slots > 1 ? cmd->slots : 1) * cmd->slot_100ms * 100u;
+    if (quiet_ms < imu_capture_upload_ms(cmd->samples)) {
+        quiet_ms = imu_capture_upload_ms(cmd->samples);
+    }
+    capture_next_chunk = 0;
+    capture_next_us = t_end + (int64_t)imu_capture_slot_delay_ms(cmd, node_addr) * 1000;
+    capture_quiet_until_us = t_end + (int64_t)quiet_ms * 1000;
+    capture_scheduled = true;
+    printf("📸 Capture %u recorded, upload in %" PRId64 " ms\n",
+           cmd->id, (capture_next_us - now_global) / 1000);
+}
+
+// Streaming paused? (a window waits for upload, or another node's slot is running)
+static bool capture_quiet(int64_t now_global)
+{
+    return capture.state == IMU_CAPTURE_READY || now_global < capture_quiet_until_us;
+}
+
+// Publisher state: set up once in app_main, before the sampler starts
+static void publisher_init(void)
+{
+    // Codec selector for IMU_PUBLISH_AUTO: all codecs, timed with the CPU cycle counter
+    imu_codec_select_config_t codec_cfg = {};
+    codec_cfg.allowed_mask = IMU_CODEC_MASK_ALL;
+    codec_cfg.precision = IMU_AUTO_PRECISION;
+    codec_cfg.max_frame = IMU_CODEC_MAX_FRAME;
+    codec_cfg.cpu_budget = IMU_AUTO_CPU_BUDGET;
+    codec_cfg.clock = cycle_clock;
+    imu_codec_selector_init(&codec_selector, &codec_cfg);
+    imu_fec_encoder_init(&fec_encoder, 0);
+    calib_load();
+    imu_tsync_init(&tsync, IMU_TSYNC_HOP_DELAY_US);
+    imu_capture_init(&capture);
+    imu_smooth_config_t smooth_cfg;
+    imu_smooth_defaults(&smooth_cfg, IMU_SMOOTH_MODE);
+    imu_smooth_configure(&smoother, &smooth_cfg);
+}
+
+// One window: drain the ring, calibrate, filter, encode, publish
+static void process_window(void)
+{
+    imu_sample_t in;
+
+    // Apply a pending ratio/mode change between frames
+    if (decim_pending) {
+        decim_pending = false;
+        imu_decimator_configure(&decimator, decim_mode, decim_ratio);
+        imu_envelope_init(&envelope, decim_ratio);
+    }
+    if (fec_pending) {
+        fec_pending = false;
+        imu_fec_encoder_set_k(&fec_encoder, fec_k);
+    }
+    if (smooth_pending) {
+        imu_smooth_configure(&smoother, &smooth_next);
+        smooth_pending = false;     // Setter may accept the next one
+    }
+    if (calib_ready) {
+        calib_install();
+        calib_ready = false;        // Handler may accept the next one
+    }
+    if (tsync_pending) {
+        tsync_update();
+        tsync_pending = false;
+    }
+    if (capture_pending) {
+        capture_arm();
+        capture_pending = false;
+    }
+
+    // Stream config: the wake after the sampler switched drains the last
+    // old window, so the publisher switches one wake later
+    if (config_apply) {
+        config_apply = false;
+        config_activate();
+    }
+    if (config_switched) {
+        config_switched = false;
+        config_apply = true;
+    }
+    if (config_pending && !config_handoff && !config_apply) {
+        config_receive();
+        config_pending = false;     // Handler may accept the next one
+    }
+    uint32_t end_count;
+    const int64_t end_local_us = window_end_local(&end_count);
+    frame_ts_ms = (uint16_t)(imu_tsync_to_global(&tsync, end_local_us) / 1000);
+    const int64_t now_global = imu_tsync_to_global(&tsync, esp_timer_get_time());
+    const bool stream = is_provisioned && !capture_quiet(now_global);
+
+    // Drain the ring in batches: calibrate, then run each sample through
+    // the anti-aliasing filter and the envelope
+    // Normally exactly R samples → exactly one output / one window
+    imu_sample_t out;
+    imu_envelope_window_t window;
+    bool have_output = false;
+    bool have_window = false;
+    imu_sample_t batch[IMU_CALIB_BATCH];
+    static imu_mag_t mag_peak = {};         // Largest |a| / |ω| of this window
+    size_t n;
+    uint32_t first = sample_ring.tail;      // Consumer-owned: index of batch[0]
+    while ((n = pop_batch(batch, IMU_CALIB_BATCH)) > 0) {
+        imu_calib_apply(&calib, imu_temp_c10, batch, n);
+        // Captures keep every channel: the mask only saves stream airtime
+        capture_record(batch, n, first, end_count, end_local_us);
+        first += n;
+        if (stream_cfg.axis_mask != IMU_AXIS_MASK_ALL) {
+            mask_axes(batch, n, stream_cfg.axis_mask);
+        }
+        if (publish_mode == IMU_PUBLISH_MAGNITUDE) {
+            imu_mag_peak(batch, n, &mag_peak);
+        }
+        imu_smooth_apply(&smoother, batch, n);
+        for (size_t i = 0; i < n; i++) {
+            in = batch[i];
+            if (imu_decimator_push(&decimator, &in, &out)) {
+                have_output = true;
+            }
+            if (imu_envelope_push(&envelope, &in, &window)) {
+                have_window = true;
+            }
+            // Block codecs work on full-rate samples, one block at a time
+            if (publish_mode == IMU_PUBLISH_RICE || publish_mode == IMU_PUBLISH_AUTO ||
+                publish_mode == IMU_PUBLISH_VQ || publish_mode == IMU_PUBLISH_FIXED) {
+                raw_block[raw_fill++] = in;
+                if (raw_fill == stream_cfg.block) {
+                    raw_fill = 0;
+                    if (stream && publish_mode == IMU_PUBLISH_RICE) {
+                        publish_imu_rice(raw_block, stream_cfg.block);
+                    } else if (stream && publish_mode == IMU_PUBLISH_VQ) {
+                        publish_imu_vq(raw_block, stream_cfg.block);
+                    } else if (stream && publish_mode == IMU_PUBLISH_FIXED) {
+                        publish_imu_fixed(raw_block, stream_cfg.block);
+                    } else if (stream) {
+                        publish_imu_auto(raw_block, stream_cfg.block);
+                    }
+                }
+            }
+        }
+    }
+    if (capture.state == IMU_CAPTURE_READY) {
+        if (!capture_scheduled) {
+            capture_schedule(now_global);
+        }
+        publish_capture();
+    }
+    if (!have_output) {
+        return;
+    }
+    // The window is closed: its peak is final whether or not it is sent
+    const imu_mag_t window_mag = mag_peak;
+    mag_peak = {};
+
+    // Store latest filtered values in global variables
+    accel_x = out.v[IMU_AXIS_AX];
+    accel_y = out.v[IMU_AXIS_AY];
+    accel_z = out.v[IMU_AXIS_AZ];
+    gyro_x = out.v[IMU_AXIS_GX] / 10;   // 0.1 dps → dps
+    gyro_y = out.v[IMU_AXIS_GY] / 10;
+    gyro_z = out.v[IMU_AXIS_GZ] / 10;
+
+    // Check if node has been provisioned (joined the mesh network)
+    // The filter keeps running while we wait, so the first frame is valid
+    // (Rice/auto/VQ/fixed blocks were already sent from the drain loop above)
+    // and stays quiet while capture windows are being uploaded
+    if (!stream || publish_mode == IMU_PUBLISH_RICE ||
+        publish_mode == IMU_PUBLISH_AUTO || publish_mode == IMU_PUBLISH_VQ ||
+        publish_mode == IMU_PUBLISH_FIXED) {
+        return;
+    }
+
+    // Send compressed IMU data via BLE Mesh
+    if (publish_mode == IMU_PUBLISH_ENVELOPE && have_window) {
+        publish_imu_envelope(&window);
+    } else if (publish_mode == IMU_PUBLISH_RANGED) {
+        publish_imu_ranged(&out);
+    } else if (publish_mode == IMU_PUBLISH_MASKED) {
+        publish_imu_masked(&out);
+    } else if (publish_mode == IMU_PUBLISH_MAGNITUDE) {
+        publish_imu_magnitude(&window_mag);
+    } else if (publish_mode == IMU_PUBLISH_PACKED) {
+        publish_imu_packed(&out);
+    } else {
+        publish_imu_data();
+    }
+}
+
+/**
+ * IMU_EVENT_WINDOW: the sampler has collected one decimation window
+ * Runs on the mesh event loop task (priority 3, APP_CPU, see TASK LAYOUT)
+ */
+static void on_window(const mesh_event_t *ev, void *ctx)
+{
+    (void)ev;
+    (void)ctx;
+    window_posted = false;              // The sampler may post the next one now
+
+    const int64_t t0 = esp_timer_get_time();
+    process_window();
+    const uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+    window_busy_us += us;
+    window_count++;
+    if (us > window_max_us) {
+        window_max_us = us;
+    }
+}
+
+#if IMU_FRAMES_TO_CONSOLE
+// "F,<opcode>,<hex>" - the line format tools/decoder/imu_decode reads
+static void print_frame(uint32_t opcode, const uint8_t *data, size_t len)
+{
+    printf("F,%06" PRIX32 ",", opcode);
+    for (size_t i = 0; i < len; i++) {
+        printf("%02X", data[i]);
+    }
+    printf("\n");
+}
+#endif
+
+/*
+ * ═══════════════════════════════════════════════════════════════════════════
+ *                    ENCODE IN PLACE
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * A frame used to be built in a local array, and mesh_model_publish_vendor()
+ * then had the stack allocate a buffer and copy it in. Single-frame-per-
+ * window publishers now encode straight into the vendor model's stage
+ * instead (mesh_model_vendor_reserve / _commit), which the stack copies
+ * into its publication buffer: no allocation on the way to the radio.
+ *
+ * No stage before the node is provisioned, nor while the last frame is
+ * still on air (retransmissions included - a short publish_ms gets there).
+ * The frame then goes to the caller's spare buffer and out through the
+ * copying publish; unprovisioned, the commit reports ESP_ERR_INVALID_STATE
+ * just as the copying publish did, and console output and FEC accounting
+ * keep working.
+ *
+ * Bursts stay on the copying path: the envelope's frame pair, FEC parity,
+ * capture chunks, the auto selector's candidates and packed frames (the
+ * encoder only knows a frame is due once it has written it).
+ * ═══════════════════════════════════════════════════════════════════════════
+ */
+#if !IMU_MESH_PERIODIC
+static uint8_t *frame_spare = NULL;             // frame_reserve fell back to the caller's buffer
+static uint32_t frame_spare_op;
+
+static uint8_t *frame_reserve(uint32_t opcode, uint8_t *spare, uint16_t max_len)
+{
+    uint8_t *p = mesh_model_vendor_reserve(0, opcode, max_len);
+    frame_spare = p ? NULL : spare;
+    frame_spare_op = opcode;
+    return p ? p : spare;
+}
+
+static esp_err_t frame_commit(size_t len)
+{
+    if (!frame_spare) {
+        return mesh_model_vendor_commit(0, (uint16_t)len);
+    }
+    uint8_t *spare = frame_spare;
+    frame_spare = NULL;
+    if (len == 0) {
+        return ESP_OK;
+    }
+    if (!is_provisioned) {
+        return ESP_ERR_INVALID_STATE;           // No publication yet
+    }
+    return mesh_model_publish_vendor(0, frame_spare_op, spare, (uint16_t)len);
+}
+#else
+/*
+ * ═══════════════════════════════════════════════════════════════════════════
+ *                    MESH-DRIVEN PUBLISHING (IMU_MESH_PERIODIC)
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * The same publishers, but nothing is sent when a window closes: the frame
+ * becomes the LATEST frame, and the stack's periodic publication pulls it
+ * (mesh_model_vendor_set_periodic, see pub->update in ble_mesh_node.c).
+ * The rate is then whatever period the provisioner set for the vendor
+ * model - change it with Config Model Publication Set, no reflash, no app
+ * timer. Period 0 sends nothing.
+ *
+ * Latest-value semantics: a period shorter than a window repeats the last
+ * frame, a longer one skips frames. That suits self-contained frames
+ * (legacy, ranged, masked, magnitude); Rice blocks show up as sequence
+ * gaps. Envelope, packed, block codecs and captures keep pushing their
+ * frames - they need every one. FEC parity is off (the app no longer
+ * knows which frames went out).
+ *
+ * HANDOVER (publisher task → BTC task):
+ * -------------------------------------
+ * Two slots. The publisher fills slot (gen + 1) & 1, then bumps gen; the
+ * update callback copies slot gen & 1. Once gen + 1 is committed, the
+ * NEXT reserve writes slot (gen + 2) & 1 - the very slot being copied -
+ * so any change of gen during the copy may mean a torn frame: copy again.
+ * Frames are a window apart, so the retry practically never runs. gen
+ * is released / acquired like window_stamp_gen (the two tasks run on
+ * different cores).
+ * ═══════════════════════════════════════════════════════════════════════════
+ */
+static uint8_t latest_frame[2][MESH_VENDOR_PUB_MAX];
+static uint16_t latest_len[2];
+static uint32_t latest_op[2];
+static uint32_t latest_gen = 0;                 // Frames handed over (publisher writes, __atomic)
+static uint32_t latest_taken = 0;               // Last gen published (BTC task only)
+
+static uint8_t *frame_reserve(uint32_t opcode, uint8_t *spare, uint16_t max_len)
+{
+    (void)spare;
+    (void)max_len;
+    const uint8_t slot = (__atomic_load_n(&latest_gen, __ATOMIC_RELAXED) + 1) & 1;
+    __atomic_thread_fence(__ATOMIC_RELEASE);    // Last commit lands before this slot is touched
+    latest_op[slot] = opcode;
+    return latest_frame[slot];
+}
+
+static esp_err_t frame_commit(size_t len)
+{
+    if (len == 0) {
+        return ESP_OK;
+    }
+    const uint32_t gen = __atomic_load_n(&latest_gen, __ATOMIC_RELAXED);
+    latest_len[(gen + 1) & 1] = (uint16_t)len;
+    __atomic_store_n(&latest_gen, gen + 1, __ATOMIC_RELEASE);    // The slot is complete
+    return ESP_OK;
+}
+
+// mesh_pub_update_t: runs in the BTC task once per publish period
+static uint16_t pull_latest_frame(uint32_t *opcode, uint8_t *buf, uint16_t cap, void *user_data)
+{
+    (void)user_data;
+    uint32_t gen;
+    uint16_t len;
+    do {
+        gen = __atomic_load_n(&latest_gen, __ATOMIC_ACQUIRE);
+        if (gen == latest_taken) {
+            return 0;                           // Nothing new: the stack repeats the last one
+        }
+        const uint8_t slot = gen & 1;
+        len = latest_len[slot];
+        if (len > cap) {
+            return 0;
+        }
+        *opcode = latest_op[slot];
+        memcpy(buf, latest_frame[slot], len);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while (gen != __atomic_load_n(&latest_gen, __ATOMIC_RELAXED));
+    latest_taken = gen;
+    return len;
+}
+#endif
+
+#define IMU_STATS_PERIOD_MS     10000
+
+/**
+ * Every 10 s on the mesh event loop (mesh_sched_start): publishes per
+ * path and their average cost inside the mesh API
+ * (mesh_model_get_publish_stats), and how often the loop task woke up -
+ * the number to watch for idle time, e.g.
+ *
+ *   📮 Publish: 100 via pub.msg @ <c> cycles, 12 allocated @ <c> cycles (8 B avg)
+ *   ⏱️  Loop: 10.1 wakeups/s, 1012 events (0 dropped), 2 job(s), 11 run in 11 batch(es)
+ *
+ * followed by the per-core usage (TASK USAGE REPORT).
+ */
+static void report_publish_stats(void *arg)
+{
+    (void)arg;
+    static uint32_t last_wakeups = 0;
+    mesh_publish_stats_t st;
+    mesh_model_get_publish_stats(&st, true);
+    printf("📮 Publish: %" PRIu32 " via pub.msg @ %" PRIu32 " cycles, %" PRIu32
+           " allocated @ %" PRIu32 " cycles (%" PRIu32 " B avg)\n",
+           st.in_place, st.in_place ? st.in_place_cycles / st.in_place : 0,
+           st.copied, st.copied ? st.copied_cycles / st.copied : 0,
+           st.copied ? st.copied_bytes / st.copied : 0);
+
+    mesh_sched_stats_t sch;
+    mesh_sched_get_stats(&sch);
+    printf("⏱️  Loop: %.1f wakeups/s, %" PRIu32 " events (%" PRIu32 " dropped), %" PRIu32
+           " job(s), %" PRIu32 " run in %" PRIu32 " batch(es)\n",
+           (sch.wakeups - last_wakeups) * 1000.0f / IMU_STATS_PERIOD_MS, sch.events,
+           sch.dropped, sch.armed, sch.fired, sch.batches);
+    last_wakeups = sch.wakeups;
+
+#if IMU_PEER_LISTEN
+    printf("🤝 Peers: %" PRIu32 " frames, %" PRIu32 " reaction(s)\n", peer_frames, peer_reactions);
+    peer_frames = 0;
+    peer_reactions = 0;
+#endif
+#if IMU_AGG_ROLE == IMU_AGG_HEAD
+    printf("📦 Batches: %" PRIu32 " sent with %" PRIu32 " frames, %" PRIu32 " busy, %" PRIu32
+           " frame(s) dropped\n", agg_batches, agg_frames, agg_busy, agg_batch.dropped);
+    agg_batches = 0;
+    agg_frames = 0;
+    agg_busy = 0;
+#endif
+#if IMU_RELAY_ELECTION
+    printf("📡 Relay: %s, %u neighbour(s), %" PRIu32 " report(s) heard, %" PRIu32 " sent, %"
+           PRIu32 " set(s)\n", node_get_relay() ? "on" : "off", topo_table.count, topo_heard,
+           topo_sent, relay_sets);
+    topo_heard = 0;
+    topo_sent = 0;
+    relay_sets = 0;
+#endif
+
+    report_task_usage();
+    sample_jitter_max_us = 0;
+    window_busy_us = 0;
+    window_max_us = 0;
+    window_count = 0;
+}
+
+/**
+ * Account for a data frame that was just published; sends the parity
+ * frame when it closes a group (no-op while IMU_FEC_K / imu_set_fec is 0)
+ */
+static void publish_fec_parity(uint32_t opcode, const uint8_t *frame, size_t len)
+{
+#if !IMU_MESH_PERIODIC
+    uint32_t parity_op;
+    uint8_t parity[IMU_FRAME_MAX];
+    size_t plen = imu_fec_encode(&fec_encoder, opcode, frame, len, &parity_op, parity);
+    if (plen == 0) {
+        return;
+    }
+
+    esp_err_t ret = mesh_model_publish_vendor(0, parity_op, parity, (uint16_t)plen);
+    if (ret != ESP_OK) {
+        printf("⚠️  Parity send failed: %d\n", ret);
+    }
+#if IMU_FRAMES_TO_CONSOLE
+    print_frame(parity_op, parity, plen);
+#endif
+#else
+    (void)opcode;                               // The stack picks which frames go out
+    (void)frame;
+    (void)len;
+#endif
+}
+
+/*
+ * ═══════════════════════════════════════════════════════════════════════════
+ *                      IMU DATA PUBLISHING FUNCTION
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * Packs all 6 IMU values into an 8-byte message and sends via vendor model.
+ *
+ * COMPRESSION ALGORITHM:
+ * ----------------------
+ * Input:  int16_t values (accel in mg, gyro in dps)
+ * Output: int8_t values (accel in 0.1g, gyro in 10dps)
+ *
+ * Accel compression:
+ *   - Divide mg by 100 → 0.1g units
+ *   - Example: 1500 mg = 1.5g → 1500/100 = 15
+ *   - Range: ±127 * 0.1g = ±12.7g (sufficient for most motion)
+ *
+ * Gyro compression:
+ *   - Divide dps by 10 → 10dps units
+ *   - Example: 250 dps → 250/10 = 25
+ *   - Range: ±127 * 10dps = ±1270 dps (sufficient for human motion)
+ *
+ * NETWORK TRANSMISSION:
+ * ---------------------
+ * The frame is written straight into the vendor model's stage
+ * (see ENCODE IN PLACE), then:
+ * 1. The stack puts [0xC00001][8 bytes] in the publication buffer
+ * 2. Encrypts payload with AppKey
+ * 3. Adds network headers (src, dst, TTL)
+ * 4. Queues for transmission to the publish address (0xC001 group)
+ *
+ * NO SEGMENTATION:
+ * ----------------
+ * 8 bytes < 11 byte segment limit = single packet transmission
+ * - Fast: ~30ms total time
+ * - Efficient: Uses 1 network buffer (not 3+)
+ * - Reliable: Lower chance of packet loss
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ */
+void publish_imu_data(void)
+{
+    // Window timestamp in ms: mesh-global once time sync has locked,
+    // otherwise time since boot (see TIME SYNC above)
+    // uint16_t wraps every ~65 seconds - fine for relative timing / correlation
+    uint16_t timestamp = frame_ts_ms;
+
+    // Pack all 6 IMU values + timestamp into 8 bytes, directly in the
+    // vendor model's publication buffer (packed struct: any alignment)
+    imu_compact_data_t spare;
+    imu_compact_data_t &imu_data = *(imu_compact_data_t*)frame_reserve(
+        VENDOR_MODEL_OP_IMU_DATA, (uint8_t*)&spare, sizeof(spare));
+    imu_data = {
+        .timestamp_ms = timestamp,
+        .accel_x = (int8_t)(accel_x / 100),  // mg → 0.1g units
         .accel_y = (int8_t)(accel_y / 100),
         .accel_z = (int8_t)(accel_z / 100),
         .gyro_x = (int8_t)(gyro_x / 10),     // dps → 10dps units
@@ -539,15 +2202,8 @@ void publish_imu_data(void)
         .gyro_z = (int8_t)(gyro_z / 10)
     };
 
-    // Publish via vendor model to configured publish address (0xC001 group)
-    // Using mesh_model_publish_vendor() instead of mesh_model_send_vendor()
-    // so it uses the publish address configured by the provisioner
-    esp_err_t ret = mesh_model_publish_vendor(
-        0,                            // Vendor model index (we only have 1)
-        VENDOR_MODEL_OP_IMU_DATA,    // Our custom opcode (0xC00001)
-        (uint8_t*)&imu_data,         // Pointer to data struct
-        sizeof(imu_data)             // 8 bytes
-    );
+    // Publish to the address configured by the provisioner (0xC001 group)
+    esp_err_t ret = frame_commit(sizeof(imu_data));
 
     // Error handling: Log failures but don't halt
     // Common errors:
@@ -557,6 +2213,11 @@ void publish_imu_data(void)
         printf("⚠️  IMU send failed: %d\n", ret);
     }
 
+#if IMU_FRAMES_TO_CONSOLE
+    print_frame(VENDOR_MODEL_OP_IMU_DATA, (const uint8_t*)&imu_data, sizeof(imu_data));
+#endif
+    publish_fec_parity(VENDOR_MODEL_OP_IMU_DATA, (const uint8_t*)&imu_data, sizeof(imu_data));
+
     // Update display with compressed data being sent
     M5.Display.fillScreen(TFT_BLACK);
     M5.Display.setTextColor(TFT_WHITE);
@@ -571,6 +2232,568 @@ void publish_imu_data(void)
     M5.Display.printf(" X: %d\n", imu_data.gyro_x);
     M5.Display.printf(" Y: %d\n", imu_data.gyro_y);
     M5.Display.printf(" Z: %d\n", imu_data.gyro_z);
+    if (peer_shown && esp_timer_get_time() < peer_shown_until_us) {
+        M5.Display.setTextColor(TFT_GREEN);
+        M5.Display.printf("\nPeer 0x%04X!\n", peer_shown);
+    }
+}
+
+/*
+ * ═══════════════════════════════════════════════════════════════════════════
+ *                    IMU ENVELOPE PUBLISHING FUNCTION
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * Sends one closed window as two 8-byte frames (see imu_envelope.h):
+ *
+ *   0xC10001 [hdr|mean X|dn/up X|mean Y|dn/up Y|mean Z|dn/up Z|W]  accel
+ *   0xC10001 [hdr|mean X|dn/up X|mean Y|dn/up Y|mean Z|dn/up Z|W]  gyro
+ *
+ * Both frames carry the same 4-bit window sequence number, so a receiver
+ * can pair them and tell a lost frame from a lost window.
+ * ═══════════════════════════════════════════════════════════════════════════
+ */
+void publish_imu_envelope(const imu_envelope_window_t *w)
+{
+    uint8_t frame[IMU_ENV_FRAME_LEN];
+
+    for (uint8_t group = IMU_ENV_GROUP_ACCEL; group <= IMU_ENV_GROUP_GYRO; group++) {
+        imu_envelope_pack(w, group, frame);
+
+        esp_err_t ret = mesh_model_publish_vendor(0, IMU_OP_ENVELOPE, frame, sizeof(frame));
+        if (ret != ESP_OK) {
+            printf("⚠️  Envelope send failed: %d\n", ret);
+        }
+#if IMU_FRAMES_TO_CONSOLE
+        print_frame(IMU_OP_ENVELOPE, frame, sizeof(frame));
+#endif
+        publish_fec_parity(IMU_OP_ENVELOPE, frame, sizeof(frame));
+    }
+
+    // Display: accel range of this window (mg)
+    M5.Display.fillScreen(TFT_BLACK);
+    M5.Display.setTextColor(TFT_WHITE);
+    M5.Display.setTextSize(1);
+    M5.Display.setCursor(0, 0);
+    M5.Display.printf("Envelope #%u:\n\n", w->seq & 0x0F);
+    M5.Display.printf("Accel min/max (mg):\n");
+    M5.Display.printf(" X: %d / %d\n", w->min.v[IMU_AXIS_AX], w->max.v[IMU_AXIS_AX]);
+    M5.Display.printf(" Y: %d / %d\n", w->min.v[IMU_AXIS_AY], w->max.v[IMU_AXIS_AY]);
+    M5.Display.printf(" Z: %d / %d\n", w->min.v[IMU_AXIS_AZ], w->max.v[IMU_AXIS_AZ]);
+}
+
+/*
+ * ═══════════════════════════════════════════════════════════════════════════
+ *                    LOSSLESS RICE PUBLISHING FUNCTION
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * Encodes one block of raw samples (see imu_rice.h) and publishes it as a
+ * single SEGMENTED vendor message. The mesh stack splits it into 12-byte
+ * segments and the receiver reassembles it - all or nothing.
+ *
+ * Every 50 blocks we log the running averages, which is where the ESP32
+ * numbers for the codec benchmark come from:
+ *
+ *   🗜️ Rice: 108 B/block, 7.20 bits/value, 41230 cycles/block
+ * ═══════════════════════════════════════════════════════════════════════════
+ */
+void publish_imu_rice(const imu_sample_t *block, uint8_t n)
+{
+    static uint8_t spare[IMU_RICE_MAX_FRAME];
+    static uint8_t seq = 0;
+    static uint32_t stat_blocks = 0, stat_bytes = 0, stat_cycles = 0;
+
+    // One block per publish: encode straight into the publication buffer
+    uint8_t *frame = frame_reserve(IMU_OP_RICE, spare, sizeof(spare));
+    uint32_t c0 = esp_cpu_get_cycle_count();
+    size_t len = imu_rice_encode(block, n, seq++, frame, sizeof(spare));
+    uint32_t c1 = esp_cpu_get_cycle_count();
+    if (len == 0) {
+        frame_commit(0);
+        printf("⚠️  Rice encode failed\n");
+        return;
+    }
+
+    esp_err_t ret = frame_commit(len);
+    if (ret != ESP_OK) {
+        printf("⚠️  Rice send failed: %d\n", ret);
+    }
+#if IMU_FRAMES_TO_CONSOLE
+    print_frame(IMU_OP_RICE, frame, len);
+#endif
+
+    stat_blocks++;
+    stat_bytes += len;
+    stat_cycles += c1 - c0;
+    if (stat_blocks == 50) {
+        printf("🗜️ Rice: %" PRIu32 " B/block, %.2f bits/value, %" PRIu32 " cycles/block\n",
+               stat_bytes / stat_blocks,
+               (double)stat_bytes * 8.0 / (double)(stat_blocks * n * IMU_AXIS_COUNT),
+               stat_cycles / stat_blocks);
+        stat_blocks = stat_bytes = stat_cycles = 0;
+    }
+}
+
+/*
+ * ═══════════════════════════════════════════════════════════════════════════
+ *                    AUTO-CODEC PUBLISHING FUNCTION
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * Lets the selector encode the block with every registered codec that fits
+ * the CPU budget and publishes the smallest result. Single segment when
+ * the winner is ≤ 8 bytes, segmented otherwise - the stack decides.
+ *
+ * Every 50 blocks we log the average frame size and how often each codec
+ * has won since boot:
+ *
+ *   🎛️ Auto: 57 B/block | raw8 0 delta 3 envelope 0 rice 47 | 0 skips
+ * ═══════════════════════════════════════════════════════════════════════════
+ */
+void publish_imu_auto(const imu_sample_t *block, uint8_t n)
+{
+    static uint8_t frame[IMU_CODEC_MAX_FRAME];
+    static uint32_t stat_blocks = 0, stat_bytes = 0;
+
+    uint8_t codec_id;
+    size_t len = imu_codec_select_encode(&codec_selector, block, n, frame, sizeof(frame), &codec_id);
+    if (len == 0) {
+        printf("⚠️  No codec fits this block\n");
+        return;
+    }
+
+    esp_err_t ret = mesh_model_publish_vendor(0, IMU_OP_CODEC, frame, (uint16_t)len);
+    if (ret != ESP_OK) {
+        printf("⚠️  Auto send failed: %d\n", ret);
+    }
+#if IMU_FRAMES_TO_CONSOLE
+    print_frame(IMU_OP_CODEC, frame, len);
+#endif
+
+    stat_blocks++;
+    stat_bytes += len;
+    if (stat_blocks == 50) {
+        size_t count;
+        const imu_codec_t *const *codecs = imu_codec_list(&count);
+        printf("🎛️ Auto: %" PRIu32 " B/block |", stat_bytes / stat_blocks);
+        for (size_t i = 0; i < count; i++) {
+            printf(" %s %" PRIu32, codecs[i]->name, codec_selector.wins[codecs[i]->id]);
+        }
+        printf(" | %" PRIu32 " skips\n", codec_selector.budget_skips);
+        stat_blocks = stat_bytes = 0;
+    }
+}
+
+/*
+ * ═══════════════════════════════════════════════════════════════════════════
+ *                    FIXED-CODEC PUBLISHING FUNCTION
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * Encodes the block with the codec set by imu_set_block_codec() and
+ * publishes it as a tagged frame (0xC30001), exactly like AUTO - the
+ * receiver can't tell the difference and needs nothing new. Shares the
+ * selector's sequence number, so falling back to AUTO for one block
+ * doesn't look like a lost window.
+ *
+ * Every 50 blocks:
+ *
+ *   🔢 Fixed bfp8: 127 B/block, 1 fallback(s)
+ * ═══════════════════════════════════════════════════════════════════════════
+ */
+void publish_imu_fixed(const imu_sample_t *block, uint8_t n)
+{
+    static uint8_t frame[IMU_CODEC_MAX_FRAME];
+    static uint32_t stat_blocks = 0, stat_bytes = 0, stat_fallbacks = 0;
+
+    const uint8_t codec_id = fixed_codec;
+    size_t len = imu_codec_encode_with(codec_id, IMU_AUTO_PRECISION, codec_selector.seq,
+                                       block, n, frame, sizeof(frame));
+    if (len == 0) {
+        stat_fallbacks++;
+        publish_imu_auto(block, n);     // Codec declined this block
+    } else {
+        codec_selector.seq++;
+        esp_err_t ret = mesh_model_publish_vendor(0, IMU_OP_CODEC, frame, (uint16_t)len);
+        if (ret != ESP_OK) {
+            printf("⚠️  Fixed-codec send failed: %d\n", ret);
+        }
+#if IMU_FRAMES_TO_CONSOLE
+        print_frame(IMU_OP_CODEC, frame, len);
+#endif
+        stat_bytes += len;
+    }
+
+    stat_blocks++;
+    if (stat_blocks == 50) {
+        uint32_t sent = stat_blocks - stat_fallbacks;
+        printf("🔢 Fixed %s: %" PRIu32 " B/block, %" PRIu32 " fallback(s)\n",
+               imu_codec_find(codec_id)->name, sent ? stat_bytes / sent : 0, stat_fallbacks);
+        stat_blocks = stat_bytes = stat_fallbacks = 0;
+    }
+}
+
+/*
+ * ═══════════════════════════════════════════════════════════════════════════
+ *                    MASKED PUBLISHING FUNCTION
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * Collects decimated samples until a masked frame (imu_masked.h) is full,
+ * then sends it:
+ *
+ *   0xCC0001 [TT|mask][time/4 ms][window 1: k × int8][window 2: k × int8]...
+ *
+ * The frame is always ≤ 8 bytes (unsegmented). A new axis mask (stream
+ * config) drops the windows collected so far and restarts the parity
+ * group, so a parity never mixes frames of two lengths.
+ * ═══════════════════════════════════════════════════════════════════════════
+ */
+void publish_imu_masked(const imu_sample_t *s)
+{
+    static imu_sample_t pending[IMU_MASKED_MAX_SAMPLES];
+    static uint8_t fill = 0;
+    static uint8_t mask = IMU_AXIS_MASK_ALL;
+
+    if (stream_cfg.axis_mask != mask) {
+        mask = stream_cfg.axis_mask;
+        fill = 0;
+        imu_fec_encoder_set_k(&fec_encoder, fec_k);
+    }
+    pending[fill++] = *s;
+    if (fill < imu_masked_capacity(mask)) {
+        return;
+    }
+
+    uint8_t spare[IMU_FRAME_MAX];
+    uint8_t *frame = frame_reserve(IMU_OP_MASKED, spare, sizeof(spare));
+    size_t len = imu_masked_pack(mask, frame_ts_ms, pending, fill, frame, sizeof(spare));
+    fill = 0;
+    if (len == 0) {
+        frame_commit(0);                // Release the reservation
+        return;
+    }
+
+    esp_err_t ret = frame_commit(len);
+    if (ret != ESP_OK) {
+        printf("⚠️  Masked send failed: %d\n", ret);
+    }
+#if IMU_FRAMES_TO_CONSOLE
+    print_frame(IMU_OP_MASKED, frame, len);
+#endif
+    publish_fec_parity(IMU_OP_MASKED, frame, len);
+}
+
+/*
+ * ═══════════════════════════════════════════════════════════════════════════
+ *                    MAGNITUDE PUBLISHING FUNCTION
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * Collects three window peaks (imu_magnitude.h), then sends them:
+ *
+ *   0xCD0001 [ms LE][|a| w1][|ω| w1][|a| w2][|ω| w2][|a| w3][|ω| w3]
+ *
+ * 8 bytes, unsegmented, one frame every three windows. The peaks come
+ * from the calibrated full-rate samples (imu_mag_peak in the drain loop).
+ * ═══════════════════════════════════════════════════════════════════════════
+ */
+void publish_imu_magnitude(const imu_mag_t *w)
+{
+    static imu_mag_t pending[IMU_MAG_WINDOWS];
+    static uint8_t fill = 0;
+
+    pending[fill++] = *w;
+    if (fill < IMU_MAG_WINDOWS) {
+        return;
+    }
+
+    uint8_t spare[IMU_MAG_FRAME_MAX];
+    uint8_t *frame = frame_reserve(IMU_OP_MAGNITUDE, spare, sizeof(spare));
+    size_t len = imu_mag_pack(frame_ts_ms, pending, fill, frame);
+    fill = 0;
+
+    esp_err_t ret = frame_commit(len);
+    if (ret != ESP_OK) {
+        printf("⚠️  Magnitude send failed: %d\n", ret);
+    }
+#if IMU_FRAMES_TO_CONSOLE
+    print_frame(IMU_OP_MAGNITUDE, frame, len);
+#endif
+    publish_fec_parity(IMU_OP_MAGNITUDE, frame, len);
+}
+
+/*
+ * ═══════════════════════════════════════════════════════════════════════════
+ *                    PACKED PUBLISHING FUNCTION
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * Feeds the decimated sample to the packed-frame encoder (imu_packed.h),
+ * which sends a frame whenever the next window would not fit:
+ *
+ *   0xCE0001 [K|seq|n-1|order][w_a|w_g][key: 6 × int8][bit planes...]
+ *
+ * 2..8 bytes, unsegmented. One key frame every IMU_PACK_KEY_INTERVAL
+ * frames bounds what a lost frame costs the receiver.
+ * ═══════════════════════════════════════════════════════════════════════════
+ */
+void publish_imu_packed(const imu_sample_t *s)
+{
+    static imu_pack_encoder_t encoder;
+    static bool started = false;
+
+    if (!started) {
+        imu_pack_encoder_init(&encoder, IMU_PACK_KEY_INTERVAL, IMU_PACK_MAX_SAMPLES);
+        started = true;
+    }
+    uint8_t frame[IMU_FRAME_MAX];
+    size_t len = imu_pack_push(&encoder, s, frame);
+    if (len == 0) {
+        return;
+    }
+
+    esp_err_t ret = mesh_model_publish_vendor(0, IMU_OP_PACKED, frame, (uint16_t)len);
+    if (ret != ESP_OK) {
+        printf("⚠️  Packed send failed: %d\n", ret);
+    }
+#if IMU_FRAMES_TO_CONSOLE
+    print_frame(IMU_OP_PACKED, frame, len);
+#endif
+}
+
+/*
+ * ═══════════════════════════════════════════════════════════════════════════
+ *                    RANGED PUBLISHING FUNCTION
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * Sends the decimated sample as a range-tagged frame (imu_autorange.h):
+ *
+ *   0xC60001 [GG|AA|12-bit ms][ax][ay][az][gx][gy][gz]   int8, step = FS/128
+ *
+ * Same size and rate as the legacy frame. The ranges are the ones the
+ * sampler picked when it closed this window (range_tag), so the frame
+ * scale always holds the window's peak.
+ * ═══════════════════════════════════════════════════════════════════════════
+ */
+void publish_imu_ranged(const imu_sample_t *s)
+{
+    static uint8_t last_tag = 0xFF;
+
+    const uint8_t tag = range_tag;
+    const imu_range_t a_r = tag & 0x03, g_r = tag >> 2;
+    uint8_t spare[IMU_RANGED_FRAME_LEN];
+    uint8_t *frame = frame_reserve(IMU_OP_RANGED, spare, sizeof(spare));
+    imu_ranged_pack(s, frame_ts_ms, a_r, g_r, frame);
+
+    esp_err_t ret = frame_commit(IMU_RANGED_FRAME_LEN);
+    if (ret != ESP_OK) {
+        printf("⚠️  Ranged send failed: %d\n", ret);
+    }
+#if IMU_FRAMES_TO_CONSOLE
+    print_frame(IMU_OP_RANGED, frame, IMU_RANGED_FRAME_LEN);
+#endif
+    publish_fec_parity(IMU_OP_RANGED, frame, IMU_RANGED_FRAME_LEN);
+
+    if (tag != last_tag) {
+        printf("📏 Range: ±%d g / ±%d dps\n", (int)(imu_accel_full_scale(a_r) / 1000),
+               (int)(imu_gyro_full_scale(g_r) / 10));
+        last_tag = tag;
+    }
+}
+
+/*
+ * ═══════════════════════════════════════════════════════════════════════════
+ *                    VQ PUBLISHING FUNCTION
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * Encodes the block against the installed codebook (imu_vq.h) and
+ * publishes it on 0xC40001. A freshly installed codebook is swapped in
+ * here, between two blocks, so every frame uses exactly one codebook.
+ *
+ * Every 50 blocks we log size, search cost and escape rate - the ESP32
+ * counterpart of tools/bench/bench_vq:
+ *
+ *   🧭 VQ #1: 2.5 B/sample, 2210 cycles/sample, escapes 3.9% res 0.0% raw
+ * ═══════════════════════════════════════════════════════════════════════════
+ */
+void publish_imu_vq(const imu_sample_t *block, uint8_t n)
+{
+    static uint8_t frame[IMU_VQ_HEADER_LEN + IMU_BLOCK_MAX * IMU_VQ_MAX_SAMPLE_BYTES];
+    static uint8_t seq = 0;
+    static imu_vq_stats_t stats = {};
+    static uint32_t stat_blocks = 0, stat_bytes = 0, stat_cycles = 0;
+
+    if (vq_ready) {
+        vq_codebook = vq_installer.pending;
+        vq_ready = false;
+        stats = {};
+        printf("🧭 VQ codebook %u active (K=%u, %u group(s))\n",
+               vq_codebook.id, vq_codebook.codes, vq_codebook.groups);
+    }
+    if (vq_codebook.id == 0) {
+        publish_imu_auto(block, n);     // No codebook yet
+        return;
+    }
+
+    uint32_t c0 = esp_cpu_get_cycle_count();
+    size_t len = imu_vq_encode(&vq_codebook, seq++, block, n, frame, sizeof(frame), &stats);
+    uint32_t c1 = esp_cpu_get_cycle_count();
+    if (len == 0) {
+        printf("⚠️  VQ encode failed\n");
+        return;
+    }
+
+    esp_err_t ret = mesh_model_publish_vendor(0, IMU_OP_VQ, frame, (uint16_t)len);
+    if (ret != ESP_OK) {
+        printf("⚠️  VQ send failed: %d\n", ret);
+    }
+#if IMU_FRAMES_TO_CONSOLE
+    print_frame(IMU_OP_VQ, frame, len);
+#endif
+
+    stat_blocks++;
+    stat_bytes += len;
+    stat_cycles += c1 - c0;
+    if (stat_blocks == 50) {
+        uint32_t groups = stats.coded + stats.residual + stats.raw;
+        printf("🧭 VQ #%u: %.1f B/sample, %" PRIu32 " cycles/sample, escapes %.1f%% res %.1f%% raw\n",
+               vq_codebook.id, (double)stat_bytes / (double)(stat_blocks * n),
+               stat_cycles / (stat_blocks * n),
+               100.0 * stats.residual / groups, 100.0 * stats.raw / groups);
+        stat_blocks = stat_bytes = stat_cycles = 0;
+    }
+}
+
+/*
+ * ═══════════════════════════════════════════════════════════════════════════
+ *                      CAPTURE UPLOAD (SEGMENTED, 0xCA0001)
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * Called by the publisher every window while a recorded capture waits.
+ * Sends the next chunk once its time has come (slot start, then one chunk
+ * every IMU_CAPTURE_CHUNK_MS); a chunk the stack refuses is retried at the
+ * next window. After the last chunk the recorder resumes the history:
+ *
+ *   📸 Capture 7 uploaded (7 chunks)
+ * ═══════════════════════════════════════════════════════════════════════════
+ */
+void publish_capture(void)
+{
+    static uint8_t frame[IMU_CAPTURE_CHUNK_MAX];
+
+    const int64_t now_global = imu_tsync_to_global(&tsync, esp_timer_get_time());
+    if (!is_provisioned || now_global < capture_next_us) {
+        return;
+    }
+    size_t len = imu_capture_chunk_pack(&capture, capture_next_chunk, frame, sizeof(frame));
+    if (len == 0) {
+        imu_capture_release(&capture);      // Nothing (left) to send
+        return;
+    }
+
+    esp_err_t ret = mesh_model_publish_vendor(0, IMU_OP_CAPTURE_DATA, frame, (uint16_t)len);
+    if (ret != ESP_OK) {
+        printf("⚠️  Capture chunk %u send failed: %d\n", capture_next_chunk, ret);
+        return;
+    }
+#if IMU_FRAMES_TO_CONSOLE
+    print_frame(IMU_OP_CAPTURE_DATA, frame, len);
+#endif
+
+    capture_next_us += (int64_t)IMU_CAPTURE_CHUNK_MS * 1000;
+    if (++capture_next_chunk == imu_capture_chunks(&capture)) {
+        printf("📸 Capture %u uploaded (%u chunks)\n", capture.cmd.id, capture_next_chunk);
+        imu_capture_release(&capture);
+    }
+}
+
+/*
+ * ───────────────────────────────────────────────────────────────────────────
+ *                     VENDOR MESSAGE HANDLER
+ * ───────────────────────────────────────────────────────────────────────────
+ *
+ * Runs in the BLE Mesh task, so it only copies data and raises flags -
+ * the publisher does the rest. Only opcodes listed in vendor_rx_opcodes
+ * (see app_main) ever reach this function.
+ */
+static const uint32_t vendor_rx_opcodes[] = {
+    IMU_OP_VQ_INSTALL,      // Codebook install chunk from the gateway
+    IMU_OP_CALIB,           // Calibration install from the gateway
+    IMU_OP_TSYNC,           // Time-sync beacon from the gateway
+    IMU_OP_CAPTURE,         // Capture command, sent to IMU_CONTROL_GROUP
+    IMU_OP_CONFIG,          // Stream config, unicast or IMU_CONTROL_GROUP
+#if IMU_RELAY_ELECTION
+    IMU_OP_RELAY_SET,       // Relay set, sent to IMU_CONTROL_GROUP
+#endif
+};
+
+void vendor_message_handler(uint32_t opcode, uint8_t *data, uint16_t length,
+                            void *ctx, void *user_data)
+{
+    if (opcode == IMU_OP_TSYNC) {
+        // Receive time first - every µs spent before this is sync error
+        const int64_t rx_us = esp_timer_get_time();
+        if (!tsync_pending && length == sizeof(tsync_rx)) {
+            memcpy(tsync_rx, data, length);
+            tsync_rx_local_us = rx_us;
+            tsync_rx_ttl = mesh_msg_recv_ttl(ctx);
+            tsync_pending = true;
+        }
+        return;
+    }
+    if (opcode == IMU_OP_CAPTURE) {
+        // Publisher arms the recorder (capture_arm)
+        if (!capture_pending && length == sizeof(capture_rx)) {
+            memcpy(capture_rx, data, length);
+            capture_pending = true;
+        }
+        return;
+    }
+#if IMU_RELAY_ELECTION
+    if (opcode == IMU_OP_RELAY_SET) {
+        // The event loop switches the relay (on_relay_set)
+        if (!relay_set_pending && length <= sizeof(relay_set_rx)) {
+            memcpy(relay_set_rx, data, length);
+            relay_set_rx_len = (uint8_t)length;
+            relay_set_pending = true;
+            if (mesh_event_post(IMU_EVENT_RELAY_SET, 0) != ESP_OK) {
+                relay_set_pending = false;  // The gateway sends it again next plan
+            }
+        }
+        return;
+    }
+#endif
+    if (opcode == IMU_OP_CONFIG) {
+        // Publisher validates, saves and hands it on (config_receive)
+        if (!config_pending && length == sizeof(config_rx)) {
+            memcpy(config_rx, data, length);
+            config_pending = true;
+        }
+        return;
+    }
+    if (opcode == IMU_OP_CALIB) {
+        // Publisher validates, applies and saves it (calib_install)
+        if (!calib_ready && length <= sizeof(calib_rx)) {
+            memcpy(calib_rx, data, length);
+            calib_rx_len = length;
+            calib_ready = true;
+        }
+        return;
+    }
+    if (opcode != IMU_OP_VQ_INSTALL) {
+        return;
+    }
+#if IMU_FRAMES_TO_CONSOLE
+    print_frame(opcode, data, length);  // Decoder learns the codebook from the log
+#endif
+    if (vq_ready) {
+        return;     // Previous codebook not swapped in yet - gateway re-sends
+    }
+    switch (imu_vq_install_feed(&vq_installer, data, length)) {
+    case IMU_VQ_INSTALL_COMPLETE:
+        vq_ready = true;
+        break;
+    case IMU_VQ_INSTALL_INVALID:
+        printf("⚠️  Bad VQ install chunk (%u bytes)\n", length);
+        break;
+    default:
+        break;
+    }
 }
 
 /*
@@ -579,10 +2802,41 @@ void publish_imu_data(void)
  * ───────────────────────────────────────────────────────────────────────────
  */
 
-// Called when node successfully joins the mesh network
+// Status screens: drawn by a node callback, cleared (or acted on) by this
+// one-shot timer - the event loop never sleeps in a handler
+static mesh_timer_t screen_timer;
+
+static void clear_screen(void *arg)
+{
+    (void)arg;
+    M5.Display.fillScreen(TFT_BLACK);
+    M5.Display.setTextSize(1);
+}
+
+static void restart_node(void *arg)
+{
+    (void)arg;
+    esp_restart();
+}
+
+// Called (on the event loop) when node successfully joins the mesh network
 void provisioned_callback(uint16_t unicast_addr)
 {
     is_provisioned = true;
+    node_addr = unicast_addr;
+
+    // Capture commands arrive on the control group, next to our publications
+    esp_err_t ret = mesh_model_subscribe_vendor(0, IMU_CONTROL_GROUP);
+    if (ret != ESP_OK) {
+        printf("⚠️  Control group subscribe failed: %d\n", ret);
+    }
+#if IMU_PEER_LISTEN
+    // The peer client (vendor model 1) reads the other sticks' publications
+    ret = mesh_model_subscribe_vendor(1, IMU_DATA_GROUP);
+    if (ret != ESP_OK) {
+        printf("⚠️  Data group subscribe failed: %d\n", ret);
+    }
+#endif
 
     // Update UI to show successful provisioning
     M5.Display.fillScreen(TFT_BLUE);
@@ -591,13 +2845,10 @@ void provisioned_callback(uint16_t unicast_addr)
     M5.Display.setTextColor(TFT_WHITE);
     M5.Display.printf("Provisioned!\n");
     M5.Display.printf("Addr: 0x%04X\n", unicast_addr);
-    vTaskDelay(pdMS_TO_TICKS(2000));
-
-    M5.Display.fillScreen(TFT_BLACK);
-    M5.Display.setTextSize(1);
+    mesh_sched_start(&screen_timer, 2000, 0, clear_screen, NULL);
 }
 
-// Called when node receives a reset command from provisioner
+// Called (on the event loop) when node receives a reset command from provisioner
 void reset_callback(void)
 {
     is_provisioned = false;
@@ -608,8 +2859,266 @@ void reset_callback(void)
     M5.Display.setTextColor(TFT_WHITE);
     M5.Display.printf("RESET!\n");
     M5.Display.printf("Rebooting...\n");
-    vTaskDelay(pdMS_TO_TICKS(2000));
-    esp_restart();
+    mesh_sched_start(&screen_timer, 2000, 0, restart_node, NULL);
+}
+
+/*
+ * ───────────────────────────────────────────────────────────────────────────
+ *                     PEER REACTIONS (vendor client)
+ * ───────────────────────────────────────────────────────────────────────────
+ *
+ * peer_frame_handler runs in the BLE Mesh task for every peer frame on
+ * IMU_DATA_GROUP: one magnitude test, at most one IMU_EVENT_PEER in the
+ * queue. on_peer reacts on the event loop.
+ */
+#if IMU_PEER_LISTEN
+static const uint32_t peer_rx_opcodes[] = {
+    IMU_OP_DATA,            // Legacy int8 frame (DECIMATED mode)
+#if IMU_RELAY_ELECTION
+    IMU_OP_TOPO_REPORT,     // A neighbour's report (RELAY ELECTION)
+#endif
+};
+
+void peer_frame_handler(uint32_t opcode, uint8_t *data, uint16_t length,
+                        void *ctx, void *user_data)
+{
+    (void)user_data;
+    const uint16_t src = mesh_msg_src_addr(ctx);
+#if IMU_RELAY_ELECTION
+    if (opcode == IMU_OP_TOPO_REPORT) {
+        // Only what came directly: a relayed copy carries the relay's RSSI
+        if (src != node_addr && length >= IMU_TOPO_REPORT_HEADER_LEN &&
+            mesh_msg_recv_ttl(ctx) == data[0]) {
+            const uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+            taskENTER_CRITICAL(&topo_lock);
+            imu_topo_observe(&topo_table, src, mesh_msg_recv_rssi(ctx), now_ms);
+            taskEXIT_CRITICAL(&topo_lock);
+            topo_heard++;
+        }
+        return;
+    }
+#endif
+    if (opcode != IMU_OP_DATA || length != sizeof(imu_compact_data_t) || src == node_addr) {
+        return;     // Not a legacy frame, or our own publication coming back
+    }
+    peer_frames++;
+#if IMU_AGG_ROLE == IMU_AGG_HEAD
+    taskENTER_CRITICAL(&agg_lock);
+    imu_batch_add(&agg_batch, src, data);      // Full: dropped and counted
+    taskEXIT_CRITICAL(&agg_lock);
+#endif
+
+    imu_compact_data_t f;
+    memcpy(&f, data, sizeof(f));
+    const uint32_t a2 = (uint32_t)(f.accel_x * f.accel_x + f.accel_y * f.accel_y +
+                                   f.accel_z * f.accel_z);     // ≤ 3 × 128², fits 16 bits
+    if (a2 > IMU_PEER_TRIGGER_G10 * IMU_PEER_TRIGGER_G10 && !peer_posted) {
+        peer_posted = true;
+        if (mesh_event_post(IMU_EVENT_PEER, ((uint32_t)src << 16) | a2) != ESP_OK) {
+            peer_posted = false;
+        }
+    }
+}
+
+// IMU_EVENT_PEER: a peer crossed the trigger
+static void on_peer(const mesh_event_t *ev, void *ctx)
+{
+    (void)ctx;
+    static int64_t last_us = 0;
+    peer_posted = false;
+    const int64_t now = esp_timer_get_time();
+    if (now - last_us < IMU_PEER_HOLDOFF_MS * 1000LL) {
+        return;     // Same knock, next frame
+    }
+    last_us = now;
+    peer_reactions++;
+
+    const uint16_t src = (uint16_t)(ev->arg >> 16);
+    const uint16_t a = imu_isqrt32(ev->arg & 0xFFFF);        // 0.1 g
+    printf("🤝 Peer 0x%04X moved: |a| = %u.%u g\n", src, a / 10, a % 10);
+    peer_shown = src;
+    peer_shown_until_us = now + IMU_PEER_SHOW_MS * 1000LL;
+}
+#endif
+
+/*
+ * ───────────────────────────────────────────────────────────────────────────
+ *                     CLUSTER HEAD (IMU_AGG_ROLE)
+ * ───────────────────────────────────────────────────────────────────────────
+ *
+ *   peer_frame_handler (BTC task) ──imu_batch_add──▶ agg_batch
+ *   agg_flush (event loop, every IMU_AGG_WINDOW_MS) ──pack──▶ 0xCF0001 → gateway
+ *
+ * The batch is packed under the lock, sent outside it. Frames that arrive
+ * meanwhile queue up behind the packed ones, and only those are consumed -
+ * after the stack accepted the batch. While the last batch is still in
+ * its SAR transfer the send fails (busy): the frames wait for the next
+ * window, and once the batch is full new ones are dropped.
+ */
+#if IMU_AGG_ROLE == IMU_AGG_HEAD
+static void agg_flush(void *arg)
+{
+    (void)arg;
+    static uint8_t buf[IMU_SEG_FRAME_MAX];
+    if (!is_provisioned) {
+        return;
+    }
+
+    uint8_t taken;
+    taskENTER_CRITICAL(&agg_lock);
+    const size_t len = imu_batch_pack(&agg_batch, buf, sizeof(buf), &taken);
+    taskEXIT_CRITICAL(&agg_lock);
+    if (len == 0) {
+        return;
+    }
+
+    esp_err_t ret = mesh_model_send_vendor(0, IMU_OP_BATCH, buf, (uint16_t)len, IMU_GATEWAY_ADDR);
+    if (ret != ESP_OK) {
+        agg_busy++;
+        return;
+    }
+    taskENTER_CRITICAL(&agg_lock);
+    imu_batch_consume(&agg_batch, taken);
+    taskEXIT_CRITICAL(&agg_lock);
+    agg_batches++;
+    agg_frames += taken;
+}
+#endif
+
+/*
+ * ───────────────────────────────────────────────────────────────────────────
+ *                     RELAY ELECTION (IMU_RELAY_ELECTION)
+ * ───────────────────────────────────────────────────────────────────────────
+ *
+ *   topo_report (event loop, every IMU_TOPO_REPORT_MS) ──▶ 0xD00001 → IMU_DATA_GROUP
+ *   vendor_message_handler ──relay_set_rx──▶ IMU_EVENT_RELAY_SET ──▶ on_relay_set
+ *
+ * The report lists the neighbours in the last relay set first, so the
+ * gateway keeps seeing the links its plan rests on. The relay state is
+ * not stored: after a reboot the node relays again with the gateway's
+ * next set (it sends one every plan).
+ */
+#if IMU_RELAY_ELECTION
+static void topo_report(void *arg)
+{
+    (void)arg;
+    if (!is_provisioned) {
+        return;
+    }
+
+    uint8_t buf[IMU_TOPO_REPORT_LEN_MAX];
+    const uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    taskENTER_CRITICAL(&topo_lock);
+    imu_topo_expire(&topo_table, now_ms, IMU_TOPO_AGE_MS);
+    const size_t len = imu_topo_report_pack(&topo_table, MESH_VENDOR_SEND_TTL, node_get_relay(),
+                                            &relay_set, buf, sizeof(buf));
+    taskEXIT_CRITICAL(&topo_lock);
+
+    // Sent even without neighbours: the report is how they find us
+    if (mesh_model_send_vendor(0, IMU_OP_TOPO_REPORT, buf, (uint16_t)len, IMU_DATA_GROUP) == ESP_OK) {
+        topo_sent++;
+    }
+}
+
+// IMU_EVENT_RELAY_SET: relay_set_rx holds a relay set from the gateway
+static void on_relay_set(const mesh_event_t *ev, void *ctx)
+{
+    (void)ev;
+    (void)ctx;
+    uint8_t plan_id;
+    imu_topo_plan_t set;
+    const bool ok = imu_topo_relay_set_unpack(relay_set_rx, relay_set_rx_len, &plan_id, &set);
+    const uint8_t len = relay_set_rx_len;
+    relay_set_pending = false;
+    if (!ok) {
+        printf("⚠️  Bad relay set (%u bytes)\n", len);
+        return;
+    }
+    relay_sets++;
+    relay_set = set;
+
+    const bool relay = imu_topo_is_relay(&set, node_addr);
+    if (relay == node_get_relay()) {
+        return;     // The gateway repeats its plan; only changes are news
+    }
+    const esp_err_t ret = node_set_relay(relay);
+    if (ret != ESP_OK) {
+        printf("⚠️  Relay switch failed: %d\n", ret);
+        return;
+    }
+    printf("📡 Relay set %u: %u relay(s), this node %s\n", plan_id, set.count,
+           relay ? "relays" : "stops relaying");
+}
+#endif
+
+/*
+ * ───────────────────────────────────────────────────────────────────────────
+ *                     BUTTONS (interrupts, not polling)
+ * ───────────────────────────────────────────────────────────────────────────
+ *
+ * app_main used to call M5.update() every 100 ms in case a button had been
+ * pressed: 10 wakeups a second for nothing. Now each button edge raises a
+ * GPIO interrupt, the ISR posts IMU_EVENT_BUTTON, and the event loop reads
+ * the pins once the contacts have settled:
+ *
+ *   edge ──ISR──▶ IMU_EVENT_BUTTON ──▶ (re)start 20 ms timer ──▶ read pins
+ *
+ * Bounces restart the timer, so a press is read once. GPIO 37/39 have
+ * external pull-ups and read 0 while pressed. (ESP32 errata: GPIO 36/39
+ * may see spurious edges while the radio sleeps; a read that finds no
+ * change just reports nothing.) The power button sits on the AXP192 and
+ * is not covered.
+ */
+#define IMU_BTN_A_GPIO          GPIO_NUM_37
+#define IMU_BTN_B_GPIO          GPIO_NUM_39
+#define IMU_BTN_DEBOUNCE_MS     20
+
+static mesh_timer_t button_timer;
+static uint8_t buttons_down = 0;                // Bit 0 = A, bit 1 = B (settled)
+
+static void button_isr(void *arg)
+{
+    mesh_event_post_from_isr(IMU_EVENT_BUTTON, (uint32_t)(uintptr_t)arg);
+}
+
+static void buttons_settled(void *arg)
+{
+    (void)arg;
+    const uint8_t down = (uint8_t)((gpio_get_level(IMU_BTN_A_GPIO) == 0) |
+                                   ((gpio_get_level(IMU_BTN_B_GPIO) == 0) << 1));
+    const uint8_t pressed = down & ~buttons_down;
+    buttons_down = down;
+    if (pressed & 0x01) {
+        printf("🔘 Button A\n");
+    }
+    if (pressed & 0x02) {
+        printf("🔘 Button B\n");
+    }
+}
+
+// IMU_EVENT_BUTTON: debounce, the pins are read when the timer expires
+static void on_button(const mesh_event_t *ev, void *ctx)
+{
+    (void)ev;
+    (void)ctx;
+    mesh_sched_start(&button_timer, IMU_BTN_DEBOUNCE_MS, 0, buttons_settled, NULL);
+}
+
+static void buttons_init(void)
+{
+    gpio_config_t io = {};
+    io.pin_bit_mask = (1ULL << IMU_BTN_A_GPIO) | (1ULL << IMU_BTN_B_GPIO);
+    io.mode = GPIO_MODE_INPUT;
+    io.intr_type = GPIO_INTR_ANYEDGE;
+    gpio_config(&io);
+
+    esp_err_t ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {    // INVALID_STATE: already installed
+        printf("⚠️  Button interrupts unavailable: %d\n", ret);
+        return;
+    }
+    gpio_isr_handler_add(IMU_BTN_A_GPIO, button_isr, (void *)IMU_BTN_A_GPIO);
+    gpio_isr_handler_add(IMU_BTN_B_GPIO, button_isr, (void *)IMU_BTN_B_GPIO);
 }
 
 // Show waiting screen while scanning for provisioner
@@ -653,7 +3162,7 @@ void show_waiting_screen(void)
  * 2. Configure mesh models (Sensor + Vendor)
  * 3. Initialize BLE Mesh stack
  * 4. Start provisioning (scan for provisioner)
- * 5. Create publishing task (runs after provisioning)
+ * 5. Create publishing task (runs after provisioning) + high-rate sampler task
  * 6. Main loop handles UI updates only
  *
  * ═══════════════════════════════════════════════════════════════════════════
@@ -677,18 +3186,21 @@ extern "C" void app_main(void)
      * Each sensor has:
      * - type: Sensor Property ID (e.g., SENSOR_ACCEL_X = 0x5001)
      * - read: Callback function to get current value
-     * - publish_period_ms: How often to auto-publish (100ms = 10 Hz)
+     * - publish_period_ms: How often the component's scheduler publishes it
+     *   (0 = only when we call mesh_model_publish_sensor)
      *
-     * NOTE: We don't actually use auto-publish for these.
-     * They exist for compatibility but vendor model is our primary transport.
+     * NOTE: We don't use auto-publish for these. The vendor model is our
+     * primary transport; six Sensor Status messages every 100 ms would add
+     * 60 messages/s on top of it. A Sensor Get is still answered.
      */
-    mesh_sensor_config_t sensors[] = {
-        { .type = SENSOR_ACCEL_X, .read = read_accel_x, .publish_period_ms = 100, .user_data = NULL },
-        { .type = SENSOR_ACCEL_Y, .read = read_accel_y, .publish_period_ms = 100, .user_data = NULL },
-        { .type = SENSOR_ACCEL_Z, .read = read_accel_z, .publish_period_ms = 100, .user_data = NULL },
-        { .type = SENSOR_GYRO_X, .read = read_gyro_x, .publish_period_ms = 100, .user_data = NULL },
-        { .type = SENSOR_GYRO_Y, .read = read_gyro_y, .publish_period_ms = 100, .user_data = NULL },
-        { .type = SENSOR_GYRO_Z, .read = read_gyro_z, .publish_period_ms = 100, .user_data = NULL },
+    // static: the component keeps pointing at these after app_main returns
+    static mesh_sensor_config_t sensors[] = {
+        { .type = SENSOR_ACCEL_X, .read = read_accel_x, .publish_period_ms = 0, .user_data = NULL },
+        { .type = SENSOR_ACCEL_Y, .read = read_accel_y, .publish_period_ms = 0, .user_data = NULL },
+        { .type = SENSOR_ACCEL_Z, .read = read_accel_z, .publish_period_ms = 0, .user_data = NULL },
+        { .type = SENSOR_GYRO_X, .read = read_gyro_x, .publish_period_ms = 0, .user_data = NULL },
+        { .type = SENSOR_GYRO_Y, .read = read_gyro_y, .publish_period_ms = 0, .user_data = NULL },
+        { .type = SENSOR_GYRO_Z, .read = read_gyro_z, .publish_period_ms = 0, .user_data = NULL },
     };
 
     /*
@@ -703,20 +3215,39 @@ extern "C" void app_main(void)
      *    - Registers 6 sensor instances
      *    - Publication enabled by default
      *
-     * 2. MESH_MODEL_VENDOR(0x0001, 0x0001, NULL, NULL)
+     * 2. MESH_MODEL_VENDOR_RX(0x0001, 0x0001, vendor_message_handler, NULL, ...)
      *    - Company ID: 0x0001 (test/development ID)
      *    - Model ID: 0x0001 (Server model - can send data)
-     *    - Handler: NULL (we don't receive vendor messages, only send)
+     *    - Handler: vendor_message_handler (VQ codebook chunks, calibration, time sync,
+     *      capture commands, stream config)
      *    - User data: NULL
+     *    - Receives: vendor_rx_opcodes (0xC50001, 0xC70001, 0xC80001, 0xC90001,
+     *      0xCB0001, 0xD10001)
      *    - Publication: enabled by default (set in macro)
+     *    - Runs inline on the BTC task: it only copies the payload and sets a
+     *      flag, and the time-sync stamp must be taken on arrival. A handler
+     *      that does real work would use MESH_MODEL_VENDOR_RX_DEFERRED
+     *      (same arguments) and run on the component's rx worker instead
+     *
+     * 3. MESH_MODEL_VENDOR_CLIENT(0x0001, IMU_PEER_MODEL_ID, peer_frame_handler, ...)
+     *    (IMU_PEER_LISTEN) - vendor model index 1
+     *    - Client: receives the other sticks' frames and neighbour reports on
+     *      IMU_DATA_GROUP (subscribed in provisioned_callback), see PEER
+     *      REACTIONS and RELAY ELECTION
+     *    - No publication buffer - it only listens
      *
      * IMPORTANT: Order matters!
      * - mesh_model_send_vendor(0, ...) refers to first vendor model
      * - If you had multiple vendor models, use index 1, 2, etc.
      */
-    mesh_model_config_t models[] = {
+    static mesh_model_config_t models[] = {
         MESH_MODEL_SENSOR(sensors, 6),                     // Standard sensor model
-        MESH_MODEL_VENDOR(0x0001, 0x0001, NULL, NULL),     // Vendor model for bulk IMU
+        MESH_MODEL_VENDOR_RX(0x0001, 0x0001, vendor_message_handler, NULL,   // Vendor model for bulk IMU
+                             vendor_rx_opcodes, sizeof(vendor_rx_opcodes) / sizeof(vendor_rx_opcodes[0])),
+#if IMU_PEER_LISTEN
+        MESH_MODEL_VENDOR_CLIENT(IMU_COMPANY_ID, IMU_PEER_MODEL_ID, peer_frame_handler, NULL,
+                                 peer_rx_opcodes, sizeof(peer_rx_opcodes) / sizeof(peer_rx_opcodes[0])),
+#endif
     };
 
     /*
@@ -730,7 +3261,7 @@ extern "C" void app_main(void)
      * - Useful when multiple types of devices in same area
      *
      * models: Array of model configurations
-     * model_count: 2 (Sensor + Vendor)
+     * model_count: entries in models (Sensor + Vendor [+ peer client])
      *
      * callbacks:
      * - provisioned: Called when provisioning succeeds
@@ -745,11 +3276,15 @@ extern "C" void app_main(void)
     config.device_uuid_prefix[0] = 0xAA;  // Match provisioner's UUID filter
     config.device_uuid_prefix[1] = 0xBB;
     config.models = models;
-    config.model_count = 2;
+    config.model_count = sizeof(models) / sizeof(models[0]);
     config.callbacks.provisioned = provisioned_callback;
     config.callbacks.reset = reset_callback;
     config.callbacks.config_complete = NULL;
     config.device_name = "M5Stick-IMU";
+    config.loop_stack_size = task_layout[IMU_TASK_LOOP].stack;     // on_window runs there
+    config.loop_priority = (uint8_t)task_layout[IMU_TASK_LOOP].priority;
+    config.loop_pinned = task_core(IMU_TASK_LOOP) != tskNO_AFFINITY;
+    config.loop_core = config.loop_pinned ? (uint8_t)task_core(IMU_TASK_LOOP) : 0;
 
     // Initialize BLE Mesh stack
     ret = node_init(&config);
@@ -763,6 +3298,37 @@ extern "C" void app_main(void)
         }
     }
 
+    // Everything below runs on the component's event loop task, not tasks of
+    // their own: window events, button events and the telemetry timer
+    mesh_event_on(IMU_EVENT_WINDOW, on_window, NULL);
+    mesh_event_on(IMU_EVENT_BUTTON, on_button, NULL);
+#if IMU_PEER_LISTEN
+    mesh_event_on(IMU_EVENT_PEER, on_peer, NULL);
+#endif
+#if IMU_AGG_ROLE == IMU_AGG_HEAD
+    static mesh_timer_t agg_timer;
+    imu_batch_init(&agg_batch);
+    mesh_sched_start(&agg_timer, IMU_AGG_WINDOW_MS, IMU_AGG_WINDOW_MS, agg_flush, NULL);
+#endif
+#if IMU_RELAY_ELECTION
+    static mesh_timer_t topo_timer;
+    imu_topo_table_init(&topo_table);
+    mesh_event_on(IMU_EVENT_RELAY_SET, on_relay_set, NULL);
+    mesh_sched_start(&topo_timer, IMU_TOPO_REPORT_MS, IMU_TOPO_REPORT_MS, topo_report, NULL);
+#endif
+    buttons_init();
+    static mesh_timer_t stats_timer;
+    mesh_sched_start(&stats_timer, IMU_STATS_PERIOD_MS, IMU_STATS_PERIOD_MS,
+                     report_publish_stats, NULL);
+
+#if IMU_MESH_PERIODIC
+    // Per-window frames go out at the provisioner's publish period
+    ret = mesh_model_vendor_set_periodic(0, pull_latest_frame, NULL);
+    if (ret != ESP_OK) {
+        printf("⚠️  Periodic publication unavailable: %d\n", ret);
+    }
+#endif
+
     // Start provisioning (begin broadcasting unprovisioned device beacons)
     ret = node_start();
     if (ret != ESP_OK) {
@@ -779,23 +3345,19 @@ extern "C" void app_main(void)
 
     /*
      * ───────────────────────────────────────────────────────────────────────
-     *              CREATE IMU PUBLISHING TASK (CRITICAL!)
+     *              IMU PUBLISHING ON THE EVENT LOOP (CRITICAL!)
      * ───────────────────────────────────────────────────────────────────────
      *
-     * xTaskCreate parameters:
-     * 1. Task function: imu_publish_task
-     * 2. Task name: "imu_publish" (for debugging)
-     * 3. Stack size: 4096 bytes (sufficient for our simple task)
-     * 4. Parameters: NULL (task doesn't need parameters)
-     * 5. Priority: 3 (CRITICAL: lower than mesh tasks which run at ~5-8)
-     * 6. Task handle: NULL (we don't need to reference this task later)
+     * There is no publishing task of our own any more: the component's
+     * mesh_loop task (node_init) runs on_window for every IMU_EVENT_WINDOW
+     * the sampler posts, next to the button events and the timers.
      *
-     * WHY PRIORITY 3?
-     * ---------------
+     * WHY PRIORITY 3 (the loop task's priority)?
+     * ------------------------------------------
      * - FreeRTOS is preemptive priority-based scheduler
      * - Higher priority tasks run first
      * - BLE Mesh advertising task = priority ~5-8
-     * - Our task = priority 3 (lower)
+     * - Loop task = priority 3 (lower)
      * - Result: Mesh always gets CPU when it needs to transmit/free buffers
      * - This prevents buffer exhaustion!
      *
@@ -805,35 +3367,35 @@ extern "C" void app_main(void)
      * causes buffer exhaustion because we queue messages faster than
      * mesh can transmit them. Lower priority = natural flow control.
      */
-    xTaskCreate(
-        imu_publish_task,           // Task function
-        "imu_publish",              // Task name (debugging)
-        4096,                       // Stack size in bytes
-        NULL,                       // Task parameters
-        3,                          // Priority (MUST be < mesh task priority!)
-        NULL                        // Task handle (not needed)
+    imu_ring_init(&sample_ring);
+    stream_config_load();       // NVS is up (node_init); sampler and publisher start with it
+    publisher_init();
+
+    // High-rate sampler: one step above the loop task, still below mesh,
+    // on the core task_layout[] gives it
+    xTaskCreatePinnedToCore(
+        imu_sample_task,                            // Task function
+        task_layout[IMU_TASK_SAMPLE].name,          // Task name (debugging, usage report)
+        task_layout[IMU_TASK_SAMPLE].stack,         // Stack size in bytes
+        NULL,                                       // Task parameters
+        task_layout[IMU_TASK_SAMPLE].priority,      // Priority (above the loop task, below mesh)
+        NULL,                                       // Task handle (not needed)
+        task_core(IMU_TASK_SAMPLE)                  // APP_CPU, or either core
     );
 
     /*
      * ───────────────────────────────────────────────────────────────────────
-     *                         MAIN LOOP
+     *                         NO MAIN LOOP
      * ───────────────────────────────────────────────────────────────────────
      *
-     * Main loop is minimal - only handles UI updates.
-     * All IMU publishing happens in the dedicated imu_publish_task.
+     * app_main used to spin on M5.update() + vTaskDelay(100) to catch button
+     * presses. Buttons are interrupts now (BUTTONS above), so app_main
+     * simply returns: ESP-IDF deletes the main task and frees its stack.
      *
-     * M5.update() checks:
-     * - Button presses
-     * - Power management
-     * - Internal state updates
-     *
-     * This separation of concerns is clean architecture:
-     * - Main loop: UI/input handling
-     * - IMU task: Data acquisition and transmission
-     * - Mesh tasks: Network operations
+     * What runs from here on:
+     * - imu_sample_task: sampling (its own timing, 200 Hz)
+     * - mesh_loop task: publishing, buttons, status screens, telemetry -
+     *   all event- or deadline-driven, blocked in between
+     * - Mesh tasks: network operations
      */
-    while(1) {
-        M5.update();
-        vTaskDelay(pdMS_TO_TICKS(100));
-    }
 }
@@ -0,0 +1,426 @@
+/*
+ * ============================================================================
+ *                    HOST BENCHMARK - CALIBRATION STAGE
+ * ============================================================================
+ *
+ * Checks and measures the fixed-point calibration kernel (imu_calib.h):
+ * - Kernel vs a double-precision reference on random samples and random
+ *   calibrations: every value within 1 LSB (any larger error is a failure)
+ * - Identity calibration is bit-exact; pack/unpack round trip; malformed
+ *   blobs (version, length, temperature order, row gain) are rejected
+ * - Correction: the trace is distorted by a simulated sensor (scale error,
+ *   1.5° misalignment, offsets, gyro bias drifting with a 20 → 45 °C warm-up),
+ *   read through the MPU6886 mock + driver (temperature register included),
+ *   then calibrated. RMS error vs the true trace, with and without the
+ *   temperature table.
+ * - Cost per sample: block kernel (bias interpolated once per block) vs
+ *   one call per sample vs the float reference
+ *
+ * Ends with the simulated sensor's calibration as an install frame
+ * (F,C70001,... - the format of tools/common/imu_frames.h): the payload is
+ * what a gateway sends to the node.
+ *
+ * Build and run: see tools/README.md
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "imu_calib.h"
+#include "imu_proto.h"
+#include "imu_frames.h"
+#include "imu_mpu6886.h"
+#include "imu_mpu6886_mock.h"
+#include "imu_trace.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define BLOCK       20          // Publisher drains ~20 samples per window
+#define TIMING_REPS 200
+
+static uint32_t rng_state = 2024;
+static int32_t rng_range(int32_t range)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return (int32_t)(rng_state % (2u * (uint32_t)range + 1u)) - range;
+}
+
+// Double-precision reference of imu_calib_apply (one sample)
+static void reference(const imu_calib_t *c, const int16_t bias[IMU_AXIS_COUNT],
+                      const imu_sample_t *in, double out[IMU_AXIS_COUNT])
+{
+    for (int s = 0; s < 2; s++) {
+        double x[3];
+        for (int k = 0; k < 3; k++) {
+            int32_t d = in->v[3 * s + k] - bias[3 * s + k];
+            x[k] = (d > 32767) ? 32767 : (d < -32768) ? -32768 : d;
+        }
+        for (int row = 0; row < 3; row++) {
+            double acc = 0.0;
+            for (int k = 0; k < 3; k++) {
+                acc += c->matrix[s][3 * row + k] / (double)IMU_CALIB_ONE * x[k];
+            }
+            out[3 * s + row] = acc;
+        }
+    }
+}
+
+static void random_calib(imu_calib_t *c)
+{
+    imu_calib_identity(c);
+    c->id = 1;
+    for (int s = 0; s < 2; s++) {
+        for (int k = 0; k < 9; k++) {
+            // Diagonal 0.8..1.2, off-diagonal ±0.1, occasionally extreme
+            int32_t base = (k % 4 == 0) ? IMU_CALIB_ONE : 0;
+            int32_t spread = (rng_range(9) == 0) ? 20000 : ((k % 4 == 0) ? 3277 : 1638);
+            int32_t v = base + rng_range(spread);
+            c->matrix[s][k] = (int16_t)((v > 21845) ? 21845 : (v < -21845) ? -21845 : v);
+        }
+    }
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        c->offset[a] = (int16_t)rng_range(200);
+    }
+    c->temp_points = (uint8_t)(rng_state % (IMU_CALIB_TEMP_POINTS + 1));
+    for (int t = 0; t < c->temp_points; t++) {
+        c->temp_c10[t] = (int16_t)(100 + 150 * t + rng_range(40));
+        for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+            c->temp_bias[t][a] = (int16_t)rng_range(100);
+        }
+    }
+}
+
+static size_t check_kernel(void)
+{
+    size_t errors = 0, values = 0;
+    double worst = 0.0;
+    for (int trial = 0; trial < 2000; trial++) {
+        imu_calib_t c;
+        random_calib(&c);
+        int16_t temp = (int16_t)(250 + rng_range(400));
+        int16_t bias[IMU_AXIS_COUNT];
+        imu_calib_bias(&c, temp, bias);
+
+        imu_sample_t block[BLOCK], in[BLOCK];
+        for (int i = 0; i < BLOCK; i++) {
+            for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+                // Mostly realistic values, some at the rails
+                int32_t r = (i == 0) ? 32767 : (i == 1) ? -32768 : rng_range(20000);
+                in[i].v[a] = (int16_t)r;
+            }
+        }
+        memcpy(block, in, sizeof(block));
+        imu_calib_apply(&c, temp, block, BLOCK);
+
+        for (int i = 0; i < BLOCK; i++) {
+            double ref[IMU_AXIS_COUNT];
+            reference(&c, bias, &in[i], ref);
+            for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+                double r = (ref[a] > 32767) ? 32767 : (ref[a] < -32768) ? -32768 : ref[a];
+                double e = fabs(block[i].v[a] - r);
+                worst = (e > worst) ? e : worst;
+                errors += (e > 1.0) ? 1 : 0;
+                values++;
+            }
+        }
+    }
+    printf("  kernel vs double reference: %zu values, max error %.2f LSB, %zu over 1 LSB\n",
+           values, worst, errors);
+    return errors;
+}
+
+static size_t check_format(const imu_trace_t *tr)
+{
+    size_t errors = 0;
+    imu_calib_t id, c, back;
+    uint8_t blob[IMU_CALIB_BLOB_MAX];
+
+    // Identity: bit-exact pass-through
+    imu_calib_identity(&id);
+    size_t n = tr->count < 4000 ? tr->count : 4000;
+    imu_sample_t *copy = malloc(n * sizeof(imu_sample_t));
+    memcpy(copy, tr->samples, n * sizeof(imu_sample_t));
+    imu_calib_apply(&id, 250, copy, n);
+    errors += memcmp(copy, tr->samples, n * sizeof(imu_sample_t)) != 0;
+    free(copy);
+
+    // Round trip at every table size
+    for (int trial = 0; trial < 200; trial++) {
+        random_calib(&c);
+        size_t len = imu_calib_pack(&c, blob, sizeof(blob));
+        memset(&back, 0xAA, sizeof(back));
+        if (len == 0 || !imu_calib_unpack(blob, len, &back) ||
+            memcmp(back.matrix, c.matrix, sizeof(c.matrix)) != 0 ||
+            memcmp(back.offset, c.offset, sizeof(c.offset)) != 0 ||
+            back.temp_points != c.temp_points || back.id != c.id ||
+            memcmp(back.temp_c10, c.temp_c10, c.temp_points * sizeof(int16_t)) != 0 ||
+            memcmp(back.temp_bias, c.temp_bias, c.temp_points * sizeof(c.temp_bias[0])) != 0) {
+            errors++;
+        }
+    }
+
+    // Malformed blobs
+    c.temp_points = 2;
+    c.temp_c10[0] = 200;
+    c.temp_c10[1] = 300;
+    size_t len = imu_calib_pack(&c, blob, sizeof(blob));
+    errors += imu_calib_unpack(blob, len - 1, &back);
+    blob[0] = IMU_CALIB_VERSION + 1;
+    errors += imu_calib_unpack(blob, len, &back);
+    c.temp_c10[1] = 200;
+    len = imu_calib_pack(&c, blob, sizeof(blob));
+    errors += imu_calib_unpack(blob, len, &back);
+    c.temp_c10[1] = 300;
+    c.matrix[0][0] = c.matrix[0][1] = c.matrix[0][2] = 30000;
+    len = imu_calib_pack(&c, blob, sizeof(blob));
+    errors += imu_calib_unpack(blob, len, &back);
+
+    printf("  identity, pack/unpack round trip, malformed blobs: %s\n", errors ? "FAIL" : "ok");
+    return errors;
+}
+
+/*
+ * ============================================================================
+ *                         CORRECTION
+ * ============================================================================
+ */
+
+// Simulated sensor: true → measured = S·R·true + offset + drift(T)
+typedef struct {
+    double dist[2][9];
+    double offset[IMU_AXIS_COUNT];
+    double drift_per_c[IMU_AXIS_COUNT];     // Units per °C, relative to 25 °C
+} sensor_model_t;
+
+static void make_sensor(sensor_model_t *m)
+{
+    const double scale[2][3] = { { 1.03, 0.98, 1.01 }, { 0.97, 1.02, 1.04 } };
+    const double th = 1.5 * M_PI / 180.0;   // Misalignment about Z, then X
+    const double rz[9] = { cos(th), -sin(th), 0, sin(th), cos(th), 0, 0, 0, 1 };
+    const double rx[9] = { 1, 0, 0, 0, cos(th), -sin(th), 0, sin(th), cos(th) };
+    double r[9];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            r[3 * i + j] = 0.0;
+            for (int k = 0; k < 3; k++) {
+                r[3 * i + j] += rz[3 * i + k] * rx[3 * k + j];
+            }
+        }
+    }
+    for (int s = 0; s < 2; s++) {
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                m->dist[s][3 * i + j] = scale[s][i] * r[3 * i + j];
+            }
+        }
+    }
+    const double offset[IMU_AXIS_COUNT] = { 40, -25, 60, 12, -30, 8 };
+    const double drift[IMU_AXIS_COUNT] = { 0.8, -0.5, 1.2, 0.5, -0.4, 0.6 };
+    memcpy(m->offset, offset, sizeof(offset));
+    memcpy(m->drift_per_c, drift, sizeof(drift));
+}
+
+static void invert3(const double m[9], double inv[9])
+{
+    double det = m[0] * (m[4] * m[8] - m[5] * m[7]) - m[1] * (m[3] * m[8] - m[5] * m[6]) +
+                 m[2] * (m[3] * m[7] - m[4] * m[6]);
+    inv[0] = (m[4] * m[8] - m[5] * m[7]) / det;
+    inv[1] = (m[2] * m[7] - m[1] * m[8]) / det;
+    inv[2] = (m[1] * m[5] - m[2] * m[4]) / det;
+    inv[3] = (m[5] * m[6] - m[3] * m[8]) / det;
+    inv[4] = (m[0] * m[8] - m[2] * m[6]) / det;
+    inv[5] = (m[2] * m[3] - m[0] * m[5]) / det;
+    inv[6] = (m[3] * m[7] - m[4] * m[6]) / det;
+    inv[7] = (m[1] * m[6] - m[0] * m[7]) / det;
+    inv[8] = (m[0] * m[4] - m[1] * m[3]) / det;
+}
+
+// What a factory calibration would produce for this sensor
+static void calib_for(const sensor_model_t *m, bool with_temp, imu_calib_t *c)
+{
+    imu_calib_identity(c);
+    c->id = 7;
+    for (int s = 0; s < 2; s++) {
+        double inv[9];
+        invert3(m->dist[s], inv);
+        for (int k = 0; k < 9; k++) {
+            c->matrix[s][k] = (int16_t)lrint(inv[k] * IMU_CALIB_ONE);
+        }
+    }
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        c->offset[a] = (int16_t)lrint(m->offset[a]);
+    }
+    if (with_temp) {
+        const int16_t points[IMU_CALIB_TEMP_POINTS] = { 150, 250, 350, 450 };
+        c->temp_points = IMU_CALIB_TEMP_POINTS;
+        for (int t = 0; t < IMU_CALIB_TEMP_POINTS; t++) {
+            c->temp_c10[t] = points[t];
+            for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+                c->temp_bias[t][a] = (int16_t)lrint(m->drift_per_c[a] * (points[t] - 250) / 10.0);
+            }
+        }
+    }
+}
+
+static void run_correction(const imu_trace_t *tr)
+{
+    sensor_model_t model;
+    make_sensor(&model);
+    imu_calib_t none, no_temp, full;
+    imu_calib_identity(&none);
+    calib_for(&model, false, &no_temp);
+    calib_for(&model, true, &full);
+    const imu_calib_t *calibs[3] = { &none, &no_temp, &full };
+    const char *names[3] = { "uncalibrated", "matrix + offset", "+ temperature table" };
+
+    for (int k = 0; k < 3; k++) {
+        imu_mpu6886_mock_t mock;
+        imu_mpu6886_mock_init(&mock, 3, 3);       // ±16 g / ±2000 dps: no clipping
+        imu_reg_bus_t bus = imu_mpu6886_mock_bus(&mock);
+        imu_mpu6886_t dev;
+        if (!imu_mpu6886_init(&dev, &bus)) {
+            return;
+        }
+
+        double sq[2] = { 0, 0 };
+        size_t count[2] = { 0, 0 };
+        imu_sample_t block[BLOCK], truth[BLOCK];
+        for (size_t i0 = 0; i0 + BLOCK <= tr->count; i0 += BLOCK) {
+            for (int i = 0; i < BLOCK; i++) {
+                const imu_sample_t *t = &tr->samples[i0 + i];
+                // Warm-up: 20 °C → 45 °C over the trace
+                double temp_c = 20.0 + 25.0 * (double)(i0 + i) / (double)tr->count;
+                imu_sample_t meas;
+                for (int s = 0; s < 2; s++) {
+                    for (int row = 0; row < 3; row++) {
+                        double v = model.offset[3 * s + row] +
+                                   model.drift_per_c[3 * s + row] * (temp_c - 25.0);
+                        for (int c2 = 0; c2 < 3; c2++) {
+                            v += model.dist[s][3 * row + c2] * t->v[3 * s + c2];
+                        }
+                        meas.v[3 * s + row] = imu_sat16((int32_t)lrint(v));
+                    }
+                }
+                mock.temp_c10 = (int16_t)lrint(temp_c * 10.0);
+                imu_mpu6886_mock_latch(&mock, &meas);
+                imu_mpu6886_read(&dev, &block[i]);
+                truth[i] = *t;
+            }
+            // Node: one temperature per block (the sampler's latest)
+            imu_calib_apply(calibs[k], dev.temp_c10, block, BLOCK);
+            for (int i = 0; i < BLOCK; i++) {
+                for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+                    double d = block[i].v[a] - truth[i].v[a];
+                    sq[a >= 3] += d * d;
+                    count[a >= 3]++;
+                }
+            }
+        }
+        printf("  %-22s %9.1f mg %9.1f (0.1 dps)\n", names[k],
+               sqrt(sq[0] / (double)count[0]), sqrt(sq[1] / (double)count[1]));
+    }
+}
+
+/*
+ * ============================================================================
+ *                         COST
+ * ============================================================================
+ */
+
+static void reference_float(const imu_calib_t *c, int16_t temp, imu_sample_t *block, size_t n)
+{
+    int16_t bias[IMU_AXIS_COUNT];
+    imu_calib_bias(c, temp, bias);
+    float m[2][9];
+    for (int s = 0; s < 2; s++) {
+        for (int k = 0; k < 9; k++) {
+            m[s][k] = c->matrix[s][k] / (float)IMU_CALIB_ONE;
+        }
+    }
+    for (size_t i = 0; i < n; i++) {
+        int16_t *v = block[i].v;
+        for (int s = 0; s < 2; s++) {
+            float x0 = (float)(v[3 * s] - bias[3 * s]);
+            float x1 = (float)(v[3 * s + 1] - bias[3 * s + 1]);
+            float x2 = (float)(v[3 * s + 2] - bias[3 * s + 2]);
+            v[3 * s]     = imu_sat16((int32_t)lrintf(m[s][0] * x0 + m[s][1] * x1 + m[s][2] * x2));
+            v[3 * s + 1] = imu_sat16((int32_t)lrintf(m[s][3] * x0 + m[s][4] * x1 + m[s][5] * x2));
+            v[3 * s + 2] = imu_sat16((int32_t)lrintf(m[s][6] * x0 + m[s][7] * x1 + m[s][8] * x2));
+        }
+    }
+}
+
+static void run_cost(const imu_trace_t *tr)
+{
+    sensor_model_t model;
+    make_sensor(&model);
+    imu_calib_t c;
+    calib_for(&model, true, &c);
+
+    const size_t n = tr->count - tr->count % BLOCK;
+    imu_sample_t *work = malloc(n * sizeof(imu_sample_t));
+    double ns[3] = { 0, 0, 0 };
+    volatile int32_t sink = 0;      // Keeps the results live
+    for (int variant = 0; variant < 3; variant++) {
+        uint64_t total = 0;
+        for (int rep = 0; rep < TIMING_REPS; rep++) {
+            memcpy(work, tr->samples, n * sizeof(imu_sample_t));
+            uint64_t t0 = bench_now_ns();
+            for (size_t i = 0; i < n; i += BLOCK) {
+                if (variant == 0) {
+                    imu_calib_apply(&c, 300, &work[i], BLOCK);
+                } else if (variant == 1) {
+                    for (size_t j = 0; j < BLOCK; j++) {
+                        imu_calib_apply(&c, 300, &work[i + j], 1);
+                    }
+                } else {
+                    reference_float(&c, 300, &work[i], BLOCK);
+                }
+            }
+            total += bench_now_ns() - t0;
+            sink += work[rep % n].v[0];
+        }
+        ns[variant] = (double)total / (double)(TIMING_REPS * n);
+    }
+    free(work);
+    printf("  block kernel (%d samples):   %6.1f ns/sample\n", BLOCK, ns[0]);
+    printf("  one call per sample:        %6.1f ns/sample\n", ns[1]);
+    printf("  float reference:            %6.1f ns/sample\n", ns[2]);
+}
+
+int main(int argc, char **argv)
+{
+    imu_trace_t tr;
+    if (imu_trace_open(argc > 1 ? argv[1] : NULL, &tr, 60000, 200) != 0) {
+        return 1;
+    }
+
+    printf("Calibration kernel checks\n");
+    size_t errors = check_kernel() + check_format(&tr);
+
+    printf("\nCorrection (%zu samples, 20 → 45 °C warm-up), RMS error vs true trace\n", tr.count);
+    run_correction(&tr);
+
+    printf("\nCost on this host\n");
+    run_cost(&tr);
+
+    sensor_model_t model;
+    imu_calib_t example;
+    uint8_t blob[IMU_CALIB_BLOB_MAX];
+    make_sensor(&model);
+    calib_for(&model, true, &example);
+    printf("\nInstall frame for this sensor's calibration:\n");
+    imu_frame_line_print(stdout, IMU_OP_CALIB, blob, imu_calib_pack(&example, blob, sizeof(blob)));
+
+    imu_trace_free(&tr);
+    if (errors) {
+        printf("\nFAIL: %zu error(s)\n", errors);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,281 @@
+/*
+ * ============================================================================
+ *                    HOST BENCHMARK - PER-WINDOW CODEC SELECTION
+ * ============================================================================
+ *
+ * Runs the selector (imu_codec.h) over a trace in windows of 20 samples
+ * and reports, per configuration:
+ * - Which codec won how often
+ * - Average frame size vs raw int16 and vs the best single fixed codec
+ * - Selector cost per window (and runs skipped by the CPU budget)
+ * - Round trip check: decoded window == quantized input (lossless codecs)
+ *
+ * Then the same trace through the noise pre-filter (imu_smooth.h) first:
+ * bits per sample of the lossless and the 10 mg selector, how far the
+ * filter moved the signal (RMS), how many samples a small and a large
+ * step take to reach 90 %, and how often the Kalman gate restarted.
+ *
+ * Build and run: see tools/README.md
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "imu_codec.h"
+#include "imu_smooth.h"
+#include "imu_trace.h"
+
+#define WINDOW  20
+
+typedef struct {
+    const char *label;
+    uint8_t precision;
+    uint16_t max_frame;
+    uint32_t budget_ns;
+} bench_config_t;
+
+static uint32_t host_clock(void)
+{
+    return (uint32_t)bench_now_ns();
+}
+
+// Bytes per window if one codec were used for everything (0 = it declined somewhere)
+static double fixed_codec_bytes(const imu_trace_t *tr, uint8_t id, uint8_t q, uint16_t max_frame)
+{
+    static uint8_t frame[IMU_CODEC_MAX_FRAME];
+    size_t windows = tr->count / WINDOW, total = 0;
+    for (size_t w = 0; w < windows; w++) {
+        size_t len = imu_codec_encode_with(id, q, 0, &tr->samples[w * WINDOW], WINDOW,
+                                           frame, max_frame);
+        if (len == 0) {
+            return 0.0;
+        }
+        total += len;
+    }
+    return (double)total / (double)windows;
+}
+
+static int run(const imu_trace_t *tr, const bench_config_t *bc)
+{
+    static imu_codec_selector_t sel;
+    static uint8_t frame[IMU_CODEC_MAX_FRAME];
+    imu_sample_t decoded[IMU_CODEC_MAX_BLOCK];
+
+    imu_codec_select_config_t cfg = {
+        .allowed_mask = IMU_CODEC_MASK_ALL,
+        .precision = bc->precision,
+        .max_frame = bc->max_frame,
+        .cpu_budget = bc->budget_ns,
+        .clock = host_clock,
+    };
+    imu_codec_selector_init(&sel, &cfg);
+
+    const size_t windows = tr->count / WINDOW;
+    size_t total = 0, mismatches = 0, dropped = 0;
+    uint64_t t0 = bench_now_ns();
+    for (size_t w = 0; w < windows; w++) {
+        const imu_sample_t *in = &tr->samples[w * WINDOW];
+        uint8_t id;
+        size_t len = imu_codec_select_encode(&sel, in, WINDOW, frame, sizeof(frame), &id);
+        if (len == 0) {
+            dropped++;
+            continue;
+        }
+        total += len;
+
+        const imu_codec_t *c = imu_codec_find(id);
+        size_t n = imu_codec_frame_decode(frame, len, decoded, IMU_CODEC_MAX_BLOCK, NULL, NULL);
+        if (c->summary || c->lossy) {
+            continue;   // Checked by imu_decode --check / bench_formats
+        }
+        for (size_t i = 0; i < n && n == WINDOW; i++) {
+            for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+                int32_t v = in[i].v[a], q = bc->precision;
+                int32_t expect = ((v >= 0) ? (v + q / 2) / q : (v - q / 2) / q) * q;
+                if (decoded[i].v[a] != imu_sat16(expect)) {
+                    mismatches++;
+                }
+            }
+        }
+        if (n != WINDOW) {
+            mismatches++;
+        }
+    }
+    uint64_t t1 = bench_now_ns();
+
+    double avg = windows - dropped ? (double)total / (double)(windows - dropped) : 0.0;
+    double raw16 = IMU_CODEC_HEADER_LEN + 1 + WINDOW * IMU_AXIS_COUNT * 2.0;
+
+    // Best single codec for comparison (lossless codecs only)
+    double best_fixed = 0.0;
+    const char *best_name = "-";
+    size_t count;
+    const imu_codec_t *const *list = imu_codec_list(&count);
+    for (size_t i = 0; i < count; i++) {
+        if (list[i]->summary || list[i]->lossy) {
+            continue;
+        }
+        double b = fixed_codec_bytes(tr, list[i]->id, bc->precision, bc->max_frame);
+        if (b > 0.0 && (best_fixed == 0.0 || b < best_fixed)) {
+            best_fixed = b;
+            best_name = list[i]->name;
+        }
+    }
+
+    printf("\n%s  (q=%u, max_frame=%u, budget=%u ns)\n", bc->label, bc->precision,
+           bc->max_frame, (unsigned)bc->budget_ns);
+    printf("  chosen:");
+    for (size_t i = 0; i < count; i++) {
+        printf("  %s %.1f%%", list[i]->name,
+               100.0 * (double)sel.wins[list[i]->id] / (double)windows);
+    }
+    printf("%s\n", dropped ? "  (some windows fit no codec)" : "");
+    printf("  avg frame %.1f B  | raw int16 %.0f B (saved %.1f%%)", avg, raw16,
+           100.0 * (1.0 - avg / raw16));
+    if (best_fixed > 0.0) {
+        printf("  | best fixed '%s' %.1f B (saved %.1f%%)", best_name, best_fixed,
+               100.0 * (1.0 - avg / best_fixed));
+    }
+    printf("\n  selector %.0f ns/window, %u budget skips, round trip %s\n",
+           (double)(t1 - t0) / (double)windows, (unsigned)sel.budget_skips,
+           mismatches ? "MISMATCH" : "ok");
+    return mismatches ? 1 : 0;
+}
+
+/*
+ * ============================================================================
+ *                         PRE-FILTER
+ * ============================================================================
+ */
+
+typedef struct {
+    const char *label;
+    imu_smooth_mode_t mode;
+    uint16_t gain;                  // COMPLEMENTARY (Q15)
+    uint32_t motion;                // KALMAN Q (LSB²), both sensors
+    uint8_t gate;                   // KALMAN
+} smooth_case_t;
+
+// Average selector frame per window, as bits per value
+static double selector_bits(const imu_sample_t *v, size_t count, uint8_t q)
+{
+    static imu_codec_selector_t sel;
+    static uint8_t frame[IMU_CODEC_MAX_FRAME];
+    imu_codec_select_config_t cfg = {
+        .allowed_mask = IMU_CODEC_MASK_ALL,
+        .precision = q,
+        .max_frame = IMU_CODEC_MAX_FRAME,
+        .cpu_budget = 0,
+        .clock = NULL,
+    };
+    imu_codec_selector_init(&sel, &cfg);
+    size_t windows = count / WINDOW, total = 0;
+    for (size_t w = 0; w < windows; w++) {
+        total += imu_codec_select_encode(&sel, &v[w * WINDOW], WINDOW, frame, sizeof(frame), NULL);
+    }
+    return 8.0 * (double)total / (double)(windows * WINDOW * IMU_AXIS_COUNT);
+}
+
+// Samples until a step of 'height' on AX reaches 90 % (from rest, no noise)
+static int step_latency(const imu_smooth_config_t *cfg, int16_t height)
+{
+    imu_smooth_t s;
+    imu_smooth_configure(&s, cfg);
+    imu_sample_t v;
+    memset(&v, 0, sizeof(v));
+    for (int i = 0; i < 50; i++) {
+        imu_sample_t z = v;
+        imu_smooth_apply(&s, &z, 1);
+    }
+    for (int i = 0; i < 1000; i++) {
+        imu_sample_t z = v;
+        z.v[IMU_AXIS_AX] = height;
+        imu_smooth_apply(&s, &z, 1);
+        if (z.v[IMU_AXIS_AX] * 10 >= height * 9) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void run_smoothing(const imu_trace_t *tr)
+{
+    static const smooth_case_t cases[] = {
+        { "off",                    IMU_SMOOTH_OFF,           0,      0, 0 },
+        { "complementary k=1/2",    IMU_SMOOTH_COMPLEMENTARY, 16384,  0, 0 },
+        { "complementary k=1/4",    IMU_SMOOTH_COMPLEMENTARY, 8192,   0, 0 },
+        { "complementary k=1/8",    IMU_SMOOTH_COMPLEMENTARY, 4096,   0, 0 },
+        { "Kalman Q=4, no gate",    IMU_SMOOTH_KALMAN,        0,      4, 0 },
+        { "Kalman Q=1, no gate",    IMU_SMOOTH_KALMAN,        0,      1, 0 },
+        { "Kalman Q=1, gate 4",     IMU_SMOOTH_KALMAN,        0,      1, 4 },
+        { "Kalman Q=1, gate 8",     IMU_SMOOTH_KALMAN,        0,      1, 8 },
+    };
+    imu_sample_t *f = malloc(sizeof(imu_sample_t) * tr->count);
+    if (!f) {
+        return;
+    }
+
+    printf("\nPre-filter (imu_smooth.h) before the selector\n");
+    printf("  filter                bits/value        RMS change        90%% of step   gate\n");
+    printf("                        q=1     q=10      accel   gyro      10    1000    restarts\n");
+    printf("  --------------------  ------  ------    ------  ------    ----  ----    --------\n");
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        imu_smooth_config_t cfg;
+        imu_smooth_defaults(&cfg, cases[c].mode);
+        if (cases[c].gain) {
+            cfg.gain[0] = cfg.gain[1] = cases[c].gain;
+        }
+        cfg.motion[0] = cfg.motion[1] = cases[c].motion ? cases[c].motion : 1;
+        cfg.gate = cases[c].gate;
+
+        imu_smooth_t s;
+        imu_smooth_configure(&s, &cfg);
+        memcpy(f, tr->samples, sizeof(imu_sample_t) * tr->count);
+        imu_smooth_apply(&s, f, tr->count);
+
+        double se[2] = { 0.0, 0.0 };
+        for (size_t i = 0; i < tr->count; i++) {
+            for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+                double d = (double)f[i].v[a] - tr->samples[i].v[a];
+                se[a < IMU_AXIS_GX ? 0 : 1] += d * d;
+            }
+        }
+        const double per = 3.0 * (double)tr->count;
+        printf("  %-20s  %6.2f  %6.2f    %4.1f mg %4.1f      %4d  %4d    %6.1f%%\n",
+               cases[c].label, selector_bits(f, tr->count, 1), selector_bits(f, tr->count, 10),
+               sqrt(se[0] / per), sqrt(se[1] / per) / 10.0,
+               step_latency(&cfg, 10), step_latency(&cfg, 1000),
+               100.0 * (double)s.restarts / (double)(tr->count * IMU_AXIS_COUNT));
+    }
+    printf("  (gyro RMS in dps; steps in LSB, latency in samples at %u Hz)\n",
+           (unsigned)tr->rate_hz);
+    free(f);
+}
+
+int main(int argc, char **argv)
+{
+    imu_trace_t tr;
+    if (imu_trace_open(argc > 1 ? argv[1] : NULL, &tr, 200 * 120, 200) != 0) {
+        return 1;
+    }
+    printf("Trace: %zu samples @ %u Hz (%s), windows of %u samples\n", tr.count,
+           (unsigned)tr.rate_hz, argc > 1 ? argv[1] : "synthetic", WINDOW);
+
+    static const bench_config_t configs[] = {
+        { "lossless",                   1, IMU_CODEC_MAX_FRAME, 0 },
+        { "lossless, tight CPU",        1, IMU_CODEC_MAX_FRAME, 2000 },
+        { "10 mg / 1 dps steps",       10, IMU_CODEC_MAX_FRAME, 0 },
+        { "legacy 0.1 g / 10 dps",    100, IMU_CODEC_MAX_FRAME, 0 },
+        { "legacy, 4 segments max",   100, 4 * 12 - 7, 0 },
+        { "lossless, 4 segments max",   1, 4 * 12 - 7, 0 },
+    };
+    int ret = 0;
+    for (size_t i = 0; i < sizeof(configs) / sizeof(configs[0]); i++) {
+        ret |= run(&tr, &configs[i]);
+    }
+    run_smoothing(&tr);
+
+    imu_trace_free(&tr);
+    return ret;
+}
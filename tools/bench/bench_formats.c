@@ -0,0 +1,367 @@
+/*
+ * ============================================================================
+ *                    HOST BENCHMARK - HALF-FLOAT / BLOCK-FLOATING-POINT FORMATS
+ * ============================================================================
+ *
+ * Checks and measures the imu_float.h wire formats:
+ * - Kernel checks (exhaustive): integer → binary16 against a table-driven
+ *   reference with ties-to-even, all 65536 binary16 patterns → integer,
+ *   BFP error bound and exponent minimality. Any failure fails the run.
+ * - Bytes per sample and RMS / max error vs the legacy int8 frame, on the
+ *   trace and on a "tremor + impacts" trace that needs the dynamic range
+ *   (errors split into quiet batches and batches containing an impact)
+ * - Encode / decode cost per batch
+ *
+ * Build and run: see tools/README.md
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "imu_float.h"
+#include "imu_codec.h"
+#include "imu_trace.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define BATCH   20
+
+/*
+ * ============================================================================
+ *                         KERNEL CHECKS
+ * ============================================================================
+ */
+
+static double half_value(uint16_t h)
+{
+    int exp = (h >> 10) & 0x1F;
+    double mant = (exp == 0) ? (h & 0x3FF) : ((h & 0x3FF) | 0x400);
+    double v = ldexp(mant, (exp == 0 ? 1 : exp) - 25);
+    return (h & 0x8000) ? -v : v;
+}
+
+// Nearest positive finite binary16 to a (ties to even), by bisection over the table
+static uint16_t ref_half_from_uint(uint32_t a)
+{
+    uint16_t lo = 0, hi = 0x7BFF;
+    if (a >= IMU_HALF_MAX) {
+        return hi;              // imu_half_from_int saturates instead of rounding to inf
+    }
+    while (hi - lo > 1) {
+        uint16_t mid = (uint16_t)((lo + hi) / 2);
+        if (half_value(mid) <= (double)a) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    double dlo = (double)a - half_value(lo), dhi = half_value(hi) - (double)a;
+    if (dlo < dhi) return lo;
+    if (dhi < dlo) return hi;
+    return (lo & 1) ? hi : lo;
+}
+
+static size_t check_half(void)
+{
+    size_t errors = 0;
+
+    for (int32_t v = -70000; v <= 70000; v++) {
+        uint32_t a = (uint32_t)(v < 0 ? -v : v);
+        uint16_t expect = ref_half_from_uint(a) | ((v < 0) ? 0x8000 : 0);
+        if (v == 0) {
+            expect = 0;
+        }
+        if (imu_half_from_int(v) != expect) {
+            if (errors++ < 5) {
+                printf("  half_from_int(%d) = %04X, expected %04X\n", v,
+                       imu_half_from_int(v), expect);
+            }
+        }
+    }
+
+    for (uint32_t h = 0; h <= 0xFFFF; h++) {
+        int exp = (h >> 10) & 0x1F;
+        int32_t expect;
+        if (exp == 0x1F) {
+            expect = (h & 0x3FF) ? 0 : ((h & 0x8000) ? -IMU_HALF_MAX : IMU_HALF_MAX);
+        } else {
+            expect = (int32_t)llround(half_value((uint16_t)h));
+        }
+        if (imu_half_to_int((uint16_t)h) != expect) {
+            if (errors++ < 5) {
+                printf("  half_to_int(%04X) = %d, expected %d\n", (unsigned)h,
+                       imu_half_to_int((uint16_t)h), expect);
+            }
+        }
+    }
+    return errors;
+}
+
+static uint32_t rng_state = 12345;
+static int16_t rng_i16(int32_t range)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return (int16_t)((int32_t)(rng_state % (2u * (uint32_t)range + 1u)) - range);
+}
+
+static size_t check_bfp_batch(const imu_sample_t *in, uint8_t n, uint8_t bits)
+{
+    uint8_t buf[IMU_BFP_HEADER_LEN + BATCH * IMU_AXIS_COUNT * 2];
+    imu_sample_t out[BATCH];
+    size_t errors = 0;
+
+    size_t len = imu_bfp_encode(in, n, bits, buf, sizeof(buf));
+    if (len == 0 || imu_bfp_decode(buf, len, bits, out, BATCH) != n ||
+        imu_bfp_decode(buf, len - 1, bits, out, BATCH) != 0) {
+        return 1;
+    }
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        uint8_t e = imu_bfp_exponent(in, n, a, bits);
+        int32_t bound = e ? (1 << (e - 1)) : 0;
+        for (uint8_t i = 0; i < n; i++) {
+            if (abs(out[i].v[a] - in[i].v[a]) > bound) {
+                errors++;
+            }
+        }
+        // Minimal: one step finer must overflow the mantissa for some sample
+        if (e > 0) {
+            int32_t hi = (1 << (bits - 1)) - 1, lo = -(1 << (bits - 1));
+            bool overflow = false;
+            for (uint8_t i = 0; i < n; i++) {
+                int32_t v = in[i].v[a];
+                int32_t m = (e - 1) ? (v + (1 << (e - 2))) >> (e - 1) : v;
+                overflow |= (m > hi || m < lo);
+            }
+            errors += overflow ? 0 : 1;
+        }
+    }
+    return errors;
+}
+
+static size_t check_bfp(const imu_trace_t *tr)
+{
+    size_t errors = 0;
+    imu_sample_t batch[BATCH];
+
+    for (uint8_t bits = 8; bits <= 12; bits += 4) {
+        for (size_t b = 0; b + BATCH <= tr->count; b += BATCH) {
+            errors += check_bfp_batch(&tr->samples[b], BATCH, bits);
+        }
+        for (int k = 0; k < 20000; k++) {
+            int32_t range = 1 << (k % 16);
+            uint8_t n = (uint8_t)(1 + k % BATCH);
+            for (uint8_t i = 0; i < n; i++) {
+                for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+                    batch[i].v[a] = rng_i16(range > 32767 ? 32767 : range);
+                }
+            }
+            if (k % 97 == 0) {
+                batch[0].v[k % IMU_AXIS_COUNT] = (k & 1) ? INT16_MIN : INT16_MAX;
+            }
+            errors += check_bfp_batch(batch, n, bits);
+        }
+    }
+    return errors;
+}
+
+/*
+ * ============================================================================
+ *                         FORMAT COMPARISON
+ * ============================================================================
+ */
+
+typedef struct {
+    const char *label;
+    int codec;                  // imu_codec_id_t, -1 = legacy int8 (÷100, saturated)
+} format_t;
+
+static const format_t formats[] = {
+    { "int8 0.1g/10dps", -1 },
+    { "half",   IMU_CODEC_HALF },
+    { "bfp8",   IMU_CODEC_BFP8 },
+    { "bfp12",  IMU_CODEC_BFP12 },
+};
+#define FORMAT_COUNT  (sizeof(formats) / sizeof(formats[0]))
+
+typedef struct {
+    double sq[2];               // Squared error sum: accel, gyro
+    int32_t max[2];
+    size_t values[2];
+} error_acc_t;
+
+static void acc_add(error_acc_t *e, const imu_sample_t *in, const imu_sample_t *out, uint8_t n)
+{
+    for (uint8_t i = 0; i < n; i++) {
+        for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+            int s = (a < IMU_AXIS_GX) ? 0 : 1;
+            int32_t d = abs(out[i].v[a] - in[i].v[a]);
+            e->sq[s] += (double)d * d;
+            e->max[s] = (d > e->max[s]) ? d : e->max[s];
+            e->values[s]++;
+        }
+    }
+}
+
+static double acc_rms(const error_acc_t *e, int s)
+{
+    return e->values[s] ? sqrt(e->sq[s] / (double)e->values[s]) : 0.0;
+}
+
+// Encode + decode one batch, returns wire bytes
+static size_t round_trip(const format_t *f, const imu_sample_t *in, imu_sample_t *out)
+{
+    static uint8_t frame[IMU_CODEC_MAX_FRAME];
+    if (f->codec < 0) {
+        for (uint8_t i = 0; i < BATCH; i++) {
+            for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+                int32_t q = in[i].v[a] / 100;
+                q = (q > 127) ? 127 : (q < -128) ? -128 : q;
+                out[i].v[a] = (int16_t)(q * 100);
+            }
+        }
+        return BATCH * IMU_AXIS_COUNT;
+    }
+    size_t len = imu_codec_encode_with((uint8_t)f->codec, 1, 0, in, BATCH, frame, sizeof(frame));
+    if (len == 0 || imu_codec_frame_decode(frame, len, out, BATCH, NULL, NULL) != BATCH) {
+        return 0;
+    }
+    return len;
+}
+
+// Batches with |accel| over 'impact_mg' on any axis count as impact batches
+static int compare(const imu_trace_t *tr, int32_t impact_mg)
+{
+    imu_sample_t out[BATCH];
+    int ret = 0;
+
+    printf("  format            B/sample | accel RMS/max (mg) | gyro RMS/max (0.1 dps)");
+    printf("%s\n", impact_mg ? " | quiet accel RMS | impact accel RMS/max" : "");
+    for (size_t k = 0; k < FORMAT_COUNT; k++) {
+        error_acc_t all = { 0 }, quiet = { 0 }, impact = { 0 };
+        size_t bytes = 0, batches = 0;
+        for (size_t b = 0; b + BATCH <= tr->count; b += BATCH) {
+            const imu_sample_t *in = &tr->samples[b];
+            size_t len = round_trip(&formats[k], in, out);
+            if (len == 0) {
+                ret = 1;
+                continue;
+            }
+            bytes += len;
+            batches++;
+            acc_add(&all, in, out, BATCH);
+            bool hit = false;
+            for (uint8_t i = 0; i < BATCH && impact_mg; i++) {
+                for (int a = 0; a < IMU_AXIS_GX; a++) {
+                    hit |= abs(in[i].v[a]) > impact_mg;
+                }
+            }
+            acc_add(hit ? &impact : &quiet, in, out, BATCH);
+        }
+        printf("  %-16s  %8.2f | %8.1f / %6d  | %8.1f / %6d", formats[k].label,
+               (double)bytes / (double)(batches * BATCH),
+               acc_rms(&all, 0), all.max[0], acc_rms(&all, 1), all.max[1]);
+        if (impact_mg) {
+            printf("      | %15.1f | %11.1f / %6d", acc_rms(&quiet, 0), acc_rms(&impact, 0),
+                   impact.max[0]);
+        }
+        printf("\n");
+    }
+    return ret;
+}
+
+// Device on a bench: gravity, 8 Hz tremor of a few mg, a 9 g knock every 2 s
+static int synth_impacts(imu_trace_t *tr, size_t count)
+{
+    tr->samples = calloc(count, sizeof(imu_sample_t));
+    if (!tr->samples) {
+        return -1;
+    }
+    tr->count = count;
+    tr->rate_hz = 200;
+    for (size_t i = 0; i < count; i++) {
+        double t = (double)i / 200.0;
+        double tremor = sin(2.0 * M_PI * 8.0 * t);
+        size_t phase = i % 400;
+        double knock = (phase < 4) ? sin(M_PI * (double)phase / 4.0) : 0.0;
+        imu_sample_t *s = &tr->samples[i];
+        s->v[IMU_AXIS_AX] = imu_sat16((int32_t)lrint(6.0 * tremor + 9000.0 * knock));
+        s->v[IMU_AXIS_AY] = imu_sat16((int32_t)lrint(-4.0 * tremor - 3000.0 * knock));
+        s->v[IMU_AXIS_AZ] = imu_sat16((int32_t)lrint(1000.0 + 3.0 * tremor));
+        s->v[IMU_AXIS_GX] = imu_sat16((int32_t)lrint(5.0 * tremor + 12000.0 * knock));
+        s->v[IMU_AXIS_GY] = imu_sat16((int32_t)lrint(-7.0 * tremor));
+        s->v[IMU_AXIS_GZ] = imu_sat16((int32_t)lrint(2.0 * tremor - 4000.0 * knock));
+    }
+    return 0;
+}
+
+/*
+ * ============================================================================
+ *                         COST
+ * ============================================================================
+ */
+static void cost(const imu_trace_t *tr)
+{
+    static uint8_t frame[IMU_CODEC_MAX_FRAME];
+    imu_sample_t out[BATCH];
+    const size_t batches = tr->count / BATCH;
+    volatile size_t sink = 0;
+
+    for (size_t k = 1; k < FORMAT_COUNT; k++) {
+        const imu_codec_t *c = imu_codec_find((uint8_t)formats[k].codec);
+        uint64_t enc = 0, dec = 0;
+        for (int rep = 0; rep < 5; rep++) {
+            for (size_t b = 0; b < batches; b++) {
+                uint64_t t0 = bench_now_ns();
+                size_t len = c->encode(&tr->samples[b * BATCH], BATCH, frame, sizeof(frame));
+                uint64_t t1 = bench_now_ns();
+                sink += c->decode(frame, len, out, BATCH);
+                uint64_t t2 = bench_now_ns();
+                enc += t1 - t0;
+                dec += t2 - t1;
+            }
+        }
+        printf("  %-6s encode %6.0f ns/batch, decode %6.0f ns/batch\n", c->name,
+               (double)enc / (double)(5 * batches), (double)dec / (double)(5 * batches));
+    }
+    (void)sink;
+}
+
+int main(int argc, char **argv)
+{
+    imu_trace_t tr, knocks;
+    if (imu_trace_open(argc > 1 ? argv[1] : NULL, &tr, 200 * 120, 200) != 0) {
+        return 1;
+    }
+    if (synth_impacts(&knocks, 200 * 60) != 0) {
+        return 1;
+    }
+    int ret = 0;
+
+    printf("Kernel checks\n");
+    size_t half_errors = check_half();
+    size_t bfp_errors = check_bfp(&tr);
+    printf("  binary16 (int -70000..70000, all 65536 patterns): %s\n",
+           half_errors ? "FAILED" : "ok");
+    printf("  BFP8/BFP12 error <= 2^(e-1), minimal exponent:      %s\n",
+           bfp_errors ? "FAILED" : "ok");
+    ret |= (half_errors || bfp_errors) ? 1 : 0;
+
+    printf("\nTrace: %zu samples @ %u Hz (%s), batches of %u samples\n", tr.count,
+           (unsigned)tr.rate_hz, argc > 1 ? argv[1] : "synthetic", BATCH);
+    ret |= compare(&tr, 0);
+
+    printf("\nTremor (3-7 units) + 9 g / 1200 dps knock every 2 s\n");
+    ret |= compare(&knocks, 2000);
+
+    printf("\nCost (host)\n");
+    cost(&tr);
+
+    imu_trace_free(&knocks);
+    imu_trace_free(&tr);
+    return ret;
+}
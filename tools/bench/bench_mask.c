@@ -0,0 +1,265 @@
+/*
+ * ============================================================================
+ *                    HOST BENCHMARK - CHANNEL-MASKED AND MAGNITUDE FRAMES
+ * ============================================================================
+ *
+ * Bytes per useful sample of the masked frame (imu_masked.h) and the
+ * magnitude frame (imu_magnitude.h) against the legacy 8-byte frame, for
+ * the channel subsets deployments actually ask for. The trace is
+ * decimated 200 Hz → 10 Hz (FIR, R = 20) as on the node, then every
+ * output is packed, unpacked and checked:
+ * - round trip: each kept channel must equal its own rounded int8 step,
+ *   each dropped channel must come back as 0 - any mismatch fails the run
+ * - messages per second and bytes per useful value, payload only and as
+ *   network PDU (payload + 3-byte opcode + 18 bytes of network/transport
+ *   header and MICs per unsegmented message)
+ * - latency the batching adds: the oldest sample of a frame waits for the
+ *   frame to fill
+ * - pack + unpack cost per frame
+ *
+ * Magnitude frames: imu_isqrt32() is checked exhaustively below 2^24 and
+ * around every perfect square up to the largest |a|² of three int16; the
+ * per-window peaks are checked against a float reference. The largest |a|
+ * each stream shows is compared with the full-rate peak (knock retention).
+ *
+ * Build and run: see tools/README.md
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "imu_masked.h"
+#include "imu_magnitude.h"
+#include "imu_decimator.h"
+#include "imu_trace.h"
+
+#define RATIO           20
+#define WINDOW_MS       100
+#define PDU_OVERHEAD    (IMU_VENDOR_OPCODE_LEN + 18)
+#define LEGACY_LEN      8
+#define COST_ROUNDS     200
+
+typedef struct {
+    const char *name;
+    uint8_t mask;
+} mask_case_t;
+
+static const mask_case_t cases[] = {
+    { "all six",        0x3F },
+    { "accel",          0x07 },
+    { "gyro",           0x38 },
+    { "accel + gz",     0x27 },
+    { "ax + ay",        0x03 },
+    { "az",             0x04 },
+    { "gz",             0x20 },
+};
+
+// Independent reference for one channel: nearest step, saturated at ±127
+static int16_t ref_value(int16_t v)
+{
+    long q = (v >= 0) ? (v + IMU_MASKED_STEP / 2) / IMU_MASKED_STEP
+                      : -((-(long)v + IMU_MASKED_STEP / 2) / IMU_MASKED_STEP);
+    if (q > 127) q = 127;
+    if (q < -127) q = -127;
+    return (int16_t)(q * IMU_MASKED_STEP);
+}
+
+static size_t check_isqrt(void)
+{
+    size_t errors = 0;
+    for (uint32_t x = 0; x < (1u << 24); x++) {
+        if (imu_isqrt32(x) != (uint16_t)sqrt((double)x) && errors++ < 5) {
+            printf("  isqrt(%u) = %u\n", x, imu_isqrt32(x));
+        }
+    }
+    // Around every perfect square up to 3 × 32768² (three int16 squared)
+    for (uint32_t r = 1; r <= 56755; r++) {
+        const uint32_t sq = r * r;
+        if ((imu_isqrt32(sq) != r || imu_isqrt32(sq - 1) != r - 1) && errors++ < 5) {
+            printf("  isqrt around %u² wrong\n", r);
+        }
+    }
+    return errors;
+}
+
+static double vec_norm(const int16_t *v)
+{
+    return sqrt((double)v[0] * v[0] + (double)v[1] * v[1] + (double)v[2] * v[2]);
+}
+
+// Reference for one magnitude: nearest step (ties up), saturated at 255 steps
+static uint16_t ref_mag_value(uint16_t m)
+{
+    long q = ((long)m + IMU_MAG_STEP / 2) / IMU_MAG_STEP;
+    return (uint16_t)((q > 255 ? 255 : q) * IMU_MAG_STEP);
+}
+
+int main(int argc, char **argv)
+{
+    imu_trace_t tr;
+    if (imu_trace_open(argc > 1 ? argv[1] : NULL, &tr, 200 * 120, 200) != 0) {
+        return 1;
+    }
+    printf("Trace: %zu samples @ %u Hz (%s), decimated by %d\n\n", tr.count,
+           (unsigned)tr.rate_hz, argc > 1 ? argv[1] : "synthetic", RATIO);
+
+    // Decimate once: every case packs the same outputs
+    static imu_decimator_t dec;
+    imu_decimator_configure(&dec, IMU_DECIM_FIR, RATIO);
+    imu_sample_t *outs = malloc(sizeof(imu_sample_t) * (tr.count / RATIO + 1));
+    if (!outs) {
+        return 1;
+    }
+    size_t n_out = imu_decimator_process(&dec, tr.samples, tr.count, outs, tr.count / RATIO + 1);
+    const double seconds = (double)n_out * WINDOW_MS / 1000.0;
+
+    printf("channels        k  n/frame  frame  msg/s   B/value  PDU B/value  legacy PDU B/value  "
+           "+latency  ns/frame\n");
+    printf("--------------  -  -------  -----  -----  -------  -----------  ------------------  "
+           "--------  --------\n");
+
+    size_t errors = 0;
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        const uint8_t mask = cases[c].mask;
+        const uint8_t k = imu_mask_channels(mask, NULL);
+        const uint8_t cap = imu_masked_capacity(mask);
+        size_t frames = 0, bytes = 0, values = 0;
+        uint8_t frame[IMU_FRAME_MAX];
+        imu_sample_t back[IMU_MASKED_MAX_SAMPLES];
+
+        for (size_t i = 0; i + cap <= n_out; i += cap) {
+            const uint16_t t_ms = (uint16_t)((i + cap - 1) * WINDOW_MS);
+            size_t len = imu_masked_pack(mask, t_ms, &outs[i], cap, frame, sizeof(frame));
+            uint8_t m;
+            uint16_t t;
+            uint8_t n = imu_masked_unpack(frame, len, &m, &t, back);
+            if (len == 0 || n != cap || m != mask || t != t_ms % IMU_MASKED_TIME_WRAP_MS) {
+                if (errors++ < 5) {
+                    printf("  frame %zu: len %zu, n %u, mask %02X, t %u\n", frames, len, n, m, t);
+                }
+                continue;
+            }
+            for (uint8_t j = 0; j < n; j++) {
+                for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+                    int16_t expect = (mask & (1u << a)) ? ref_value(outs[i + j].v[a]) : 0;
+                    if (back[j].v[a] != expect && errors++ < 5) {
+                        printf("  sample %zu axis %d: %d, expected %d\n", i + j, a,
+                               back[j].v[a], expect);
+                    }
+                }
+            }
+            frames++;
+            bytes += len;
+            values += (size_t)n * k;
+        }
+
+        // Cost: pack + unpack of one full frame, repeated over the outputs
+        uint64_t t0 = bench_now_ns();
+        size_t ops = 0;
+        for (int r = 0; r < COST_ROUNDS; r++) {
+            for (size_t i = 0; i + cap <= n_out; i += cap, ops++) {
+                size_t len = imu_masked_pack(mask, 0, &outs[i], cap, frame, sizeof(frame));
+                imu_masked_unpack(frame, len, NULL, NULL, back);
+            }
+        }
+        uint64_t t1 = bench_now_ns();
+
+        printf("%-14s  %u  %7u  %3zu B  %5.2f  %7.2f  %11.2f  %18.2f  %5d ms  %8.1f\n",
+               cases[c].name, k, cap, bytes / (frames ? frames : 1),
+               (double)frames / seconds, (double)bytes / (double)values,
+               (double)(bytes + frames * PDU_OVERHEAD) / (double)values,
+               (double)(LEGACY_LEN + PDU_OVERHEAD) / k,
+               (cap - 1) * WINDOW_MS, (double)(t1 - t0) / (double)(ops ? ops : 1));
+    }
+
+    // Magnitude frames: per-window peaks of the full-rate samples, 3 windows per frame
+    {
+        const size_t windows = tr.count / RATIO;
+        size_t frames = 0, bytes = 0;
+        double peak_full = 0.0, peak_decim = 0.0, peak_mag = 0.0;
+        imu_mag_t w[IMU_MAG_WINDOWS], back[IMU_MAG_WINDOWS];
+        uint8_t frame[IMU_MAG_FRAME_MAX];
+        uint8_t fill = 0;
+
+        for (size_t i = 0; i < windows; i++) {
+            const imu_sample_t *win = &tr.samples[i * RATIO];
+            double ref_a = 0.0, ref_g = 0.0;
+            for (int j = 0; j < RATIO; j++) {
+                ref_a = fmax(ref_a, vec_norm(&win[j].v[IMU_AXIS_AX]));
+                ref_g = fmax(ref_g, vec_norm(&win[j].v[IMU_AXIS_GX]));
+            }
+            peak_full = fmax(peak_full, ref_a);
+            if (i < n_out) {
+                peak_decim = fmax(peak_decim, vec_norm(&outs[i].v[IMU_AXIS_AX]));
+            }
+
+            w[fill].accel = w[fill].gyro = 0;
+            imu_mag_peak(win, RATIO, &w[fill]);
+            if (w[fill].accel != (uint16_t)floor(ref_a) || w[fill].gyro != (uint16_t)floor(ref_g)) {
+                if (errors++ < 5) {
+                    printf("  window %zu: peak %u/%u, expected %.0f/%.0f\n", i,
+                           w[fill].accel, w[fill].gyro, floor(ref_a), floor(ref_g));
+                }
+            }
+            if (++fill < IMU_MAG_WINDOWS) {
+                continue;
+            }
+            fill = 0;
+            size_t len = imu_mag_pack((uint16_t)(i * WINDOW_MS), w, IMU_MAG_WINDOWS, frame);
+            uint16_t t;
+            if (imu_mag_unpack(frame, len, &t, back) != IMU_MAG_WINDOWS) {
+                errors++;
+                continue;
+            }
+            for (int j = 0; j < IMU_MAG_WINDOWS; j++) {
+                if ((back[j].accel != ref_mag_value(w[j].accel) ||
+                     back[j].gyro != ref_mag_value(w[j].gyro)) && errors++ < 5) {
+                    printf("  magnitude frame %zu: %u/%u\n", frames, back[j].accel, back[j].gyro);
+                }
+                peak_mag = fmax(peak_mag, back[j].accel);
+            }
+            frames++;
+            bytes += len;
+        }
+
+        uint64_t t0 = bench_now_ns();
+        size_t ops = 0;
+        for (int r = 0; r < COST_ROUNDS; r++) {
+            for (size_t i = 0; i + IMU_MAG_WINDOWS <= windows; i += IMU_MAG_WINDOWS, ops++) {
+                for (int j = 0; j < IMU_MAG_WINDOWS; j++) {
+                    w[j].accel = w[j].gyro = 0;
+                    imu_mag_peak(&tr.samples[(i + j) * RATIO], RATIO, &w[j]);
+                }
+                size_t len = imu_mag_pack(0, w, IMU_MAG_WINDOWS, frame);
+                imu_mag_unpack(frame, len, NULL, back);
+            }
+        }
+        uint64_t t1 = bench_now_ns();
+
+        const size_t values = frames * IMU_MAG_WINDOWS * 2;
+        printf("%-14s  %u  %7u  %3zu B  %5.2f  %7.2f  %11.2f  %18.2f  %5d ms  %8.1f\n",
+               "|a| |w| peaks", 2, IMU_MAG_WINDOWS, bytes / (frames ? frames : 1),
+               (double)frames / seconds, (double)bytes / (double)values,
+               (double)(bytes + frames * PDU_OVERHEAD) / (double)values,
+               (double)(LEGACY_LEN + PDU_OVERHEAD) / 2, (IMU_MAG_WINDOWS - 1) * WINDOW_MS,
+               (double)(t1 - t0) / (double)(ops ? ops : 1));
+        printf("\n(legacy = one 8-byte frame per window whatever the mask; +latency = how long\n"
+               " the oldest sample of a frame waits for the frame to fill; magnitude ns/frame\n"
+               " includes the %d-sample peak search of all three windows)\n", RATIO);
+        printf("\nLargest |a|: full rate %.0f mg, decimated stream %.0f mg, magnitude frames %.0f mg\n",
+               peak_full, peak_decim, peak_mag);
+    }
+
+    size_t isqrt_errors = check_isqrt();
+    printf("isqrt: %s\n", isqrt_errors ? "MISMATCH" : "exact (2^24 exhaustive + every square up to 56755²)");
+    errors += isqrt_errors;
+
+    free(outs);
+    imu_trace_free(&tr);
+    if (errors) {
+        printf("\n%zu round-trip mismatch(es)\n", errors);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,306 @@
+/*
+ * ============================================================================
+ *                    HOST BENCHMARK - PREDICTIVE BIT-PLANE PACKED FRAMES
+ * ============================================================================
+ *
+ * Samples per 8-byte frame of the packed format (imu_packed.h) against the
+ * legacy imu_compact_data_t frame, which always carries exactly one:
+ * - kernel check: the word-at-a-time plane packer against the scalar
+ *   reference, every value count 1..24 and width 0..10 on random values,
+ *   both directions - any byte of difference fails the run
+ * - stream round trip: the trace is decimated 200 Hz → 10 Hz (FIR, R = 20)
+ *   as on the node, packed and decoded; every sample must equal its own
+ *   rounded 0.1 g / 10 dps step
+ * - per key interval: samples per frame, messages per second, network PDU
+ *   bytes per sample (payload + 3-byte opcode + 18 bytes of network /
+ *   transport header and MICs), mean latency the batching adds, and how
+ *   many samples one lost frame costs (the frame itself plus the predicted
+ *   frames after it, up to the next key frame)
+ * - the same at the full 200 Hz rate, where consecutive samples are closer
+ * - cost: scalar vs word-at-a-time kernels, and encode + decode per frame
+ *
+ * Build and run: see tools/README.md
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "imu_packed.h"
+#include "imu_decimator.h"
+#include "imu_trace.h"
+
+#define RATIO           20
+#define WINDOW_MS       100
+#define PDU_OVERHEAD    (IMU_VENDOR_OPCODE_LEN + 18)
+#define LEGACY_LEN      8
+#define KERNEL_ROUNDS   2000
+#define COST_ROUNDS     50
+
+static const uint8_t key_intervals[] = { 1, 2, 4, 8, 16 };
+
+// Independent reference for one value: nearest step, saturated at ±127
+static int16_t ref_value(int16_t v)
+{
+    long q = (v >= 0) ? (v + IMU_PACK_STEP / 2) / IMU_PACK_STEP
+                      : -((-(long)v + IMU_PACK_STEP / 2) / IMU_PACK_STEP);
+    if (q > 127) q = 127;
+    if (q < -127) q = -127;
+    return (int16_t)(q * IMU_PACK_STEP);
+}
+
+static uint32_t rng_state = 12345;
+
+static uint32_t rng(void)
+{
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state >> 8;
+}
+
+/*
+ * ============================================================================
+ *                         KERNEL CHECK
+ * ============================================================================
+ */
+static size_t check_kernels(void)
+{
+    size_t errors = 0;
+    for (int r = 0; r < KERNEL_ROUNDS; r++) {
+        for (uint8_t m = 1; m <= IMU_PACK_MAX_VALUES; m++) {
+            for (uint8_t w = 0; w <= IMU_PACK_MAX_WIDTH; w++) {
+                uint16_t u[IMU_PACK_MAX_VALUES], back_ref[IMU_PACK_MAX_VALUES];
+                uint16_t back_word[IMU_PACK_MAX_VALUES];
+                for (uint8_t i = 0; i < m; i++) {
+                    u[i] = (uint16_t)(rng() & ((1u << w) - 1u));
+                }
+                uint8_t a[32] = { 0 }, b[32] = { 0 };
+                imu_bitwriter_t wa, wb;
+                imu_bw_init(&wa, a, sizeof(a));
+                imu_bw_init(&wb, b, sizeof(b));
+                imu_bw_put(&wa, 5, 3);              // Start off a byte boundary
+                imu_bw_put(&wb, 5, 3);
+                imu_pack_planes_ref(&wa, u, m, w);
+                imu_pack_planes(&wb, u, m, w);
+                size_t la = imu_bw_finish(&wa), lb = imu_bw_finish(&wb);
+
+                imu_bitreader_t ra, rb;
+                imu_br_init(&ra, a, la);
+                imu_br_init(&rb, a, la);
+                imu_br_get(&ra, 3);
+                imu_br_get(&rb, 3);
+                imu_unpack_planes_ref(&ra, back_ref, m, w);
+                imu_unpack_planes(&rb, back_word, m, w);
+
+                if ((la != lb || memcmp(a, b, la) != 0 ||
+                     memcmp(back_ref, u, sizeof(*u) * m) != 0 ||
+                     memcmp(back_word, u, sizeof(*u) * m) != 0) && errors++ < 5) {
+                    printf("  kernel mismatch: m %u, w %u\n", m, w);
+                }
+            }
+        }
+    }
+    return errors;
+}
+
+// Average ns per call of one plane packer on m values of width w
+static double time_kernel(bool word, uint8_t m, uint8_t w)
+{
+    uint16_t u[IMU_PACK_MAX_VALUES];
+    for (uint8_t i = 0; i < m; i++) {
+        u[i] = (uint16_t)(rng() & ((1u << w) - 1u));
+    }
+    uint8_t buf[32];
+    volatile uint8_t sink = 0;
+    const int calls = 200000;
+    uint64_t t0 = bench_now_ns();
+    for (int r = 0; r < calls; r++) {
+        imu_bitwriter_t bw;
+        imu_bw_init(&bw, buf, sizeof(buf));
+        u[0] = (uint16_t)(r & ((1u << w) - 1u));
+        if (word) {
+            imu_pack_planes(&bw, u, m, w);
+        } else {
+            imu_pack_planes_ref(&bw, u, m, w);
+        }
+        sink ^= buf[imu_bw_finish(&bw) / 2];
+    }
+    uint64_t t1 = bench_now_ns();
+    (void)sink;
+    return (double)(t1 - t0) / calls;
+}
+
+/*
+ * ============================================================================
+ *                         STREAM RUN
+ * ============================================================================
+ */
+typedef struct {
+    size_t frames, samples, bytes, key_frames;
+    double wait_windows;            // Sum over samples of windows until sent
+    double lost_per_loss;           // Mean samples lost when one frame is lost
+    size_t errors;
+} run_t;
+
+static run_t run_stream(const imu_sample_t *in, size_t count, uint8_t key_interval)
+{
+    run_t r;
+    memset(&r, 0, sizeof(r));
+    imu_pack_encoder_t enc;
+    imu_pack_decoder_t dec;
+    imu_pack_encoder_init(&enc, key_interval, IMU_PACK_MAX_SAMPLES);
+    imu_pack_decoder_init(&dec);
+
+    // Per frame: sample count and key flag, for the loss accounting below
+    uint8_t *frame_n = malloc(count + 1);
+    bool *frame_key = malloc(count + 1);
+    if (!frame_n || !frame_key) {
+        r.errors++;
+        free(frame_n);
+        free(frame_key);
+        return r;
+    }
+
+    uint8_t frame[IMU_FRAME_MAX];
+    imu_sample_t back[IMU_PACK_MAX_SAMPLES];
+    size_t checked = 0;
+    for (size_t i = 0; i <= count; i++) {
+        size_t len = (i < count) ? imu_pack_push(&enc, &in[i], frame) : imu_pack_flush(&enc, frame);
+        if (len == 0) {
+            continue;
+        }
+        bool key;
+        uint8_t n = imu_pack_decode(&dec, frame, len, back, &key);
+        if (n == 0 || len > IMU_FRAME_MAX) {
+            if (r.errors++ < 5) {
+                printf("  frame %zu: len %zu did not decode\n", r.frames, len);
+            }
+            continue;
+        }
+        for (uint8_t j = 0; j < n; j++, checked++) {
+            for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+                if (back[j].v[a] != ref_value(in[checked].v[a]) && r.errors++ < 5) {
+                    printf("  sample %zu axis %d: %d, expected %d\n", checked, a,
+                           back[j].v[a], ref_value(in[checked].v[a]));
+                }
+            }
+            // Sent when window i closes (the flush: with the last one)
+            r.wait_windows += (double)(i < count ? i : count - 1) - (double)checked;
+        }
+        frame_n[r.frames] = n;
+        frame_key[r.frames] = key;
+        r.frames++;
+        r.samples += n;
+        r.bytes += len;
+        r.key_frames += key;
+    }
+    if (checked != count) {
+        printf("  %zu of %zu samples decoded\n", checked, count);
+        r.errors++;
+    }
+
+    // Losing frame f costs f and every predicted frame up to the next key frame
+    double lost = 0.0;
+    for (size_t f = 0; f < r.frames; f++) {
+        lost += frame_n[f];
+        for (size_t g = f + 1; g < r.frames && !frame_key[g]; g++) {
+            lost += frame_n[g];
+        }
+    }
+    r.lost_per_loss = lost / (double)(r.frames ? r.frames : 1);
+    free(frame_n);
+    free(frame_key);
+    return r;
+}
+
+static void print_run(const char *name, uint8_t k, const run_t *r, double seconds,
+                      double window_ms)
+{
+    printf("%-13s  %3u  %9.2f  %5.2f  %8.2f  %10.2f  %7.0f ms  %11.2f\n",
+           name, k, (double)r->samples / (double)r->frames, (double)r->frames / seconds,
+           (double)r->bytes / (double)r->frames,
+           (double)(r->bytes + r->frames * PDU_OVERHEAD) / (double)r->samples,
+           r->wait_windows / (double)r->samples * window_ms, r->lost_per_loss);
+}
+
+int main(int argc, char **argv)
+{
+    imu_trace_t tr;
+    if (imu_trace_open(argc > 1 ? argv[1] : NULL, &tr, 200 * 120, 200) != 0) {
+        return 1;
+    }
+    printf("Trace: %zu samples @ %u Hz (%s), decimated by %d\n\n", tr.count,
+           (unsigned)tr.rate_hz, argc > 1 ? argv[1] : "synthetic", RATIO);
+
+    size_t errors = check_kernels();
+    printf("Plane kernels: %s\n\n", errors ? "MISMATCH"
+           : "word-at-a-time == scalar (m 1..24, w 0..10, random values, both ways)");
+
+    static imu_decimator_t dec;
+    imu_decimator_configure(&dec, IMU_DECIM_FIR, RATIO);
+    imu_sample_t *outs = malloc(sizeof(imu_sample_t) * (tr.count / RATIO + 1));
+    if (!outs) {
+        return 1;
+    }
+    size_t n_out = imu_decimator_process(&dec, tr.samples, tr.count, outs, tr.count / RATIO + 1);
+    const double seconds = (double)n_out * WINDOW_MS / 1000.0;
+
+    printf("stream         key  samples/  msg/s  B/frame  PDU B/      +latency   samples lost\n");
+    printf("               int  frame                   sample      (mean)     per lost frame\n");
+    printf("-------------  ---  ---------  -----  --------  ----------  ---------  -----------\n");
+    printf("%-13s  %3s  %9.2f  %5.2f  %8.2f  %10.2f  %7.0f ms  %11.2f\n", "legacy 10 Hz", "-",
+           1.0, (double)n_out / seconds, (double)LEGACY_LEN, (double)(LEGACY_LEN + PDU_OVERHEAD),
+           0.0, 1.0);
+    for (size_t k = 0; k < sizeof(key_intervals) / sizeof(key_intervals[0]); k++) {
+        run_t r = run_stream(outs, n_out, key_intervals[k]);
+        errors += r.errors;
+        print_run("packed 10 Hz", key_intervals[k], &r, seconds, WINDOW_MS);
+    }
+    {
+        const double full_s = (double)tr.count / tr.rate_hz;
+        run_t r = run_stream(tr.samples, tr.count, IMU_PACK_KEY_INTERVAL);
+        errors += r.errors;
+        print_run("packed 200 Hz", IMU_PACK_KEY_INTERVAL, &r, full_s, 1000.0 / tr.rate_hz);
+    }
+    printf("\n(+latency = how long a sample waits for its frame to be sent; legacy rows send\n"
+           " one sample per frame; lost = the frame plus predicted frames up to the next key)\n");
+
+    // Kernel cost on the shapes the stream actually produces
+    printf("\nPlane packer ns/call     scalar    word\n");
+    const uint8_t shapes[][2] = { { 24, 1 }, { 12, 3 }, { 6, 5 }, { 3, 10 } };
+    for (size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++) {
+        printf("  %2u values × %2u planes  %7.1f  %6.1f\n", shapes[s][0], shapes[s][1],
+               time_kernel(false, shapes[s][0], shapes[s][1]),
+               time_kernel(true, shapes[s][0], shapes[s][1]));
+    }
+
+    // Encode + decode per frame, whole decimated stream
+    {
+        imu_pack_encoder_t enc;
+        imu_pack_decoder_t pd;
+        uint8_t frame[IMU_FRAME_MAX];
+        imu_sample_t back[IMU_PACK_MAX_SAMPLES];
+        size_t frames = 0;
+        uint64_t t0 = bench_now_ns();
+        for (int r = 0; r < COST_ROUNDS; r++) {
+            imu_pack_encoder_init(&enc, IMU_PACK_KEY_INTERVAL, IMU_PACK_MAX_SAMPLES);
+            imu_pack_decoder_init(&pd);
+            for (size_t i = 0; i < n_out; i++) {
+                size_t len = imu_pack_push(&enc, &outs[i], frame);
+                if (len) {
+                    imu_pack_decode(&pd, frame, len, back, NULL);
+                    frames++;
+                }
+            }
+        }
+        uint64_t t1 = bench_now_ns();
+        printf("Encode + decode: %.1f ns/frame (key interval %d)\n",
+               (double)(t1 - t0) / (double)(frames ? frames : 1), IMU_PACK_KEY_INTERVAL);
+    }
+
+    free(outs);
+    imu_trace_free(&tr);
+    if (errors) {
+        printf("\n%zu mismatch(es)\n", errors);
+        return 1;
+    }
+    return 0;
+}
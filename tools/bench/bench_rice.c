@@ -0,0 +1,125 @@
+/*
+ * ============================================================================
+ *                    HOST BENCHMARK - LOSSLESS RICE CODEC
+ * ============================================================================
+ *
+ * Measures, for several block sizes:
+ * - Bits per value (vs 16 raw, vs 8 for the lossy int8 frame)
+ * - Frame size distribution and segments per frame
+ * - Encode and decode cost per block, decode throughput
+ * - Bit-exact round trip (any mismatch is a failure)
+ *
+ * Encode cycles on the ESP32 are logged by the firmware in Rice mode
+ * (see IMU_PUBLISH_RICE in main/m5stick_mesh_imu.cpp).
+ *
+ * Build and run: see tools/README.md
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "imu_rice.h"
+#include "imu_trace.h"
+
+#define SEGMENT_PAYLOAD  12   // Upper transport bytes per segment
+
+static const char *axis_names[IMU_AXIS_COUNT] = { "AX", "AY", "AZ", "GX", "GY", "GZ" };
+
+static int run(const imu_trace_t *tr, uint8_t block)
+{
+    static uint8_t frame[IMU_RICE_MAX_FRAME];
+    imu_sample_t decoded[IMU_RICE_MAX_BLOCK];
+    const size_t n_blocks = tr->count / block;
+
+    // Pass 1: sizes, round trip and per-axis split (one axis at a time
+    // is measured by re-encoding a copy with the other axes zeroed)
+    size_t total_bytes = 0, max_bytes = 0, mismatches = 0, segments = 0;
+    for (size_t b = 0; b < n_blocks; b++) {
+        const imu_sample_t *in = &tr->samples[b * block];
+        size_t len = imu_rice_encode(in, block, (uint8_t)b, frame, sizeof(frame));
+        if (len == 0) {
+            printf("encode failed at block %zu\n", b);
+            return 1;
+        }
+        total_bytes += len;
+        if (len > max_bytes) max_bytes = len;
+        // 3-byte opcode + 4-byte TransMIC travel in the same segments
+        segments += (len + 3 + 4 + SEGMENT_PAYLOAD - 1) / SEGMENT_PAYLOAD;
+
+        uint8_t seq;
+        if (imu_rice_decode(frame, len, decoded, IMU_RICE_MAX_BLOCK, &seq) != block ||
+            memcmp(decoded, in, block * sizeof(imu_sample_t)) != 0) {
+            mismatches++;
+        }
+    }
+
+    double axis_bits[IMU_AXIS_COUNT];
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        size_t bytes = 0;
+        imu_sample_t tmp[IMU_RICE_MAX_BLOCK];
+        for (size_t b = 0; b < n_blocks; b++) {
+            memset(tmp, 0, sizeof(tmp));
+            for (uint8_t i = 0; i < block; i++) {
+                tmp[i].v[a] = tr->samples[b * block + i].v[a];
+            }
+            bytes += imu_rice_encode(tmp, block, 0, frame, sizeof(frame)) - IMU_RICE_HEADER_LEN;
+        }
+        // Remove the 5 zeroed axes (6 bits each: order 0 + k 0 + N one-bit codes)
+        double bits = (double)bytes * 8.0 - (double)n_blocks * 5.0 * (6.0 + block);
+        axis_bits[a] = bits / (double)(n_blocks * block);
+    }
+
+    // Pass 2: timing
+    uint64_t t0 = bench_now_ns();
+    for (size_t b = 0; b < n_blocks; b++) {
+        imu_rice_encode(&tr->samples[b * block], block, (uint8_t)b, frame, sizeof(frame));
+    }
+    uint64_t t1 = bench_now_ns();
+
+    // Decode the same frame repeatedly - the encoder is not in the loop
+    size_t mid = (n_blocks / 2) * block;
+    size_t len = imu_rice_encode(&tr->samples[mid], block, 0, frame, sizeof(frame));
+    uint64_t t2 = bench_now_ns();
+    for (size_t b = 0; b < n_blocks; b++) {
+        imu_rice_decode(frame, len, decoded, IMU_RICE_MAX_BLOCK, NULL);
+    }
+    uint64_t t3 = bench_now_ns();
+
+    double values = (double)(n_blocks * block * IMU_AXIS_COUNT);
+    double enc_ns = (double)(t1 - t0) / (double)n_blocks;
+    double dec_ns = (double)(t3 - t2) / (double)n_blocks;
+    printf("%5u  %8.2f  %7.0f  %5zu  %8.1f  %9.0f  %9.0f  %8.1f  %s\n",
+           block, (double)total_bytes * 8.0 / values,
+           (double)total_bytes / (double)n_blocks, max_bytes,
+           (double)segments / (double)n_blocks, enc_ns, dec_ns,
+           (double)block * 1e3 / dec_ns, mismatches ? "MISMATCH" : "ok");
+
+    printf("       per-axis bits/value:");
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        printf(" %s %.2f", axis_names[a], axis_bits[a]);
+    }
+    printf("\n");
+    return mismatches ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    imu_trace_t tr;
+    if (imu_trace_open(argc > 1 ? argv[1] : NULL, &tr, 200 * 120, 200) != 0) {
+        return 1;
+    }
+    printf("Trace: %zu samples @ %u Hz (%s)\n", tr.count, (unsigned)tr.rate_hz,
+           argc > 1 ? argv[1] : "synthetic");
+    printf("Reference: 16 bits/value raw, 8 bits/value lossy int8 frame\n\n");
+
+    static const uint8_t blocks[] = { 10, 20, 30 };
+    int ret = 0;
+    printf("block  bits/val  B/frame  max B  segments  enc ns/blk  dec ns/blk  Msamp/s  lossless\n");
+    printf("-----  --------  -------  -----  --------  ----------  ----------  -------  --------\n");
+    for (size_t i = 0; i < sizeof(blocks); i++) {
+        ret |= run(&tr, blocks[i]);
+    }
+
+    imu_trace_free(&tr);
+    return ret;
+}
@@ -0,0 +1,322 @@
+/*
+ * ============================================================================
+ *                    HOST BENCHMARK - DEFERRED VENDOR HANDLERS
+ * ============================================================================
+ *
+ * Received vendor messages handled inline on the mesh stack's BTC task
+ * against copied into the received-message pool (mesh_msg_pool.h, the
+ * component's code, unchanged) and handled on the rx worker task.
+ *
+ * One CPU, simulated in 10 µs steps, pre-emptive priorities: BTC above
+ * the worker. Traffic for 60 s per run:
+ * - relayed / other mesh messages: BTC work only (decrypt, relay, ack)
+ * - vendor messages for our model, handler-heavy: 80% light (50 µs),
+ *   15% medium (2 ms), 5% heavy (20 ms - NVS write + pipeline reconfigure,
+ *   a 200-byte segmented message)
+ * The BTC input queue holds BTC_QUEUE messages; beyond that the stack
+ * drops them. Per message the BTC task spends STACK_US, plus the handler
+ * (inline) or the pool copy (deferred).
+ *
+ * Reported: vendor messages handled per second, messages lost (BTC queue
+ * full / pool full), the stack's latency (arrival → BTC done: how long the
+ * mesh was held up) and the handler latency (arrival → handler done).
+ * Checks - any failure fails the run: the worker handles messages in
+ * arrival order, each exactly once, and every pooled buffer comes back.
+ *
+ * Build and run: see tools/README.md
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "mesh_msg_pool.h"
+#include "imu_trace.h"              // bench_now_ns
+
+#define STEP_US         10
+#define RUN_US          (60u * 1000u * 1000u)
+#define BTC_QUEUE       60          // CONFIG_BT_BTC_TASK_QUEUE_LEN default
+#define STACK_US        400         // BTC work per received message (ESP32, AES-CCM etc.)
+#define COPY_US         10          // BTC work to pool a message: 2 critical sections + memcpy + notify
+#define RELAY_PER_S     50
+#define MAX_MSGS        20000
+
+typedef enum { KIND_RELAY, KIND_LIGHT, KIND_MEDIUM, KIND_HEAVY } kind_t;
+
+static const struct {
+    const char *name;
+    uint32_t handler_us;
+    uint16_t len;
+} kinds[] = {
+    { "relay", 0, 0 },
+    { "light", 50, 8 },
+    { "medium", 2000, 11 },
+    { "heavy", 20000, 200 },
+};
+
+typedef struct {
+    uint32_t arrive_us;
+    kind_t kind;
+    uint32_t stack_done_us;         // 0 = not yet / lost
+    uint32_t handler_done_us;
+    bool lost;
+} msg_t;
+
+static msg_t msgs[MAX_MSGS];
+static size_t n_msgs;
+static uint32_t rng_state = 777;
+
+static uint32_t rng(void)
+{
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state >> 8;
+}
+
+// Exponential inter-arrival time, µs (Poisson traffic)
+static uint32_t exp_gap(double rate_per_s)
+{
+    const double u = (rng() + 1.0) / (double)(1u << 24);
+    return (uint32_t)(-log(u) * 1e6 / rate_per_s) + 1;
+}
+
+static int cmp_arrival(const void *a, const void *b)
+{
+    const msg_t *x = a, *y = b;
+    return (x->arrive_us > y->arrive_us) - (x->arrive_us < y->arrive_us);
+}
+
+static void build_traffic(double app_per_s)
+{
+    n_msgs = 0;
+    for (uint32_t t = exp_gap(RELAY_PER_S); t < RUN_US && n_msgs < MAX_MSGS; t += exp_gap(RELAY_PER_S)) {
+        msgs[n_msgs++] = (msg_t){ t, KIND_RELAY, 0, 0, false };
+    }
+    for (uint32_t t = exp_gap(app_per_s); t < RUN_US && n_msgs < MAX_MSGS; t += exp_gap(app_per_s)) {
+        const uint32_t r = rng() % 100;
+        const kind_t k = r < 80 ? KIND_LIGHT : r < 95 ? KIND_MEDIUM : KIND_HEAVY;
+        msgs[n_msgs++] = (msg_t){ t, k, 0, 0, false };
+    }
+    qsort(msgs, n_msgs, sizeof(msgs[0]), cmp_arrival);
+}
+
+/*
+ * ============================================================================
+ *                         SIMULATION
+ * ============================================================================
+ */
+typedef struct {
+    double handled_per_s;
+    uint32_t lost_btc, lost_pool;
+    uint32_t stack_p99, stack_max;
+    uint32_t handler_p99, handler_max;
+    uint32_t max_pending;
+} result_t;
+
+static size_t errors;
+static mesh_msg_pool_t pool;
+
+static int cmp_u32(const void *a, const void *b)
+{
+    const uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void percentiles(uint32_t *v, size_t n, uint32_t *p99, uint32_t *max)
+{
+    if (n == 0) {
+        *p99 = *max = 0;
+        return;
+    }
+    qsort(v, n, sizeof(v[0]), cmp_u32);
+    *p99 = v[(n * 99) / 100 < n ? (n * 99) / 100 : n - 1];
+    *max = v[n - 1];
+}
+
+static result_t simulate(bool deferred)
+{
+    static uint32_t btc_q[BTC_QUEUE];
+    size_t q_head = 0, q_len = 0;
+    size_t next = 0;
+    int32_t btc_cur = -1;               // Message the BTC task is working on
+    uint32_t btc_left = 0;
+    mesh_msg_t *wk_cur = NULL;          // Message the worker is handling
+    uint32_t wk_left = 0;
+    uint32_t last_handled = 0;          // Arrival order check
+    bool any_handled = false;
+    result_t r = { 0 };
+
+    mesh_msg_pool_init(&pool);
+    for (size_t i = 0; i < n_msgs; i++) {
+        msgs[i].stack_done_us = msgs[i].handler_done_us = 0;
+        msgs[i].lost = false;
+    }
+
+    for (uint32_t now = 0; now < RUN_US + 5u * 1000u * 1000u; now += STEP_US) {
+        // Radio: arrivals go into the BTC queue, or are lost
+        while (next < n_msgs && msgs[next].arrive_us <= now) {
+            if (q_len == BTC_QUEUE) {
+                msgs[next].lost = true;
+                r.lost_btc++;
+            } else {
+                btc_q[(q_head + q_len++) % BTC_QUEUE] = (uint32_t)next;
+            }
+            next++;
+        }
+
+        // BTC task (higher priority) gets the step if it has work
+        if (btc_cur < 0 && q_len) {
+            btc_cur = (int32_t)btc_q[q_head];
+            q_head = (q_head + 1) % BTC_QUEUE;
+            q_len--;
+            const msg_t *m = &msgs[btc_cur];
+            btc_left = STACK_US;
+            if (m->kind != KIND_RELAY) {
+                btc_left += deferred ? COPY_US : kinds[m->kind].handler_us;
+            }
+        }
+        if (btc_cur >= 0) {
+            btc_left = btc_left > STEP_US ? btc_left - STEP_US : 0;
+            if (btc_left == 0) {
+                msg_t *m = &msgs[btc_cur];
+                m->stack_done_us = now + STEP_US;
+                if (m->kind != KIND_RELAY) {
+                    if (!deferred) {
+                        m->handler_done_us = now + STEP_US;
+                    } else {
+                        mesh_msg_t *pm = mesh_msg_pool_get(&pool, kinds[m->kind].len);
+                        if (!pm) {
+                            m->lost = true;
+                            r.lost_pool++;
+                        } else {
+                            memset(pm->data, (int)m->kind, pm->len);
+                            pm->opcode = (uint32_t)btc_cur;
+                            pm->rx_us = now + STEP_US;
+                            mesh_msg_pool_push(&pool, pm);
+                        }
+                    }
+                }
+                btc_cur = -1;
+            }
+            continue;
+        }
+
+        // Worker: only when the BTC task is idle
+        if (!wk_cur) {
+            wk_cur = mesh_msg_pool_pop(&pool);
+            if (wk_cur) {
+                const msg_t *m = &msgs[wk_cur->opcode];
+                if (any_handled && wk_cur->opcode <= last_handled && errors++ < 5) {
+                    printf("  message %u handled after %u\n", wk_cur->opcode, last_handled);
+                }
+                if ((wk_cur->len == 0 || wk_cur->data[0] != (uint8_t)m->kind) && errors++ < 5) {
+                    printf("  message %u: payload corrupted\n", wk_cur->opcode);
+                }
+                last_handled = wk_cur->opcode;
+                any_handled = true;
+                wk_left = kinds[m->kind].handler_us;
+            }
+        }
+        if (wk_cur) {
+            wk_left = wk_left > STEP_US ? wk_left - STEP_US : 0;
+            if (wk_left == 0) {
+                msg_t *m = &msgs[wk_cur->opcode];
+                if (m->handler_done_us && errors++ < 5) {
+                    printf("  message %u handled twice\n", wk_cur->opcode);
+                }
+                m->handler_done_us = now + STEP_US;
+                mesh_msg_pool_put(&pool, wk_cur);
+                wk_cur = NULL;
+            }
+        }
+    }
+
+    // Every buffer back on its free list
+    size_t free_bufs = 0;
+    for (mesh_msg_t *m = pool.free_small; m; m = m->next) {
+        free_bufs++;
+    }
+    for (mesh_msg_t *m = pool.free_large; m; m = m->next) {
+        free_bufs++;
+    }
+    if (free_bufs != MESH_MSG_POOL_SMALL + MESH_MSG_POOL_LARGE && errors++ < 5) {
+        printf("  %zu pooled buffers leaked\n", MESH_MSG_POOL_SMALL + MESH_MSG_POOL_LARGE - free_bufs);
+    }
+
+    static uint32_t stack_lat[MAX_MSGS], handler_lat[MAX_MSGS];
+    size_t ns = 0, nh = 0, handled = 0;
+    for (size_t i = 0; i < n_msgs; i++) {
+        const msg_t *m = &msgs[i];
+        if (m->stack_done_us) {
+            stack_lat[ns++] = m->stack_done_us - m->arrive_us;
+        }
+        if (m->kind != KIND_RELAY && !m->lost && m->handler_done_us) {
+            handler_lat[nh++] = m->handler_done_us - m->arrive_us;
+            if (m->handler_done_us <= RUN_US) {
+                handled++;
+            }
+        }
+    }
+    percentiles(stack_lat, ns, &r.stack_p99, &r.stack_max);
+    percentiles(handler_lat, nh, &r.handler_p99, &r.handler_max);
+    r.handled_per_s = handled / (RUN_US / 1e6);
+    r.max_pending = pool.max_pending;
+    return r;
+}
+
+/*
+ * ============================================================================
+ *                         POOL OVERHEAD
+ * ============================================================================
+ */
+static void run_overhead(void)
+{
+    static const uint16_t lens[] = { 8, 200 };
+    uint8_t payload[MESH_MSG_LARGE];
+    memset(payload, 0x5A, sizeof(payload));
+    printf("\nPool overhead on the host (ns per message: get + copy + push + pop + put)\n");
+    for (size_t k = 0; k < sizeof(lens) / sizeof(lens[0]); k++) {
+        mesh_msg_pool_init(&pool);
+        const int ops = 2000000;
+        volatile uint32_t sink = 0;
+        const uint64_t t0 = bench_now_ns();
+        for (int i = 0; i < ops; i++) {
+            mesh_msg_t *m = mesh_msg_pool_get(&pool, lens[k]);
+            memcpy(m->data, payload, lens[k]);
+            m->opcode = (uint32_t)i;
+            mesh_msg_pool_push(&pool, m);
+            m = mesh_msg_pool_pop(&pool);
+            sink += m->data[0];
+            mesh_msg_pool_put(&pool, m);
+        }
+        (void)sink;
+        printf("  %3u-byte message: %.1f ns\n", lens[k], (double)(bench_now_ns() - t0) / ops);
+    }
+}
+
+int main(void)
+{
+    static const double loads[] = { 10, 50, 100, 300, 450 };
+    printf("Vendor messages: 80%% light (50 µs), 15%% medium (2 ms), 5%% heavy (20 ms)\n");
+    printf("plus %d relayed msgs/s; BTC: %d µs per message, queue of %d; pool: %d + %d buffers\n\n",
+           RELAY_PER_S, STACK_US, BTC_QUEUE, MESH_MSG_POOL_SMALL, MESH_MSG_POOL_LARGE);
+    printf("offered   mode       handled/s  lost BTC  lost pool  stack p99 / max ms  handler p99 / max ms  pending\n");
+    printf("-------   --------   ---------  --------  ---------  ------------------  --------------------  -------\n");
+    for (size_t i = 0; i < sizeof(loads) / sizeof(loads[0]); i++) {
+        build_traffic(loads[i]);
+        for (int d = 0; d < 2; d++) {
+            const result_t r = simulate(d);
+            printf("%5.0f/s   %-8s   %9.1f  %8u  %9u  %8.1f / %6.1f   %9.1f / %7.1f  %7u\n",
+                   loads[i], d ? "deferred" : "inline", r.handled_per_s, r.lost_btc, r.lost_pool,
+                   r.stack_p99 / 1000.0, r.stack_max / 1000.0, r.handler_p99 / 1000.0,
+                   r.handler_max / 1000.0, r.max_pending);
+        }
+    }
+    printf("(stack = arrival → BTC done, for every message incl. relays: how long the\n"
+           " mesh was held up; handler = arrival → our handler done)\n");
+    run_overhead();
+    if (errors) {
+        printf("\n%zu error(s)\n", errors);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,164 @@
+/*
+ * ============================================================================
+ *                    HOST BENCHMARK - VQ CODEBOOKS vs INT8 FRAME
+ * ============================================================================
+ *
+ * Trains codebooks (imu_vq_train.h) on the first half of a trace and
+ * encodes the second half with them - the node never sees its training
+ * data again, so this is the honest number. For joint and split codebooks
+ * at several sizes it reports:
+ * - Bytes per sample (frame header and escapes included)
+ * - RMS and max reconstruction error, accel (mg) and gyro (0.1 dps)
+ * - Escape rate (residual / raw)
+ * - Encode cost per sample (dominated by the nearest-codeword search)
+ *
+ * Reference row: the legacy 8-byte frame (int8 values in 0.1 g / 10 dps
+ * steps + 2-byte timestamp), one frame per sample.
+ *
+ * Build and run: see tools/README.md
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "imu_vq.h"
+#include "imu_trace.h"
+#include "imu_vq_train.h"
+
+#define BLOCK  20
+
+typedef struct {
+    double sq[2];           // Squared error sums: accel, gyro
+    int32_t max[2];
+    size_t values[2];
+} vq_error_t;
+
+static void error_add(vq_error_t *e, const imu_sample_t *ref, const imu_sample_t *got)
+{
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        int g = (a >= IMU_AXIS_GX);
+        int32_t d = abs((int32_t)ref->v[a] - got->v[a]);
+        e->sq[g] += (double)d * d;
+        if (d > e->max[g]) e->max[g] = d;
+        e->values[g]++;
+    }
+}
+
+static void print_row(const char *label, double bytes_per_sample, const vq_error_t *e,
+                      double esc_res, double esc_raw, double ns)
+{
+    printf("%-16s  %6.2f  %8.1f %6d  %8.1f %6d  %5.2f%% %5.2f%%  %7.0f\n", label,
+           bytes_per_sample,
+           sqrt(e->sq[0] / (double)e->values[0]), (int)e->max[0],
+           sqrt(e->sq[1] / (double)e->values[1]), (int)e->max[1],
+           esc_res, esc_raw, ns);
+}
+
+// Legacy frame: accel mg / 100 and gyro (0.1 dps) / 100, truncated to int8
+static int16_t legacy_round_trip(int16_t v)
+{
+    int32_t q = v / 100;
+    if (q > INT8_MAX) q = INT8_MAX;
+    if (q < INT8_MIN) q = INT8_MIN;
+    return (int16_t)(q * 100);
+}
+
+static void run_legacy(const imu_sample_t *test, size_t count)
+{
+    vq_error_t e;
+    memset(&e, 0, sizeof(e));
+    for (size_t i = 0; i < count; i++) {
+        imu_sample_t r;
+        for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+            r.v[a] = legacy_round_trip(test[i].v[a]);
+        }
+        error_add(&e, &test[i], &r);
+    }
+    print_row("int8 frame", 8.0, &e, 0.0, 0.0, 0.0);
+}
+
+static int run(const imu_sample_t *train, size_t n_train, const imu_sample_t *test,
+               size_t n_test, uint8_t groups, uint8_t codes)
+{
+    static imu_vq_codebook_t cb;
+    static uint8_t frame[IMU_VQ_HEADER_LEN + BLOCK * IMU_VQ_MAX_SAMPLE_BYTES];
+    imu_sample_t decoded[BLOCK];
+
+    imu_vq_train_config_t cfg;
+    imu_vq_train_defaults(&cfg);
+    cfg.groups = groups;
+    cfg.codes = codes;
+    if (imu_vq_train(train, n_train, &cfg, &cb) != 0) {
+        printf("training failed\n");
+        return 1;
+    }
+
+    const size_t blocks = n_test / BLOCK;
+    imu_vq_stats_t stats = { 0 };
+    vq_error_t e;
+    memset(&e, 0, sizeof(e));
+    size_t bytes = 0, failures = 0;
+    for (size_t b = 0; b < blocks; b++) {
+        const imu_sample_t *in = &test[b * BLOCK];
+        size_t len = imu_vq_encode(&cb, (uint8_t)b, in, BLOCK, frame, sizeof(frame), &stats);
+        if (len == 0 || imu_vq_decode(&cb, frame, len, decoded, BLOCK, NULL) != BLOCK) {
+            failures++;
+            continue;
+        }
+        bytes += len;
+        for (int i = 0; i < BLOCK; i++) {
+            error_add(&e, &in[i], &decoded[i]);
+        }
+    }
+
+    // Timing pass (encode only)
+    uint64_t t0 = bench_now_ns();
+    for (size_t b = 0; b < blocks; b++) {
+        imu_vq_encode(&cb, (uint8_t)b, &test[b * BLOCK], BLOCK, frame, sizeof(frame), NULL);
+    }
+    uint64_t t1 = bench_now_ns();
+
+    char label[32];
+    snprintf(label, sizeof(label), "%s K=%u", groups == 1 ? "joint" : "split", cb.codes);
+    double total = (double)(stats.coded + stats.residual + stats.raw);
+    print_row(label, (double)bytes / (double)(blocks * BLOCK), &e,
+              100.0 * stats.residual / total, 100.0 * stats.raw / total,
+              (double)(t1 - t0) / (double)(blocks * BLOCK));
+    if (failures) {
+        printf("  %zu blocks failed to round trip\n", failures);
+    }
+    return failures ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    imu_trace_t tr;
+    if (imu_trace_open(argc > 1 ? argv[1] : NULL, &tr, 200 * 120, 200) != 0) {
+        return 1;
+    }
+    size_t half = tr.count / 2;
+    printf("Trace: %zu samples @ %u Hz (%s): train on first %zu, test on last %zu\n",
+           tr.count, (unsigned)tr.rate_hz, argc > 1 ? argv[1] : "synthetic", half,
+           tr.count - half);
+    imu_vq_train_config_t def;
+    imu_vq_train_defaults(&def);
+    printf("Escape threshold %u per value (max), residual step %u, blocks of %u samples\n\n",
+           (unsigned)def.esc_thresh, 1u << def.res_shift, BLOCK);
+
+    printf("codebook          B/samp   acc RMS    max   gyr RMS    max  esc res   raw  ns/samp\n");
+    printf("----------------  ------  --------  -----  --------  -----  -------------  -------\n");
+    run_legacy(&tr.samples[half], tr.count - half);
+
+    static const uint8_t groups[] = { 2, 1 };
+    static const uint8_t codes[] = { 16, 64, 254 };
+    int ret = 0;
+    for (size_t g = 0; g < sizeof(groups); g++) {
+        for (size_t k = 0; k < sizeof(codes); k++) {
+            ret |= run(tr.samples, half, &tr.samples[half], tr.count - half, groups[g], codes[k]);
+        }
+    }
+
+    imu_trace_free(&tr);
+    return ret;
+}
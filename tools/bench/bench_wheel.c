@@ -0,0 +1,270 @@
+/*
+ * ============================================================================
+ *                    HOST BENCHMARK - TIMER WHEEL SCHEDULER
+ * ============================================================================
+ *
+ * The hashed timer wheel (components/ble_mesh_node mesh_timer_wheel.h) that
+ * drives every periodic job on the node from one task:
+ * - check: random timers (one-shot and periodic, random delays, stops and
+ *   restarts from inside callbacks, late wakeups) must fire exactly at
+ *   their tick, once, and a periodic timer that fell behind must resume on
+ *   its own grid - any deviation fails the run
+ * - a node's periodic work for 10 minutes (six sensors, battery, telemetry,
+ *   cadence check): wakeups and RAM with one task per job (vTaskDelay loop)
+ *   against one scheduler task sleeping until the next deadline, with all
+ *   jobs started together (deadlines coalesce) and with random phases
+ * - overhead: ns per start + stop, per fired timer and per next-deadline
+ *   query, for 8 to 512 armed timers
+ *
+ * Build and run: see tools/README.md
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mesh_timer_wheel.h"
+#include "imu_trace.h"              // bench_now_ns
+
+#define CHECK_TIMERS    48
+#define CHECK_TICKS     200000
+#define TASK_STACK      2048        // Smallest sensible FreeRTOS stack for a publish job
+#define TASK_TCB        352         // ESP-IDF TCB, approximate
+#define RUN_MS          (10u * 60u * 1000u)
+
+static uint32_t rng_state = 12345;
+
+static uint32_t rng(void)
+{
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state >> 8;
+}
+
+/*
+ * ============================================================================
+ *                         CORRECTNESS CHECK
+ * ============================================================================
+ */
+typedef struct {
+    mesh_timer_t t;
+    uint32_t expect;                // Tick it must fire at next
+    uint32_t period;
+    bool live;                      // Expected to be armed
+} check_timer_t;
+
+static mesh_wheel_t cw;
+static check_timer_t ct[CHECK_TIMERS];
+static uint32_t check_now;          // The 'now' the current advance was called with
+static size_t check_errors, check_fires;
+
+static void check_fn(void *arg)
+{
+    check_timer_t *c = arg;
+    check_fires++;
+    if ((!c->live || cw.now != c->expect) && check_errors++ < 5) {
+        printf("  timer %d fired at %u, expected %u%s\n", (int)(c - ct), cw.now, c->expect,
+               c->live ? "" : " (stopped)");
+    }
+    if (c->period) {
+        uint32_t d = cw.now + c->period;
+        if ((int32_t)(check_now - d) >= 0) {
+            d += ((check_now - d) / c->period + 1) * c->period;
+        }
+        c->expect = d;
+    } else {
+        c->live = false;
+    }
+
+    // Now and then, stop or restart another timer from inside a callback
+    const uint32_t r = rng();
+    check_timer_t *o = &ct[r % CHECK_TIMERS];
+    if ((r >> 8) % 8 == 0) {
+        mesh_wheel_stop(&cw, &o->t);
+        o->live = false;
+    } else if ((r >> 8) % 8 == 1) {
+        o->period = (r >> 12) % 3 ? 1 + (r >> 14) % 150 : 0;
+        o->expect = cw.now + 1 + (r >> 16) % 300;
+        o->live = true;
+        mesh_wheel_start(&cw, &o->t, o->expect - cw.now, o->period, check_fn, o);
+    }
+}
+
+static size_t run_check(void)
+{
+    mesh_wheel_init(&cw, 1000);
+    for (int i = 0; i < CHECK_TIMERS; i++) {
+        ct[i].period = (i % 3) ? 1 + rng() % 150 : 0;
+        ct[i].expect = cw.now + rng() % 500;
+        ct[i].live = true;
+        mesh_wheel_start(&cw, &ct[i].t, ct[i].expect - cw.now, ct[i].period, check_fn, &ct[i]);
+    }
+
+    uint32_t now = cw.now;
+    while (now - 1000 < CHECK_TICKS) {
+        // Mostly short steps, sometimes a late wakeup several laps long
+        now += (rng() % 16 == 0) ? 1 + rng() % (4 * MESH_WHEEL_SLOTS) : 1 + rng() % 3;
+        check_now = now;
+        mesh_wheel_advance(&cw, now);
+
+        for (int i = 0; i < CHECK_TIMERS; i++) {
+            if (ct[i].live != ct[i].t.armed && check_errors++ < 5) {
+                printf("  timer %d armed %d, expected %d\n", i, ct[i].t.armed, ct[i].live);
+            }
+            if (ct[i].live && (int32_t)(ct[i].expect - now) <= 0 && check_errors++ < 5) {
+                printf("  timer %d missed tick %u (now %u)\n", i, ct[i].expect, now);
+            }
+        }
+        if (rng() % 64 == 0) {                  // Restart one from outside
+            check_timer_t *o = &ct[rng() % CHECK_TIMERS];
+            o->period = 1 + rng() % 100;
+            o->expect = cw.now + rng() % 200;
+            o->live = true;
+            mesh_wheel_start(&cw, &o->t, o->expect - cw.now, o->period, check_fn, o);
+        }
+    }
+    printf("Check: %zu fires over %u ticks, %u periods skipped after late wakeups, %zu error(s)\n",
+           check_fires, CHECK_TICKS, cw.skipped, check_errors);
+    return check_errors;
+}
+
+/*
+ * ============================================================================
+ *                         NODE WORKLOAD
+ * ============================================================================
+ */
+typedef struct {
+    const char *name;
+    uint32_t period_ms;
+    uint8_t count;
+} job_t;
+
+static const job_t jobs[] = {
+    { "sensor publish", 1000, 6 },
+    { "battery publish", 60000, 1 },
+    { "telemetry report", 10000, 1 },
+    { "cadence check", 250, 1 },
+};
+#define JOB_KINDS   (sizeof(jobs) / sizeof(jobs[0]))
+
+static uint32_t job_runs;
+
+static void job_fn(void *arg)
+{
+    (void)arg;
+    job_runs++;
+}
+
+// Scheduler task loop: sleep until the next deadline, run it, repeat
+static uint32_t wheel_wakeups(bool staggered)
+{
+    static mesh_timer_t timers[16];
+    mesh_wheel_t w;
+    mesh_wheel_init(&w, 0);
+    int n = 0;
+    for (size_t k = 0; k < JOB_KINDS; k++) {
+        for (uint8_t i = 0; i < jobs[k].count; i++) {
+            const uint32_t period = mesh_wheel_ticks(jobs[k].period_ms);
+            const uint32_t phase = staggered ? rng() % period : 0;
+            timers[n].armed = false;
+            mesh_wheel_start(&w, &timers[n], period + phase, period, job_fn, NULL);
+            n++;
+        }
+    }
+    job_runs = 0;
+    uint32_t wakeups = 0;
+    const uint32_t end = RUN_MS / MESH_WHEEL_TICK_MS;
+    for (;;) {
+        const uint32_t gap = mesh_wheel_next(&w);
+        if (gap == MESH_WHEEL_NONE || w.now + gap > end) {
+            break;
+        }
+        mesh_wheel_advance(&w, w.now + gap);
+        wakeups++;
+    }
+    return wakeups;
+}
+
+static void run_workload(void)
+{
+    uint32_t tasks = 0, task_wakeups = 0;
+    printf("\nNode periodic work, %u minutes:\n", RUN_MS / 60000);
+    for (size_t k = 0; k < JOB_KINDS; k++) {
+        printf("  %u × %-16s every %6u ms\n", jobs[k].count, jobs[k].name, jobs[k].period_ms);
+        tasks += jobs[k].count;
+        task_wakeups += jobs[k].count * (RUN_MS / jobs[k].period_ms);
+    }
+
+    const uint32_t aligned = wheel_wakeups(false);
+    const uint32_t runs = job_runs;
+    const uint32_t staggered = wheel_wakeups(true);
+
+    printf("\n                           tasks  stack+TCB  wakeups  wakeups/s  jobs run\n");
+    printf("-------------------------  -----  ---------  -------  ---------  --------\n");
+    printf("%-25s  %5u  %7u B  %7u  %9.2f  %8u\n", "task per job (vTaskDelay)", tasks,
+           tasks * (TASK_STACK + TASK_TCB), task_wakeups, task_wakeups / (RUN_MS / 1000.0),
+           task_wakeups);
+    printf("%-25s  %5u  %7u B  %7u  %9.2f  %8u\n", "wheel, started together", 1u,
+           (unsigned)(TASK_STACK + TASK_TCB + sizeof(mesh_wheel_t)), aligned,
+           aligned / (RUN_MS / 1000.0), runs);
+    printf("%-25s  %5u  %7u B  %7u  %9.2f  %8u\n", "wheel, random phases", 1u,
+           (unsigned)(TASK_STACK + TASK_TCB + sizeof(mesh_wheel_t)), staggered,
+           staggered / (RUN_MS / 1000.0), job_runs);
+    printf("(%u B per task = %u B stack + ~%u B TCB; the wheel adds %zu B + %zu B per timer)\n",
+           TASK_STACK + TASK_TCB, TASK_STACK, TASK_TCB, sizeof(mesh_wheel_t), sizeof(mesh_timer_t));
+}
+
+/*
+ * ============================================================================
+ *                         OVERHEAD
+ * ============================================================================
+ */
+static void run_overhead(void)
+{
+    static const uint32_t sizes[] = { 8, 64, 512 };
+    printf("\nOverhead (ns)     start+stop  per fire  next()\n");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        const uint32_t n = sizes[s];
+        mesh_timer_t *t = calloc(n + 1, sizeof(*t));
+        mesh_wheel_t w;
+        mesh_wheel_init(&w, 0);
+        for (uint32_t i = 0; i < n; i++) {
+            mesh_wheel_start(&w, &t[i], 1 + rng() % 1000, 1 + rng() % 1000, job_fn, NULL);
+        }
+
+        const int ops = 200000;
+        uint64_t t0 = bench_now_ns();
+        for (int r = 0; r < ops; r++) {
+            mesh_wheel_start(&w, &t[n], 1 + (uint32_t)r % 997, 0, job_fn, NULL);
+            mesh_wheel_stop(&w, &t[n]);
+        }
+        const double start_stop = (double)(bench_now_ns() - t0) / ops;
+
+        volatile uint32_t sink = 0;
+        t0 = bench_now_ns();
+        for (int r = 0; r < 20000; r++) {
+            sink += mesh_wheel_next(&w);
+        }
+        const double next = (double)(bench_now_ns() - t0) / 20000;
+
+        job_runs = 0;
+        t0 = bench_now_ns();
+        mesh_wheel_advance(&w, w.now + 100000);
+        const double per_fire = (double)(bench_now_ns() - t0) / (job_runs ? job_runs : 1);
+        (void)sink;
+
+        printf("  %3u timers      %10.1f  %8.1f  %6.1f\n", n, start_stop, per_fire, next);
+        free(t);
+    }
+    printf("(per fire includes finding the next deadline - one next() per due tick)\n");
+}
+
+int main(void)
+{
+    size_t errors = run_check();
+    run_workload();
+    run_overhead();
+    if (errors) {
+        printf("\n%zu error(s)\n", errors);
+        return 1;
+    }
+    return 0;
+}
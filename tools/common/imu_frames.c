@@ -0,0 +1,66 @@
+/*
+ * ============================================================================
+ *                    HOST TOOLS - FRAME LOG FORMAT
+ * ============================================================================
+ */
+
+#include "imu_frames.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int hex_nibble(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    c = (char)tolower((unsigned char)c);
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+int imu_frame_line_parse(const char *line, uint32_t *opcode,
+                         uint8_t *payload, size_t cap, size_t *len)
+{
+    const char *p = strstr(line, "F,");
+    if (!p) {
+        return -1;
+    }
+    p += 2;
+
+    char *end;
+    unsigned long op = strtoul(p, &end, 16);
+    if (end == p || *end != ',') {
+        return -1;
+    }
+    p = end + 1;
+
+    size_t n = 0;
+    while (*p) {
+        if (*p == ' ') {
+            p++;
+            continue;
+        }
+        int hi = hex_nibble(p[0]);
+        int lo = (hi >= 0) ? hex_nibble(p[1]) : -1;
+        if (lo < 0) {
+            break;      // End of payload (newline, CR, comment...)
+        }
+        if (n == cap) {
+            return -1;
+        }
+        payload[n++] = (uint8_t)((hi << 4) | lo);
+        p += 2;
+    }
+
+    *opcode = (uint32_t)op;
+    *len = n;
+    return 0;
+}
+
+void imu_frame_line_print(FILE *out, uint32_t opcode, const uint8_t *payload, size_t len)
+{
+    fprintf(out, "F,%06X,", (unsigned)opcode);
+    for (size_t i = 0; i < len; i++) {
+        fprintf(out, "%02X", payload[i]);
+    }
+    fputc('\n', out);
+}
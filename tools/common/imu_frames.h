@@ -0,0 +1,44 @@
+/*
+ * ============================================================================
+ *                    HOST TOOLS - FRAME LOG FORMAT
+ * ============================================================================
+ *
+ * Text format for captured / generated mesh frames, one per line:
+ *
+ *   F,C10001,0A00F12203338414
+ *     ^opcode ^payload (hex, spaces allowed)
+ *
+ * This is exactly what the firmware prints when IMU_FRAMES_TO_CONSOLE is
+ * enabled in main/m5stick_mesh_imu.cpp, so a serial log can be piped
+ * straight into the decoder. Lines without the "F," prefix are ignored.
+ */
+
+#ifndef IMU_FRAMES_H
+#define IMU_FRAMES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_FRAME_LINE_MAX_PAYLOAD  384   // Largest segmented access payload
+
+/**
+ * Parse one log line. Returns 0 on success, -1 if the line is not a frame.
+ */
+int imu_frame_line_parse(const char *line, uint32_t *opcode,
+                         uint8_t *payload, size_t cap, size_t *len);
+
+/**
+ * Print one frame in log format
+ */
+void imu_frame_line_print(FILE *out, uint32_t opcode, const uint8_t *payload, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_FRAMES_H
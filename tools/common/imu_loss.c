@@ -0,0 +1,43 @@
+/*
+ * ============================================================================
+ *                    HOST TOOLS - PACKET LOSS CHANNEL (GILBERT-ELLIOTT)
+ * ============================================================================
+ */
+
+#include "imu_loss.h"
+
+static double rng_uniform(uint32_t *state)
+{
+    // xorshift32 → [0, 1)
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return (double)x / 4294967296.0;
+}
+
+void imu_loss_init(imu_loss_channel_t *ch, double p_gb, double p_bg,
+                   double loss_good, double loss_bad, uint32_t seed)
+{
+    ch->p_gb = p_gb;
+    ch->p_bg = p_bg;
+    ch->loss_good = loss_good;
+    ch->loss_bad = loss_bad;
+    ch->bad = false;
+    ch->rng = seed ? seed : 1;
+}
+
+bool imu_loss_drop(imu_loss_channel_t *ch)
+{
+    double u = rng_uniform(&ch->rng);
+    ch->bad = ch->bad ? (u >= ch->p_bg) : (u < ch->p_gb);
+    return rng_uniform(&ch->rng) < (ch->bad ? ch->loss_bad : ch->loss_good);
+}
+
+double imu_loss_mean(const imu_loss_channel_t *ch)
+{
+    double sum = ch->p_gb + ch->p_bg;
+    double in_bad = (sum > 0.0) ? ch->p_gb / sum : 0.0;
+    return in_bad * ch->loss_bad + (1.0 - in_bad) * ch->loss_good;
+}
@@ -0,0 +1,63 @@
+/*
+ * ============================================================================
+ *                    HOST TOOLS - PACKET LOSS CHANNEL (GILBERT-ELLIOTT)
+ * ============================================================================
+ *
+ * Advertising-bearer loss is bursty: a collision storm or a busy Wi-Fi
+ * channel wipes out several messages in a row, then things are clean
+ * again. An i.i.d. "drop 5%" model hides exactly the case that breaks
+ * parity schemes (two losses in one group).
+ *
+ * TWO-STATE MODEL:
+ * ----------------
+ *           p_gb
+ *   GOOD ─────────▶ BAD         each message: first move, then drop with
+ *   loss_good ◀──── loss_bad    the current state's loss probability
+ *           p_bg
+ *
+ *   Mean burst length (messages in BAD) = 1 / p_bg
+ *   Time in BAD                         = p_gb / (p_gb + p_bg)
+ *
+ * p_gb = 0 gives plain i.i.d. loss at loss_good.
+ */
+
+#ifndef IMU_LOSS_H
+#define IMU_LOSS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    double p_gb;            // GOOD → BAD per message
+    double p_bg;            // BAD → GOOD per message
+    double loss_good;       // Drop probability in GOOD
+    double loss_bad;        // Drop probability in BAD
+    bool bad;               // Current state
+    uint32_t rng;
+} imu_loss_channel_t;
+
+/**
+ * Initialize a channel (starts in GOOD). Same seed => same loss pattern.
+ */
+void imu_loss_init(imu_loss_channel_t *ch, double p_gb, double p_bg,
+                   double loss_good, double loss_bad, uint32_t seed);
+
+/**
+ * Advance by one message. Returns true if the message is lost.
+ */
+bool imu_loss_drop(imu_loss_channel_t *ch);
+
+/**
+ * Long-run average loss rate of the channel parameters
+ */
+double imu_loss_mean(const imu_loss_channel_t *ch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_LOSS_H
@@ -0,0 +1,76 @@
+/*
+ * ============================================================================
+ *                    HOST TOOLS - MPU6886 REGISTER-LEVEL MOCK
+ * ============================================================================
+ */
+
+#include <math.h>
+#include <string.h>
+#include "imu_mpu6886_mock.h"
+
+static int mock_read(void *ctx, uint8_t reg, uint8_t *buf, size_t len)
+{
+    imu_mpu6886_mock_t *m = ctx;
+    if ((size_t)reg + len > sizeof(m->regs)) {
+        return -1;
+    }
+    memcpy(buf, &m->regs[reg], len);
+    m->reads++;
+    return 0;
+}
+
+static int mock_write(void *ctx, uint8_t reg, uint8_t value)
+{
+    imu_mpu6886_mock_t *m = ctx;
+    if (reg >= sizeof(m->regs) || reg == IMU_MPU6886_REG_WHO_AM_I) {
+        return -1;
+    }
+    m->regs[reg] = value;
+    m->writes++;
+    return 0;
+}
+
+void imu_mpu6886_mock_init(imu_mpu6886_mock_t *m, imu_range_t accel, imu_range_t gyro)
+{
+    memset(m, 0, sizeof(*m));
+    m->regs[IMU_MPU6886_REG_WHO_AM_I] = IMU_MPU6886_WHO_AM_I_VALUE;
+    m->regs[IMU_MPU6886_REG_ACCEL_CONFIG] = (uint8_t)((accel & 0x03u) << IMU_MPU6886_FS_SHIFT);
+    m->regs[IMU_MPU6886_REG_GYRO_CONFIG] = (uint8_t)((gyro & 0x03u) << IMU_MPU6886_FS_SHIFT);
+    m->temp_c10 = 250;
+}
+
+imu_reg_bus_t imu_mpu6886_mock_bus(imu_mpu6886_mock_t *m)
+{
+    imu_reg_bus_t bus = { mock_read, mock_write, m };
+    return bus;
+}
+
+static int16_t adc(imu_mpu6886_mock_t *m, int32_t v, int32_t full_scale, int sensor)
+{
+    int64_t p = (int64_t)v * 32768;
+    int64_t c = (p >= 0) ? (p + full_scale / 2) / full_scale : -((-p + full_scale / 2) / full_scale);
+    if (c > INT16_MAX || c < INT16_MIN) {
+        m->clipped[sensor]++;
+        return (c > 0) ? INT16_MAX : INT16_MIN;
+    }
+    return (int16_t)c;
+}
+
+void imu_mpu6886_mock_latch(imu_mpu6886_mock_t *m, const imu_sample_t *truth)
+{
+    imu_range_t ar = (m->regs[IMU_MPU6886_REG_ACCEL_CONFIG] & IMU_MPU6886_FS_MASK) >> IMU_MPU6886_FS_SHIFT;
+    imu_range_t gr = (m->regs[IMU_MPU6886_REG_GYRO_CONFIG] & IMU_MPU6886_FS_MASK) >> IMU_MPU6886_FS_SHIFT;
+    uint8_t *d = &m->regs[IMU_MPU6886_REG_ACCEL_XOUT_H];
+    for (int a = 0; a < 3; a++) {
+        int16_t acc = adc(m, truth->v[IMU_AXIS_AX + a], imu_accel_full_scale(ar), 0);
+        int16_t gyr = adc(m, truth->v[IMU_AXIS_GX + a], imu_gyro_full_scale(gr), 1);
+        d[2 * a] = (uint8_t)((uint16_t)acc >> 8);
+        d[2 * a + 1] = (uint8_t)acc;
+        d[8 + 2 * a] = (uint8_t)((uint16_t)gyr >> 8);
+        d[8 + 2 * a + 1] = (uint8_t)gyr;
+    }
+    // Temperature: counts = (°C - 25) × 326.8
+    int16_t t = (int16_t)lrint((m->temp_c10 - 250) * 32.68);
+    d[6] = (uint8_t)((uint16_t)t >> 8);
+    d[7] = (uint8_t)t;
+}
@@ -0,0 +1,53 @@
+/*
+ * ============================================================================
+ *                    HOST TOOLS - MPU6886 REGISTER-LEVEL MOCK
+ * ============================================================================
+ *
+ * A pretend MPU6886 behind an imu_reg_bus_t, so the real driver
+ * (imu_mpu6886.c) and auto-ranging controller run unchanged on a PC.
+ *
+ * The mock keeps a 128-byte register file. Writing a config register
+ * changes the range; imu_mpu6886_mock_latch() converts a "true" sample
+ * (from a trace, mg / 0.1 dps) into the data registers exactly like the
+ * ADC would at the current range: counts = round(v × 32768 / full scale),
+ * clipped to int16. Clipped values are counted - that is what a too-small
+ * range costs. The temperature registers hold temp_c10 (0.1 °C).
+ */
+
+#ifndef IMU_MPU6886_MOCK_H
+#define IMU_MPU6886_MOCK_H
+
+#include <stdint.h>
+#include "imu_mpu6886.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint8_t regs[128];
+    uint32_t reads, writes;         // Bus transactions
+    uint32_t clipped[2];            // Clipped values: accel, gyro
+    int16_t temp_c10;               // Die temperature latched with each sample
+} imu_mpu6886_mock_t;
+
+/**
+ * Power-on state, with the given initial ranges (M5Unified: accel 2, gyro 3)
+ */
+void imu_mpu6886_mock_init(imu_mpu6886_mock_t *m, imu_range_t accel, imu_range_t gyro);
+
+/**
+ * Bus for imu_mpu6886_init() that talks to this mock
+ */
+imu_reg_bus_t imu_mpu6886_mock_bus(imu_mpu6886_mock_t *m);
+
+/**
+ * Latch a new true sample into the data registers at the current ranges
+ */
+void imu_mpu6886_mock_latch(imu_mpu6886_mock_t *m, const imu_sample_t *truth);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_MPU6886_MOCK_H
@@ -0,0 +1,163 @@
+/*
+ * ============================================================================
+ *                    HOST TOOLS - IMU TRACE LOADER / SYNTHESIZER
+ * ============================================================================
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "imu_trace.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+int imu_trace_load_csv(const char *path, imu_trace_t *trace)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+
+    size_t cap = 4096;
+    trace->samples = malloc(cap * sizeof(imu_sample_t));
+    trace->count = 0;
+    trace->rate_hz = 100;
+    if (!trace->samples) {
+        fclose(f);
+        return -1;
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#') {
+            unsigned rate;
+            if (sscanf(line, "# rate_hz=%u", &rate) == 1 && rate > 0) {
+                trace->rate_hz = rate;
+            }
+            continue;
+        }
+        const char *p = line;
+        if (strncmp(p, "T,", 2) == 0) {
+            p += 2;     // Raw serial log line from the firmware
+        }
+        int v[IMU_AXIS_COUNT];
+        if (sscanf(p, "%d,%d,%d,%d,%d,%d", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5]) != 6) {
+            continue;   // Header or garbage
+        }
+        if (trace->count == cap) {
+            cap *= 2;
+            imu_sample_t *grown = realloc(trace->samples, cap * sizeof(imu_sample_t));
+            if (!grown) {
+                fclose(f);
+                imu_trace_free(trace);
+                return -1;
+            }
+            trace->samples = grown;
+        }
+        for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+            trace->samples[trace->count].v[a] = imu_sat16(v[a]);
+        }
+        trace->count++;
+    }
+    fclose(f);
+
+    if (trace->count == 0) {
+        fprintf(stderr, "%s: no samples\n", path);
+        imu_trace_free(trace);
+        return -1;
+    }
+    return 0;
+}
+
+// Small deterministic PRNG (xorshift32) so traces are reproducible everywhere
+static uint32_t rng_next(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static double rng_gauss(uint32_t *state)
+{
+    // Sum of 4 uniforms, variance-corrected: cheap and good enough for noise
+    double s = 0.0;
+    for (int i = 0; i < 4; i++) {
+        s += (double)(rng_next(state) & 0xFFFF) / 65535.0;
+    }
+    return (s - 2.0) * 1.732;
+}
+
+int imu_trace_synth(imu_trace_t *trace, size_t count, uint32_t rate_hz, uint32_t seed)
+{
+    trace->samples = malloc(count * sizeof(imu_sample_t));
+    if (!trace->samples) {
+        return -1;
+    }
+    trace->count = count;
+    trace->rate_hz = rate_hz;
+
+    uint32_t rng = seed ? seed : 0x1234567u;
+    for (size_t i = 0; i < count; i++) {
+        double t = (double)i / (double)rate_hz;
+
+        // Slow tilt: gravity vector wanders between axes
+        double tilt = 0.6 * sin(2.0 * M_PI * 0.05 * t);
+        double roll = 0.4 * sin(2.0 * M_PI * 0.031 * t + 1.0);
+        double gx = 1000.0 * sin(tilt);
+        double gy = 1000.0 * sin(roll) * cos(tilt);
+        double gz = 1000.0 * cos(roll) * cos(tilt);
+
+        // Gait-like bursts: 1.8 Hz steps, active 60% of the time
+        double active = (fmod(t, 20.0) < 12.0) ? 1.0 : 0.0;
+        double step = active * 350.0 * pow(fabs(sin(M_PI * 1.8 * t)), 6.0);
+
+        // Motor vibration line at 37 Hz (aliases badly at 10 Hz sampling)
+        double vib = 60.0 * sin(2.0 * M_PI * 37.0 * t);
+
+        double a[3] = { gx + 0.3 * step + vib, gy + 0.2 * step, gz + step - 0.5 * vib };
+        double w[3] = {
+            10.0 * 40.0 * cos(2.0 * M_PI * 0.05 * t) * 0.3 + active * 10.0 * 120.0 * sin(2.0 * M_PI * 0.9 * t),
+            10.0 * 25.0 * cos(2.0 * M_PI * 0.031 * t) + 10.0 * 8.0 * sin(2.0 * M_PI * 37.0 * t),
+            active * 10.0 * 60.0 * sin(2.0 * M_PI * 0.45 * t + 0.5),
+        };
+
+        imu_sample_t *s = &trace->samples[i];
+        for (int k = 0; k < 3; k++) {
+            s->v[IMU_AXIS_AX + k] = imu_sat16((int32_t)lrint(a[k] + 4.0 * rng_gauss(&rng)));
+            s->v[IMU_AXIS_GX + k] = imu_sat16((int32_t)lrint(w[k] + 6.0 * rng_gauss(&rng)));
+        }
+    }
+    return 0;
+}
+
+int imu_trace_open(const char *path_or_null, imu_trace_t *trace,
+                   size_t default_count, uint32_t default_rate_hz)
+{
+    if (path_or_null) {
+        return imu_trace_load_csv(path_or_null, trace);
+    }
+    return imu_trace_synth(trace, default_count, default_rate_hz, 1);
+}
+
+void imu_trace_free(imu_trace_t *trace)
+{
+    free(trace->samples);
+    trace->samples = NULL;
+    trace->count = 0;
+}
@@ -0,0 +1,74 @@
+/*
+ * ============================================================================
+ *                    HOST TOOLS - IMU TRACE LOADER / SYNTHESIZER
+ * ============================================================================
+ *
+ * Shared helpers for the host benchmarks and simulators in tools/.
+ *
+ * TRACE FILE FORMAT (CSV):
+ * ------------------------
+ *   # rate_hz=200
+ *   ax_mg,ay_mg,az_mg,gx_ddps,gy_ddps,gz_ddps
+ *   12,-40,1003,15,-2,7
+ *   ...
+ *
+ * Lines starting with '#' are comments, except "# rate_hz=N" which sets the
+ * sample rate. A non-numeric first line is treated as a header. This is
+ * exactly what the firmware prints when IMU_TRACE_TO_CONSOLE is enabled in
+ * main/m5stick_mesh_imu.cpp (filter the "T," prefix from the serial log).
+ *
+ * SYNTHETIC TRACES:
+ * -----------------
+ * Without a capture file every tool falls back to a deterministic synthetic
+ * trace: gravity + slow orientation changes + gait-like bursts + a motor
+ * vibration line + sensor noise. Good for relative comparisons; use real
+ * captures for absolute numbers.
+ */
+
+#ifndef IMU_TRACE_H
+#define IMU_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "imu_sample.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    imu_sample_t *samples;
+    size_t count;
+    uint32_t rate_hz;
+} imu_trace_t;
+
+/**
+ * Load a CSV capture. Returns 0 on success, -1 on error.
+ * Free with imu_trace_free().
+ */
+int imu_trace_load_csv(const char *path, imu_trace_t *trace);
+
+/**
+ * Generate a synthetic trace of 'count' samples at 'rate_hz'.
+ * Same seed => same trace. Returns 0 on success.
+ */
+int imu_trace_synth(imu_trace_t *trace, size_t count, uint32_t rate_hz, uint32_t seed);
+
+/**
+ * Load argv-style: path given => CSV, NULL => synthetic (default_count samples).
+ */
+int imu_trace_open(const char *path_or_null, imu_trace_t *trace,
+                   size_t default_count, uint32_t default_rate_hz);
+
+void imu_trace_free(imu_trace_t *trace);
+
+/**
+ * Monotonic wall clock in nanoseconds (for benchmark timing)
+ */
+uint64_t bench_now_ns(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_TRACE_H
@@ -0,0 +1,210 @@
+/*
+ * ============================================================================
+ *                    HOST TOOLS - VQ CODEBOOK TRAINING
+ * ============================================================================
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "imu_vq_train.h"
+#include "imu_frames.h"
+
+static uint32_t rng_next(uint32_t *state)
+{
+    // xorshift32
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+void imu_vq_train_defaults(imu_vq_train_config_t *cfg)
+{
+    cfg->id = 1;
+    cfg->groups = 2;
+    cfg->codes = 64;
+    cfg->res_shift = 3;
+    cfg->esc_thresh = 99;       // Max error of the int8 frame (step 100)
+    cfg->iterations = 20;
+    cfg->seed = 1;
+}
+
+static uint32_t dist2(const int16_t *a, const int16_t *b, uint8_t dim)
+{
+    uint32_t d = 0;
+    for (uint8_t j = 0; j < dim; j++) {
+        int32_t e = (int32_t)a[j] - b[j];
+        d += (uint32_t)(e * e);
+    }
+    return d;
+}
+
+// k-means++ seeding of one group (codewords at 'cw', vectors x[i*stride + off])
+static void seed_group(const imu_sample_t *s, size_t count, uint8_t off, uint8_t dim,
+                       uint8_t codes, int16_t *cw, uint32_t *d2, uint32_t *rng)
+{
+    size_t first = rng_next(rng) % count;
+    memcpy(cw, &s[first].v[off], dim * sizeof(int16_t));
+    for (size_t i = 0; i < count; i++) {
+        d2[i] = dist2(&s[i].v[off], cw, dim);
+    }
+
+    for (uint8_t k = 1; k < codes; k++) {
+        double total = 0.0;
+        for (size_t i = 0; i < count; i++) {
+            total += d2[i];
+        }
+        size_t pick = rng_next(rng) % count;
+        if (total > 0.0) {
+            double r = (double)rng_next(rng) / 4294967296.0 * total;
+            for (pick = 0; pick + 1 < count && r >= d2[pick]; pick++) {
+                r -= d2[pick];
+            }
+        }
+        int16_t *c = &cw[k * dim];
+        memcpy(c, &s[pick].v[off], dim * sizeof(int16_t));
+        for (size_t i = 0; i < count; i++) {
+            uint32_t d = dist2(&s[i].v[off], c, dim);
+            if (d < d2[i]) {
+                d2[i] = d;
+            }
+        }
+    }
+}
+
+typedef struct {
+    uint32_t uses;
+    int16_t cw[IMU_AXIS_COUNT];
+} ranked_t;
+
+static int by_uses_desc(const void *a, const void *b)
+{
+    const ranked_t *x = a, *y = b;
+    return (x->uses < y->uses) - (x->uses > y->uses);
+}
+
+int imu_vq_train(const imu_sample_t *samples, size_t count,
+                 const imu_vq_train_config_t *cfg, imu_vq_codebook_t *cb)
+{
+    if (count == 0 || cfg->codes == 0 || cfg->codes > IMU_VQ_MAX_CODES) {
+        return -1;
+    }
+    memset(cb, 0, sizeof(*cb));
+    cb->id = cfg->id;
+    cb->groups = cfg->groups;
+    cb->codes = (count < cfg->codes) ? (uint8_t)count : cfg->codes;
+    cb->res_shift = cfg->res_shift;
+    cb->esc_thresh = cfg->esc_thresh;
+    if (!imu_vq_codebook_valid(cb)) {
+        return -1;
+    }
+
+    const uint8_t dim = IMU_AXIS_COUNT / cb->groups;
+    const uint8_t K = cb->codes;
+    uint32_t *d2 = malloc(count * sizeof(uint32_t));
+    uint8_t *assign = malloc(count);
+    int64_t *sum = malloc((size_t)K * dim * sizeof(int64_t));
+    uint32_t *uses = malloc(K * sizeof(uint32_t));
+    ranked_t *rank = malloc(K * sizeof(ranked_t));
+    if (!d2 || !assign || !sum || !uses || !rank) {
+        free(d2); free(assign); free(sum); free(uses); free(rank);
+        return -1;
+    }
+
+    uint32_t rng = cfg->seed ? cfg->seed : 1;
+    for (uint8_t g = 0; g < cb->groups; g++) {
+        const uint8_t off = g * dim;
+        int16_t *cw = &cb->values[(size_t)g * K * dim];
+        seed_group(samples, count, off, dim, K, cw, d2, &rng);
+
+        for (uint8_t it = 0; it <= cfg->iterations; it++) {
+            // Assign (the node's search) and accumulate
+            memset(sum, 0, (size_t)K * dim * sizeof(int64_t));
+            memset(uses, 0, K * sizeof(uint32_t));
+            size_t worst = 0;
+            for (size_t i = 0; i < count; i++) {
+                uint8_t k = imu_vq_nearest(cb, g, &samples[i].v[off],
+                                           i ? assign[i - 1] : 0, &d2[i]);
+                assign[i] = k;
+                uses[k]++;
+                for (uint8_t j = 0; j < dim; j++) {
+                    sum[k * dim + j] += samples[i].v[off + j];
+                }
+                if (d2[i] > d2[worst]) {
+                    worst = i;
+                }
+            }
+            if (it == cfg->iterations) {
+                break;  // Last pass only counts uses for the sort
+            }
+
+            // Update: centroid = mean (rounded); re-seed empty codewords
+            for (uint8_t k = 0; k < K; k++) {
+                int16_t *c = &cw[k * dim];
+                if (uses[k] == 0) {
+                    memcpy(c, &samples[worst].v[off], dim * sizeof(int16_t));
+                    d2[worst] = 0;
+                    for (size_t i = 0; i < count; i++) {
+                        if (d2[i] > d2[worst]) {
+                            worst = i;
+                        }
+                    }
+                    continue;
+                }
+                for (uint8_t j = 0; j < dim; j++) {
+                    int64_t s = sum[k * dim + j], n = uses[k];
+                    c[j] = imu_sat16((int32_t)((s >= 0) ? (s + n / 2) / n : (s - n / 2) / n));
+                }
+            }
+        }
+
+        // Most used first
+        for (uint8_t k = 0; k < K; k++) {
+            rank[k].uses = uses[k];
+            memcpy(rank[k].cw, &cw[k * dim], dim * sizeof(int16_t));
+        }
+        qsort(rank, K, sizeof(ranked_t), by_uses_desc);
+        for (uint8_t k = 0; k < K; k++) {
+            memcpy(&cw[k * dim], rank[k].cw, dim * sizeof(int16_t));
+        }
+    }
+
+    free(d2); free(assign); free(sum); free(uses); free(rank);
+    return 0;
+}
+
+int imu_vq_codebook_write(FILE *out, const imu_vq_codebook_t *cb)
+{
+    uint8_t chunk[IMU_SEG_FRAME_MAX];
+    int n = 0;
+    size_t len;
+    while ((len = imu_vq_install_chunk(cb, (uint8_t)n, chunk, sizeof(chunk))) > 0) {
+        imu_frame_line_print(out, IMU_OP_VQ_INSTALL, chunk, len);
+        n++;
+    }
+    return n;
+}
+
+int imu_vq_codebook_read(FILE *in, imu_vq_codebook_t *cb)
+{
+    static imu_vq_installer_t inst;
+    char line[1024];
+    uint8_t payload[IMU_FRAME_LINE_MAX_PAYLOAD];
+    imu_vq_installer_init(&inst);
+
+    while (fgets(line, sizeof(line), in)) {
+        uint32_t opcode;
+        size_t len;
+        if (imu_frame_line_parse(line, &opcode, payload, sizeof(payload), &len) != 0 ||
+            opcode != IMU_OP_VQ_INSTALL) {
+            continue;
+        }
+        if (imu_vq_install_feed(&inst, payload, len) == IMU_VQ_INSTALL_COMPLETE) {
+            *cb = inst.pending;
+            return 0;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,79 @@
+/*
+ * ============================================================================
+ *                    HOST TOOLS - VQ CODEBOOK TRAINING
+ * ============================================================================
+ *
+ * k-means on captured samples, producing an imu_vq_codebook_t for the node
+ * (see components/imu_stream/include/imu_vq.h). Runs on the gateway or a PC.
+ *
+ * ALGORITHM:
+ * ----------
+ * 1. k-means++ seeding: each new codeword is drawn with probability
+ *    proportional to its squared distance from the codewords so far
+ *    (spreads the initial codewords over the data, deterministic seed)
+ * 2. Lloyd iterations: assign every vector to its nearest codeword
+ *    (imu_vq_nearest - the node's own search), move each codeword to the
+ *    mean of its vectors; an empty codeword is re-seeded on the vector
+ *    with the largest error
+ * 3. Sort codewords by use, most frequent first
+ *
+ * Step 3 matters on the node: the search starts from the previous winner,
+ * and frequent codewords near the front tighten its bound early.
+ *
+ * CODEBOOK FILES:
+ * ---------------
+ * A codebook is stored as its install frames in the frame log format
+ * (tools/common/imu_frames.h): "F,C50001,<chunk>" lines. The same file is
+ * what the gateway sends to the node, and what imu_decode needs to decode
+ * 0xC40001 frames.
+ */
+
+#ifndef IMU_VQ_TRAIN_H
+#define IMU_VQ_TRAIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "imu_vq.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint8_t id;                 // Codebook ID (1..255)
+    uint8_t groups;             // 1 = joint 6-D, 2 = accel + gyro
+    uint8_t codes;              // K per group (reduced if there are fewer samples)
+    uint8_t res_shift;          // Residual escape step 2^res_shift
+    uint16_t esc_thresh;        // Escape above this error on any one value
+    uint8_t iterations;         // Lloyd iterations
+    uint32_t seed;              // k-means++ seed
+} imu_vq_train_config_t;
+
+/**
+ * Default configuration: split groups, K = 64, threshold 100, 20 iterations
+ */
+void imu_vq_train_defaults(imu_vq_train_config_t *cfg);
+
+/**
+ * Train a codebook. Returns 0 on success, -1 on bad parameters or no memory.
+ */
+int imu_vq_train(const imu_sample_t *samples, size_t count,
+                 const imu_vq_train_config_t *cfg, imu_vq_codebook_t *cb);
+
+/**
+ * Write a codebook as install frame lines. Returns the number of chunks.
+ */
+int imu_vq_codebook_write(FILE *out, const imu_vq_codebook_t *cb);
+
+/**
+ * Read a codebook from install frame lines (other lines are ignored).
+ * Returns 0 once a complete codebook was read, -1 otherwise.
+ */
+int imu_vq_codebook_read(FILE *in, imu_vq_codebook_t *cb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_VQ_TRAIN_H
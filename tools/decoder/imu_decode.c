@@ -0,0 +1,535 @@
+/*
+ * ============================================================================
+ *                    HOST DECODER - IMU MESH FRAMES
+ * ============================================================================
+ *
+ * Decodes frame logs (see tools/common/imu_frames.h) and renders them:
+ * - Legacy 0xC00001 frames as numbers
+ * - Cluster-head batches 0xCF0001 (imu_batch.h) as one legacy line per
+ *   entry, prefixed with the member's address
+ * - Rice 0xC20001 blocks as "T,ax,ay,az,gx,gy,gz" lines (a trace the other
+ *   tools can load - lossless, so identical to the node's own samples)
+ * - Codec-tagged 0xC30001 windows (imu_codec.h) the same way: sample
+ *   windows as "T," lines, summary windows as envelope strips
+ * - VQ 0xC40001 blocks (imu_vq.h) as "T," lines, using the codebook from
+ *   the 0xC50001 install frames seen earlier in the log (prepend the
+ *   vq_train output if the log doesn't contain them)
+ * - Range-tagged 0xC60001 frames (imu_autorange.h) as numbers in mg and
+ *   0.1 dps, with the full scale they were sent at
+ * - Channel-masked 0xCC0001 frames (imu_masked.h) as one line per window,
+ *   '-' for the channels the node does not send
+ * - Magnitude 0xCD0001 frames (imu_magnitude.h) as one |a| / |ω| peak line
+ *   per window
+ * - Packed 0xCE0001 frames (imu_packed.h) as one line per sample, numbered
+ *   in decode order ('K' marks key frames); predicted frames
+ *   after a lost one are counted until the next key frame
+ * - Calibration installs 0xC70001 (imu_calib.h) and stream configs
+ *   0xCB0001 (imu_config.h) as a summary on stderr
+ * - Neighbour reports 0xD00001 and relay sets 0xD10001 (imu_topology.h)
+ *   as one line each on stderr
+ * - Capture upload chunks 0xCA0001 (imu_capture.h) as "T," lines, with
+ *   one line per chunk on stderr
+ * - Parity 0xE00001..0xFF0001 frames (imu_fec.h): a lost legacy, ranged or
+ *   envelope frame is rebuilt and rendered as if it had just arrived
+ * - Envelope 0xC10001 frames as one ASCII strip per axis per window:
+ *
+ *     seq  AX                  AY                  AZ          ...
+ *      3   ......|--o---.....  ......o-|.........  ........|..--o--
+ *                ^min ^mean ^max   '|' = zero
+ *
+ * Modes:
+ *   imu_decode [log|-]            Decode a frame log (default: stdin)
+ *   imu_decode --encode [trace]   Encode a trace as envelope frames (log format)
+ *   imu_decode --check [trace]    Round trip: containment + peak comparison
+ *
+ * Build and run: see tools/README.md
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "imu_proto.h"
+#include "imu_envelope.h"
+#include "imu_rice.h"
+#include "imu_codec.h"
+#include "imu_vq.h"
+#include "imu_fec.h"
+#include "imu_autorange.h"
+#include "imu_calib.h"
+#include "imu_capture.h"
+#include "imu_config.h"
+#include "imu_masked.h"
+#include "imu_magnitude.h"
+#include "imu_packed.h"
+#include "imu_batch.h"
+#include "imu_topology.h"
+#include "imu_decimator.h"
+#include "imu_trace.h"
+#include "imu_frames.h"
+
+#define WINDOW        20        // 200 Hz -> 10 Hz, same as the firmware default
+#define STRIP_WIDTH   19
+#define STRIP_SCALE   2000      // Full scale: +-2 g (mg) and +-200 dps (0.1 dps)
+
+static const char *axis_names[IMU_AXIS_COUNT] = { "AX", "AY", "AZ", "GX", "GY", "GZ" };
+
+static int strip_col(int32_t v, int32_t scale)
+{
+    if (v < -scale) v = -scale;
+    if (v > scale) v = scale;
+    return (int)((v + scale) * (STRIP_WIDTH - 1) / (2 * scale));
+}
+
+static void render_strip(char *out, int16_t lo, int16_t mean, int16_t hi, int32_t scale)
+{
+    memset(out, '.', STRIP_WIDTH);
+    out[STRIP_WIDTH] = '\0';
+    out[strip_col(0, scale)] = '|';
+    for (int c = strip_col(lo, scale); c <= strip_col(hi, scale); c++) {
+        out[c] = '-';
+    }
+    out[strip_col(mean, scale)] = 'o';
+}
+
+static void render_header(void)
+{
+    printf("seq ");
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        printf(" %-*s", STRIP_WIDTH, axis_names[a]);
+    }
+    printf("\n");
+}
+
+static void render_window(const imu_envelope_window_t *w, uint8_t have_mask)
+{
+    char strip[STRIP_WIDTH + 1];
+    printf("%3u ", w->seq);
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        uint8_t group = (a < IMU_AXIS_GX) ? IMU_ENV_GROUP_ACCEL : IMU_ENV_GROUP_GYRO;
+        if (!(have_mask & (1u << group))) {
+            printf(" %-*s", STRIP_WIDTH, "(lost)");
+            continue;
+        }
+        render_strip(strip, w->min.v[a], w->mean.v[a], w->max.v[a], STRIP_SCALE);
+        printf(" %s", strip);
+    }
+    printf("\n");
+}
+
+/*
+ * ============================================================================
+ *                         DECODE A LOG
+ * ============================================================================
+ */
+static int decode_log(FILE *in)
+{
+    char line[1024];
+    uint8_t payload[IMU_FRAME_LINE_MAX_PAYLOAD];
+    imu_envelope_window_t cur;
+    int cur_seq = -1;
+    uint8_t have_mask = 0;
+    unsigned frames = 0, unknown = 0, rice_lost = 0, vq_no_codebook = 0;
+    unsigned codec_wins[IMU_CODEC_MAX] = { 0 };
+    int rice_seq = -1;
+    bool header_done = false;
+    static imu_vq_installer_t vq_install;
+    static imu_vq_codebook_t vq_codebook;    // id 0 = none yet
+    imu_fec_decoder_t fec;
+    unsigned parity_frames = 0;
+    imu_pack_decoder_t pack;
+    unsigned pack_samples = 0;
+    imu_pack_decoder_init(&pack);
+    imu_vq_installer_init(&vq_install);
+    imu_fec_decoder_init(&fec);
+
+    while (fgets(line, sizeof(line), in)) {
+        uint32_t opcode;
+        size_t len;
+        if (imu_frame_line_parse(line, &opcode, payload, sizeof(payload), &len) != 0) {
+            continue;
+        }
+        frames++;
+
+        if (imu_fec_parity_opcode(opcode, NULL, NULL)) {
+            uint32_t rec_op;
+            uint8_t rec[IMU_FRAME_MAX];
+            size_t rec_len = imu_fec_decode(&fec, opcode, payload, len, &rec_op, rec);
+            parity_frames++;
+            if (rec_len == 0) {
+                continue;
+            }
+            // Rebuilt a lost frame: decode it below as if it arrived now
+            opcode = rec_op;
+            memcpy(payload, rec, rec_len);
+            len = rec_len;
+        } else {
+            imu_fec_decode(&fec, opcode, payload, len, NULL, NULL);
+        }
+
+        if (opcode == IMU_OP_DATA && len == 8) {
+            printf("t=%5u  A:[%4d,%4d,%4d]x0.1g  G:[%4d,%4d,%4d]x10dps\n",
+                   (unsigned)(payload[0] | (payload[1] << 8)),
+                   (int8_t)payload[2], (int8_t)payload[3], (int8_t)payload[4],
+                   (int8_t)payload[5], (int8_t)payload[6], (int8_t)payload[7]);
+        } else if (opcode == IMU_OP_BATCH) {
+            imu_batch_entry_t e[IMU_BATCH_MAX_ENTRIES];
+            uint8_t n = imu_batch_unpack(payload, len, e, IMU_BATCH_MAX_ENTRIES);
+            if (n == 0) {
+                unknown++;
+                continue;
+            }
+            for (uint8_t i = 0; i < n; i++) {
+                const uint8_t *f = e[i].frame;
+                printf("0x%04X t=%5u  A:[%4d,%4d,%4d]x0.1g  G:[%4d,%4d,%4d]x10dps\n",
+                       e[i].src, (unsigned)(f[0] | (f[1] << 8)), (int8_t)f[2], (int8_t)f[3],
+                       (int8_t)f[4], (int8_t)f[5], (int8_t)f[6], (int8_t)f[7]);
+            }
+        } else if (opcode == IMU_OP_RANGED) {
+            imu_sample_t s;
+            uint16_t t;
+            imu_range_t ar, gr;
+            if (!imu_ranged_unpack(payload, len, &s, &t, &ar, &gr)) {
+                unknown++;
+                continue;
+            }
+            printf("t=%4u  A:[%6d,%6d,%6d]mg  G:[%6d,%6d,%6d]x0.1dps  (%dg/%ddps)\n",
+                   (unsigned)t, s.v[0], s.v[1], s.v[2], s.v[3], s.v[4], s.v[5],
+                   (int)(imu_accel_full_scale(ar) / 1000), (int)(imu_gyro_full_scale(gr) / 10));
+        } else if (opcode == IMU_OP_MASKED) {
+            imu_sample_t block[IMU_MASKED_MAX_SAMPLES];
+            uint8_t mask;
+            uint16_t t;
+            uint8_t n = imu_masked_unpack(payload, len, &mask, &t, block);
+            if (n == 0) {
+                unknown++;
+                continue;
+            }
+            for (uint8_t i = 0; i < n; i++) {
+                printf("t=%4u  [%u/%u] ", (unsigned)t, i + 1, n);
+                for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+                    if (mask & (1u << a)) {
+                        printf(" %s:%6d", axis_names[a], block[i].v[a]);
+                    } else {
+                        printf(" %s:     -", axis_names[a]);
+                    }
+                }
+                printf("\n");
+            }
+        } else if (opcode == IMU_OP_MAGNITUDE) {
+            imu_mag_t w[IMU_MAG_WINDOWS];
+            uint16_t t;
+            uint8_t n = imu_mag_unpack(payload, len, &t, w);
+            if (n == 0) {
+                unknown++;
+                continue;
+            }
+            for (uint8_t i = 0; i < n; i++) {
+                printf("t=%4u  [%u/%u]  |A|:%6u mg  |G|:%6u x0.1dps\n",
+                       (unsigned)t, i + 1, n, w[i].accel, w[i].gyro);
+            }
+        } else if (opcode == IMU_OP_PACKED) {
+            imu_sample_t block[IMU_PACK_MAX_SAMPLES];
+            const uint32_t lost_before = pack.unreferenced;
+            bool key;
+            uint8_t n = imu_pack_decode(&pack, payload, len, block, &key);
+            if (n == 0) {
+                if (pack.unreferenced == lost_before) {
+                    unknown++;
+                }
+                continue;
+            }
+            for (uint8_t i = 0; i < n; i++, pack_samples++) {
+                printf("s=%5u [%u/%u]%s A:[%6d,%6d,%6d]mg  G:[%6d,%6d,%6d]x0.1dps\n",
+                       pack_samples, i + 1, n, key ? "K" : " ", block[i].v[0], block[i].v[1],
+                       block[i].v[2], block[i].v[3], block[i].v[4], block[i].v[5]);
+            }
+        } else if (opcode == IMU_OP_CALIB) {
+            imu_calib_t c;
+            if (!imu_calib_unpack(payload, len, &c)) {
+                unknown++;
+                continue;
+            }
+            fprintf(stderr, "Calibration %u: accel diag %.4f %.4f %.4f, gyro diag %.4f %.4f %.4f, "
+                    "offset [%d,%d,%d,%d,%d,%d], %u temperature point(s)\n", c.id,
+                    c.matrix[0][0] / (double)IMU_CALIB_ONE, c.matrix[0][4] / (double)IMU_CALIB_ONE,
+                    c.matrix[0][8] / (double)IMU_CALIB_ONE, c.matrix[1][0] / (double)IMU_CALIB_ONE,
+                    c.matrix[1][4] / (double)IMU_CALIB_ONE, c.matrix[1][8] / (double)IMU_CALIB_ONE,
+                    c.offset[0], c.offset[1], c.offset[2], c.offset[3], c.offset[4], c.offset[5],
+                    c.temp_points);
+        } else if (opcode == IMU_OP_CONFIG) {
+            imu_config_t c;
+            if (!imu_config_unpack(payload, len, &c) || c.period_ms == 0) {
+                unknown++;
+                continue;
+            }
+            fprintf(stderr, "Stream config %u: %u Hz, %u ms windows, mode %u, %s, block %u, "
+                    "axes 0x%02X, codec %u\n", c.id, 1000u / c.period_ms, c.publish_ms, c.mode,
+                    c.decim ? "CIC" : "FIR", c.block, c.axis_mask, c.codec);
+        } else if (opcode == IMU_OP_TOPO_REPORT) {
+            imu_topo_report_t r;
+            if (!imu_topo_report_unpack(payload, len, &r)) {
+                unknown++;
+                continue;
+            }
+            fprintf(stderr, "Neighbour report (TTL %u%s):", r.ttl, r.relaying ? ", relaying" : "");
+            for (uint8_t i = 0; i < r.count; i++) {
+                fprintf(stderr, " 0x%04X %d dBm", r.link[i].addr, r.link[i].rssi);
+            }
+            fprintf(stderr, "\n");
+        } else if (opcode == IMU_OP_RELAY_SET) {
+            imu_topo_plan_t p;
+            uint8_t id;
+            if (!imu_topo_relay_set_unpack(payload, len, &id, &p)) {
+                unknown++;
+                continue;
+            }
+            fprintf(stderr, "Relay set %u:", id);
+            for (uint8_t i = 0; i < p.count; i++) {
+                fprintf(stderr, " 0x%04X", p.relay[i]);
+            }
+            fprintf(stderr, "%s\n", p.count ? "" : " none");
+        } else if (opcode == IMU_OP_CAPTURE_DATA) {
+            imu_capture_chunk_t c;
+            imu_sample_t block[IMU_CAPTURE_CHUNK_SAMPLES];
+            if (!imu_capture_chunk_unpack(payload, len, &c, block)) {
+                unknown++;
+                continue;
+            }
+            fprintf(stderr, "Capture %u: chunk %u/%u, %u samples, first at T+%u us\n",
+                    c.id, c.chunk + 1, c.chunks, c.samples, c.first_offset_us);
+            for (size_t i = 0; i < c.samples; i++) {
+                printf("T,%d,%d,%d,%d,%d,%d\n", block[i].v[0], block[i].v[1], block[i].v[2],
+                       block[i].v[3], block[i].v[4], block[i].v[5]);
+            }
+        } else if (opcode == IMU_OP_RICE) {
+            imu_sample_t block[IMU_RICE_MAX_BLOCK];
+            uint8_t seq;
+            size_t n = imu_rice_decode(payload, len, block, IMU_RICE_MAX_BLOCK, &seq);
+            if (n == 0) {
+                unknown++;
+                continue;
+            }
+            if (rice_seq >= 0) {
+                rice_lost += (uint8_t)(seq - rice_seq - 1);
+            }
+            rice_seq = seq;
+            for (size_t i = 0; i < n; i++) {
+                printf("T,%d,%d,%d,%d,%d,%d\n", block[i].v[0], block[i].v[1], block[i].v[2],
+                       block[i].v[3], block[i].v[4], block[i].v[5]);
+            }
+        } else if (opcode == IMU_OP_CODEC) {
+            imu_sample_t block[IMU_CODEC_MAX_BLOCK];
+            uint8_t id, seq;
+            size_t n = imu_codec_frame_decode(payload, len, block, IMU_CODEC_MAX_BLOCK, &id, &seq);
+            if (n == 0) {
+                unknown++;
+                continue;
+            }
+            codec_wins[id]++;
+            if (imu_codec_find(id)->summary) {
+                imu_envelope_window_t w = { .min = block[0], .mean = block[1], .max = block[2],
+                                            .count = 0, .seq = seq };
+                if (!header_done) {
+                    render_header();
+                    header_done = true;
+                }
+                render_window(&w, 3);
+                continue;
+            }
+            for (size_t i = 0; i < n; i++) {
+                printf("T,%d,%d,%d,%d,%d,%d\n", block[i].v[0], block[i].v[1], block[i].v[2],
+                       block[i].v[3], block[i].v[4], block[i].v[5]);
+            }
+        } else if (opcode == IMU_OP_VQ_INSTALL) {
+            imu_vq_install_status_t st = imu_vq_install_feed(&vq_install, payload, len);
+            if (st == IMU_VQ_INSTALL_INVALID) {
+                unknown++;
+            } else if (st == IMU_VQ_INSTALL_COMPLETE) {
+                vq_codebook = vq_install.pending;
+                fprintf(stderr, "VQ codebook %u installed (K=%u x %u group(s))\n",
+                        vq_codebook.id, vq_codebook.codes, vq_codebook.groups);
+            }
+        } else if (opcode == IMU_OP_VQ) {
+            imu_sample_t block[IMU_VQ_MAX_BLOCK];
+            size_t n = imu_vq_decode(&vq_codebook, payload, len, block, IMU_VQ_MAX_BLOCK, NULL);
+            if (n == 0) {
+                vq_no_codebook++;
+                continue;
+            }
+            for (size_t i = 0; i < n; i++) {
+                printf("T,%d,%d,%d,%d,%d,%d\n", block[i].v[0], block[i].v[1], block[i].v[2],
+                       block[i].v[3], block[i].v[4], block[i].v[5]);
+            }
+        } else if (opcode == IMU_OP_ENVELOPE) {
+            imu_envelope_window_t w;
+            uint8_t group;
+            if (!imu_envelope_unpack(payload, len, &w, &group)) {
+                unknown++;
+                continue;
+            }
+            if (!header_done) {
+                render_header();
+                header_done = true;
+            }
+            // A new sequence number closes the previous (possibly half) window
+            if (cur_seq >= 0 && w.seq != cur_seq) {
+                render_window(&cur, have_mask);
+                have_mask = 0;
+            }
+            if (have_mask == 0) {
+                memset(&cur, 0, sizeof(cur));
+            }
+            imu_envelope_unpack(payload, len, &cur, NULL);
+            cur_seq = w.seq;
+            have_mask |= (uint8_t)(1u << group);
+            if (have_mask == 3) {
+                render_window(&cur, have_mask);
+                have_mask = 0;
+                cur_seq = -1;
+            }
+        } else {
+            unknown++;
+        }
+    }
+    if (have_mask) {
+        render_window(&cur, have_mask);
+    }
+    fprintf(stderr, "%u frames, %u unknown/malformed, %u Rice blocks lost\n",
+            frames, unknown, rice_lost);
+    for (uint8_t id = 0; id < IMU_CODEC_MAX; id++) {
+        const imu_codec_t *c = imu_codec_find(id);
+        if (c && codec_wins[id]) {
+            fprintf(stderr, "  codec %-8s %u windows\n", c->name, codec_wins[id]);
+        }
+    }
+    if (vq_no_codebook) {
+        fprintf(stderr, "  %u VQ blocks without a matching codebook (or malformed)\n",
+                vq_no_codebook);
+    }
+    if (pack.unreferenced) {
+        fprintf(stderr, "  %u packed frames after a lost one (waited for a key frame)\n",
+                (unsigned)pack.unreferenced);
+    }
+    if (parity_frames) {
+        fprintf(stderr, "  FEC: %u parity frames, %u groups intact, %u frames recovered, "
+                "%u groups unrecoverable\n", parity_frames, (unsigned)fec.groups_ok,
+                (unsigned)fec.recovered, (unsigned)fec.unrecoverable);
+    }
+    return 0;
+}
+
+/*
+ * ============================================================================
+ *                         ENCODE A TRACE
+ * ============================================================================
+ */
+static int encode_trace(const imu_trace_t *tr)
+{
+    imu_envelope_t env;
+    imu_envelope_window_t w;
+    uint8_t frame[IMU_ENV_FRAME_LEN];
+
+    imu_envelope_init(&env, WINDOW);
+    for (size_t i = 0; i < tr->count; i++) {
+        if (imu_envelope_push(&env, &tr->samples[i], &w)) {
+            for (uint8_t g = 0; g < 2; g++) {
+                imu_envelope_pack(&w, g, frame);
+                imu_frame_line_print(stdout, IMU_OP_ENVELOPE, frame, sizeof(frame));
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ * ============================================================================
+ *                         ROUND-TRIP CHECK
+ * ============================================================================
+ *
+ * For every window: pack -> unpack, then verify the decoded envelope
+ * contains the true min/max. Also compares the largest value each stream
+ * shows a receiver: decimated (filtered mean) vs decoded envelope.
+ */
+static int check_trace(const imu_trace_t *tr)
+{
+    static imu_decimator_t dec;
+    imu_envelope_t env;
+    imu_envelope_window_t w, d;
+    uint8_t frame[IMU_ENV_FRAME_LEN];
+    imu_sample_t filtered;
+
+    imu_decimator_configure(&dec, IMU_DECIM_FIR, WINDOW);
+    imu_envelope_init(&env, WINDOW);
+
+    int16_t true_peak[IMU_AXIS_COUNT] = { 0 }, decim_peak[IMU_AXIS_COUNT] = { 0 };
+    int16_t env_peak[IMU_AXIS_COUNT] = { 0 };
+    double slack[IMU_AXIS_COUNT] = { 0 };
+    size_t windows = 0, violations = 0;
+
+    for (size_t i = 0; i < tr->count; i++) {
+        const imu_sample_t *s = &tr->samples[i];
+        for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+            if (abs(s->v[a]) > true_peak[a]) true_peak[a] = (int16_t)abs(s->v[a]);
+        }
+        if (imu_decimator_push(&dec, s, &filtered)) {
+            for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+                if (abs(filtered.v[a]) > decim_peak[a]) decim_peak[a] = (int16_t)abs(filtered.v[a]);
+            }
+        }
+        if (!imu_envelope_push(&env, s, &w)) {
+            continue;
+        }
+        for (uint8_t g = 0; g < 2; g++) {
+            imu_envelope_pack(&w, g, frame);
+            imu_envelope_unpack(frame, sizeof(frame), &d, NULL);
+        }
+        windows++;
+        for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+            if (d.min.v[a] > w.min.v[a] || d.max.v[a] < w.max.v[a]) {
+                violations++;
+            }
+            slack[a] += (double)(d.max.v[a] - d.min.v[a]) - (double)(w.max.v[a] - w.min.v[a]);
+            int16_t p = (int16_t)(abs(d.min.v[a]) > abs(d.max.v[a]) ? abs(d.min.v[a]) : abs(d.max.v[a]));
+            if (p > env_peak[a]) env_peak[a] = p;
+        }
+    }
+
+    printf("Windows: %zu x %u samples, containment violations: %zu\n\n",
+           windows, WINDOW, violations);
+    printf("axis  true |peak|  decimated |peak|  envelope |peak|  mean slack\n");
+    printf("----  -----------  ----------------  ---------------  ----------\n");
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        printf("%-4s  %11d  %16d  %15d  %10.1f\n", axis_names[a], true_peak[a],
+               decim_peak[a], env_peak[a], windows ? slack[a] / (double)windows : 0.0);
+    }
+    printf("\nUnits: mg (accel), 0.1 dps (gyro). Slack = decoded width - true width.\n");
+    return violations ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && (strcmp(argv[1], "--encode") == 0 || strcmp(argv[1], "--check") == 0)) {
+        imu_trace_t tr;
+        if (imu_trace_open(argc > 2 ? argv[2] : NULL, &tr, 200 * 60, 200) != 0) {
+            return 1;
+        }
+        int ret = (argv[1][2] == 'e') ? encode_trace(&tr) : check_trace(&tr);
+        imu_trace_free(&tr);
+        return ret;
+    }
+
+    FILE *in = stdin;
+    if (argc > 1 && strcmp(argv[1], "-") != 0) {
+        in = fopen(argv[1], "r");
+        if (!in) {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+    int ret = decode_log(in);
+    if (in != stdin) {
+        fclose(in);
+    }
+    return ret;
+}
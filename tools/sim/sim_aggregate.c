@@ -0,0 +1,583 @@
+/*
+ * ============================================================================
+ *                    HOST SIMULATOR - CLUSTER-HEAD AGGREGATION
+ * ============================================================================
+ *
+ * A cluster of sticks streams legacy frames to a gateway a chain of relays
+ * away. Two ways to get the frames there:
+ *
+ *   direct      every stick publishes its frames with TTL 7, every relay
+ *               on the chain forwards every frame
+ *   aggregated  members publish with TTL 0, so no relay forwards them. The
+ *               head (stick 0, a vendor client on the data group) collects
+ *               them and sends one segmented batch (imu_batch.h, the
+ *               component's code) to the gateway per window, acked by SAR.
+ *               The head's own stream stays direct, as in the firmware.
+ *
+ * Radio model (as sim_capture where the two overlap):
+ * - one transmission = AIR_US on the 3 advertising channels
+ * - every PDU goes out NET_XMIT times, XMIT_GAP_US + U(0, 10 ms) apart
+ *   (net and relay transmit (2, 20) in ble_mesh_node.c), the first copy
+ *   after U(0, 10 ms) too (the advertiser's advDelay). A node's bearer
+ *   sends one PDU at a time from a queue of ADV_BUFS, and drops beyond
+ * - the cluster hears itself and the first relay, each relay its two
+ *   neighbours, the gateway the last relay (no relays: the cluster)
+ * - a reception fails when the receiver transmits or hears a second
+ *   transmission at the same time, and with BASE_LOSS on top
+ * - relays forward each new message once with TTL - 1 (message cache).
+ *   Sticks don't relay (relay disabled, as the node is configured)
+ * - SAR: the gateway acks a complete batch at once, an incomplete one
+ *   ACK_DELAY_US after its last segment. The head resends the missing
+ *   segments on an ack or after SAR_TIMEOUT_US, SAR_ROUNDS rounds at
+ *   most; acks travel back over the relays
+ *
+ * Reported per 60 s run: frames delivered, transmissions (every copy on
+ * every node) and air time per delivered frame, and the frame latency
+ * (generated → at the gateway).
+ *
+ * Checks - any failure fails the run: imu_batch round trips (escaped
+ * addresses, full batches, truncation), and every entry of every batch
+ * the gateway completes unpacks to the exact frame its member sent.
+ *
+ * Usage:
+ *   sim_aggregate
+ *
+ * Build and run: see tools/README.md
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "imu_batch.h"
+
+#define TICK_US         50
+#define RUN_US          60000000LL
+#define GEN_US          (RUN_US - 2000000LL)    // Last frame: 2 s before the end
+#define AIR_US          1100
+#define NET_XMIT        3
+#define XMIT_GAP_US     20000
+#define XMIT_JITTER_US  10000
+#define ADV_BUFS        60
+#define BASE_LOSS       0.02
+#define SEG_DATA        12          // Upper transport bytes per segment
+#define ACK_DELAY_US    150000
+#define SAR_TIMEOUT_US  550000      // 200 ms + 50 ms × TTL 7
+#define SAR_ROUNDS      4
+#define TTL             7
+#define FIRST_ADDR      2           // Stick unicast addresses (1 = gateway)
+#define MAX_NODES       32
+#define MAX_FRAMES      16384
+#define MAX_MSGS        65536
+#define MAX_BATCHES     4096
+
+static uint32_t rng = 0x2468ACEu;
+
+static double uniform(void)
+{
+    // xorshift32 → [0, 1)
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return (double)rng / 4294967296.0;
+}
+
+/*
+ * ============================================================================
+ *                         1. BATCH ROUND TRIP
+ * ============================================================================
+ */
+
+static void make_frame(uint32_t id, uint16_t src, uint8_t f[IMU_BATCH_FRAME_LEN])
+{
+    const uint32_t h = id * 2654435761u ^ (uint32_t)src * 40503u;
+    f[0] = (uint8_t)id;
+    f[1] = (uint8_t)(id >> 8);
+    f[2] = (uint8_t)(id >> 16);
+    f[3] = (uint8_t)(id >> 24);
+    f[4] = (uint8_t)h;
+    f[5] = (uint8_t)(h >> 8);
+    f[6] = (uint8_t)(h >> 16);
+    f[7] = (uint8_t)(h >> 24);
+}
+
+// The frame's id if it is exactly what make_frame() gave src, else -1
+static int64_t frame_id(uint16_t src, const uint8_t f[IMU_BATCH_FRAME_LEN])
+{
+    const uint32_t id = f[0] | (f[1] << 8) | ((uint32_t)f[2] << 16) | ((uint32_t)f[3] << 24);
+    uint8_t want[IMU_BATCH_FRAME_LEN];
+    make_frame(id, src, want);
+    return memcmp(want, f, IMU_BATCH_FRAME_LEN) ? -1 : (int64_t)id;
+}
+
+static int check_round_trip(void)
+{
+    static imu_batch_t b;
+    static imu_batch_entry_t out[IMU_BATCH_MAX_ENTRIES];
+    uint8_t buf[IMU_SEG_FRAME_MAX];
+    int failures = 0;
+
+    for (int trial = 0; trial < 2000; trial++) {
+        imu_batch_init(&b);
+        const int n = 1 + (int)(uniform() * (IMU_BATCH_MAX_ENTRIES + 4));  // Overfill too
+        for (int i = 0; i < n; i++) {
+            // Mostly close addresses, some far apart (escapes), repeats
+            const double u = uniform();
+            const uint16_t src = (u < 0.15) ? (uint16_t)(1 + uniform() * 0x7FFE)
+                                            : (uint16_t)(FIRST_ADDR + uniform() * 12);
+            uint8_t f[IMU_BATCH_FRAME_LEN];
+            make_frame((uint32_t)(trial * 64 + i), src, f);
+            if (imu_batch_add(&b, src, f) != (i < IMU_BATCH_MAX_ENTRIES)) {
+                failures++;
+            }
+        }
+        const uint8_t kept = b.count;
+        const size_t cap = (trial & 1) ? sizeof(buf) : 40 + (size_t)(uniform() * 200);
+        uint8_t taken;
+        const size_t len = imu_batch_pack(&b, buf, cap, &taken);
+        const uint8_t got = imu_batch_unpack(buf, len, out, IMU_BATCH_MAX_ENTRIES);
+        if (len > cap || got != taken || taken == 0 || b.count != kept) {
+            failures++;
+            continue;
+        }
+        // Truncated batches are rejected
+        if (imu_batch_unpack(buf, len - 1, out, IMU_BATCH_MAX_ENTRIES)) {
+            failures++;
+        }
+        // Sorted by source, every frame intact, a source's frames in order
+        for (uint8_t i = 0; i < got; i++) {
+            const int64_t id = frame_id(out[i].src, out[i].frame);
+            if (id < 0 || (i > 0 && (out[i].src < out[i - 1].src ||
+                (out[i].src == out[i - 1].src && id <= frame_id(out[i - 1].src, out[i - 1].frame))))) {
+                failures++;
+                break;
+            }
+        }
+        // Everything left over comes out in the following batches
+        uint32_t total = got;
+        imu_batch_consume(&b, taken);
+        while (b.count) {
+            const size_t l = imu_batch_pack(&b, buf, sizeof(buf), &taken);
+            total += imu_batch_unpack(buf, l, out, IMU_BATCH_MAX_ENTRIES);
+            imu_batch_consume(&b, taken);
+        }
+        if (total != kept || b.dropped != (uint32_t)(n - kept)) {
+            failures++;
+        }
+    }
+
+    // Cost of the source codes: a cluster of consecutive addresses
+    imu_batch_init(&b);
+    for (int i = 0; i < 8; i++) {
+        uint8_t f[IMU_BATCH_FRAME_LEN];
+        make_frame((uint32_t)i, (uint16_t)(FIRST_ADDR + 7 - i), f);
+        imu_batch_add(&b, (uint16_t)(FIRST_ADDR + 7 - i), f);
+    }
+    uint8_t taken;
+    const size_t len8 = imu_batch_pack(&b, buf, sizeof(buf), &taken);
+    printf("1. Batch round trip: 2000 random batches %s\n"
+           "   8 members, consecutive addresses: %zu bytes = %zu segments "
+           "(8 legacy frames: 8 messages)\n\n", failures ? "FAILED" : "ok",
+           len8, (len8 + IMU_VENDOR_OPCODE_LEN + 4 + SEG_DATA - 1) / SEG_DATA);
+    return failures;
+}
+
+/*
+ * ============================================================================
+ *                         2. NETWORK
+ * ============================================================================
+ */
+
+enum { PDU_FRAME, PDU_SEG, PDU_ACK };
+
+typedef struct {
+    uint8_t kind, ttl, seg, origin;
+    uint32_t msg;                       // Message id (relay cache)
+    uint32_t ref;                       // Frame id / batch id
+    uint32_t bits;                      // Ack: segments received
+} pdu_t;
+
+typedef struct {
+    pdu_t q[ADV_BUFS];
+    int head, count;
+    int copies;                         // Copies of q[head] still to send
+    bool delayed;                       // First copy waits its advDelay
+    int64_t next_tx;
+    bool on_air;
+    int64_t tx_end;
+    uint32_t corrupt;                   // Receivers that lose this transmission
+    bool last_copy;
+} node_t;
+
+typedef struct {
+    uint8_t sticks, relays;
+    uint32_t period_ms;
+    uint32_t window_ms;                 // 0 = direct
+    uint8_t member_xmit;                // Copies per member frame (aggregated)
+} scenario_t;
+
+typedef struct {
+    uint32_t generated, delivered, tx, adv_drops, batches, batches_lost, frames_dropped;
+    double p50_ms, p99_ms, seg_per_frame;
+    int failures;
+} result_t;
+
+static node_t nodes[MAX_NODES];
+static uint32_t hears[MAX_NODES];       // Bit x: node x hears this node
+static uint8_t seen[MAX_NODES][MAX_MSGS / 8];
+static int64_t gen_us[MAX_FRAMES], got_us[MAX_FRAMES];
+static uint32_t msg_count, frame_count;
+
+// Head / gateway SAR state
+static imu_batch_t agg;
+static uint8_t batch_buf[MAX_BATCHES][IMU_SEG_FRAME_MAX];
+static uint16_t batch_len[MAX_BATCHES];
+static uint8_t batch_segs[MAX_BATCHES];
+static struct {
+    bool active;
+    uint32_t bid, pending;
+    int round, outstanding;
+    int64_t deadline, round_done;
+} sar;
+static struct {
+    uint32_t rx[MAX_BATCHES];
+    bool complete[MAX_BATCHES];
+    int64_t ack_at;
+    uint32_t ack_bid;
+} gw;
+
+static float lat_ms[MAX_FRAMES];
+static uint32_t lat_count;
+
+static void enqueue(int n, pdu_t p, result_t *r)
+{
+    node_t *nd = &nodes[n];
+    if (nd->count == ADV_BUFS) {
+        r->adv_drops++;
+        if (p.kind == PDU_SEG && n == 0) {
+            sar.outstanding--;          // Never sent: counts as lost
+        }
+        return;
+    }
+    nd->q[(nd->head + nd->count) % ADV_BUFS] = p;
+    nd->count++;
+}
+
+// Bit per segment of a batch (up to 32)
+static uint32_t seg_mask(uint8_t segs)
+{
+    return (segs >= 32) ? 0xFFFFFFFFu : (1u << segs) - 1;
+}
+
+static void deliver(uint32_t id, int64_t t)
+{
+    if (got_us[id] < 0) {
+        got_us[id] = t;
+        lat_ms[lat_count++] = (float)(t - gen_us[id]) / 1000.0f;
+    }
+}
+
+static void sar_send_round(int64_t t, result_t *r)
+{
+    sar.outstanding = 0;
+    for (uint8_t s = 0; s < batch_segs[sar.bid]; s++) {
+        if (sar.pending & (1u << s)) {
+            sar.outstanding++;
+            pdu_t p = { PDU_SEG, TTL, s, 0, msg_count++, sar.bid, 0 };
+            enqueue(0, p, r);
+        }
+    }
+    sar.round_done = t;
+    sar.deadline = (sar.outstanding > 0) ? -1 : t + SAR_TIMEOUT_US;
+}
+
+static void sar_next_round(int64_t t, result_t *r)
+{
+    if (++sar.round >= SAR_ROUNDS) {
+        sar.active = false;
+        r->batches_lost++;
+        return;
+    }
+    sar_send_round(t, r);
+}
+
+static void receive(int x, const scenario_t *sc, const pdu_t *p, int64_t t, result_t *r)
+{
+    if (seen[x][p->msg / 8] & (1u << (p->msg % 8))) {
+        return;
+    }
+    seen[x][p->msg / 8] |= (uint8_t)(1u << (p->msg % 8));
+
+    const int gateway = sc->sticks + sc->relays;
+    if (x >= sc->sticks && x < gateway) {
+        if (p->ttl >= 2) {
+            pdu_t fwd = *p;
+            fwd.ttl--;
+            enqueue(x, fwd, r);
+        }
+        return;
+    }
+
+    if (x == gateway) {
+        if (p->kind == PDU_FRAME) {
+            deliver(p->ref, t);
+        } else if (p->kind == PDU_SEG) {
+            const uint32_t bid = p->ref;
+            const uint32_t all = seg_mask(batch_segs[bid]);
+            if (!gw.complete[bid]) {
+                gw.rx[bid] |= 1u << p->seg;
+                if (gw.rx[bid] == all) {
+                    gw.complete[bid] = true;
+                    imu_batch_entry_t e[IMU_BATCH_MAX_ENTRIES];
+                    const uint8_t n = imu_batch_unpack(batch_buf[bid], batch_len[bid], e,
+                                                       IMU_BATCH_MAX_ENTRIES);
+                    if (n == 0) {
+                        r->failures++;
+                    }
+                    for (uint8_t i = 0; i < n; i++) {
+                        const int64_t id = frame_id(e[i].src, e[i].frame);
+                        if (id < 0 || id >= frame_count) {
+                            r->failures++;
+                            continue;
+                        }
+                        deliver((uint32_t)id, t);
+                    }
+                    gw.ack_bid = bid;
+                    gw.ack_at = t;
+                    return;
+                }
+            }
+            // Incomplete: ack once the segments stop coming. Complete
+            // already (the ack got lost): ack again at once
+            gw.ack_bid = bid;
+            gw.ack_at = t + (gw.complete[bid] ? 0 : ACK_DELAY_US);
+        }
+        return;
+    }
+
+    // Sticks: only the head listens, and only when aggregating
+    if (x != 0 || sc->window_ms == 0) {
+        return;
+    }
+    if (p->kind == PDU_FRAME && p->origin != 0) {
+        uint8_t f[IMU_BATCH_FRAME_LEN];
+        const uint16_t src = (uint16_t)(FIRST_ADDR + p->origin);
+        make_frame(p->ref, src, f);
+        if (!imu_batch_add(&agg, src, f)) {
+            r->frames_dropped++;
+        }
+    } else if (p->kind == PDU_ACK && sar.active && p->ref == sar.bid) {
+        sar.pending &= ~p->bits;
+        if (!sar.pending) {
+            sar.active = false;
+        } else if (sar.outstanding == 0 && t - sar.round_done >= ACK_DELAY_US) {
+            // Resend what is missing - unless the ack left the gateway
+            // before this round's segments could have arrived
+            sar_next_round(t, r);
+        }
+    }
+}
+
+static int cmp_float(const void *a, const void *b)
+{
+    const float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+static result_t run(const scenario_t *sc)
+{
+    result_t r;
+    memset(&r, 0, sizeof(r));
+    memset(nodes, 0, sizeof(nodes));
+    memset(seen, 0, sizeof(seen));
+    memset(&sar, 0, sizeof(sar));
+    memset(&gw, 0, sizeof(gw));
+    gw.ack_at = -1;
+    imu_batch_init(&agg);
+    msg_count = frame_count = lat_count = 0;
+
+    // Who hears whom: cluster ↔ relay 1 ↔ ... ↔ relay R ↔ gateway
+    const int total = sc->sticks + sc->relays + 1;
+    const int gateway = total - 1;
+    memset(hears, 0, sizeof(hears));
+    for (int a = 0; a < total; a++) {
+        const int ha = (a < sc->sticks) ? 0 : a - sc->sticks + 1;    // Hop position
+        for (int b = 0; b < total; b++) {
+            const int hb = (b < sc->sticks) ? 0 : b - sc->sticks + 1;
+            if (a != b && abs(ha - hb) <= 1) {
+                hears[a] |= 1u << b;
+            }
+        }
+    }
+
+    int64_t next_frame[MAX_NODES];
+    for (int s = 0; s < sc->sticks; s++) {
+        next_frame[s] = (int64_t)(uniform() * sc->period_ms * 1000.0);
+    }
+    int64_t next_flush = sc->window_ms * 1000LL;
+    uint32_t seg_sum = 0, frames_batched = 0;
+
+    for (int64_t t = 0; t < RUN_US; t += TICK_US) {
+        // Transmissions that end: receptions, bearer bookkeeping
+        for (int n = 0; n < total; n++) {
+            node_t *nd = &nodes[n];
+            if (!nd->on_air || t < nd->tx_end) {
+                continue;
+            }
+            nd->on_air = false;
+            const pdu_t p = nd->q[nd->head];
+            for (int x = 0; x < total; x++) {
+                if ((hears[n] & (1u << x)) && !(nd->corrupt & (1u << x)) && uniform() >= BASE_LOSS) {
+                    receive(x, sc, &p, t, &r);
+                }
+            }
+            if (nd->last_copy) {
+                nd->head = (nd->head + 1) % ADV_BUFS;
+                nd->count--;
+                if (n == 0 && p.kind == PDU_SEG && sar.active && p.ref == sar.bid &&
+                    --sar.outstanding == 0) {
+                    sar.round_done = t;
+                    sar.deadline = t + SAR_TIMEOUT_US;
+                }
+            }
+        }
+
+        // Sticks generate frames
+        for (int s = 0; s < sc->sticks && t < GEN_US; s++) {
+            if (t < next_frame[s]) {
+                continue;
+            }
+            next_frame[s] += sc->period_ms * 1000LL;
+            const uint32_t id = frame_count++;
+            gen_us[id] = t;
+            got_us[id] = -1;
+            r.generated++;
+            const bool member = sc->window_ms && s != 0;
+            pdu_t p = { PDU_FRAME, member ? 0 : TTL, 0, (uint8_t)s, msg_count++, id, 0 };
+            enqueue(s, p, &r);
+        }
+
+        // Head: one batch per window, if the last one is through
+        if (sc->window_ms && t >= next_flush) {
+            next_flush += sc->window_ms * 1000LL;
+            if (!sar.active && agg.count && r.batches < MAX_BATCHES) {
+                uint8_t taken;
+                const uint32_t bid = r.batches++;
+                const size_t len = imu_batch_pack(&agg, batch_buf[bid], IMU_SEG_FRAME_MAX, &taken);
+                imu_batch_consume(&agg, taken);
+                batch_len[bid] = (uint16_t)len;
+                batch_segs[bid] = (uint8_t)((len + IMU_VENDOR_OPCODE_LEN + 4 + SEG_DATA - 1) / SEG_DATA);
+                seg_sum += batch_segs[bid];
+                frames_batched += taken;
+                sar.active = true;
+                sar.bid = bid;
+                sar.pending = seg_mask(batch_segs[bid]);
+                sar.round = 0;
+                sar_send_round(t, &r);
+            }
+        }
+        if (sar.active && sar.deadline >= 0 && t >= sar.deadline) {
+            sar_next_round(t, &r);
+        }
+        if (gw.ack_at >= 0 && t >= gw.ack_at) {
+            pdu_t p = { PDU_ACK, TTL, 0, (uint8_t)gateway, msg_count++, gw.ack_bid, gw.rx[gw.ack_bid] };
+            enqueue(gateway, p, &r);
+            gw.ack_at = -1;
+        }
+
+        // Bearers: start the next copy; collisions and half duplex
+        for (int n = 0; n < total; n++) {
+            node_t *nd = &nodes[n];
+            if (nd->on_air || nd->count == 0 || t < nd->next_tx) {
+                continue;
+            }
+            if (nd->copies == 0 && !nd->delayed) {
+                nd->delayed = true;
+                nd->next_tx = t + (int64_t)(uniform() * XMIT_JITTER_US);
+                continue;
+            }
+            if (nd->copies == 0) {
+                nd->delayed = false;
+                const bool member = sc->window_ms && n > 0 && n < sc->sticks;
+                nd->copies = member ? sc->member_xmit : NET_XMIT;
+            }
+            nd->copies--;
+            nd->last_copy = (nd->copies == 0);
+            nd->on_air = true;
+            nd->tx_end = t + AIR_US;
+            nd->corrupt = 0;
+            nd->next_tx = t + (nd->last_copy ? AIR_US
+                                             : XMIT_GAP_US + (int64_t)(uniform() * XMIT_JITTER_US));
+            r.tx++;
+            for (int a = 0; a < total; a++) {
+                if (a == n || !nodes[a].on_air) {
+                    continue;
+                }
+                const uint32_t both = hears[a] & hears[n];
+                nodes[a].corrupt |= both | (1u << n);
+                nd->corrupt |= both | (1u << a);
+            }
+        }
+        if (msg_count >= MAX_MSGS - 64 || frame_count >= MAX_FRAMES - 64) {
+            r.failures++;
+            printf("   FAIL: simulation tables full\n");
+            break;
+        }
+    }
+
+    r.delivered = lat_count;
+    qsort(lat_ms, lat_count, sizeof(lat_ms[0]), cmp_float);
+    r.p50_ms = lat_count ? lat_ms[lat_count / 2] : 0.0;
+    r.p99_ms = lat_count ? lat_ms[(uint32_t)(lat_count * 0.99)] : 0.0;
+    r.seg_per_frame = frames_batched ? (double)seg_sum / frames_batched : 0.0;
+    return r;
+}
+
+static int check_network(void)
+{
+    static const scenario_t scenarios[] = {
+        { 8, 1, 1000, 0, 3 }, { 8, 1, 1000, 1000, 3 }, { 8, 1, 1000, 2000, 1 },
+        { 8, 2, 1000, 0, 3 }, { 8, 2, 1000, 1000, 3 }, { 8, 2, 1000, 2000, 1 },
+        { 8, 4, 1000, 0, 3 }, { 8, 4, 1000, 1000, 3 }, { 8, 4, 1000, 2000, 1 },
+        { 4, 1, 200, 0, 3 }, { 4, 1, 200, 1000, 3 }, { 4, 1, 200, 1000, 1 },
+        { 4, 2, 200, 0, 3 }, { 4, 2, 200, 1000, 3 }, { 4, 2, 200, 1000, 1 },
+        { 4, 4, 200, 0, 3 }, { 4, 4, 200, 1000, 3 }, { 4, 4, 200, 1000, 1 },
+        { 4, 2, 100, 0, 3 }, { 4, 2, 100, 1000, 3 }, { 4, 2, 100, 1000, 1 },
+    };
+    int failures = 0;
+
+    printf("2. Network: cluster → relay chain → gateway, 60 s per run\n");
+    printf("   %-6s %-6s %-7s %-15s %9s %9s %10s %9s %17s %9s\n", "sticks", "relays", "rate",
+           "mode", "delivered", "tx/frame", "air/frame", "seg/frame", "latency p50/p99", "adv drop");
+    for (size_t k = 0; k < sizeof(scenarios) / sizeof(scenarios[0]); k++) {
+        const scenario_t *sc = &scenarios[k];
+        const result_t r = run(sc);
+        char mode[24];
+        if (sc->window_ms) {
+            snprintf(mode, sizeof(mode), "batch %u s, %ux", (unsigned)(sc->window_ms / 1000),
+                     (unsigned)sc->member_xmit);
+        } else {
+            snprintf(mode, sizeof(mode), "direct");
+        }
+        printf("   %-6u %-6u %4.0f Hz %-15s %8.1f%% %9.2f %8.2f ms %9.2f %7.0f / %5.0f ms %9u\n",
+               sc->sticks, sc->relays, 1000.0 / sc->period_ms, mode,
+               r.generated ? 100.0 * r.delivered / r.generated : 0.0,
+               r.delivered ? (double)r.tx / r.delivered : 0.0,
+               r.delivered ? (double)r.tx * AIR_US / 1000.0 / r.delivered : 0.0,
+               r.seg_per_frame, r.p50_ms, r.p99_ms, (unsigned)r.adv_drops);
+        if (r.failures) {
+            printf("   FAIL: %d batch entries did not match what the members sent\n", r.failures);
+            failures += r.failures;
+        }
+    }
+    printf("   batch W s, Nx = one batch per W s, members send N copies of a frame\n"
+           "   tx/frame = transmissions of every node (all copies, relays, acks) per\n"
+           "   delivered frame; seg/frame = segments per batched frame\n");
+    return failures;
+}
+
+int main(void)
+{
+    int failures = check_round_trip();
+    failures += check_network();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,275 @@
+/*
+ * ============================================================================
+ *                    HOST SIMULATOR - AUTO-RANGING FULL-SCALE SELECTION
+ * ============================================================================
+ *
+ * Runs the node's sampling path on a PC, register for register:
+ *
+ *   trace ──▶ MPU6886 mock ──I2C regs──▶ imu_mpu6886 driver ──▶ decimator ──▶ ranged frame
+ *    (truth)   (ADC at current FSR,        (count → mg / 0.1 dps)               (int8, step = FS/128)
+ *               clips)                            │
+ *                                          imu_autorange ──FSR writes──▶ mock
+ *
+ * and compares fixed ranges with the auto-ranging controller, per motion
+ * regime:
+ * - Frame error: decoded frame vs the decimated TRUE signal (RMS, mg / 0.1 dps)
+ * - Clipped ADC values (the range was too small)
+ * - Range switches and time spent in each range (auto only)
+ * The legacy 0.1 g / 10 dps frame at M5Unified's default ranges is the
+ * baseline.
+ *
+ * Usage:
+ *   sim_autorange [trace.csv]     (default: built-in regimes + synthetic trace)
+ *
+ * Build and run: see tools/README.md
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "imu_mpu6886.h"
+#include "imu_autorange.h"
+#include "imu_decimator.h"
+#include "imu_mpu6886_mock.h"
+#include "imu_trace.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define RATE        200
+#define RATIO       20          // 200 Hz → 10 Hz, as the firmware
+#define SECONDS     60
+
+typedef struct {
+    const char *label;
+    imu_sample_t *samples;
+    size_t count;
+} regime_t;
+
+typedef struct {
+    const char *label;
+    int accel, gyro;            // Fixed ranges, -1 = auto
+    bool legacy;                // Legacy int8 frame instead of the ranged frame
+} sim_config_t;
+
+typedef struct {
+    double sq[2];
+    size_t values[2];
+    uint32_t clipped[2];
+    uint32_t switches;
+    uint32_t windows_in[2][IMU_RANGE_COUNT];
+    size_t windows;
+} sim_result_t;
+
+/*
+ * ============================================================================
+ *                         REGIMES
+ * ============================================================================
+ */
+
+typedef void (*regime_fn)(size_t i, double t, imu_sample_t *s);
+
+// On a desk: gravity + a few mg of tremor
+static void regime_rest(size_t i, double t, imu_sample_t *s)
+{
+    (void)i;
+    double tremor = sin(2.0 * M_PI * 8.0 * t);
+    s->v[IMU_AXIS_AX] = (int16_t)lrint(5.0 * tremor);
+    s->v[IMU_AXIS_AY] = (int16_t)lrint(-3.0 * tremor);
+    s->v[IMU_AXIS_AZ] = (int16_t)lrint(1000.0 + 2.0 * tremor);
+    s->v[IMU_AXIS_GX] = (int16_t)lrint(6.0 * tremor);
+    s->v[IMU_AXIS_GY] = (int16_t)lrint(-4.0 * tremor);
+    s->v[IMU_AXIS_GZ] = 0;
+}
+
+// Rest, knocked with 9 g / 1200 dps every 2 s
+static void regime_knocks(size_t i, double t, imu_sample_t *s)
+{
+    regime_rest(i, t, s);
+    size_t phase = i % (2 * RATE);
+    double k = (phase < 4) ? sin(M_PI * (double)phase / 4.0) : 0.0;
+    s->v[IMU_AXIS_AX] = imu_sat16(s->v[IMU_AXIS_AX] + (int32_t)lrint(9000.0 * k));
+    s->v[IMU_AXIS_AY] = imu_sat16(s->v[IMU_AXIS_AY] - (int32_t)lrint(3000.0 * k));
+    s->v[IMU_AXIS_GX] = imu_sat16(s->v[IMU_AXIS_GX] + (int32_t)lrint(12000.0 * k));
+}
+
+// Swinging an arm: ±3 g, ±600 dps at 1.5 Hz
+static void regime_swing(size_t i, double t, imu_sample_t *s)
+{
+    (void)i;
+    double w = sin(2.0 * M_PI * 1.5 * t);
+    s->v[IMU_AXIS_AX] = (int16_t)lrint(3000.0 * w);
+    s->v[IMU_AXIS_AY] = (int16_t)lrint(800.0 * cos(2.0 * M_PI * 1.5 * t));
+    s->v[IMU_AXIS_AZ] = (int16_t)lrint(1000.0 + 400.0 * w * w);
+    s->v[IMU_AXIS_GX] = (int16_t)lrint(1500.0 * w);
+    s->v[IMU_AXIS_GY] = (int16_t)lrint(6000.0 * cos(2.0 * M_PI * 1.5 * t));
+    s->v[IMU_AXIS_GZ] = (int16_t)lrint(-800.0 * w);
+}
+
+static int make_regime(regime_t *r, const char *label, regime_fn fn)
+{
+    r->label = label;
+    r->count = (size_t)SECONDS * RATE;
+    r->samples = calloc(r->count, sizeof(imu_sample_t));
+    if (!r->samples) {
+        return -1;
+    }
+    for (size_t i = 0; i < r->count; i++) {
+        fn(i, (double)i / RATE, &r->samples[i]);
+    }
+    return 0;
+}
+
+/*
+ * ============================================================================
+ *                         SIMULATION
+ * ============================================================================
+ */
+
+static void add_error(sim_result_t *res, const imu_sample_t *truth, const imu_sample_t *got)
+{
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        int s = (a < IMU_AXIS_GX) ? 0 : 1;
+        double d = (double)got->v[a] - (double)truth->v[a];
+        res->sq[s] += d * d;
+        res->values[s]++;
+    }
+}
+
+// Legacy frame: ÷100, int8 (saturating here; the firmware cast wraps)
+static void legacy_round_trip(const imu_sample_t *in, imu_sample_t *out)
+{
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        int32_t q = in->v[a] / 100;
+        q = (q > 127) ? 127 : (q < -128) ? -128 : q;
+        out->v[a] = (int16_t)(q * 100);
+    }
+}
+
+static sim_result_t simulate(const regime_t *rg, const sim_config_t *sc)
+{
+    static imu_decimator_t dec_true, dec_meas;
+    sim_result_t res;
+    memset(&res, 0, sizeof(res));
+
+    const bool autorange = sc->accel < 0;
+    imu_mpu6886_mock_t mock;
+    // Auto starts where M5.begin() leaves the chip: ±8 g / ±2000 dps
+    imu_mpu6886_mock_init(&mock, autorange ? 2 : (imu_range_t)sc->accel,
+                          autorange ? 3 : (imu_range_t)sc->gyro);
+    imu_reg_bus_t bus = imu_mpu6886_mock_bus(&mock);
+    imu_mpu6886_t dev;
+    if (!imu_mpu6886_init(&dev, &bus)) {
+        return res;
+    }
+
+    imu_autorange_t ar;
+    imu_autorange_config_t cfg = imu_autorange_default_config();
+    imu_autorange_init(&ar, &cfg, dev.accel_range, dev.gyro_range);
+
+    imu_decimator_configure(&dec_true, IMU_DECIM_FIR, RATIO);
+    imu_decimator_configure(&dec_meas, IMU_DECIM_FIR, RATIO);
+
+    for (size_t i = 0; i < rg->count; i++) {
+        imu_sample_t s, truth_out, meas_out, decoded;
+        imu_mpu6886_mock_latch(&mock, &rg->samples[i]);
+        if (!imu_mpu6886_read(&dev, &s)) {
+            break;
+        }
+        imu_autorange_observe(&ar, &s);
+        imu_decimator_push(&dec_true, &rg->samples[i], &truth_out);
+        if (!imu_decimator_push(&dec_meas, &s, &meas_out)) {
+            continue;
+        }
+
+        // Window closed: pick next ranges, frame this window with them
+        imu_range_t a_r = dev.accel_range, g_r = dev.gyro_range;
+        if (autorange && imu_autorange_update(&ar, &a_r, &g_r)) {
+            imu_mpu6886_set_range(&dev, a_r, g_r);
+        }
+        if (sc->legacy) {
+            legacy_round_trip(&meas_out, &decoded);
+        } else {
+            uint8_t frame[IMU_RANGED_FRAME_LEN];
+            imu_ranged_pack(&meas_out, (uint16_t)(i * 1000 / RATE), a_r, g_r, frame);
+            imu_ranged_unpack(frame, sizeof(frame), &decoded, NULL, NULL, NULL);
+        }
+        add_error(&res, &truth_out, &decoded);
+        res.windows_in[0][a_r]++;
+        res.windows_in[1][g_r]++;
+        res.windows++;
+    }
+    res.clipped[0] = mock.clipped[0];
+    res.clipped[1] = mock.clipped[1];
+    res.switches = ar.switches;
+    return res;
+}
+
+static void print_result(const sim_config_t *sc, const sim_result_t *r, size_t samples)
+{
+    printf("  %-22s %9.1f %9.1f  %7.2f%% %7.2f%%", sc->label,
+           r->values[0] ? sqrt(r->sq[0] / (double)r->values[0]) : 0.0,
+           r->values[1] ? sqrt(r->sq[1] / (double)r->values[1]) : 0.0,
+           100.0 * r->clipped[0] / (3.0 * (double)samples),
+           100.0 * r->clipped[1] / (3.0 * (double)samples));
+    if (sc->accel < 0 && r->windows) {
+        printf("  %4u  ", (unsigned)r->switches);
+        for (int s = 0; s < 2; s++) {
+            printf(" %s", s ? "G" : "A");
+            for (int k = 0; k < IMU_RANGE_COUNT; k++) {
+                printf(" %3.0f", 100.0 * r->windows_in[s][k] / (double)r->windows);
+            }
+        }
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    static const sim_config_t configs[] = {
+        { "legacy, 8 g / 2000 dps", 2, 3, true },
+        { "fixed 2 g / 250 dps",    0, 0, false },
+        { "fixed 4 g / 500 dps",    1, 1, false },
+        { "fixed 8 g / 2000 dps",   2, 3, false },
+        { "fixed 16 g / 2000 dps",  3, 3, false },
+        { "auto",                  -1, -1, false },
+    };
+
+    regime_t regimes[5];
+    size_t count = 0;
+    imu_trace_t tr;
+    if (argc > 1) {
+        if (imu_trace_load_csv(argv[1], &tr) != 0) {
+            return 1;
+        }
+        regimes[count++] = (regime_t){ argv[1], tr.samples, tr.count };
+    } else {
+        if (make_regime(&regimes[count++], "rest (tremor)", regime_rest) != 0 ||
+            make_regime(&regimes[count++], "rest + 9 g knocks", regime_knocks) != 0 ||
+            make_regime(&regimes[count++], "arm swing", regime_swing) != 0 ||
+            imu_trace_synth(&tr, (size_t)SECONDS * RATE, RATE, 1) != 0) {
+            return 1;
+        }
+        regimes[count++] = (regime_t){ "synthetic trace", tr.samples, tr.count };
+    }
+
+    for (size_t k = 0; k < count; k++) {
+        printf("\n%s (%zu samples)\n", regimes[k].label, regimes[k].count);
+        printf("  %-22s %9s %9s  %8s %8s  %s\n", "ranges", "accel RMS", "gyro RMS",
+               "A clip", "G clip", "auto: switches, % of windows per range 0..3");
+        for (size_t c = 0; c < sizeof(configs) / sizeof(configs[0]); c++) {
+            sim_result_t r = simulate(&regimes[k], &configs[c]);
+            print_result(&configs[c], &r, regimes[k].count);
+        }
+    }
+    printf("\nRMS error of the decoded frame vs the decimated true signal, in mg\n"
+           "and 0.1 dps. Clip = share of raw ADC values stuck at full scale.\n");
+
+    for (size_t k = 0; k + 1 < count; k++) {
+        free(regimes[k].samples);
+    }
+    imu_trace_free(&tr);
+    return 0;
+}
@@ -0,0 +1,389 @@
+/*
+ * ============================================================================
+ *                    HOST SIMULATOR - SYNCHRONIZED CAPTURE AND UPLOAD
+ * ============================================================================
+ *
+ * Two checks of the group-triggered capture (imu_capture.h):
+ *
+ * 1. ALIGNMENT: every node samples at 200 Hz with its own phase, a
+ *    residual time-sync error of up to ±3 ms (sim_timesync p99) and gets
+ *    the command up to 150 ms late. A knock hits all nodes at the same
+ *    true instant; after aligning each window with its first_offset_us,
+ *    where does each node put the knock?
+ *
+ * 2. UPLOAD SCHEDULE: after the window, every node uploads its chunks
+ *    (segmented messages, imu_capture_chunk_pack) to the gateway. The
+ *    advertising channel is one shared medium:
+ *    - each segment is one ~1.1 ms transmission (3 advertising channels)
+ *    - segments of a message follow every 15 + U(0,5) ms
+ *    - two overlapping transmissions are both lost; 2% loss on top
+ *    - SAR: 150 ms after a message's last segment the gateway acks the
+ *      segments it has; the node resends the missing ones, up to 4 rounds,
+ *      then the chunk is lost
+ *    - streaming (one 8-byte frame every 100 ms) pauses on every node until
+ *      the last slot ends, as in the firmware; with "all at once" a node
+ *      resumes streaming when its own upload is done
+ *    Schedules: all nodes at once, staggered slots of
+ *    imu_capture_upload_ms(), and slots that are too short.
+ *
+ * Returns nonzero if a node misplaces the knock by more than half a sample
+ * period + the sync error, or if the recommended staggered schedule loses
+ * a chunk or overruns a slot.
+ *
+ * Usage:
+ *   sim_capture
+ *
+ * Build and run: see tools/README.md
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "imu_capture.h"
+
+#define NODES           8
+#define FIRST_ADDR      2           // Unicast addresses 2..9 (1 = provisioner)
+#define PERIOD_US       5000        // 200 Hz
+#define WINDOW_SAMPLES  200         // 1 s capture
+#define SYNC_ERR_US     3000
+#define TICK_US         50
+#define AIR_US          1100
+#define SEG_GAP_US      15000
+#define SEG_JITTER_US   5000
+#define ACK_US          150000
+#define SAR_ROUNDS      4
+#define STREAM_US       100000
+#define BASE_LOSS       0.02
+#define SEG_DATA        12          // Bytes per segment (upper transport)
+
+static uint32_t rng = 0x13579BDu;
+
+static double uniform(void)
+{
+    // xorshift32 → [0, 1)
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return (double)rng / 4294967296.0;
+}
+
+/*
+ * ============================================================================
+ *                         1. ALIGNMENT
+ * ============================================================================
+ */
+
+static imu_capture_t recorder;
+
+static int check_alignment(void)
+{
+    const uint32_t t_start = 4294967296.0 - 2e6;    // Window crosses the 32-bit wrap
+    const double knock_us = 500000.0 + 1234.0;       // True knock, relative to T
+    double worst = 0.0;
+    int failures = 0;
+
+    printf("1. Alignment: %d nodes, sync error up to ±%d us, window of %d samples\n",
+           NODES, SYNC_ERR_US, WINDOW_SAMPLES);
+    printf("   %-5s %9s %10s %12s %14s\n", "node", "sync err", "cmd late", "first ofs",
+           "knock err (us)");
+
+    for (int n = 0; n < NODES; n++) {
+        const double phase = uniform() * PERIOD_US;
+        const double sync_err = (uniform() * 2.0 - 1.0) * SYNC_ERR_US;
+        const double late = uniform() * 150000.0;
+        imu_capture_init(&recorder);
+
+        imu_capture_cmd_t cmd = { 1, NODES, 20, t_start, WINDOW_SAMPLES };
+        bool armed = false;
+        // True time (µs, relative to T) of sample k: 3 s of history before T
+        for (int k = 0; k < 1000; k++) {
+            const double t = -3e6 + phase + (double)k * PERIOD_US;
+            if (!armed && t >= late) {
+                armed = imu_capture_arm(&recorder, &cmd);
+                if (!armed) {
+                    break;
+                }
+            }
+            imu_sample_t s = { { 0, 0, 1000, 0, 0, 0 } };
+            if (fabs(t - knock_us) < PERIOD_US / 2.0) {
+                s.v[IMU_AXIS_AX] = 8000;
+            }
+            const uint32_t global = t_start + (uint32_t)(int64_t)llround(t + sync_err);
+            if (imu_capture_push(&recorder, &s, global) == IMU_CAPTURE_READY) {
+                break;
+            }
+        }
+        if (recorder.state != IMU_CAPTURE_READY) {
+            printf("   node %d: capture not completed\n", n);
+            failures++;
+            continue;
+        }
+
+        // Gateway side: unpack the chunks, find the knock
+        double knock_at = -1.0;
+        uint16_t first_offset = 0;
+        for (uint8_t c = 0; c < imu_capture_chunks(&recorder); c++) {
+            uint8_t buf[IMU_CAPTURE_CHUNK_MAX];
+            imu_sample_t got[IMU_CAPTURE_CHUNK_SAMPLES];
+            imu_capture_chunk_t hdr;
+            size_t len = imu_capture_chunk_pack(&recorder, c, buf, sizeof(buf));
+            if (!imu_capture_chunk_unpack(buf, len, &hdr, got)) {
+                failures++;
+                break;
+            }
+            first_offset = hdr.first_offset_us;
+            for (uint8_t i = 0; i < hdr.samples; i++) {
+                if (got[i].v[IMU_AXIS_AX] == 8000) {
+                    knock_at = hdr.first_offset_us +
+                               (double)(c * IMU_CAPTURE_CHUNK_SAMPLES + i) * PERIOD_US;
+                }
+            }
+        }
+        const double err = knock_at - knock_us;
+        printf("   %-5d %9.0f %10.0f %12u %14.0f\n", n, sync_err, late, first_offset, err);
+        if (knock_at < 0.0 || fabs(err) > PERIOD_US / 2.0 + SYNC_ERR_US) {
+            failures++;
+        }
+        worst = fmax(worst, fabs(err));
+    }
+    printf("   worst knock error %.0f us (bound: half a sample + sync error = %d us)\n\n",
+           worst, PERIOD_US / 2 + SYNC_ERR_US);
+    return failures;
+}
+
+/*
+ * ============================================================================
+ *                         2. UPLOAD SCHEDULE
+ * ============================================================================
+ */
+
+typedef struct {
+    const char *label;
+    uint8_t slots;
+    uint32_t slot_ms;
+    bool recommended;
+} schedule_t;
+
+typedef struct {
+    // Upload
+    bool uploading, done;
+    int64_t slot_start, slot_end, finished, quiet_until;
+    uint8_t chunk, chunks, round;
+    int segs;
+    uint32_t pending, received;     // Segment bitmaps
+    int next_seg;
+    int64_t chunk_start, next_tx, ack_at;
+    uint32_t failed;
+
+    // Current transmission
+    bool on_air, corrupt, is_seg;
+    int seg;
+    int64_t tx_end;
+
+    // Stream
+    int64_t next_frame;
+} node_t;
+
+typedef struct {
+    double complete_s;
+    uint32_t failed, overruns, collisions, transmissions;
+    uint32_t seg_sent, seg_needed;
+} sched_result_t;
+
+static int chunk_segments(uint8_t chunk, uint8_t chunks)
+{
+    const uint32_t n = (chunk + 1 < chunks) ? IMU_CAPTURE_CHUNK_SAMPLES
+                     : WINDOW_SAMPLES - (uint32_t)chunk * IMU_CAPTURE_CHUNK_SAMPLES;
+    const uint32_t bytes = 3 + IMU_CAPTURE_CHUNK_HEADER + n * IMU_AXIS_COUNT * 2 + 4;
+    return (int)((bytes + SEG_DATA - 1) / SEG_DATA);
+}
+
+static void start_chunk(node_t *nd, int64_t now)
+{
+    nd->segs = chunk_segments(nd->chunk, nd->chunks);
+    nd->pending = (nd->segs == 32) ? 0xFFFFFFFFu : ((1u << nd->segs) - 1);
+    nd->received = 0;
+    nd->round = 0;
+    nd->next_seg = 0;
+    nd->chunk_start = now;
+    nd->next_tx = now;
+    nd->ack_at = -1;
+}
+
+static int next_pending(const node_t *nd, int from)
+{
+    for (int s = from; s < nd->segs; s++) {
+        if (nd->pending & (1u << s)) {
+            return s;
+        }
+    }
+    return -1;
+}
+
+static sched_result_t run_schedule(const schedule_t *sc)
+{
+    sched_result_t r;
+    memset(&r, 0, sizeof(r));
+    node_t nodes[NODES];
+    const uint8_t chunks = (WINDOW_SAMPLES + IMU_CAPTURE_CHUNK_SAMPLES - 1) / IMU_CAPTURE_CHUNK_SAMPLES;
+    imu_capture_cmd_t cmd = { 1, sc->slots, (uint8_t)((sc->slot_ms + 99) / 100), 0, WINDOW_SAMPLES };
+
+    for (int n = 0; n < NODES; n++) {
+        node_t *nd = &nodes[n];
+        memset(nd, 0, sizeof(*nd));
+        nd->slot_start = (int64_t)imu_capture_slot_delay_ms(&cmd, FIRST_ADDR + n) * 1000;
+        nd->slot_end = nd->slot_start + (int64_t)cmd.slot_100ms * 100000;
+        nd->chunks = chunks;
+        nd->next_frame = (int64_t)(uniform() * STREAM_US);
+        nd->quiet_until = (int64_t)(cmd.slots > 1 ? cmd.slots : 0) * cmd.slot_100ms * 100000;
+    }
+
+    const int64_t limit = 120000000;      // Give up after 2 minutes
+    int active = 0;                       // Transmissions on air
+    int64_t t;
+    for (t = 0; t < limit; t += TICK_US) {
+        // End of transmissions: deliver to the gateway
+        for (int n = 0; n < NODES; n++) {
+            node_t *nd = &nodes[n];
+            if (nd->on_air && t >= nd->tx_end) {
+                nd->on_air = false;
+                active--;
+                if (!nd->corrupt && uniform() >= BASE_LOSS && nd->is_seg) {
+                    nd->received |= 1u << nd->seg;
+                }
+            }
+        }
+
+        // Node state machines: start transmissions
+        bool all_done = true;
+        for (int n = 0; n < NODES; n++) {
+            node_t *nd = &nodes[n];
+            if (!nd->done) {
+                all_done = false;
+            }
+            if (!nd->done && !nd->uploading && t >= nd->slot_start) {
+                nd->uploading = true;
+                nd->chunk = 0;
+                start_chunk(nd, t);
+            }
+            bool tx = false, seg = false;
+            if (nd->uploading) {
+                if (nd->ack_at >= 0 && t >= nd->ack_at) {
+                    // SAR ack: what is still missing?
+                    nd->pending &= ~nd->received;
+                    nd->ack_at = -1;
+                    if (nd->pending && ++nd->round < SAR_ROUNDS) {
+                        nd->next_seg = 0;
+                        nd->next_tx = t;
+                    } else {
+                        if (nd->pending) {
+                            nd->failed++;
+                        }
+                        if (++nd->chunk == nd->chunks) {
+                            nd->uploading = false;
+                            nd->done = true;
+                            nd->finished = t;
+                        } else {
+                            // One chunk per IMU_CAPTURE_CHUNK_MS, or later if SAR ran long
+                            int64_t next = nd->chunk_start + IMU_CAPTURE_CHUNK_MS * 1000;
+                            start_chunk(nd, next > t ? next : t);
+                        }
+                    }
+                }
+                if (nd->uploading && nd->ack_at < 0 && t >= nd->next_tx && !nd->on_air) {
+                    int s = next_pending(nd, nd->next_seg);
+                    if (s >= 0) {
+                        nd->seg = s;
+                        nd->next_seg = s + 1;
+                        tx = seg = true;
+                        r.seg_sent++;
+                        nd->next_tx = t + SEG_GAP_US + (int64_t)(uniform() * SEG_JITTER_US);
+                        if (next_pending(nd, nd->next_seg) < 0) {
+                            nd->ack_at = t + AIR_US + ACK_US;
+                        }
+                    }
+                }
+            } else if (nd->done && t >= nd->quiet_until && t >= nd->next_frame && !nd->on_air) {
+                // Streaming resumes after the capture schedule
+                tx = true;
+                nd->next_frame = t + STREAM_US + (int64_t)((uniform() - 0.5) * 10000.0);
+            }
+            if (tx) {
+                nd->on_air = true;
+                nd->is_seg = seg;
+                nd->corrupt = false;
+                nd->tx_end = t + AIR_US;
+                active++;
+                r.transmissions++;
+            }
+        }
+        if (active > 1) {
+            for (int n = 0; n < NODES; n++) {
+                if (nodes[n].on_air && !nodes[n].corrupt) {
+                    nodes[n].corrupt = true;
+                    r.collisions++;
+                }
+            }
+        }
+        if (all_done) {
+            break;
+        }
+    }
+
+    r.complete_s = (double)t / 1e6;
+    for (int n = 0; n < NODES; n++) {
+        r.failed += nodes[n].failed;
+        if (!nodes[n].done) {
+            r.failed += nodes[n].chunks - nodes[n].chunk;
+        }
+        if (sc->slots > 1 && nodes[n].done && nodes[n].finished > nodes[n].slot_end) {
+            r.overruns++;
+        }
+        for (uint8_t c = 0; c < chunks; c++) {
+            r.seg_needed += (uint32_t)chunk_segments(c, chunks);
+        }
+    }
+    return r;
+}
+
+static int check_schedules(void)
+{
+    const uint32_t upload = imu_capture_upload_ms(WINDOW_SAMPLES);
+    const schedule_t schedules[] = {
+        { "all at once",              1,         0,          false },
+        { "2 nodes per slot",         NODES / 2, upload,     false },
+        { "staggered, half slot",     NODES,     upload / 2, false },
+        { "staggered, upload_ms",     NODES,     upload,     true },
+    };
+    int failures = 0;
+
+    printf("2. Upload: %d nodes × %u samples = %u chunks each, slot = %u ms "
+           "(imu_capture_upload_ms)\n", NODES, WINDOW_SAMPLES,
+           (WINDOW_SAMPLES + IMU_CAPTURE_CHUNK_SAMPLES - 1) / IMU_CAPTURE_CHUNK_SAMPLES,
+           (unsigned)upload);
+    printf("   %-24s %9s %8s %9s %11s %9s\n", "schedule", "all in", "chunks", "overruns",
+           "segs sent", "collided");
+    for (size_t k = 0; k < sizeof(schedules) / sizeof(schedules[0]); k++) {
+        const schedule_t *sc = &schedules[k];
+        sched_result_t r = run_schedule(sc);
+        printf("   %-24s %8.1fs %4u lost %9u %10.2fx %8.1f%%\n", sc->label, r.complete_s,
+               (unsigned)r.failed, (unsigned)r.overruns,
+               r.seg_needed ? (double)r.seg_sent / r.seg_needed : 0.0,
+               r.transmissions ? 100.0 * r.collisions / r.transmissions : 0.0);
+        if (sc->recommended && (r.failed || r.overruns)) {
+            printf("   FAIL: the recommended schedule lost chunks or overran a slot\n");
+            failures++;
+        }
+    }
+    printf("   all in = time from window end until the last node is done; segs sent\n"
+           "   = segments transmitted / segments in the data (SAR retransmissions)\n");
+    return failures;
+}
+
+int main(void)
+{
+    int failures = check_alignment();
+    failures += check_schedules();
+    return failures ? 1 : 0;
+}
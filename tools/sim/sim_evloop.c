@@ -0,0 +1,424 @@
+/*
+ * ============================================================================
+ *                    HOST SIMULATOR - NODE EVENT LOOP
+ * ============================================================================
+ *
+ * The component's event loop core (mesh_event_loop.c) and timer wheel
+ * (mesh_timer_wheel.c), unchanged, driven by a simulated port: a 16-entry
+ * queue (LOOP_QUEUE_LEN in ble_mesh_node.c) and a virtual millisecond
+ * clock. The producers are the firmware's:
+ * - the sampler's window watermark (IMU_EVENT_WINDOW, one per decimation
+ *   window, not re-posted while one is queued)
+ * - button edges from the GPIO ISR (IMU_EVENT_BUTTON), with contact bounce
+ * - mesh lifecycle events (provisioned, AppKey added)
+ * and the firmware's handlers and timers: on_window (a few ms of work),
+ * 20 ms button debounce, the 2 s status screen, the 10 s telemetry report.
+ *
+ * Checks, in every scenario - any failure fails the run:
+ * - events of each type are dispatched once, in posting order
+ * - no timer runs early, none later than one tick + the longest handler
+ * - every button press is reported exactly once
+ * - no wakeup without work (a deadline that finds nothing due)
+ * - no event dropped on a full queue
+ *
+ * Then the wakeups per second against the previous design (app_main
+ * polling M5.update() every 100 ms, a publisher task woken per window and
+ * a scheduler task for the timers).
+ *
+ * Usage:
+ *   sim_evloop
+ *
+ * Build and run: see tools/README.md
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mesh_event_loop.h"
+
+#define SIM_MS              (10u * 60u * 1000u)
+#define QUEUE_LEN           16          // LOOP_QUEUE_LEN in ble_mesh_node.c
+#define WINDOW_COST_MS      3           // on_window: drain, filter, encode, publish
+#define REPORT_COST_MS      1
+#define DEBOUNCE_MS         20          // IMU_BTN_DEBOUNCE_MS
+#define STATS_MS            10000       // IMU_STATS_PERIOD_MS
+#define SCREEN_MS           2000
+#define PRESSES             30
+#define MAX_SOURCES         16384
+
+#define IMU_EVENT_WINDOW    (MESH_EVENT_APP + 0)
+#define IMU_EVENT_BUTTON    (MESH_EVENT_APP + 1)
+
+static uint32_t rng_state = 2024;
+
+static uint32_t rng(void)
+{
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state >> 8;
+}
+
+typedef struct {
+    const char *name;
+    uint32_t window_ms;                 // Sampler watermark period, 0 = sampler off
+    uint32_t stall_every_ms;            // A window handler now and then takes...
+    uint32_t stall_ms;                  // ...this long (flash write, capture upload)
+} scenario_t;
+
+static const scenario_t scenarios[] = {
+    { "idle (sampler off)", 0, 0, 0 },
+    { "streaming 10 Hz", 100, 0, 0 },
+    { "streaming 5 Hz", 200, 0, 0 },
+    { "10 Hz, 300 ms stalls", 100, 10000, 300 },
+};
+
+/*
+ * ============================================================================
+ *                         SIMULATED PORT
+ * ============================================================================
+ */
+typedef struct {
+    uint64_t t;
+    uint8_t type;
+    uint32_t arg;
+    int8_t level;                       // Button edges: raw level after the edge
+} source_t;
+
+typedef struct {
+    mesh_event_t ev;
+    uint64_t posted;
+} queued_t;
+
+static source_t src[MAX_SOURCES];
+static size_t n_src, next_src;
+static queued_t q[QUEUE_LEN];
+static size_t q_head, q_len, q_max;
+static uint64_t now_ms;
+static bool done;
+
+static const scenario_t *sc;
+static mesh_evloop_t loop;
+static bool window_posted;
+static int8_t raw_level[2];             // Button pins as the ISR saw them (0 = pressed)
+static uint32_t errors, dropped, coalesced, posted_windows;
+static uint64_t lat_sum, lat_max;
+static uint32_t lat_n;
+
+static void fail(const char *what, uint64_t detail)
+{
+    if (errors++ < 5) {
+        printf("  [%s] t=%llu ms: %s (%llu)\n", sc->name, (unsigned long long)now_ms, what,
+               (unsigned long long)detail);
+    }
+}
+
+static void post(uint64_t t, uint8_t type, uint32_t arg)
+{
+    if (q_len == QUEUE_LEN) {
+        dropped++;
+        return;
+    }
+    q[(q_head + q_len) % QUEUE_LEN] = (queued_t){ { type, arg }, t };
+    q_len++;
+    if (q_len > q_max) {
+        q_max = q_len;
+    }
+}
+
+// Producers whose time has come post into the queue, in time order (a
+// handler that ran long delivers them late, stamped with their own time)
+static void deliver_sources(void)
+{
+    while (next_src < n_src && src[next_src].t <= now_ms) {
+        const source_t *s = &src[next_src++];
+        if (s->type == IMU_EVENT_WINDOW) {
+            if (window_posted) {
+                coalesced++;                    // The queued one will drain this window too
+                continue;
+            }
+            window_posted = true;
+            post(s->t, s->type, posted_windows++);
+        } else {
+            if (s->type == IMU_EVENT_BUTTON) {
+                raw_level[s->arg] = s->level;
+            }
+            post(s->t, s->type, s->arg);
+        }
+    }
+}
+
+static uint32_t port_now(void *ctx)
+{
+    (void)ctx;
+    return (uint32_t)(now_ms / MESH_WHEEL_TICK_MS);
+}
+
+static bool port_wait(void *ctx, mesh_event_t *ev, bool forever, uint32_t deadline)
+{
+    (void)ctx;
+    const uint64_t tick_start = (uint64_t)deadline * MESH_WHEEL_TICK_MS;
+    for (;;) {
+        const uint64_t td = tick_start > now_ms ? tick_start : now_ms;    // Already due: no sleep
+        deliver_sources();
+        if (q_len) {
+            const queued_t *e = &q[q_head];
+            *ev = e->ev;
+            const uint64_t lat = now_ms - e->posted;
+            lat_sum += lat;
+            lat_n++;
+            if (lat > lat_max) {
+                lat_max = lat;
+            }
+            q_head = (q_head + 1) % QUEUE_LEN;
+            q_len--;
+            return true;
+        }
+        const uint64_t ts = next_src < n_src ? src[next_src].t : UINT64_MAX;
+        if (!forever && td <= ts) {
+            if (td >= SIM_MS) {
+                done = true;
+            }
+            now_ms = td;                        // Sleep until the deadline
+            return false;
+        }
+        if (ts >= SIM_MS) {
+            done = true;
+            return false;
+        }
+        now_ms = ts;                            // Sleep until the next interrupt
+    }
+}
+
+// mesh_sched_start() as in ble_mesh_node.c (here always called on the loop)
+static void sched_start(mesh_timer_t *t, uint32_t delay_ms, uint32_t period_ms,
+                        mesh_timer_fn_t fn, void *arg)
+{
+    const int32_t lag = (int32_t)(port_now(NULL) - loop.wheel.now);
+    mesh_wheel_start(&loop.wheel, t, mesh_wheel_ticks(delay_ms) + lag,
+                     period_ms ? mesh_wheel_ticks(period_ms) : 0, fn, arg);
+}
+
+/*
+ * ============================================================================
+ *                         FIRMWARE HANDLERS
+ * ============================================================================
+ */
+static mesh_timer_t stats_timer, button_timer, screen_timer;
+static uint8_t buttons_down;
+static uint32_t presses_reported, windows_handled, next_window_seq, reports;
+static uint64_t next_stall;
+static uint64_t late_max;
+
+// Every timer callback: not early, not later than a tick + the longest handler
+static void check_timing(void)
+{
+    const uint64_t due = (uint64_t)loop.wheel.now * MESH_WHEEL_TICK_MS;
+    if (now_ms < due) {
+        fail("timer ran early", due - now_ms);
+        return;
+    }
+    const uint64_t late = now_ms - due;
+    if (late > late_max) {
+        late_max = late;
+    }
+    const uint64_t limit = MESH_WHEEL_TICK_MS + (sc->stall_ms ? sc->stall_ms : WINDOW_COST_MS);
+    if (late > limit) {
+        fail("timer ran late", late);
+    }
+}
+
+static void report(void *arg)
+{
+    (void)arg;
+    check_timing();
+    reports++;
+    now_ms += REPORT_COST_MS;
+}
+
+static void clear_screen(void *arg)
+{
+    (void)arg;
+    check_timing();
+}
+
+static void buttons_settled(void *arg)
+{
+    (void)arg;
+    check_timing();
+    const uint8_t down = (uint8_t)((raw_level[0] == 0) | ((raw_level[1] == 0) << 1));
+    const uint8_t pressed = down & ~buttons_down;
+    buttons_down = down;
+    presses_reported += (pressed & 1) + ((pressed >> 1) & 1);
+}
+
+static void on_window(const mesh_event_t *ev, void *ctx)
+{
+    (void)ctx;
+    window_posted = false;
+    if (ev->arg != next_window_seq) {
+        fail("window event out of order", ev->arg);
+    }
+    next_window_seq = ev->arg + 1;
+    windows_handled++;
+    if (sc->stall_every_ms && now_ms >= next_stall) {
+        next_stall += sc->stall_every_ms;
+        now_ms += sc->stall_ms;
+    } else {
+        now_ms += WINDOW_COST_MS;
+    }
+}
+
+static void on_button(const mesh_event_t *ev, void *ctx)
+{
+    (void)ev;
+    (void)ctx;
+    sched_start(&button_timer, DEBOUNCE_MS, 0, buttons_settled, NULL);
+}
+
+static void on_provisioned(const mesh_event_t *ev, void *ctx)
+{
+    (void)ev;
+    (void)ctx;
+    sched_start(&screen_timer, SCREEN_MS, 0, clear_screen, NULL);
+}
+
+static void on_configured(const mesh_event_t *ev, void *ctx)
+{
+    (void)ev;
+    (void)ctx;
+}
+
+/*
+ * ============================================================================
+ *                         SCENARIO
+ * ============================================================================
+ */
+static int cmp_source(const void *a, const void *b)
+{
+    const source_t *x = a, *y = b;
+    return (x->t > y->t) - (x->t < y->t);
+}
+
+static void add_source(uint64_t t, uint8_t type, uint32_t arg, int8_t level)
+{
+    if (n_src < MAX_SOURCES) {
+        src[n_src++] = (source_t){ t, type, arg, level };
+    }
+}
+
+static void build_sources(void)
+{
+    n_src = next_src = 0;
+    if (sc->window_ms) {
+        for (uint64_t t = sc->window_ms; t < SIM_MS; t += sc->window_ms) {
+            add_source(t, IMU_EVENT_WINDOW, 0, 0);
+        }
+    }
+    add_source(8000, MESH_EVENT_PROVISIONED, 0x0005, 0);
+    add_source(9000, MESH_EVENT_CONFIGURED, 0, 0);
+
+    // Presses spread over the run, alternating A / B, each edge bouncing
+    for (uint32_t p = 0; p < PRESSES; p++) {
+        const uint32_t pin = p & 1;
+        uint64_t t = (uint64_t)(p + 1) * (SIM_MS / (PRESSES + 1)) + rng() % 5000;
+        const uint32_t bounces = 1 + rng() % 3;
+        for (uint32_t b = 0; b < bounces; b++) {        // Down, up, down, ... ends down
+            add_source(t, IMU_EVENT_BUTTON, pin, 0);
+            t += 1 + rng() % 2;
+            add_source(t, IMU_EVENT_BUTTON, pin, 1);
+            t += 1 + rng() % 2;
+        }
+        add_source(t, IMU_EVENT_BUTTON, pin, 0);
+        t += 80 + rng() % 300;                          // Held
+        add_source(t, IMU_EVENT_BUTTON, pin, 1);
+        t += 1 + rng() % 2;
+        add_source(t, IMU_EVENT_BUTTON, pin, 0);        // Release bounce
+        t += 1 + rng() % 2;
+        add_source(t, IMU_EVENT_BUTTON, pin, 1);
+    }
+    qsort(src, n_src, sizeof(src[0]), cmp_source);
+}
+
+static void run_scenario(const scenario_t *s)
+{
+    sc = s;
+    now_ms = 0;
+    done = false;
+    q_head = q_len = q_max = 0;
+    window_posted = false;
+    raw_level[0] = raw_level[1] = 1;
+    buttons_down = 0;
+    errors = dropped = coalesced = posted_windows = 0;
+    lat_sum = lat_max = late_max = 0;
+    lat_n = 0;
+    presses_reported = windows_handled = next_window_seq = reports = 0;
+    next_stall = s->stall_every_ms;
+    memset(&stats_timer, 0, sizeof(stats_timer));
+    memset(&button_timer, 0, sizeof(button_timer));
+    memset(&screen_timer, 0, sizeof(screen_timer));
+    build_sources();
+
+    const mesh_evloop_port_t port = { port_wait, port_now, NULL, NULL, NULL };
+    mesh_evloop_init(&loop, &port);
+    mesh_evloop_on(&loop, MESH_EVENT_PROVISIONED, on_provisioned, NULL);
+    mesh_evloop_on(&loop, MESH_EVENT_CONFIGURED, on_configured, NULL);
+    mesh_evloop_on(&loop, IMU_EVENT_WINDOW, on_window, NULL);
+    mesh_evloop_on(&loop, IMU_EVENT_BUTTON, on_button, NULL);
+    sched_start(&stats_timer, STATS_MS, STATS_MS, report, NULL);
+
+    // A turn that wakes on a deadline must find a timer due on the next one
+    uint32_t idle_wakeups = 0;
+    bool expect_timer = false;
+    while (!done) {
+        const uint32_t fired = loop.wheel.fired;
+        const uint32_t events = loop.events;
+        mesh_evloop_run_once(&loop);
+        if (expect_timer && loop.wheel.fired == fired) {
+            idle_wakeups++;
+        }
+        expect_timer = !done && loop.events == events;
+    }
+
+    if (idle_wakeups) {
+        fail("wakeups with nothing to do", idle_wakeups);
+    }
+    if (dropped) {
+        fail("events dropped on a full queue", dropped);
+    }
+    if (presses_reported != PRESSES) {
+        fail("button presses reported", presses_reported);
+    }
+    if (loop.unhandled) {
+        fail("unhandled events", loop.unhandled);
+    }
+
+    // Previous design: app_main M5.update() poll, publisher task woken per
+    // window (task notifications coalesce the same way), scheduler task
+    const double secs = SIM_MS / 1000.0;
+    const double old_rate = (SIM_MS / 100 + windows_handled + loop.wheel.batches) / secs;
+    printf("%-22s  %8.2f  %8.2f  %6u  %5u  %9u  %3zu  %5.1f / %3llu  %4llu\n", s->name,
+           old_rate, loop.wakeups / secs, loop.events, coalesced, presses_reported, q_max,
+           lat_n ? (double)lat_sum / lat_n : 0.0, (unsigned long long)lat_max,
+           (unsigned long long)late_max);
+}
+
+int main(void)
+{
+    printf("Node event loop, %u minutes per scenario, %u button presses\n\n",
+           SIM_MS / 60000, PRESSES);
+    printf("                        wakeups/s           events  coal-  presses    max  latency ms  timer\n");
+    printf("scenario                previous  one loop          esced  reported   queue  avg / max  late\n");
+    printf("----------------------  --------  --------  ------  -----  ---------  ---  ---------  ----\n");
+    uint32_t total_errors = 0;
+    for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        run_scenario(&scenarios[i]);
+        total_errors += errors;
+    }
+    printf("\n(previous: 3 tasks - app_main 4096 B, imu_publish 4096 B, mesh_sched 3072 B stacks;\n"
+           " one loop: mesh_loop 6144 B, app_main returns.\n"
+           " The 200 Hz sampler task is the same in both.)\n");
+    if (total_errors) {
+        printf("\n%u error(s)\n", total_errors);
+        return 1;
+    }
+    return 0;
+}
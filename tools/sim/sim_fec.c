@@ -0,0 +1,180 @@
+/*
+ * ============================================================================
+ *                    HOST SIMULATOR - XOR PARITY OVER A LOSSY CHANNEL
+ * ============================================================================
+ *
+ * Sends a 10 Hz stream of legacy 8-byte frames through Gilbert-Elliott
+ * loss channels (imu_loss.h), with and without imu_fec.h parity, and
+ * reports for each group size K:
+ * - Airtime overhead (extra messages per data frame)
+ * - Residual loss after repair (what the application actually misses)
+ * - Frames repaired, groups lost for good (2+ losses, or a loss + a lost parity)
+ * - Repair correctness (a repaired frame must equal the original)
+ *
+ * Baseline: "send twice" (every frame duplicated, 100% overhead). On a
+ * bursty channel both copies tend to die together.
+ *
+ * One "message" here is one access message after the mesh's own network
+ * retransmissions - the loss rates are end-to-end, as seen by the gateway.
+ *
+ * Usage:
+ *   sim_fec [trace.csv] [frames]
+ *
+ * Build and run: see tools/README.md
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "imu_fec.h"
+#include "imu_loss.h"
+#include "imu_trace.h"
+
+#define DECIM   20          // 200 Hz trace → 10 Hz frames
+
+typedef struct {
+    const char *label;
+    double p_gb, p_bg, loss_good, loss_bad;
+} channel_config_t;
+
+typedef struct {
+    size_t data, sent, delivered, repaired, wrong;
+    uint32_t unrecoverable;
+} sim_result_t;
+
+// Same packing as publish_imu_data() in main/m5stick_mesh_imu.cpp
+static void legacy_frame(const imu_sample_t *s, uint16_t t_ms, uint8_t *f)
+{
+    f[0] = (uint8_t)(t_ms & 0xFF);
+    f[1] = (uint8_t)(t_ms >> 8);
+    for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+        int32_t q = s->v[a] / 100;
+        f[2 + a] = (uint8_t)(int8_t)(q > 127 ? 127 : q < -128 ? -128 : q);
+    }
+}
+
+// k = 0: plain stream, k = 1: send every frame twice, k >= 2: XOR parity
+static sim_result_t simulate(const uint8_t (*frames)[IMU_FRAME_MAX], size_t n,
+                             const channel_config_t *cc, uint8_t k)
+{
+    sim_result_t r = { 0 };
+    imu_loss_channel_t ch;
+    imu_loss_init(&ch, cc->p_gb, cc->p_bg, cc->loss_good, cc->loss_bad, 42);
+
+    imu_fec_encoder_t enc;
+    imu_fec_decoder_t dec;
+    imu_fec_encoder_init(&enc, k >= 2 ? k : 0);
+    imu_fec_decoder_init(&dec);
+
+    // Which frames the gateway has (by index), to score repairs
+    bool *have = calloc(n, sizeof(bool));
+    if (!have) {
+        return r;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        const uint8_t *f = frames[i];
+        r.data++;
+
+        r.sent++;
+        bool got = !imu_loss_drop(&ch);
+        if (k == 1) {
+            r.sent++;
+            got = !imu_loss_drop(&ch) || got;
+        }
+        if (got) {
+            have[i] = true;
+            imu_fec_decode(&dec, IMU_OP_DATA, f, IMU_FRAME_MAX, NULL, NULL);
+        }
+
+        uint32_t pop;
+        uint8_t parity[IMU_FRAME_MAX];
+        size_t plen = imu_fec_encode(&enc, IMU_OP_DATA, f, IMU_FRAME_MAX, &pop, parity);
+        if (plen == 0) {
+            continue;
+        }
+        r.sent++;
+        if (imu_loss_drop(&ch)) {
+            continue;
+        }
+        uint32_t rop;
+        uint8_t rec[IMU_FRAME_MAX];
+        if (imu_fec_decode(&dec, pop, parity, plen, &rop, rec) == 0) {
+            continue;
+        }
+        // Locate the frame the repair claims to be: the missing one of this group
+        size_t first = i + 1 - k;
+        size_t lost = first;
+        while (lost <= i && have[lost]) {
+            lost++;
+        }
+        if (lost <= i && rop == IMU_OP_DATA && memcmp(rec, frames[lost], IMU_FRAME_MAX) == 0) {
+            have[lost] = true;
+            r.repaired++;
+        } else {
+            r.wrong++;
+        }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        r.delivered += have[i];
+    }
+    r.unrecoverable = dec.unrecoverable;
+    free(have);
+    return r;
+}
+
+int main(int argc, char **argv)
+{
+    imu_trace_t tr;
+    size_t n = (argc > 2) ? (size_t)atol(argv[2]) : 100000;
+    if (imu_trace_open(argc > 1 ? argv[1] : NULL, &tr, n * DECIM, 200) != 0) {
+        return 1;
+    }
+    if (n > tr.count / DECIM) {
+        n = tr.count / DECIM;
+    }
+
+    uint8_t (*frames)[IMU_FRAME_MAX] = malloc(n * IMU_FRAME_MAX);
+    if (!frames) {
+        return 1;
+    }
+    for (size_t i = 0; i < n; i++) {
+        legacy_frame(&tr.samples[i * DECIM], (uint16_t)(i * 100), frames[i]);
+    }
+    printf("%zu frames at 10 Hz (%s)\n", n, argc > 1 ? argv[1] : "synthetic");
+
+    static const channel_config_t channels[] = {
+        { "iid 2%",                      0.0,   1.0,  0.02, 0.0 },
+        { "iid 10%",                     0.0,   1.0,  0.10, 0.0 },
+        { "bursty ~5%, bursts of 2",     0.03,  0.5,  0.01, 0.80 },
+        { "bursty ~10%, bursts of 4",    0.035, 0.25, 0.02, 0.70 },
+    };
+    static const uint8_t ks[] = { 0, 1, 2, 3, 4, 8 };
+
+    int ret = 0;
+    for (size_t c = 0; c < sizeof(channels) / sizeof(channels[0]); c++) {
+        imu_loss_channel_t probe;
+        imu_loss_init(&probe, channels[c].p_gb, channels[c].p_bg,
+                      channels[c].loss_good, channels[c].loss_bad, 1);
+        printf("\nChannel: %s (mean loss %.1f%%)\n", channels[c].label,
+               100.0 * imu_loss_mean(&probe));
+        printf("  scheme       airtime  residual loss  repaired  unrecoverable groups\n");
+        for (size_t j = 0; j < sizeof(ks); j++) {
+            sim_result_t r = simulate((const uint8_t (*)[IMU_FRAME_MAX])frames, n, &channels[c], ks[j]);
+            char label[16];
+            if (ks[j] == 0) snprintf(label, sizeof(label), "none");
+            else if (ks[j] == 1) snprintf(label, sizeof(label), "send twice");
+            else snprintf(label, sizeof(label), "parity K=%u", ks[j]);
+            printf("  %-11s  %+6.1f%%  %12.2f%%  %8zu  %8u%s\n", label,
+                   100.0 * ((double)r.sent / (double)r.data - 1.0),
+                   100.0 * (1.0 - (double)r.delivered / (double)r.data),
+                   r.repaired, r.unrecoverable, r.wrong ? "  WRONG REPAIRS" : "");
+            ret |= r.wrong ? 1 : 0;
+        }
+    }
+
+    free(frames);
+    imu_trace_free(&tr);
+    return ret;
+}
@@ -0,0 +1,730 @@
+/*
+ * ============================================================================
+ *                    HOST SIMULATOR - RELAY ELECTION
+ * ============================================================================
+ *
+ * Sticks spread over a floor stream legacy frames to a gateway at one edge.
+ * Which sticks relay:
+ *
+ *   none        no stick (the node's default before the election)
+ *   all         every stick
+ *   planned k   the relay election (imu_topology.h, the component's code):
+ *               sticks report what they hear every 30 s, the gateway plans
+ *               every 30 s and sends the relay set; k = 1 or 2 relays (or
+ *               the gateway) in range of every stick
+ *
+ * The election runs on the simulated mesh itself: reports and relay sets
+ * are segmented messages that need every segment, and only travel over the
+ * relays chosen so far. Delivery and transmissions are measured from
+ * MEASURE_US on, once the set has settled.
+ *
+ * Radio model (as sim_aggregate where the two overlap):
+ * - placement per layout, log-distance path loss: RSSI = -55 dBm at 1 m,
+ *   exponent 2.5, shadowing N(0, 4 dB) per link (+ N(0, 1 dB) per
+ *   direction), N(0, 2 dB) per reception on top
+ * - a reception succeeds with 1 / (1 + exp(-(RSSI + 93) / 1.5)): 50 % at
+ *   -93 dBm, 96 % at -88 dBm. Links above -98 dBm interfere
+ * - one transmission = AIR_US; every PDU goes out NET_XMIT times,
+ *   XMIT_GAP_US + U(0, 10 ms) apart, the first after U(0, 10 ms); one PDU at
+ *   a time from a queue of ADV_BUFS, drops beyond
+ * - a reception fails when the receiver transmits or hears a second
+ *   transmission at the same time
+ * - relays forward each new network PDU once with TTL - 1 (message cache);
+ *   the gateway doesn't relay
+ *
+ * Reported per layout and mode: frames delivered (overall and the worst
+ * stick), transmissions per delivered frame (every copy on every node,
+ * reports and relay sets included), relays, and when the plan last changed.
+ *
+ * Checks - any failure fails the run: report and relay set round trips,
+ * and on 2000 random graphs every planned relay set covers every reachable
+ * node, hangs together through the gateway, and comes out the same when
+ * the reports arrive in another order. The plan size is compared with the
+ * brute-force optimum.
+ *
+ * Usage:
+ *   sim_relay
+ *
+ * Build and run: see tools/README.md
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "imu_topology.h"
+
+#define TICK_US         50
+#define RUN_US          300000000LL
+#define MEASURE_US      180000000LL     // Streaming measured from here on
+#define GEN_END_US      (RUN_US - 2000000LL)
+#define AIR_US          1100
+#define NET_XMIT        3
+#define XMIT_GAP_US     20000
+#define XMIT_JITTER_US  10000
+#define ADV_BUFS        60
+#define PERIOD_US       1000000LL       // 1 Hz per stick
+#define REPORT_US       30000000LL      // IMU_TOPO_REPORT_MS in the firmware
+#define PLAN_US         30000000LL
+#define NEIGHBOUR_AGE_MS 90000
+#define SEG_DATA        12
+#define UNSEG_ACCESS    11              // Opcode + payload that fit one PDU
+#define TTL             7
+#define FIRST_ADDR      2               // Stick unicast addresses (1 = gateway)
+#define GATEWAY_ADDR    1
+#define MAX_NODES       32
+#define MAX_NET         65536
+#define MAX_FRAMES      16384
+#define MAX_CTRL        2048
+#define HEAR_DBM        (-98.0)
+
+static uint32_t rng = 0x13579BDu;
+
+static double uniform(void)
+{
+    // xorshift32 → [0, 1)
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return (double)rng / 4294967296.0;
+}
+
+static double gauss(void)
+{
+    const double u = uniform() + 1e-12, v = uniform();
+    return sqrt(-2.0 * log(u)) * cos(6.283185307179586 * v);
+}
+
+/*
+ * ============================================================================
+ *                         1. FORMATS AND PLANNER
+ * ============================================================================
+ */
+
+static int check_formats(void)
+{
+    int failures = 0;
+    for (int trial = 0; trial < 2000; trial++) {
+        imu_topo_table_t t;
+        imu_topo_table_init(&t);
+        const int heard = (int)(uniform() * 40);
+        for (int i = 0; i < heard; i++) {
+            imu_topo_observe(&t, (uint16_t)(FIRST_ADDR + uniform() * 24),
+                             (int8_t)(-40 - uniform() * 60), (uint32_t)i * 100);
+        }
+        uint8_t buf[IMU_TOPO_REPORT_LEN_MAX];
+        const size_t cap = (trial & 1) ? sizeof(buf) : 3 + (size_t)(uniform() * 40);
+        const size_t len = imu_topo_report_pack(&t, TTL, trial & 2, NULL, buf, cap);
+        imu_topo_report_t r;
+        if (len == 0 || len > cap || !imu_topo_report_unpack(buf, len, &r) ||
+            r.ttl != TTL || r.relaying != ((trial & 2) != 0)) {
+            failures++;
+            continue;
+        }
+        // Strongest first, no neighbour twice, what the table holds
+        for (uint8_t i = 0; i < r.count; i++) {
+            bool found = false;
+            for (uint8_t j = 0; j < t.count; j++) {
+                found |= t.n[j].addr == r.link[i].addr && t.n[j].rssi_x16 / 16 == r.link[i].rssi;
+            }
+            for (uint8_t j = 0; j < i; j++) {
+                found &= r.link[j].addr != r.link[i].addr;
+            }
+            if (!found || (i > 0 && r.link[i].rssi > r.link[i - 1].rssi)) {
+                failures++;
+                break;
+            }
+        }
+        if (r.count < IMU_TOPO_REPORT_MAX && r.count < t.count && len + 3 <= cap) {
+            failures++;                     // Room left, neighbours left out
+        }
+        if (imu_topo_report_unpack(buf, len - 1, &r)) {
+            failures++;
+        }
+
+        imu_topo_plan_t p = { .count = (uint8_t)(uniform() * (IMU_TOPO_MAX_RELAYS + 1)) }, q;
+        for (uint8_t i = 0; i < p.count; i++) {
+            p.relay[i] = (uint16_t)(1 + uniform() * 0x7FFE);
+        }
+        uint8_t set[IMU_TOPO_SET_LEN_MAX], id;
+        const size_t slen = imu_topo_relay_set_pack(&p, (uint8_t)trial, set, sizeof(set));
+        if (slen == 0 || !imu_topo_relay_set_unpack(set, slen, &id, &q) || id != (uint8_t)trial ||
+            q.count != p.count || memcmp(q.relay, p.relay, p.count * sizeof(p.relay[0])) ||
+            imu_topo_relay_set_unpack(set, slen - 1, &id, &q)) {
+            failures++;
+        }
+    }
+    return failures;
+}
+
+// Planner view of a random floor: n nodes, node 0 = gateway
+typedef struct {
+    int n;
+    double rssi[MAX_NODES][MAX_NODES];  // Heard by [rx] from [tx]
+} floor_t;
+
+static void random_floor(floor_t *f, int n, double side)
+{
+    double x[MAX_NODES], y[MAX_NODES];
+    f->n = n;
+    for (int i = 0; i < n; i++) {
+        x[i] = i ? uniform() * side : 0.0;
+        y[i] = i ? uniform() * side : 0.0;
+    }
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < i; j++) {
+            const double d = fmax(1.0, hypot(x[i] - x[j], y[i] - y[j]));
+            const double m = -55.0 - 25.0 * log10(d) + 4.0 * gauss();
+            f->rssi[i][j] = m + gauss();
+            f->rssi[j][i] = m + gauss();
+        }
+    }
+}
+
+// The graph the gateway builds from every node's report, in the given order
+static void floor_graph(const floor_t *f, const int *order, imu_topo_graph_t *g)
+{
+    imu_topo_graph_init(g, GATEWAY_ADDR);
+    for (int k = 0; k < f->n; k++) {
+        const int i = order[k];
+        imu_topo_report_t r = { TTL, false, 0, {{0, 0}} };
+        for (int j = 0; j < f->n && r.count < IMU_TOPO_REPORT_MAX; j++) {
+            if (j != i && f->rssi[i][j] >= HEAR_DBM) {
+                r.link[r.count].addr = (uint16_t)(j ? FIRST_ADDR + j - 1 : GATEWAY_ADDR);
+                r.link[r.count++].rssi = (int8_t)lround(f->rssi[i][j]);
+            }
+        }
+        if (i == 0) {
+            for (uint8_t l = 0; l < r.count; l++) {
+                imu_topo_graph_link(g, GATEWAY_ADDR, r.link[l].addr, r.link[l].rssi);
+            }
+        } else {
+            imu_topo_graph_report(g, (uint16_t)(FIRST_ADDR + i - 1), &r);
+        }
+    }
+}
+
+// Usable links of g as the planner sees them, indexed like g
+static void usable(const imu_topo_graph_t *g, bool adj[MAX_NODES][MAX_NODES])
+{
+    for (int i = 0; i < g->count; i++) {
+        for (int j = 0; j < g->count; j++) {
+            int a = g->rssi[i][j], b = g->rssi[j][i];
+            if (a == IMU_TOPO_NO_LINK) a = b;
+            if (b == IMU_TOPO_NO_LINK) b = a;
+            adj[i][j] = i != j && a != IMU_TOPO_NO_LINK && (a < b ? a : b) >= IMU_TOPO_RSSI_MIN;
+        }
+    }
+}
+
+// Does the set (bit per graph index, bit 0 = gateway always) cover every
+// node reachable from the gateway, and hang together through it?
+static bool covers(int n, bool adj[MAX_NODES][MAX_NODES], uint32_t set, int cover, int *short_cover)
+{
+    bool reached[MAX_NODES] = { true }, linked[MAX_NODES] = { true };
+    for (int round = 0; round < n; round++) {
+        for (int u = 0; u < n; u++) {
+            for (int v = 0; v < n; v++) {
+                if (adj[u][v] && reached[u]) reached[v] = true;
+                if (adj[u][v] && linked[u] && (set & (1u << v))) linked[v] = true;
+            }
+        }
+    }
+    bool ok = true;
+    *short_cover = 0;
+    for (int u = 1; u < n; u++) {
+        if ((set & (1u << u)) && !linked[u]) {
+            ok = false;                     // A relay cut off from the gateway
+        }
+        int in_range = 0;
+        for (int d = 0; d < n; d++) {
+            in_range += adj[u][d] && (set & (1u << d));
+        }
+        if (reached[u] && in_range == 0) {
+            ok = false;
+        }
+        if (reached[u] && in_range < cover) {
+            (*short_cover)++;
+        }
+    }
+    return ok;
+}
+
+static uint32_t plan_bits(const imu_topo_graph_t *g, const imu_topo_plan_t *p)
+{
+    uint32_t set = 1;
+    for (int i = 1; i < g->count; i++) {
+        set |= imu_topo_is_relay(p, g->addr[i]) ? 1u << i : 0;
+    }
+    return set;
+}
+
+static int check_planner(void)
+{
+    int failures = 0, trials = 0, optimal = 0, plus1 = 0;
+    double greedy_sum = 0.0, best_sum = 0.0, k2_sum = 0.0;
+
+    for (int trial = 0; trial < 2000; trial++) {
+        floor_t f;
+        const int n = 6 + (int)(uniform() * 8);
+        random_floor(&f, n, 25.0 + uniform() * 35.0);
+        int order[MAX_NODES];
+        for (int i = 0; i < n; i++) {
+            order[i] = i;
+        }
+        imu_topo_graph_t g, h;
+        floor_graph(&f, order, &g);
+        for (int i = n - 1; i > 0; i--) {
+            const int j = (int)(uniform() * (i + 1)), s = order[i];
+            order[i] = order[j];
+            order[j] = s;
+        }
+        floor_graph(&f, order, &h);
+
+        bool adj[MAX_NODES][MAX_NODES];
+        usable(&g, adj);
+        for (int k = 1; k <= 2; k++) {
+            imu_topo_plan_t p, q;
+            imu_topo_plan(&g, IMU_TOPO_RSSI_MIN, (uint8_t)k, NULL, &p);
+            imu_topo_plan(&h, IMU_TOPO_RSSI_MIN, (uint8_t)k, NULL, &q);
+            int short_cover;
+            const uint32_t set = plan_bits(&g, &p);
+            bool same = p.count == q.count;
+            for (uint8_t i = 0; i < p.count; i++) {
+                same &= imu_topo_is_relay(&q, p.relay[i]);
+            }
+            if (!covers(g.count, adj, set, k, &short_cover) || short_cover != p.short_cover || !same) {
+                failures++;
+            }
+            if (k == 2) {
+                k2_sum += p.count;
+                continue;
+            }
+
+            // Brute force: the fewest relays that also cover
+            int best = p.count;
+            for (uint32_t s = 0; s < (1u << (g.count - 1)); s++) {
+                const int bits = __builtin_popcount(s);
+                int sc;
+                if (bits < best && covers(g.count, adj, (s << 1) | 1, 1, &sc)) {
+                    best = bits;
+                }
+            }
+            trials++;
+            greedy_sum += p.count;
+            best_sum += best;
+            optimal += (p.count == best);
+            plus1 += (p.count <= best + 1);
+        }
+    }
+    printf("   planner: %d random floors of 6..13 nodes, relays k = 1: %.2f (optimum %.2f),\n"
+           "            optimal in %.1f%%, at most one more in %.1f%%; k = 2: %.2f relays\n",
+           trials, greedy_sum / trials, best_sum / trials, 100.0 * optimal / trials,
+           100.0 * plus1 / trials, k2_sum / trials);
+    return failures;
+}
+
+/*
+ * ============================================================================
+ *                         2. NETWORK
+ * ============================================================================
+ */
+
+enum { PDU_FRAME, PDU_REPORT, PDU_SET };
+enum { MODE_NONE, MODE_ALL, MODE_K1, MODE_K2 };
+
+typedef struct {
+    uint8_t kind, ttl, seg, segs, origin;
+    uint32_t net;                       // Network PDU id (relay cache)
+    uint32_t ref;                       // Frame id / control message id
+} pdu_t;
+
+typedef struct {
+    pdu_t q[ADV_BUFS];
+    int head, count;
+    int copies;                         // Copies of q[head] still to send
+    bool delayed;                       // First copy waits its advDelay
+    int64_t next_tx;
+    bool on_air;
+    int64_t tx_end;
+    uint32_t corrupt;                   // Receivers that lose this transmission
+    bool last_copy;
+    bool relay;
+    imu_topo_plan_t relays;             // Last relay set received
+    imu_topo_table_t table;
+} node_t;
+
+typedef struct {
+    const char *name;
+    uint8_t sticks;
+    uint8_t clusters;                   // 0 = uniform over w × h
+    double w, h;
+    uint32_t seed;
+} layout_t;
+
+typedef struct {
+    uint32_t generated, delivered, tx, adv_drops, relays, plans, set_changes;
+    double worst;                       // Worst stick's delivery
+    double settled_s;                   // Last plan change
+    int failures;
+} result_t;
+
+static node_t nodes[MAX_NODES];
+static double link_dbm[MAX_NODES][MAX_NODES];   // Mean RSSI at [rx] from [tx]
+static uint32_t hears[MAX_NODES];               // Bit x: node x can hear this node
+static uint8_t seen[MAX_NODES][MAX_NET / 8];
+static uint8_t frame_origin[MAX_FRAMES];
+static int64_t frame_gen[MAX_FRAMES];
+static bool frame_got[MAX_FRAMES];
+static uint32_t net_count, frame_count, ctrl_count;
+
+static uint8_t ctrl_buf[MAX_CTRL][IMU_TOPO_REPORT_LEN_MAX];
+static uint8_t ctrl_len[MAX_CTRL];
+static uint8_t ctrl_rx[MAX_NODES][MAX_CTRL];    // Segments received, bit per segment
+
+static imu_topo_graph_t graph;
+static int sticks, gateway;
+
+static uint16_t addr_of(int n)
+{
+    return (n == gateway) ? GATEWAY_ADDR : (uint16_t)(FIRST_ADDR + n);
+}
+
+static void enqueue(int n, pdu_t p, result_t *r)
+{
+    node_t *nd = &nodes[n];
+    seen[n][p.net / 8] |= (uint8_t)(1u << (p.net % 8));     // Own PDUs don't come back
+    if (nd->count == ADV_BUFS) {
+        r->adv_drops++;
+        return;
+    }
+    nd->q[(nd->head + nd->count) % ADV_BUFS] = p;
+    nd->count++;
+}
+
+// Segments of a control message: one PDU if it fits, else SAR segments
+static uint8_t segments(size_t len)
+{
+    const size_t access = len + 3;
+    return (access <= UNSEG_ACCESS) ? 1 : (uint8_t)((access + 4 + SEG_DATA - 1) / SEG_DATA);
+}
+
+static void send_ctrl(int n, uint8_t kind, const uint8_t *buf, size_t len, result_t *r)
+{
+    if (ctrl_count >= MAX_CTRL) {
+        r->failures++;
+        return;
+    }
+    const uint32_t id = ctrl_count++;
+    memcpy(ctrl_buf[id], buf, len);
+    ctrl_len[id] = (uint8_t)len;
+    const uint8_t segs = segments(len);
+    for (uint8_t s = 0; s < segs; s++) {
+        pdu_t p = { kind, TTL, s, segs, (uint8_t)n, net_count++, id };
+        enqueue(n, p, r);
+    }
+}
+
+static void receive(int x, const pdu_t *p, double dbm, int64_t t, result_t *r)
+{
+    if (seen[x][p->net / 8] & (1u << (p->net % 8))) {
+        return;
+    }
+    seen[x][p->net / 8] |= (uint8_t)(1u << (p->net % 8));
+
+    if (x != gateway && nodes[x].relay && p->ttl >= 2) {
+        pdu_t fwd = *p;
+        fwd.ttl--;
+        enqueue(x, fwd, r);
+    }
+
+    if (p->kind == PDU_FRAME) {
+        if (x == gateway) {
+            frame_got[p->ref] = true;
+        }
+        return;
+    }
+
+    // Control messages: complete once every segment is in
+    const uint32_t all = (1u << p->segs) - 1;
+    if (ctrl_rx[x][p->ref] == all) {
+        return;
+    }
+    ctrl_rx[x][p->ref] |= (uint8_t)(1u << p->seg);
+    if (ctrl_rx[x][p->ref] != all) {
+        return;
+    }
+    const uint8_t *buf = ctrl_buf[p->ref];
+    const size_t len = ctrl_len[p->ref];
+
+    if (p->kind == PDU_REPORT) {
+        imu_topo_report_t rep;
+        if (!imu_topo_report_unpack(buf, len, &rep)) {
+            r->failures++;
+            return;
+        }
+        const bool direct = (p->ttl == rep.ttl);
+        const int8_t rssi = (int8_t)lround(fmax(-127.0, dbm));
+        if (x == gateway) {
+            imu_topo_graph_report(&graph, addr_of(p->origin), &rep);
+            if (direct) {
+                imu_topo_graph_link(&graph, GATEWAY_ADDR, addr_of(p->origin), rssi);
+            }
+        } else if (direct) {
+            imu_topo_observe(&nodes[x].table, addr_of(p->origin), rssi, (uint32_t)(t / 1000));
+        }
+    } else if (p->kind == PDU_SET && x != gateway) {
+        imu_topo_plan_t set;
+        uint8_t plan_id;
+        if (!imu_topo_relay_set_unpack(buf, len, &plan_id, &set)) {
+            r->failures++;
+            return;
+        }
+        nodes[x].relays = set;
+        nodes[x].relay = imu_topo_is_relay(&set, addr_of(x));
+    }
+}
+
+static void place(const layout_t *lay)
+{
+    double x[MAX_NODES], y[MAX_NODES];
+    for (int i = 0; i < sticks; i++) {
+        if (lay->clusters) {
+            // Cluster centres spread along the floor, 5 m around each
+            const int c = i % lay->clusters;
+            const double cx = lay->w * (c + 1) / (lay->clusters + 0.3);
+            const double a = uniform() * 6.283185307179586, d = 5.0 * sqrt(uniform());
+            x[i] = cx + d * cos(a);
+            y[i] = lay->h / 2 + d * sin(a);
+        } else {
+            x[i] = 2.0 + uniform() * (lay->w - 2.0);
+            y[i] = uniform() * lay->h;
+        }
+    }
+    x[gateway] = 0.0;
+    y[gateway] = lay->h / 2;
+
+    memset(hears, 0, sizeof(hears));
+    for (int i = 0; i <= gateway; i++) {
+        for (int j = 0; j < i; j++) {
+            const double d = fmax(1.0, hypot(x[i] - x[j], y[i] - y[j]));
+            const double m = -55.0 - 25.0 * log10(d) + 4.0 * gauss();
+            link_dbm[i][j] = m + gauss();
+            link_dbm[j][i] = m + gauss();
+            if (link_dbm[i][j] >= HEAR_DBM) hears[j] |= 1u << i;
+            if (link_dbm[j][i] >= HEAR_DBM) hears[i] |= 1u << j;
+        }
+    }
+}
+
+static result_t run(const layout_t *lay, int mode)
+{
+    result_t r;
+    memset(&r, 0, sizeof(r));
+    memset(nodes, 0, sizeof(nodes));
+    memset(seen, 0, sizeof(seen));
+    memset(ctrl_rx, 0, sizeof(ctrl_rx));
+    net_count = frame_count = ctrl_count = 0;
+
+    // The same floor for every mode
+    rng = lay->seed;
+    sticks = lay->sticks;
+    gateway = sticks;
+    place(lay);
+    const int total = sticks + 1;
+
+    imu_topo_graph_init(&graph, GATEWAY_ADDR);
+    for (int s = 0; s < sticks; s++) {
+        nodes[s].relay = (mode == MODE_ALL);
+        imu_topo_table_init(&nodes[s].table);
+    }
+    const bool elect = (mode == MODE_K1 || mode == MODE_K2);
+
+    int64_t next_frame[MAX_NODES], next_report[MAX_NODES];
+    for (int s = 0; s < sticks; s++) {
+        next_frame[s] = (int64_t)(uniform() * PERIOD_US);
+        next_report[s] = 1000000LL + (int64_t)(uniform() * REPORT_US);
+    }
+    int64_t next_plan = PLAN_US;
+    imu_topo_plan_t last = { .count = 0 };
+    uint8_t plan_id = 0;
+    uint32_t tx_before = 0, per_gen[MAX_NODES] = {0}, per_got[MAX_NODES] = {0};
+
+    for (int64_t t = 0; t < RUN_US; t += TICK_US) {
+        if (t == MEASURE_US) {
+            tx_before = r.tx;
+        }
+
+        // Transmissions that end: receptions, bearer bookkeeping
+        for (int n = 0; n < total; n++) {
+            node_t *nd = &nodes[n];
+            if (!nd->on_air || t < nd->tx_end) {
+                continue;
+            }
+            nd->on_air = false;
+            const pdu_t p = nd->q[nd->head];
+            for (int x = 0; x < total; x++) {
+                if (!(hears[n] & (1u << x)) || (nd->corrupt & (1u << x))) {
+                    continue;
+                }
+                const double dbm = link_dbm[x][n] + 2.0 * gauss();
+                if (uniform() < 1.0 / (1.0 + exp(-(dbm + 93.0) / 1.5))) {
+                    receive(x, &p, dbm, t, &r);
+                }
+            }
+            if (nd->last_copy) {
+                nd->head = (nd->head + 1) % ADV_BUFS;
+                nd->count--;
+            }
+        }
+
+        // Sticks stream, and report while electing
+        for (int s = 0; s < sticks; s++) {
+            if (t >= next_frame[s] && t < GEN_END_US) {
+                next_frame[s] += PERIOD_US;
+                const uint32_t id = frame_count++;
+                frame_origin[id] = (uint8_t)s;
+                frame_gen[id] = t;
+                frame_got[id] = false;
+                pdu_t p = { PDU_FRAME, TTL, 0, 1, (uint8_t)s, net_count++, id };
+                enqueue(s, p, &r);
+            }
+            if (elect && t >= next_report[s]) {
+                next_report[s] += REPORT_US;
+                imu_topo_expire(&nodes[s].table, (uint32_t)(t / 1000), NEIGHBOUR_AGE_MS);
+                uint8_t buf[IMU_TOPO_REPORT_LEN_MAX];
+                const size_t len = imu_topo_report_pack(&nodes[s].table, TTL, nodes[s].relay,
+                                                        &nodes[s].relays, buf, sizeof(buf));
+                send_ctrl(s, PDU_REPORT, buf, len, &r);
+            }
+        }
+
+        // Gateway: plan, send the set (every time: a lost one is repeated)
+        if (elect && t >= next_plan) {
+            next_plan += PLAN_US;
+            imu_topo_plan_t p;
+            imu_topo_plan(&graph, IMU_TOPO_RSSI_MIN, mode == MODE_K2 ? 2 : 1, &last, &p);
+            bool same = p.count == last.count;
+            for (uint8_t i = 0; i < p.count; i++) {
+                same &= imu_topo_is_relay(&last, p.relay[i]);
+            }
+            if (!same) {
+                plan_id++;
+                r.set_changes++;
+                r.settled_s = t / 1e6;
+                last = p;
+            }
+            uint8_t buf[IMU_TOPO_SET_LEN_MAX];
+            const size_t len = imu_topo_relay_set_pack(&p, plan_id, buf, sizeof(buf));
+            send_ctrl(gateway, PDU_SET, buf, len, &r);
+            r.plans++;
+        }
+
+        // Bearers: start the next copy; collisions and half duplex
+        for (int n = 0; n < total; n++) {
+            node_t *nd = &nodes[n];
+            if (nd->on_air || nd->count == 0 || t < nd->next_tx) {
+                continue;
+            }
+            if (nd->copies == 0 && !nd->delayed) {
+                nd->delayed = true;
+                nd->next_tx = t + (int64_t)(uniform() * XMIT_JITTER_US);
+                continue;
+            }
+            if (nd->copies == 0) {
+                nd->delayed = false;
+                nd->copies = NET_XMIT;
+            }
+            nd->copies--;
+            nd->last_copy = (nd->copies == 0);
+            nd->on_air = true;
+            nd->tx_end = t + AIR_US;
+            nd->corrupt = 0;
+            nd->next_tx = t + (nd->last_copy ? AIR_US
+                                             : XMIT_GAP_US + (int64_t)(uniform() * XMIT_JITTER_US));
+            r.tx++;
+            for (int a = 0; a < total; a++) {
+                if (a == n || !nodes[a].on_air) {
+                    continue;
+                }
+                const uint32_t both = hears[a] & hears[n];
+                nodes[a].corrupt |= both | (1u << n);
+                nd->corrupt |= both | (1u << a);
+            }
+        }
+        if (net_count >= MAX_NET - 64 || frame_count >= MAX_FRAMES - 64) {
+            r.failures++;
+            printf("   FAIL: simulation tables full\n");
+            break;
+        }
+    }
+
+    for (uint32_t id = 0; id < frame_count; id++) {
+        if (frame_gen[id] >= MEASURE_US) {
+            per_gen[frame_origin[id]]++;
+            per_got[frame_origin[id]] += frame_got[id];
+        }
+    }
+    r.worst = 1.0;
+    for (int s = 0; s < sticks; s++) {
+        r.generated += per_gen[s];
+        r.delivered += per_got[s];
+        if (per_gen[s]) {
+            const double d = (double)per_got[s] / per_gen[s];
+            r.worst = (d < r.worst) ? d : r.worst;
+        }
+        r.relays += nodes[s].relay;
+    }
+    r.tx -= tx_before;
+    return r;
+}
+
+static int check_network(void)
+{
+    static const layout_t layouts[] = {
+        { "corridor", 16, 0, 90.0, 4.0, 0x1234567u },
+        { "hall", 24, 0, 45.0, 45.0, 0x2345678u },
+        { "clusters", 18, 3, 70.0, 20.0, 0x3456789u },
+    };
+    static const char *const modes[] = { "none", "all", "planned k=1", "planned k=2" };
+    int failures = 0;
+
+    printf("2. Network: sticks stream 1 Hz to a gateway at the edge, measured %lld..%lld s\n",
+           MEASURE_US / 1000000, RUN_US / 1000000);
+    printf("   %-9s %-12s %9s %7s %9s %7s %8s %9s\n", "layout", "relays", "delivered", "worst",
+           "tx/frame", "relays", "settled", "adv drop");
+    for (size_t l = 0; l < sizeof(layouts) / sizeof(layouts[0]); l++) {
+        for (int mode = MODE_NONE; mode <= MODE_K2; mode++) {
+            const result_t r = run(&layouts[l], mode);
+            char settled[16] = "-";
+            if (mode >= MODE_K1) {
+                snprintf(settled, sizeof(settled), "%.0f s", r.settled_s);
+            }
+            printf("   %-9s %-12s %8.1f%% %6.1f%% %9.2f %7u %8s %9u\n",
+                   mode ? "" : layouts[l].name, modes[mode],
+                   r.generated ? 100.0 * r.delivered / r.generated : 0.0, 100.0 * r.worst,
+                   r.delivered ? (double)r.tx / r.delivered : 0.0, (unsigned)r.relays,
+                   settled, (unsigned)r.adv_drops);
+            if (r.failures) {
+                printf("   FAIL: %d malformed control messages or full tables\n", r.failures);
+                failures += r.failures;
+            }
+        }
+    }
+    printf("   tx/frame = transmissions of every node (all copies, relays, reports, relay\n"
+           "   sets) per delivered frame; settled = last change of the relay set\n");
+    return failures;
+}
+
+int main(void)
+{
+    printf("1. Formats and planner\n");
+    int failures = check_formats();
+    printf("   report / relay set round trips: 2000 random %s\n", failures ? "FAILED" : "ok");
+    const int plan_failures = check_planner();
+    printf("   planned sets cover, connect, independent of report order: %s\n\n",
+           plan_failures ? "FAILED" : "ok");
+    failures += plan_failures;
+    failures += check_network();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,338 @@
+/*
+ * ============================================================================
+ *                    HOST SIMULATOR - MESH TIME SYNCHRONIZATION
+ * ============================================================================
+ *
+ * A gateway sends time-sync beacons (imu_timesync.h) to a handful of nodes,
+ * each with its own crystal, and the simulator measures how well the nodes'
+ * mesh-global timestamps line up:
+ *
+ *   gateway clock ──stamp──▶ adv queue (q, known later) ──▶ relays ──▶ node rx
+ *                             exp, mean 8 ms               3 + U(0,10) ms/hop, U(0,2) ms
+ *
+ *   node clock = boot offset + (1 + skew + wander(t)) × t
+ *                0-20 s        ±40 ppm, ±2 ppm over 10 min
+ *
+ * Every 100 ms (one 10 Hz frame) each node stamps "now" in global time;
+ * the error is that stamp minus the gateway clock. Reported per estimator:
+ * - Pairwise spread p99 / max: max - min error over all nodes at one instant,
+ *   i.e. how far apart the same instant lands in two nodes' frames (µs)
+ * - RMS alignment error per node (about the mesh-wide mean), and what
+ *   the node itself reports (error_us)
+ *
+ * Estimators:
+ *   naive      last beacon's stamp, as received (no correction)
+ *   corrected  last beacon with send-time and hop correction
+ *   tsync      imu_timesync: corrected pairs, weighted LS offset + skew,
+ *              outlier gate, restart on a clock step
+ *
+ * The beacon losses come from imu_loss.h, one channel per node. The gateway
+ * stamp starts 60 s before its 32-bit wrap, so every run crosses it.
+ * Returns nonzero if tsync's p99 spread is worse than "corrected" anywhere,
+ * or if a node never restarts after the gateway clock step.
+ *
+ * Usage:
+ *   sim_timesync
+ *
+ * Build and run: see tools/README.md
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "imu_timesync.h"
+#include "imu_loss.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define NODES           6
+#define DURATION_S      900
+#define WARMUP_S        120         // Not scored: every estimator converging
+#define FRAME_US        100000      // 10 Hz frames
+#define HOP_DELAY_US    8000        // Mean of 3 + U(0,10) ms, as configured on the node
+#define BEACON_TTL      7
+#define GW_START_US     (4294967296.0 - 60e6)
+#define STEP_US         50000       // Gateway clock step (reboot / resync upstream)
+#define STEP_SKIP_S     30          // Not scored after the step
+
+enum { EST_NAIVE, EST_CORRECTED, EST_TSYNC, EST_COUNT };
+
+typedef struct {
+    const char *label;
+    int period_s;
+    double p_gb, p_bg, loss_good, loss_bad;
+    int step_at_s;                  // 0 = no clock step
+} scenario_t;
+
+typedef struct {
+    double boot_us, skew, wander_phase;
+    int hops;
+    imu_loss_channel_t loss;
+    imu_tsync_t ts;
+
+    // naive / corrected: offset = global - local from the last usable beacon
+    double naive_off, corr_off;
+    bool have_prev;                 // Previous beacon received (for corrected)
+    double prev_local, prev_global;
+} node_t;
+
+typedef struct {
+    double *spread[EST_COUNT];
+    size_t n;
+    double sq[EST_COUNT], reported;
+    size_t values;
+    uint32_t min_restarts, used, beacons;
+} sim_result_t;
+
+static uint32_t rng = 0x2468ACEu;
+
+static double uniform(void)
+{
+    // xorshift32 → [0, 1)
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return (double)rng / 4294967296.0;
+}
+
+/*
+ * ============================================================================
+ *                         CLOCKS
+ * ============================================================================
+ */
+
+static double gateway_us(const scenario_t *sc, double t_us)
+{
+    double g = GW_START_US + t_us;
+    if (sc->step_at_s && t_us >= sc->step_at_s * 1e6) {
+        g += STEP_US;
+    }
+    return g;
+}
+
+static double local_us(const node_t *nd, double t_us)
+{
+    // Integral of 1 + skew + 2 ppm × sin(2π t / 600 s + φ)
+    const double w = 2.0 * M_PI / 600e6;
+    return nd->boot_us + t_us * (1.0 + nd->skew) +
+           2e-6 / w * (cos(nd->wander_phase) - cos(w * t_us + nd->wander_phase));
+}
+
+/*
+ * ============================================================================
+ *                         SIMULATION
+ * ============================================================================
+ */
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void deliver(node_t *nd, const imu_tsync_beacon_t *b, double stamp_global,
+                    double rx_true_us)
+{
+    const double l = local_us(nd, rx_true_us);
+
+    nd->naive_off = stamp_global - l;
+
+    // Corrected: the previous beacon's pair, completed by this one
+    if (nd->have_prev && b->prev_corr_us != IMU_TSYNC_CORR_UNKNOWN) {
+        nd->corr_off = nd->prev_global + b->prev_corr_us - nd->prev_local;
+    }
+    nd->have_prev = true;
+    nd->prev_local = l;
+    nd->prev_global = stamp_global + nd->hops * HOP_DELAY_US;
+
+    imu_tsync_feed(&nd->ts, b, (uint8_t)(BEACON_TTL - nd->hops), llround(l));
+}
+
+static sim_result_t simulate(const scenario_t *sc)
+{
+    sim_result_t res;
+    memset(&res, 0, sizeof(res));
+    const size_t ticks = (size_t)DURATION_S * 1000000 / FRAME_US;
+    for (int e = 0; e < EST_COUNT; e++) {
+        res.spread[e] = malloc(ticks * sizeof(double));
+    }
+
+    node_t nodes[NODES];
+    for (int i = 0; i < NODES; i++) {
+        node_t *nd = &nodes[i];
+        memset(nd, 0, sizeof(*nd));
+        nd->boot_us = 20e6 * uniform();
+        nd->skew = (uniform() * 2.0 - 1.0) * 40e-6;
+        nd->wander_phase = 2.0 * M_PI * uniform();
+        nd->hops = i % 3;
+        imu_loss_init(&nd->loss, sc->p_gb, sc->p_bg, sc->loss_good, sc->loss_bad,
+                      1000u + (uint32_t)i);
+        imu_tsync_init(&nd->ts, HOP_DELAY_US);
+    }
+
+    // One beacon per period; every arrival (< 100 ms) lands before the next
+    // beacon, and frames between arrivals see the state as of the last one
+    const double period_us = sc->period_s * 1e6;
+    double prev_queue = -1.0;
+    double next_frame = 0.0;
+    for (uint32_t k = 0; k * period_us < DURATION_S * 1e6; k++) {
+        const double t_send = k * period_us;
+        const double queue = fmin(-8000.0 * log(1.0 - uniform()), 60000.0);
+        const double stamp = gateway_us(sc, t_send);
+
+        imu_tsync_beacon_t b = {
+            .seq = (uint8_t)k,
+            .ttl = BEACON_TTL,
+            .t_us = (uint32_t)(uint64_t)stamp,
+            .prev_corr_us = prev_queue < 0.0 ? IMU_TSYNC_CORR_UNKNOWN
+                                             : (uint16_t)lrint(prev_queue),
+        };
+        prev_queue = queue;
+
+        double arrival[NODES];
+        bool got[NODES];
+        for (int i = 0; i < NODES; i++) {
+            arrival[i] = t_send + queue + 2000.0 * uniform();
+            for (int h = 0; h < nodes[i].hops; h++) {
+                arrival[i] += 3000.0 + 10000.0 * uniform();
+            }
+            got[i] = !imu_loss_drop(&nodes[i].loss);
+            if (!got[i]) {
+                nodes[i].have_prev = false;
+            }
+        }
+
+        // Frames up to the next beacon, delivering this beacon on the way
+        const double t_next = t_send + period_us;
+        for (; next_frame < t_next; next_frame += FRAME_US) {
+            for (int i = 0; i < NODES; i++) {
+                if (got[i] && arrival[i] <= next_frame) {
+                    deliver(&nodes[i], &b, stamp, arrival[i]);
+                    got[i] = false;
+                }
+            }
+
+            const double t = next_frame;
+            const bool skip = t < WARMUP_S * 1e6 ||
+                              (sc->step_at_s && t >= sc->step_at_s * 1e6 &&
+                               t < (sc->step_at_s + STEP_SKIP_S) * 1e6);
+            if (skip) {
+                continue;
+            }
+            const double truth = gateway_us(sc, t);
+            double lo[EST_COUNT], hi[EST_COUNT];
+            for (int e = 0; e < EST_COUNT; e++) {
+                lo[e] = INFINITY;
+                hi[e] = -INFINITY;
+            }
+            double err[NODES][EST_COUNT], mean[EST_COUNT] = { 0 };
+            for (int i = 0; i < NODES; i++) {
+                node_t *nd = &nodes[i];
+                const double l = local_us(nd, t);
+                err[i][EST_NAIVE] = l + nd->naive_off - truth;
+                err[i][EST_CORRECTED] = l + nd->corr_off - truth;
+                err[i][EST_TSYNC] = (double)imu_tsync_to_global(&nd->ts, llround(l)) - truth;
+                for (int e = 0; e < EST_COUNT; e++) {
+                    lo[e] = fmin(lo[e], err[i][e]);
+                    hi[e] = fmax(hi[e], err[i][e]);
+                    mean[e] += err[i][e] / NODES;
+                }
+                res.reported += nd->ts.error_us;
+            }
+            // Alignment: error about the mesh-wide mean (the common receive
+            // latency shifts every node alike and does not misalign frames)
+            for (int i = 0; i < NODES; i++) {
+                for (int e = 0; e < EST_COUNT; e++) {
+                    const double d = err[i][e] - mean[e];
+                    res.sq[e] += d * d;
+                }
+                res.values++;
+            }
+            for (int e = 0; e < EST_COUNT; e++) {
+                res.spread[e][res.n] = hi[e] - lo[e];
+            }
+            res.n++;
+        }
+        for (int i = 0; i < NODES; i++) {
+            if (got[i]) {
+                deliver(&nodes[i], &b, stamp, arrival[i]);
+            }
+        }
+    }
+
+    res.min_restarts = UINT32_MAX;
+    for (int i = 0; i < NODES; i++) {
+        if (nodes[i].ts.restarts < res.min_restarts) {
+            res.min_restarts = nodes[i].ts.restarts;
+        }
+        res.used += nodes[i].ts.used;
+        res.beacons += nodes[i].ts.beacons;
+    }
+    return res;
+}
+
+int main(void)
+{
+    static const scenario_t scenarios[] = {
+        { "1 s beacons, no loss",       1, 0.0,  0.0,  0.0,  0.0, 0 },
+        { "1 s, 20% random loss",       1, 0.0,  0.0,  0.20, 0.0, 0 },
+        { "1 s, bursty loss",           1, 0.05, 0.25, 0.01, 0.8, 0 },
+        { "5 s beacons, no loss",       5, 0.0,  0.0,  0.0,  0.0, 0 },
+        { "5 s, bursty loss",           5, 0.05, 0.25, 0.01, 0.8, 0 },
+        { "1 s, gateway step +50 ms",   1, 0.0,  0.0,  0.0,  0.0, 450 },
+    };
+    static const char *est_names[EST_COUNT] = { "naive", "corrected", "tsync" };
+    int failures = 0;
+
+    printf("%d nodes (0-2 relay hops), %d s per run, scored after %d s, "
+           "one stamp per node every %d ms\n\n", NODES, DURATION_S, WARMUP_S, FRAME_US / 1000);
+    printf("%-26s", "pairwise spread p99/max, us");
+    for (int e = 0; e < EST_COUNT; e++) {
+        printf(" %17s", est_names[e]);
+    }
+    printf("   %8s %8s %6s %5s\n", "tsync RMS", "reported", "pairs", "rst");
+
+    for (size_t s = 0; s < sizeof(scenarios) / sizeof(scenarios[0]); s++) {
+        const scenario_t *sc = &scenarios[s];
+        sim_result_t r = simulate(sc);
+        double p99[EST_COUNT];
+
+        printf("%-26s", sc->label);
+        for (int e = 0; e < EST_COUNT; e++) {
+            if (!r.spread[e] || r.n == 0) {
+                printf(" %17s", "-");
+                p99[e] = INFINITY;
+                continue;
+            }
+            qsort(r.spread[e], r.n, sizeof(double), cmp_double);
+            p99[e] = r.spread[e][(size_t)(0.99 * (double)(r.n - 1))];
+            printf("  %7.0f / %6.0f", p99[e], r.spread[e][r.n - 1]);
+        }
+        printf("   %8.0f %8.0f %5.0f%% %5u\n",
+               r.values ? sqrt(r.sq[EST_TSYNC] / (double)r.values) : 0.0,
+               r.values ? r.reported / (double)r.values : 0.0,
+               r.beacons ? 100.0 * r.used / (double)r.beacons : 0.0,
+               (unsigned)r.min_restarts);
+
+        if (p99[EST_TSYNC] > p99[EST_CORRECTED]) {
+            printf("  FAIL: tsync worse than the corrected last beacon\n");
+            failures++;
+        }
+        if (sc->step_at_s && r.min_restarts == 0) {
+            printf("  FAIL: a node did not restart after the clock step\n");
+            failures++;
+        }
+        for (int e = 0; e < EST_COUNT; e++) {
+            free(r.spread[e]);
+        }
+    }
+
+    printf("\nspread = max - min of (node stamp - gateway clock) over all nodes at\n"
+           "one instant. tsync RMS = per-node error about the mean of all nodes,\n"
+           "reported = the node's own error_us, pairs = beacons that became fit\n"
+           "points, rst = fewest restarts of any node.\n");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,94 @@
+/*
+ * ============================================================================
+ *                    HOST TOOL - VQ CODEBOOK TRAINER
+ * ============================================================================
+ *
+ * Trains a codebook (imu_vq_train.h) from a capture and writes it as
+ * install frames - the file the gateway sends to the node (opcode
+ * 0xC50001) and the file imu_decode reads to decode VQ frames.
+ *
+ * Usage:
+ *   vq_train [trace.csv|-] [K] [groups] [esc_thresh] [id] > codebook.log
+ *
+ *   trace.csv   Capture to train on ('-' or omitted: synthetic trace)
+ *   K           Codewords per group (default 64, max 254)
+ *   groups      1 = joint 6-D, 2 = accel + gyro (default 2)
+ *   esc_thresh  Escape above this error on any one value (default 99)
+ *   id          Codebook ID 1..255 (default 1)
+ *
+ * A summary (error, escape rate, bytes per sample on the training data)
+ * goes to stderr so stdout stays a clean codebook file.
+ *
+ * Build and run: see tools/README.md
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "imu_vq.h"
+#include "imu_trace.h"
+#include "imu_vq_train.h"
+
+#define BLOCK  20
+
+int main(int argc, char **argv)
+{
+    const char *path = (argc > 1 && strcmp(argv[1], "-") != 0) ? argv[1] : NULL;
+    imu_vq_train_config_t cfg;
+    imu_vq_train_defaults(&cfg);
+    if (argc > 2) cfg.codes = (uint8_t)atoi(argv[2]);
+    if (argc > 3) cfg.groups = (uint8_t)atoi(argv[3]);
+    if (argc > 4) cfg.esc_thresh = (uint16_t)atoi(argv[4]);
+    if (argc > 5) cfg.id = (uint8_t)atoi(argv[5]);
+
+    imu_trace_t tr;
+    if (imu_trace_open(path, &tr, 200 * 120, 200) != 0) {
+        return 1;
+    }
+
+    static imu_vq_codebook_t cb;
+    uint64_t t0 = bench_now_ns();
+    if (imu_vq_train(tr.samples, tr.count, &cfg, &cb) != 0) {
+        fprintf(stderr, "training failed (K 1..%u, groups 1|2, esc_thresh <= %u)\n",
+                IMU_VQ_MAX_CODES, IMU_VQ_MAX_THRESH);
+        imu_trace_free(&tr);
+        return 1;
+    }
+    uint64_t t1 = bench_now_ns();
+
+    // Encode the training data once for the summary
+    static uint8_t frame[IMU_VQ_HEADER_LEN + BLOCK * IMU_VQ_MAX_SAMPLE_BYTES];
+    imu_sample_t decoded[BLOCK];
+    imu_vq_stats_t stats = { 0 };
+    size_t bytes = 0, blocks = tr.count / BLOCK;
+    double sq = 0.0;
+    for (size_t b = 0; b < blocks; b++) {
+        const imu_sample_t *in = &tr.samples[b * BLOCK];
+        size_t len = imu_vq_encode(&cb, (uint8_t)b, in, BLOCK, frame, sizeof(frame), &stats);
+        imu_vq_decode(&cb, frame, len, decoded, BLOCK, NULL);
+        bytes += len;
+        for (int i = 0; i < BLOCK; i++) {
+            for (int a = 0; a < IMU_AXIS_COUNT; a++) {
+                double e = (double)in[i].v[a] - decoded[i].v[a];
+                sq += e * e;
+            }
+        }
+    }
+    uint32_t groups_coded = stats.coded + stats.residual + stats.raw;
+
+    int chunks = imu_vq_codebook_write(stdout, &cb);
+    fprintf(stderr, "Codebook %u: K=%u x %u group(s), esc_thresh=%u, res step %u, trained in %.1f ms\n",
+            cb.id, cb.codes, cb.groups, cb.esc_thresh, 1u << cb.res_shift,
+            (double)(t1 - t0) / 1e6);
+    fprintf(stderr, "  %zu samples (%s): %.2f B/sample, RMS error %.1f, escapes %.2f%% residual + %.2f%% raw\n",
+            tr.count, path ? path : "synthetic",
+            (double)bytes / (double)(blocks * BLOCK),
+            sqrt(sq / (double)(blocks * BLOCK * IMU_AXIS_COUNT)),
+            100.0 * stats.residual / (groups_coded ? groups_coded : 1),
+            100.0 * stats.raw / (groups_coded ? groups_coded : 1));
+    fprintf(stderr, "  %d install chunk(s) written\n", chunks);
+
+    imu_trace_free(&tr);
+    return 0;
+}